@@ -10,11 +10,56 @@
     #define CB_PROG_LOGIC_MAX 256 // Change the value to change how far logic commands can be nested
 #endif
 
+#ifndef CB_READAHEAD_BLOCKS // Avoids redefinition error if '-DCB_READAHEAD_BLOCKS=<number>' is used
+    /* Sets how many CB_FILE_BUF_SIZE blocks the read-ahead thread of a file opened with "p" keeps filled */
+    #define CB_READAHEAD_BLOCKS 3 // Change the value to change how far ahead of the program the file is read
+#endif
+
+#ifndef CB_REC_PAGE_SIZE // Avoids redefinition error if '-DCB_REC_PAGE_SIZE=<number>' is used
+    /* Sets the approximate size of a cached page of a record file opened with FOPENREC */
+    #define CB_REC_PAGE_SIZE 65536 // Change the value to change how many bytes of records are read into the cache at once
+#endif
+
+#ifndef CB_KV_BUCKETS // Avoids redefinition error if '-DCB_KV_BUCKETS=<number>' is used
+    /* Sets the starting hash bucket count of a new KVOPEN store (must be a power of 2) */
+    #define CB_KV_BUCKETS 4096 // Change the value to change how many keys a new store holds before it is rehashed
+#endif
+
+#ifndef CB_KV_GROW // Avoids redefinition error if '-DCB_KV_GROW=<number>' is used
+    /* Sets the minimum amount a KVOPEN store's file grows by when its log fills up */
+    #define CB_KV_GROW 1048576 // Change the value to change how often a store is extended and remapped
+#endif
+
+#ifndef CB_SORT_MEM // Avoids redefinition error if '-DCB_SORT_MEM=<number>' is used
+    /* Sets the default memory budget of SORTFILE in bytes */
+    #define CB_SORT_MEM 268435456 // Change the value to change how much of a file SORTFILE sorts in memory before writing runs
+#endif
+
+#ifndef CB_SORT_MAXRUNS // Avoids redefinition error if '-DCB_SORT_MAXRUNS=<number>' is used
+    /* Sets how many sorted runs SORTFILE merges at once */
+    #define CB_SORT_MAXRUNS 256 // Change the value to change how many temporary files are open at once during a merge
+#endif
+
 #ifndef GCP_TIMEOUT // Avoids redefinition error if '-DGCP_TIMEOUT=<number>' is used
     /* Sets the timeout for getCurPos() before resending the escape code (slower terminals may require a higher value) */
     #define GCP_TIMEOUT 50000 // Change how long getCurPos() waits in microseconds until resending the cursor position request
 #endif
 
+#ifndef CB_FILE_BUF_SIZE // Avoids redefinition error if '-DCB_FILE_BUF_SIZE=<number>' is used
+    /* Sets the size of the stdio buffer given to files opened with FOPEN */
+    #define CB_FILE_BUF_SIZE 262144 // Change the value to change how much is read from or written to a file at once
+#endif
+
+#ifndef CB_SHARD_BUF_SIZE // Avoids redefinition error if '-DCB_SHARD_BUF_SIZE=<number>' is used
+    /* Sets how much output a --jobs shard can queue while a shard before it is still printing */
+    #define CB_SHARD_BUF_SIZE 16777216 // Change the value to change how far a shard can run ahead before its writes block
+#endif
+
+#ifndef CB_CHAN_MAX // Avoids redefinition error if '-DCB_CHAN_MAX=<number>' is used
+    /* Sets how many channels CHANOPEN can have open at once */
+    #define CB_CHAN_MAX 256 // Change the value to change the number of channel IDs
+#endif
+
 /* Uses strcpy and strcat in place of copyStr and copyStrApnd */
 #define BUILT_IN_STRING_FUNCS // Comment out this line to use CLIBASIC string functions
 
@@ -39,6 +84,10 @@
 /* Fix implicit declaration issues */
 #define _POSIX_C_SOURCE 999999L
 #define _XOPEN_SOURCE 999999L
+#define _DEFAULT_SOURCE
+
+/* Use 64-bit file offsets (fseeko/ftello/off_t) on 32-bit systems */
+#define _FILE_OFFSET_BITS 64
 
 /* Check if the buffer size is usable */
 #if (CB_BUF_SIZE < 0)
@@ -74,9 +123,11 @@
 
 #include <math.h>
 #include <time.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
@@ -88,8 +139,10 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#ifndef CB_LIB
 #include <readline/readline.h>
 #include <readline/history.h>
+#endif
 
 // OS-specific includes and definitions
 
@@ -97,7 +150,16 @@
     #include <termios.h>
     #include <sys/ioctl.h>
     #include <sys/wait.h>
+    #include <poll.h>
+    #include <sys/mman.h>
+    #include <sys/uio.h>
+    #include <pthread.h>
     #include <dlfcn.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
 #else
     #include <windows.h>
     #include <conio.h>
@@ -108,6 +170,20 @@
     #include <mach-o/dyld.h>
 #endif
 
+#ifdef __linux__
+    #include <sys/syscall.h>
+    #include <sys/sendfile.h>
+    #include <sys/epoll.h>
+    #include <sys/timerfd.h>
+    #include <linux/fs.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define CB_X86
+    #include <cpuid.h>
+    #include <immintrin.h>
+#endif
+
 // Useful macros
 
 /* Swap function to swap values */
@@ -116,6 +192,15 @@
 /* Free & set to NULL combo */
 #define nfree(ptr) {if (ptr) {free(ptr);} ptr = NULL;}
 
+/* Thread-local storage class */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+    #define CB_TLS _Thread_local
+#elif defined(_MSC_VER)
+    #define CB_TLS __declspec(thread)
+#else
+    #define CB_TLS __thread
+#endif
+
 // Base defines
 
 char VER[] = "0.28.1.4";
@@ -153,74 +238,24 @@ char VER[] = "0.28.1.4";
 // Global vars and functions
 
 #include "clibasic.h"
-
-int progindex = -1;
-char** progbuf = NULL;
-char** progfn = NULL;
-#define progfnstr (progfn[progindex])
-int32_t* progcp = NULL;
-int* progcmdl = NULL;
-int* proglinebuf = NULL;
-
-int err = 0;
-int cerr;
-
-bool inProg = false;
-bool chkinProg = false;
-int progLine = 1;
-
-int varmaxct = 0;
-
-cb_var* vardata = NULL;
-
-char gpbuf[CB_BUF_SIZE];
-
-char* cmd = NULL;
-int cmdl = 0;
-//char** tmpargs = NULL;
-char** arg = NULL;
-uint8_t* argt = NULL;
-int32_t* argl = NULL;
-int argct = -1;
-
-int cmdpos = 0;
-
-bool didloop = false;
-bool lockpl = false;
+#ifdef CB_LIB
+#include "libclibasic.h"
+#if CB_BUF_SIZE != CB_LIB_BUF_SIZE
+    #error "CB_BUF_SIZE must match CB_LIB_BUF_SIZE in libclibasic.h"
+#endif
+#endif
 
 typedef struct {
     uint8_t type;
     uint8_t block;
 } cb_brkinfo;
 
-cb_brkinfo brkinfo;
-cb_brkinfo* oldbrkinfo = NULL;
-
 typedef struct {
     int pl;
     int32_t cp;
     cb_brkinfo brkinfo;
 } cb_jump;
 
-cb_jump dlstack[CB_PROG_LOGIC_MAX];
-bool dldcmd[CB_PROG_LOGIC_MAX];
-int dlstackp = -1;
-int* mindlstackp = NULL;
-
-bool itdcmd[CB_PROG_LOGIC_MAX];
-int itstackp = -1;
-int* minitstackp = NULL;
-bool didelse[CB_PROG_LOGIC_MAX];
-bool didelseif[CB_PROG_LOGIC_MAX];
-
-cb_jump fnstack[CB_PROG_LOGIC_MAX];
-bool fndcmd[CB_PROG_LOGIC_MAX];
-bool fninfor[CB_PROG_LOGIC_MAX];
-int fnstackp = -1;
-int* minfnstackp = NULL;
-char fnvar[CB_BUF_SIZE];
-char forbuf[4][CB_BUF_SIZE];
-
 typedef struct {
     int pl;
     int32_t cp;
@@ -230,10 +265,225 @@ typedef struct {
     cb_brkinfo brkinfo;
 } cb_gosub;
 
-cb_gosub gsstack[CB_PROG_LOGIC_MAX];
-int gsstackp = -1;
+typedef struct {
+    int pl;
+    int32_t cp;
+    bool used;
+    char* name;
+    int dlsp;
+    int fnsp;
+    int itsp;
+    cb_brkinfo brkinfo;
+} cb_goto;
+
+typedef struct {
+    bool inuse;
+    char* path;
+    int fd;
+    char* map;
+    int64_t cap;
+} cb_kv;
+
+typedef struct {
+    bool inuse;
+    bool owner;    // created the segment, unlinks it when dropped
+    bool borrowed; // mapping belongs to another context
+    char* name;
+    char* key;
+    uint8_t type;
+    int32_t size;
+    int32_t width; // bytes per element
+    char* map;
+    size_t maplen;
+} cb_shm;
+
+// Saved execution state of a coroutine, the stacks are only valid up to depth
+typedef struct {
+    bool waiting;
+    int fd;         // file descriptor to wait for, -1 if none
+    uint64_t until; // usTime() to stop waiting at, 0 if none
+    int32_t cp;
+    int cl;
+    int pl;
+    bool lock;
+    bool looped;
+    cb_brkinfo brkinfo;
+    int dlsp;
+    int itsp;
+    int fnsp;
+    int gssp;
+    int depth;
+    cb_jump dl[CB_PROG_LOGIC_MAX];
+    bool dld[CB_PROG_LOGIC_MAX];
+    bool itd[CB_PROG_LOGIC_MAX];
+    bool ite[CB_PROG_LOGIC_MAX];
+    bool itei[CB_PROG_LOGIC_MAX];
+    cb_jump fn[CB_PROG_LOGIC_MAX];
+    bool fnd[CB_PROG_LOGIC_MAX];
+    bool fni[CB_PROG_LOGIC_MAX];
+    cb_gosub gs[CB_PROG_LOGIC_MAX];
+} cb_co;
+
+// Event source watched by EVWAIT, its id is the index + 1
+typedef struct {
+    bool inuse;
+    bool timer;
+    bool polled;       // false for files that cannot be polled (regular files), they are ready until EOF
+    int fnum;          // file number, -1 for stdin
+    int fd;            // descriptor in the epoll set, the timerfd for timers on Linux
+    uint64_t next;     // usTime() of the next tick of an emulated timer
+    uint64_t interval; // 0 for one-shot timers
+} cb_ev;
+
+// SORTFILE options, passed down the sort so tasks can sort at the same time
+typedef struct {
+    bool rev;
+    bool num;
+    bool fold;
+    bool uniq;
+    int key;
+    char sep;
+    int64_t mem;
+    int jobs;
+} cb_sortopts;
+
+typedef struct {
+    char* var;
+    uint8_t op; // 0 = +, 1 = *, 2 = MIN, 3 = MAX
+    double val;
+} cb_parred;
+
+// Per-program interpreter state, everything runcmd, getVal, and friends read and write
+// through the thread-local cbctx with CBX(field)
+
+struct cb_ctx {
+    int progindex;
+    char** progbuf;
+    char** progfn;
+    int32_t* progcp;
+    int* progcmdl;
+    int* proglinebuf;
+    int err;
+    int cerr;
+    bool inProg;
+    bool chkinProg;
+    int progLine;
+    int varmaxct;
+    cb_var* vardata;
+    char* cmd;
+    int cmdl;
+    char** arg;
+    uint8_t* argt;
+    int32_t* argl;
+    int argct;
+    int cmdpos;
+    int32_t cp;
+    bool didloop;
+    bool lockpl;
+    cb_brkinfo brkinfo;
+    cb_brkinfo* oldbrkinfo;
+    cb_jump dlstack[CB_PROG_LOGIC_MAX];
+    bool dldcmd[CB_PROG_LOGIC_MAX];
+    int dlstackp;
+    int* mindlstackp;
+    bool itdcmd[CB_PROG_LOGIC_MAX];
+    int itstackp;
+    int* minitstackp;
+    bool didelse[CB_PROG_LOGIC_MAX];
+    bool didelseif[CB_PROG_LOGIC_MAX];
+    cb_jump fnstack[CB_PROG_LOGIC_MAX];
+    bool fndcmd[CB_PROG_LOGIC_MAX];
+    bool fninfor[CB_PROG_LOGIC_MAX];
+    int fnstackp;
+    int* minfnstackp;
+    char fnvar[CB_BUF_SIZE];
+    char forbuf[4][CB_BUF_SIZE];
+    cb_gosub gsstack[CB_PROG_LOGIC_MAX];
+    int gsstackp;
+    char* errstr;
+    int progargc;
+    int* oldprogargc;
+    int newprogargc;
+    char** progargs;
+    char*** oldprogargs;
+    char** newprogargs;
+    bool argslater;
+    int retval;
+    int exitcode;
+    cb_goto* gotodata;
+    cb_goto** proggotodata;
+    int gotomaxct;
+    int* proggotomaxct;
+    cb_file* filedata;
+    int filemaxct;
+    int fileerror;
+    cb_kv* kvdata;
+    int kvmaxct;
+    cb_shm* shmdata;
+    int shmmaxct;
+    cb_var* parvars; // variables of the program that started this PARFOR chunk, whose arrays it shares
+    int parvarct;
+    cb_co** codata;
+    int comaxct;
+    int coself;
+    int coprog;
+    int codepth;
+    cb_ev* evdata;
+    int evmaxct;
+    int evep;
+    bool evepok;
+    int evlast;
+    int evpend;
+    char* evlbl;
+    int evprog;
+    int evgs;
+    uint64_t evchk;
+    char* tmrlbl;
+    int tmrprog;
+    int tmrgs;
+    uint64_t tmrint;
+    uint64_t tmrnext;
+    uint64_t waitend;
+    int waitcp;
+    char* chkCmdPtr;
+    char gpbuf[CB_BUF_SIZE];
+    char getstrbuf[CB_BUF_SIZE];
+    char* bfnbuf;
+    uint16_t getFuncIndex;
+    char* getFunc_gftmp[2];
+    uint16_t getVarIndex;
+    char* getVarBuf;
+    char setVarBuf[CB_BUF_SIZE];
+    uint16_t getValIndex;
+    char* getVal_tmp[4];
+    char runcmdbuf[2][CB_BUF_SIZE];
+    char* lttmp_tmp[3];
+    int logictestexpr_index;
+    char* ltbuf_tmp;
+    int logictest_index;
+    char ltmp[2][CB_BUF_SIZE];
+    int lasterr;
+};
+
+cb_ctx cbmainctx;
+CB_TLS cb_ctx* cbctx = &cbmainctx;
+
+static inline void initCtx(cb_ctx* ctx) {
+    memset(ctx, 0, sizeof(cb_ctx));
+    ctx->progindex = -1;
+    ctx->progLine = 1;
+    ctx->argct = -1;
+    ctx->dlstackp = -1;
+    ctx->itstackp = -1;
+    ctx->fnstackp = -1;
+    ctx->gsstackp = -1;
+}
+
+cb_ctx* getCtx() {return cbctx;}
+void setCtx(cb_ctx* ctx) {cbctx = (ctx) ? ctx : &cbmainctx;}
 
-char* errstr = NULL;
+#define CBX(name) (cbctx->name) // field of the context bound to this thread
+#define progfnstr (CBX(progfn)[CBX(progindex)])
 
 char conbuf[CB_BUF_SIZE];
 char prompt[CB_BUF_SIZE];
@@ -244,7 +494,6 @@ int curx = 0;
 int cury = 0;
 
 int concp = 0;
-int32_t cp = 0;
 
 bool cmdint = false;
 bool inprompt = false;
@@ -263,6 +512,28 @@ bool sh_silent = false;
 bool sh_clearAttrib = true;
 bool sh_restoreAttrib = true;
 
+#ifndef _WIN32
+typedef struct {
+    pid_t pid;
+    int in;
+    int out;
+    char* cwd;
+    int gen;              // shpoolgen when the shell was started
+    pthread_mutex_t lock; // held by the task running a command on this worker
+} cb_shworker;
+
+cb_shworker* shpool = NULL;
+int shpoolct = 0;
+unsigned shpoolnext = 0;
+int shpoolgen = 0; // bumped when the environment changes so workers restart before their next command
+char shpoolnonce[17]; // random hex picked when the pool starts, ends the marker line each command prints last
+pthread_rwlock_t shpoollock = PTHREAD_RWLOCK_INITIALIZER; // write-locked to start or stop the pool
+pthread_mutex_t shpoolsiglock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+int shardid = 0;
+int shardct = 1;
+
 cb_txt txtattrib;
 
 bool textlock = false;
@@ -277,40 +548,11 @@ bool autohist = false;
 
 int tab_width = 4;
 
-int progargc = 0;
-int* oldprogargc = NULL;
-int newprogargc = 0;
-char** progargs = NULL;
-char*** oldprogargs = NULL;
-char** newprogargs = NULL;
 char* startcmd = NULL;
-bool argslater = false;
 
 bool changedtitle = false;
 bool changedtitlecmd = false;
 
-int retval = 0;
-
-typedef struct {
-    int pl;
-    int32_t cp;
-    bool used;
-    char* name;
-    int dlsp;
-    int fnsp;
-    int itsp;
-    cb_brkinfo brkinfo;
-} cb_goto;
-
-cb_goto* gotodata = NULL;
-cb_goto** proggotodata = NULL;
-int gotomaxct = 0;
-int* proggotomaxct = NULL;
-
-cb_file* filedata = NULL;
-int filemaxct = 0;
-int fileerror = 0;
-
 typedef struct {
     char* name;
     char* data;
@@ -321,7 +563,9 @@ int submaxct = 0;
 bool addsub = false;
 int subindex = -1;
 
+#ifndef CB_LIB
 char* rl_tmpptr = NULL;
+#endif
 
 typedef struct {
     bool inuse;
@@ -347,8 +591,8 @@ struct termios initterm;
 void txtqunlock() {if (textlock || sneaktextlock) {tcsetattr(0, TCSANOW, &restore); textlock = false;}}
 
 int kbhit() {
-    int inchar;
-    ioctl(0, FIONREAD, &inchar);
+    int inchar = 0;
+    if (ioctl(0, FIONREAD, &inchar) == -1) return 0;
     return inchar;
 }
 
@@ -373,6 +617,7 @@ static inline void* setsig(int sig, void* func) {
     #endif
 }
 
+#ifndef CB_LIB
 int tab_end = 0;
 static inline void strApndChar(char*, char);
 char* rl_get_tab(const char* text, int state) {
@@ -396,30 +641,31 @@ char** rl_tab(const char* text, int start, int end) {
     tab = rl_completion_matches(text, rl_get_tab);
     return tab;
 }
+#endif
 
 static inline void clearGlobals() {
-    dlstackp = -1;
-    itstackp = -1;
-    fnstackp = -1;
-    gsstackp = -1;
-    memset(&brkinfo, 0, sizeof(brkinfo));
+    CBX(dlstackp) = -1;
+    CBX(itstackp) = -1;
+    CBX(fnstackp) = -1;
+    CBX(gsstackp) = -1;
+    memset(&CBX(brkinfo), 0, sizeof(CBX(brkinfo)));
     for (int i = 0; i < CB_PROG_LOGIC_MAX; ++i) {
-        memset(&dlstack[i], 0, sizeof(cb_jump));
-        dldcmd[i] = false;
-        memset(&fnstack[i], 0, sizeof(cb_jump));
-        fnstack[i].cp = -1;
-        fndcmd[i] = false;
-        fninfor[i] = false;
-        itdcmd[i] = false;
-        didelse[i] = false;
-        didelseif[i] = false;
-        memset(&gsstack[i], 0, sizeof(cb_jump));
-    }
-    for (int i = 0; i < gotomaxct; ++i) {
-        if (gotodata[i].used) nfree(gotodata[i].name);
-    }
-    nfree(gotodata);
-    gotomaxct = 0;
+        memset(&CBX(dlstack)[i], 0, sizeof(cb_jump));
+        CBX(dldcmd)[i] = false;
+        memset(&CBX(fnstack)[i], 0, sizeof(cb_jump));
+        CBX(fnstack)[i].cp = -1;
+        CBX(fndcmd)[i] = false;
+        CBX(fninfor)[i] = false;
+        CBX(itdcmd)[i] = false;
+        CBX(didelse)[i] = false;
+        CBX(didelseif)[i] = false;
+        memset(&CBX(gsstack)[i], 0, sizeof(cb_jump));
+    }
+    for (int i = 0; i < CBX(gotomaxct); ++i) {
+        if (CBX(gotodata)[i].used) nfree(CBX(gotodata)[i].name);
+    }
+    nfree(CBX(gotodata));
+    CBX(gotomaxct) = 0;
     for (int i = extmaxct - 1; i > -1; --i) {
         if (extdata[i].inuse && extdata[i].clearGlobals) {
             extdata[i].clearGlobals();
@@ -448,6 +694,7 @@ void setcsr() {
     coord.Y = 0;
     SetConsoleCursorPosition(hConsole, coord);
 }
+#ifndef CB_LIB
 void rl_sigh(int sig) {
     setsig(sig, rl_sigh);
     putchar('\n');
@@ -455,6 +702,7 @@ void rl_sigh(int sig) {
     rl_replace_line("", 0);
     rl_redisplay();
 }
+#endif
 void txtqunlock() {}
 #ifndef _WIN_NO_VT
 bool vtenabled = false;
@@ -534,7 +782,6 @@ WORD ocAttrib = 0;
 #endif
 #endif
 
-struct timeval time1;
 uint64_t tval;
 
 void* oldsigh = NULL;
@@ -558,27 +805,160 @@ void unloadAllProg();
 static inline char* basefilename(char*);
 static inline char* pathfilename(char*);
 int openFile(char*, char*);
+int sockListen(char*);
+int sockAccept(int);
+int openRecFile(char*, int32_t, int32_t);
+bool fileGetRec(int, int64_t, char*);
+bool filePutRec(int, int64_t, char*);
+int kvOpen(char*);
+bool kvClose(int);
+bool kvGet(int, char*, char*);
+bool kvPut(int, char*, char*);
+bool kvDel(int, char*);
+bool shmDim(char*, int32_t, int32_t, char*);
+bool shmAdd(char*, double);
+static inline int shmFind(char*);
+static uint8_t shmGet(int, bool, int32_t, char*);
+static bool shmSet(int, bool, int32_t, char*, uint8_t, int32_t);
+static void shmDrop(int);
+void shmFreeAll();
+bool sortParseOpts(char*, cb_sortopts*);
+bool sortFile(char*, char*, cb_sortopts*);
+int32_t grepFiles(char*, char*, char*);
+int32_t dirList(char*, char*, bool);
+int dimVar(char*, uint8_t, int32_t);
+int taskSpawn(char*, int, char**, bool);
+int taskJoin(int);
+int parFor(char*, double, double, cb_parred*, int);
+int coStart(char*);
+void coWait(double, int);
+void coYield(bool);
+int coCount();
+void coFreeAll();
+int evWatch(int);
+int evTimer(double, bool);
+bool evUnwatch(int);
+int evWait(double);
+static void evCheck();
+bool tmrStart(double, char*);
+void tmrStop();
+static void tmrCheck();
+static inline int64_t tmrLeft(uint64_t);
+static void progWait(uint64_t);
+static inline bool isLabel(char*);
+int chanOpen(int32_t);
+bool chanClose(int);
+bool chanSend(int, char*);
+bool chanRecv(int, char*);
 bool closeFile(int);
+static inline int fileGetc(int);
+static inline int32_t fileRead(int, char*, int32_t);
+static inline int32_t fileReadLine(int, char*, int32_t);
+static inline bool fileEOF(int);
+static inline int64_t fileTell(int);
+static inline bool fileSeek(int, int64_t);
+static inline int64_t fileSize(int);
+static inline bool fileWrite(int, char*, bool);
+static inline bool fileFlush(int);
+static inline bool fileSetBuf(int, int32_t);
+#ifndef _WIN32
+void shpoolStop();
+#endif
 static inline void upCase(char*);
 uint8_t logictest(char*);
 int loadExt(char*);
 bool unloadExt(int);
 
+static void freeCtxMem() {
+    freeBaseMem();
+    shmFreeAll();
+    coFreeAll();
+    evUnwatch(-1);
+    nfree(CBX(evlbl));
+    tmrStop();
+    for (int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse) {
+            if (CBX(vardata)[i].size == -1) CBX(vardata)[i].size = 0;
+            for (int32_t j = 0; j <= CBX(vardata)[i].size; ++j) {
+                nfree(CBX(vardata)[i].data[j]);
+            }
+            nfree(CBX(vardata)[i].data);
+            nfree(CBX(vardata)[i].name);
+        }
+    }
+    for (int i = 0; i < CBX(gotomaxct); ++i) {
+        if (CBX(gotodata)[i].used) {
+            nfree(CBX(gotodata)[i].name);
+        }
+    }
+    for (int i = 0; i < CBX(argct); ++i) {
+        nfree(CBX(arg)[i]);
+    }
+    nfree(CBX(cmd));
+    nfree(CBX(arg));
+    nfree(CBX(argt));
+    nfree(CBX(argl));
+    nfree(CBX(errstr));
+    nfree(CBX(vardata));
+    if (CBX(progindex) > -1) {
+        nfree(CBX(progbuf)[0]);
+        nfree(CBX(progfn)[0]);
+    }
+    nfree(CBX(progbuf));
+    nfree(CBX(progfn));
+    nfree(CBX(progcp));
+    nfree(CBX(progcmdl));
+    nfree(CBX(proglinebuf));
+    nfree(CBX(minfnstackp));
+    nfree(CBX(mindlstackp));
+    nfree(CBX(minitstackp));
+    nfree(CBX(proggotodata));
+    nfree(CBX(proggotomaxct));
+    nfree(CBX(oldprogargc));
+    nfree(CBX(oldprogargs));
+    clearGlobals();
+}
+
+static cb_ctx* newCtx() {
+    cb_ctx* ctx = malloc(sizeof(cb_ctx));
+    if (!ctx) return NULL;
+    initCtx(ctx);
+    cb_ctx* oldctx = cbctx;
+    cbctx = ctx;
+    initBaseMem();
+    clearGlobals();
+    cbctx = oldctx;
+    return ctx;
+}
+
+static void destroyCtx(cb_ctx* ctx) {
+    cb_ctx* oldctx = cbctx;
+    cbctx = ctx;
+    unloadAllProg();
+    closeFile(-1);
+    kvClose(-1);
+    freeCtxMem();
+    cbctx = (oldctx == ctx) ? &cbmainctx : oldctx;
+    free(ctx);
+}
+
 void cleanExit() {
     txtqunlock();
     int ret;
     if (inprompt) {
         int i = kbhit();
-        if (i) {ret = read(0, &gpbuf, i);}
+        if (i) {ret = read(0, &CBX(gpbuf), i);}
         getCurPos();
         unloadAllProg();
         cmdint = true;
         putchar('\n');
+        #ifndef CB_LIB
         history_set_pos(history_length);
         rl_on_new_line();
         rl_replace_line("", 0);
         rl_pending_input = false;
         rl_redisplay();
+        #endif
         return;
     }
     setsig(SIGINT, forceExit);
@@ -586,8 +966,13 @@ void cleanExit() {
     fflush(stdout);
     unloadAllProg();
     closeFile(-1);
+    kvClose(-1);
+    #ifndef _WIN32
+    shpoolStop();
+    #endif
     ret = chdir(gethome());
     (void)ret;
+    #ifndef CB_LIB
     if (autohist && !runfile) {
         write_history(HIST_FILE);
         #ifdef _WIN32
@@ -596,6 +981,7 @@ void cleanExit() {
     }
     rl_clear_history();
     clear_history();
+    #endif
     #if defined(CHANGE_TITLE) && !defined(_WIN_NO_VT)
     if (esc && changedtitle) fputs("\e[23;0t", stdout);
     #endif
@@ -613,55 +999,17 @@ void cleanExit() {
         getCurPos();
         if (curx != 1) putchar('\n');
     }
-    freeBaseMem();
-    for (int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse) {
-            if (vardata[i].size == -1) vardata[i].size = 0;
-            for (int32_t j = 0; j <= vardata[i].size; ++j) {
-                nfree(vardata[i].data[j]);
-            }
-            nfree(vardata[i].data);
-            nfree(vardata[i].name);
-        }
-    }
-    for (int i = 0; i < gotomaxct; ++i) {
-        if (gotodata[i].used) {
-            nfree(gotodata[i].name);
-        }
-    }
-    for (int i = 0; i < argct; ++i) {
-        nfree(arg[i]);
-    }
     nfree(startcmd);
+    #ifndef CB_LIB
     nfree(rl_tmpptr);
-    nfree(cmd);
-    nfree(arg);
-    nfree(argt);
-    nfree(argl);
-    nfree(errstr);
-    nfree(vardata);
-    if (progindex > -1) {
-        nfree(progbuf[0]);
-        nfree(progfn[0]);
-    }
-    nfree(progbuf);
-    nfree(progfn);
-    nfree(progcp);
-    nfree(progcmdl);
-    nfree(proglinebuf);
-    nfree(minfnstackp);
-    nfree(mindlstackp);
-    nfree(minitstackp);
-    nfree(proggotodata);
-    nfree(proggotomaxct);
-    nfree(oldprogargc);
-    nfree(oldprogargs);
+    #endif
+    freeCtxMem();
     clearGlobals();
     unloadExt(-1);
     #ifndef _WIN32
     tcsetattr(0, TCSANOW, &initterm);
     #endif
-    exit(err);
+    exit(CBX(err));
 }
 
 void cmdIntHndl() {
@@ -681,9 +1029,13 @@ static inline void copyStrApndNoEsc(char*, char*);
 static inline void copyStrTo(char*, int32_t, char*);
 static inline void copyStrSnip(char*, int32_t, int32_t, char*);
 uint8_t getVal(char*, char*);
+uint8_t getVar(char*, char*);
+bool setVar(char*, char*, uint8_t, int32_t);
 static inline void resetTimer();
 bool loadProg(char*);
+static void pushProg(char*, const char*, int32_t);
 void unloadProg();
+static bool runLoop(bool);
 static inline void updateTxtAttrib();
 static inline int isFile();
 static inline uint64_t usTime();
@@ -703,7 +1055,6 @@ static inline char* gethome() {
     return homepath;
 }
 
-char* bfnbuf = NULL;
 
 static inline char* basefilename(char* fn) {
     int32_t fnlen = strlen(fn);
@@ -714,8 +1065,8 @@ static inline char* basefilename(char* fn) {
         if (fn[i] == '\\') break;
         #endif
     }
-    copyStrSnip(fn, i + 1, fnlen, bfnbuf);
-    return bfnbuf;
+    copyStrSnip(fn, i + 1, fnlen, CBX(bfnbuf));
+    return CBX(bfnbuf);
 }
 
 static inline char* pathfilename(char* fn) {
@@ -727,8 +1078,8 @@ static inline char* pathfilename(char* fn) {
         if (fn[i] == '\\') break;
         #endif
     }
-    copyStrTo(fn, i + 1, bfnbuf);
-    return bfnbuf;
+    copyStrTo(fn, i + 1, CBX(bfnbuf));
+    return CBX(bfnbuf);
 }
 
 static inline void ttycheck() {
@@ -761,14 +1112,14 @@ static inline void readyTerm() {
     } else if (!skip) {
         char* tmpcwd = getcwd(NULL, 0);
         int ret = chdir(homepath);
-        bool tmp_inProg = inProg;
-        inProg = true;
+        bool tmp_inProg = CBX(inProg);
+        CBX(inProg) = true;
         autorun = true;
-        argslater = false;
+        CBX(argslater) = false;
         if (!loadProg(".clibasicrc"))
             if (!loadProg("autorun.bas"))
                 if (!loadProg(".autorun.bas"))
-                    {autorun = false; inProg = tmp_inProg;}
+                    {autorun = false; CBX(inProg) = tmp_inProg;}
         ret = chdir(tmpcwd);
         nfree(tmpcwd);
         (void)ret;
@@ -782,11 +1133,117 @@ char roptstr[16] = "-";
 #define IACT() {fputs("Incorrect number of arguments passed.\n", stderr);}
 #define IOCT() {fputs("Incorrect number of options passed.\n", stderr);}
 
+#ifndef CB_LIB
+#ifndef _WIN32
+// Forks shardct copies of the loaded program; the children return and run it with stdout going to a
+// pipe, the parent prints the output of each child in shard order, and exits with the worst exit
+// code. The first unfinished shard is copied straight through, later ones are queued up to
+// CB_SHARD_BUF_SIZE and then left unread (so their writes block) until it is their turn
+static void runShards() {
+    pid_t* pids = (pid_t*)malloc(shardct * sizeof(pid_t));
+    struct pollfd* pfd = (struct pollfd*)malloc(shardct * sizeof(struct pollfd));
+    fflush(stdout);
+    for (int i = 0; i < shardct; ++i) {
+        int p[2];
+        if (pipe(p)) {fputs("Failed to create a pipe for a job.\n", stderr); exit(1);}
+        pid_t pid = fork();
+        if (pid == -1) {fputs("Failed to start a job.\n", stderr); exit(1);}
+        if (!pid) {
+            for (int j = 0; j < i; ++j) {close(pfd[j].fd);}
+            close(p[0]);
+            dup2(p[1], 1);
+            close(p[1]);
+            free(pids);
+            free(pfd);
+            shardid = i;
+            redirection = true; // stdout is the pipe to the parent now
+            return;
+        }
+        close(p[1]);
+        pids[i] = pid;
+        pfd[i].fd = p[0];
+        pfd[i].events = POLLIN;
+    }
+    signal(SIGINT, SIG_IGN);
+    char** buf = (char**)calloc(shardct, sizeof(char*));
+    size_t* len = (size_t*)calloc(shardct, sizeof(size_t));
+    size_t* size = (size_t*)calloc(shardct, sizeof(size_t));
+    bool* done = (bool*)calloc(shardct, sizeof(bool));
+    char rbuf[65536];
+    int head = 0;
+    while (head < shardct) {
+        if (done[head]) {
+            // its turn came after it finished, print what it queued and move on
+            if (len[head]) fwrite(buf[head], 1, len[head], stdout);
+            nfree(buf[head]);
+            ++head;
+            continue;
+        }
+        if (len[head]) {
+            fwrite(buf[head], 1, len[head], stdout);
+            nfree(buf[head]);
+            len[head] = size[head] = 0;
+        }
+        fflush(stdout);
+        // a full queue is taken out of the poll set by negating its fd
+        for (int i = head; i < shardct; ++i) {
+            if (done[i]) continue;
+            bool full = (i != head && len[i] >= CB_SHARD_BUF_SIZE);
+            if (full == (pfd[i].fd >= 0)) pfd[i].fd = -pfd[i].fd - 1;
+        }
+        if (poll(&pfd[head], shardct - head, -1) == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = head; i < shardct; ++i) {
+            if (pfd[i].fd < 0 || !pfd[i].revents) continue;
+            char* dst = rbuf;
+            size_t room = sizeof(rbuf);
+            if (i != head) {
+                if (size[i] - len[i] < sizeof(rbuf)) {
+                    size[i] = (size[i]) ? size[i] * 2 : sizeof(rbuf) * 2;
+                    buf[i] = realloc(buf[i], size[i]);
+                }
+                dst = &buf[i][len[i]];
+                room = size[i] - len[i];
+            }
+            ssize_t ct = read(pfd[i].fd, dst, room);
+            if (ct > 0) {
+                if (i == head) fwrite(rbuf, 1, ct, stdout);
+                else len[i] += ct;
+            } else if (ct == 0 || errno != EINTR) {
+                close(pfd[i].fd);
+                done[i] = true;
+            }
+        }
+    }
+    fflush(stdout);
+    int ret = 0;
+    for (int i = 0; i < shardct; ++i) {
+        int status = 0;
+        while (waitpid(pids[i], &status, 0) == -1 && errno == EINTR) {}
+        int tmpret = (WIFEXITED(status)) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        if (tmpret > ret) ret = tmpret;
+        free(buf[i]);
+    }
+    free(buf);
+    free(len);
+    free(size);
+    free(done);
+    free(pfd);
+    free(pids);
+    exit(ret);
+}
+#endif
+
 int main(int argc, char** argv) {
+    initCtx(&cbmainctx);
     bool pexit = false;
     bool info = false;
     #ifndef _WIN32
     tcgetattr(0, &initterm);
+    // stdin is read unbuffered so EVWATCH on it is not fooled by input that stdio already holds
+    setvbuf(stdin, NULL, _IONBF, 0);
     #endif
     for (int i = 1; i < argc; ++i) {
         int shortopti = 0;
@@ -825,6 +1282,9 @@ int main(int argc, char** argv) {
                 puts("    --version                   Displays the version and license information.");
                 puts("    -x, --exec FILE [ARG]...    Runs FILE and passes ARGs to FILE.");
                 puts("    -c, --command COMMAND       Runs COMMAND as if in shell mode.");
+                #ifndef _WIN32
+                puts("    -j, --jobs N                Runs FILE or COMMAND in N processes and prints their output in order.");
+                #endif
                 puts("    -k, --keep                  Stops CLIBASIC from resetting text attributes when exiting.");
                 puts("    -s, --skip                  Skips searching for autorun programs.");
                 puts("    -i, --info                  Displays an info string when starting in shell mode.");
@@ -839,16 +1299,28 @@ int main(int argc, char** argv) {
                 if (runfile) {unloadProg(); IOCT(); exit(1);}
                 ++i;
                 if (!argv[i]) {fputs("No filename provided.\n", stderr); exit(1);}
-                argslater = true;
-                if (!loadProg(argv[i])) {printError(cerr); exit(1);}
-                inProg = true;
+                CBX(argslater) = true;
+                if (!loadProg(argv[i])) {printError(CBX(cerr)); exit(1);}
+                CBX(inProg) = true;
                 runfile = true;
-                progargs = (char**)malloc((argc - i) * sizeof(char*));
-                for (progargc = 1; progargc < argc - i; ++progargc) {	
-                    progargs[progargc] = malloc(strlen(argv[i + progargc]) + 1);
-                    copyStr(argv[i + progargc], progargs[progargc]);
+                CBX(progargs) = (char**)malloc((argc - i) * sizeof(char*));
+                for (CBX(progargc) = 1; CBX(progargc) < argc - i; ++CBX(progargc)) {	
+                    CBX(progargs)[CBX(progargc)] = malloc(strlen(argv[i + CBX(progargc)]) + 1);
+                    copyStr(argv[i + CBX(progargc)], CBX(progargs)[CBX(progargc)]);
                 }
                 i = argc;
+            #ifndef _WIN32
+            } else if (!strcmp(argv[i], "--jobs") || (shortopt && argv[i][shortopti] == 'j')) {
+                if (shortopt && argv[i][shortopti + 1]) {RARG(); exit(1);}
+                if (runfile) {fputs("Jobs must be set before the file or command.\n", stderr); exit(1);}
+                if (shardct > 1) {IOCT(); exit(1);}
+                ++i;
+                if (!argv[i]) {fputs("No job count provided.\n", stderr); exit(1);}
+                char* tmpptr;
+                long tmpct = strtol(argv[i], &tmpptr, 10);
+                if (*tmpptr || tmpct < 1 || tmpct > 1024) {fprintf(stderr, "Invalid job count '%s'.\n", argv[i]); exit(1);}
+                shardct = tmpct;
+            #endif
             } else if (!strcmp(argv[i], "--keep") || (shortopt && argv[i][shortopti] == 'k')) {
                 if (keep) {IOCT(); exit(1);}
                 keep = true;
@@ -904,19 +1376,25 @@ int main(int argc, char** argv) {
             if (runc) {fputs("Cannot run command and file.\n", stderr); exit(1);}
             if (runfile) {unloadProg(); IOCT(); exit(1);}
             if (!argv[i]) {fputs("No filename provided.\n", stderr); exit(1);}
-            argslater = true;
-            if (!loadProg(argv[i])) {printError(cerr); exit(1);}
-            inProg = true;
+            CBX(argslater) = true;
+            if (!loadProg(argv[i])) {printError(CBX(cerr)); exit(1);}
+            CBX(inProg) = true;
             runfile = true;
-            progargs = (char**)malloc((argc - i) * sizeof(char*));
-            for (progargc = 1; progargc < argc - i; ++progargc) {	
-                progargs[progargc] = malloc(strlen(argv[i + progargc]) + 1);
-                copyStr(argv[i + progargc], progargs[progargc]);
+            CBX(progargs) = (char**)malloc((argc - i) * sizeof(char*));
+            for (CBX(progargc) = 1; CBX(progargc) < argc - i; ++CBX(progargc)) {	
+                CBX(progargs)[CBX(progargc)] = malloc(strlen(argv[i + CBX(progargc)]) + 1);
+                copyStr(argv[i + CBX(progargc)], CBX(progargs)[CBX(progargc)]);
             }
             i = argc;
         }
     }
     if (pexit) exit(0);
+    #ifndef _WIN32
+    if (shardct > 1) {
+        if (!runfile) {fputs("Jobs require a file or command.\n", stderr); exit(1);}
+        runShards();
+    }
+    #endif
     roptstr[roptptr++] = 'x';
     readyTerm();
     rl_readline_name = "CLIBASIC";
@@ -1023,9 +1501,9 @@ int main(int argc, char** argv) {
         #endif
         #endif
     }
-    cmd = NULL;
-    argt = NULL;
-    arg = NULL;
+    CBX(cmd) = NULL;
+    CBX(argt) = NULL;
+    CBX(arg) = NULL;
     srand(usTime());
     if (!runfile && gethome()) {
         char* tmpcwd = getcwd(NULL, 0);
@@ -1042,17 +1520,17 @@ int main(int argc, char** argv) {
         free(tmpcwd);
         (void)ret;
     }
-    cerr = 0;
+    CBX(cerr) = 0;
     initBaseMem();
     resetTimer();
-    if (inProg || runc) {
+    if (CBX(inProg) || runc) {
         clearGlobals();
     }
     while (!pexit) {
         fchkint:;
-        cp = 0;
-        if (chkinProg) {inProg = true; chkinProg = false;}
-        if (!inProg && !runc) {
+        CBX(cp) = 0;
+        if (CBX(chkinProg)) {CBX(inProg) = true; CBX(chkinProg) = false;}
+        if (!CBX(inProg) && !runc) {
             if (runfile) cleanExit();
             clearGlobals();
             promptReady();
@@ -1088,7 +1566,7 @@ int main(int argc, char** argv) {
             updateTxtAttrib();
             concp = 0;
             inprompt = false;
-            if (!tmpstr) {err = 0; cleanExit();}
+            if (!tmpstr) {CBX(err) = 0; cleanExit();}
             int32_t tmpptr;
             if (tmpstr[0] == 0) {nfree(tmpstr); goto brkproccmd;}
             for (tmpptr = 0; tmpstr[tmpptr] == ' '; ++tmpptr) {}
@@ -1112,68 +1590,11 @@ int main(int argc, char** argv) {
             cmdint = false;
         }
         if (runc) runc = false;
-        cmdl = 0;
-        didloop = false;
-        bool inStr = false;
+        CBX(cmdl) = 0;
+        CBX(didloop) = false;
         if (!runfile) setsig(SIGINT, cmdIntHndl);
-        progLine = 1;
-        bool comment = false;
-        while (1) {
-            rechk:;
-            if (progindex < 0) {inProg = false;}
-            else if (inProg == false) {progindex = - 1;}
-            if (inProg) {
-                if (progbuf[progindex][cp] == '"') {inStr = !inStr; cmdl++;} else
-                if ((progbuf[progindex][cp] == ':' && !inStr) || progbuf[progindex][cp] == '\n' || progbuf[progindex][cp] == 0) {
-                    if (cp - cmdl > 0 && progbuf[progindex][cp - cmdl - 1] == '\n') {
-                        if (!lockpl) progLine++;
-                        if (inStr) inStr = false;
-                    }
-                    if (lockpl) lockpl = false;
-                    while (progbuf[progindex][cp - cmdl] == ' ' && cmdl > 0) {cmdl--;}
-                    cmd = (char*)realloc(cmd, cmdl + 1);
-                    cmdpos = cp - cmdl;
-                    copyStrSnip(progbuf[progindex], cp - cmdl, cp, cmd);
-                    cmdl = 0;
-                    runcmd();
-                    if (cmdint) {inProg = false; unloadAllProg(); cmdint = false; goto brkproccmd;}
-                    if (cp == -1) {inProg = false; unloadAllProg(); goto brkproccmd;}
-                    if (cp > -1 && progbuf[progindex][cp] == 0) {
-                        unloadProg();
-                        err = 0;
-                        if (progindex < 0) {
-                            inProg = false;
-                            goto rechk;
-                        } else {
-                            didloop = true;
-                        }
-                    }
-                } else
-                {cmdl++;}
-                if (!didloop) {cp++;} else {didloop = false;}
-            } else {
-                if (!inStr && (conbuf[concp] == '\'' || conbuf[concp] == '#')) comment = true;
-                if (!inStr && conbuf[concp] == '\n') comment = false;
-                if (!inStr) {conbuf[concp] = ((conbuf[concp] >= 'a' && conbuf[concp] <= 'z') ? conbuf[concp] - 32 : conbuf[concp]);}
-                if (conbuf[concp] == '"') {inStr = !inStr; cmdl++;} else
-                if ((conbuf[concp] == ':' && !inStr) || conbuf[concp] == 0) {
-                    while (conbuf[concp - cmdl] == ' ' && cmdl > 0) {cmdl--;}
-                    cmd = (char*)realloc(cmd, cmdl + 1);
-                    cmdpos = concp - cmdl;
-                    copyStrSnip(conbuf, concp - cmdl, concp, cmd);
-                    cmdl = 0;
-                    runcmd();
-                    if (cmdint) {txtqunlock(); cmdint = false; goto brkproccmd;}
-                    if (concp == -1) goto brkproccmd;
-                    if (concp > -1 && conbuf[concp] == 0) {
-                        goto brkproccmd;
-                    }
-                    if (chkinProg) goto fchkint;
-                } else
-                {cmdl++;}
-                if (!didloop) {if (comment) {conbuf[concp] = 0;} concp++;} else {didloop = false;}
-            }
-        }
+        CBX(progLine) = 1;
+        if (runLoop(true)) goto fchkint;
         brkproccmd:;
         #ifndef _WIN32
         setsig(SIGINT, cleanExit);
@@ -1184,8 +1605,180 @@ int main(int argc, char** argv) {
     cleanExit();
     return 0;
 }
+#else
+static pthread_once_t cblibonce = PTHREAD_ONCE_INIT;
+
+static void cbLibInit() {
+    initCtx(&cbmainctx);
+    esc = false;
+    cpos = false;
+    skip = true;
+    runfile = true;
+    startcmd = malloc(9);
+    strcpy(startcmd, "clibasic");
+    txtattrib.fgce = true;
+    txtattrib.fgc = 15;
+    txtattrib.truefgc = 0xFFFFFF;
+    srand(usTime());
+    resetTimer();
+}
+
+cb_ctx* cbCreate() {
+    pthread_once(&cblibonce, cbLibInit);
+    return newCtx();
+}
+
+void cbDestroy(cb_ctx* ctx) {
+    if (ctx) destroyCtx(ctx);
+}
+
+static int cbRun(cb_ctx* ctx, const char* path, const char* src) {
+    cb_ctx* oldctx = cbctx;
+    cbctx = ctx;
+    clearGlobals();
+    CBX(cerr) = 0;
+    CBX(lasterr) = 0;
+    CBX(exitcode) = 0;
+    if (path) {
+        if (!loadProg((char*)path)) CBX(lasterr) = CBX(cerr);
+    } else if (src) {
+        char* name = malloc(7);
+        strcpy(name, "(eval)");
+        pushProg(name, src, strlen(src));
+    }
+    if (!CBX(lasterr)) {
+        CBX(inProg) = true;
+        CBX(didloop) = false;
+        runLoop(false);
+    }
+    int ret = CBX(lasterr);
+    cbctx = oldctx;
+    return ret;
+}
+
+int cbEval(cb_ctx* ctx, const char* src) {
+    return cbRun(ctx, NULL, src);
+}
+
+int cbLoad(cb_ctx* ctx, const char* path) {
+    return cbRun(ctx, path, NULL);
+}
+
+int cbExitCode(cb_ctx* ctx) {
+    cb_ctx* oldctx = cbctx;
+    cbctx = ctx;
+    int ret = CBX(exitcode);
+    cbctx = oldctx;
+    return ret;
+}
+
+uint8_t cbGetVar(cb_ctx* ctx, const char* name, char* out) {
+    cb_ctx* oldctx = cbctx;
+    cbctx = ctx;
+    char* vn = malloc(strlen(name) + 1);
+    strcpy(vn, name);
+    upCase(vn);
+    CBX(cerr) = 0;
+    uint8_t t = getVar(vn, out);
+    if (CBX(cerr)) t = 0;
+    free(vn);
+    cbctx = oldctx;
+    return t;
+}
+
+int cbSetVar(cb_ctx* ctx, const char* name, const char* val, uint8_t type) {
+    cb_ctx* oldctx = cbctx;
+    cbctx = ctx;
+    char* vn = malloc(strlen(name) + 1);
+    strcpy(vn, name);
+    upCase(vn);
+    CBX(cerr) = 0;
+    if (type == 2) {
+        char* tmp = malloc(strlen(val) + 1);
+        strcpy(tmp, val);
+        uint8_t t = getVal(tmp, CBX(runcmdbuf)[0]);
+        free(tmp);
+        if (t == 2) setVar(vn, CBX(runcmdbuf)[0], 2, -1);
+        else if (t) CBX(cerr) = 2;
+    } else if (type == 1) {
+        if (strlen(val) >= CB_BUF_SIZE) CBX(cerr) = 16;
+        else setVar(vn, (char*)val, 1, -1);
+    } else {
+        CBX(cerr) = 2;
+    }
+    int ret = CBX(cerr);
+    free(vn);
+    cbctx = oldctx;
+    return ret;
+}
+#endif
+
+static bool runLoop(bool console) {
+    bool inStr = false;
+    bool comment = false;
+    while (1) {
+        rechk:;
+        if (CBX(progindex) < 0) {CBX(inProg) = false;}
+        else if (CBX(inProg) == false) {CBX(progindex) = - 1;}
+        if (CBX(inProg)) {
+            if (CBX(progbuf)[CBX(progindex)][CBX(cp)] == '"') {inStr = !inStr; CBX(cmdl)++;} else
+            if ((CBX(progbuf)[CBX(progindex)][CBX(cp)] == ':' && !inStr) || CBX(progbuf)[CBX(progindex)][CBX(cp)] == '\n' || CBX(progbuf)[CBX(progindex)][CBX(cp)] == 0) {
+                if (CBX(cp) - CBX(cmdl) > 0 && CBX(progbuf)[CBX(progindex)][CBX(cp) - CBX(cmdl) - 1] == '\n') {
+                    if (!CBX(lockpl)) CBX(progLine)++;
+                    if (inStr) inStr = false;
+                }
+                if (CBX(lockpl)) CBX(lockpl) = false;
+                while (CBX(progbuf)[CBX(progindex)][CBX(cp) - CBX(cmdl)] == ' ' && CBX(cmdl) > 0) {CBX(cmdl)--;}
+                CBX(cmd) = (char*)realloc(CBX(cmd), CBX(cmdl) + 1);
+                CBX(cmdpos) = CBX(cp) - CBX(cmdl);
+                copyStrSnip(CBX(progbuf)[CBX(progindex)], CBX(cp) - CBX(cmdl), CBX(cp), CBX(cmd));
+                CBX(cmdl) = 0;
+                runcmd();
+                if (cmdint) {CBX(inProg) = false; unloadAllProg(); if (cbctx == &cbmainctx) {cmdint = false;} return false;}
+                if (CBX(cp) == -1) {CBX(inProg) = false; unloadAllProg(); return false;}
+                if (CBX(cp) > -1 && CBX(progbuf)[CBX(progindex)][CBX(cp)] == 0) {
+                    unloadProg();
+                    CBX(err) = 0;
+                    if (CBX(progindex) < 0) {
+                        CBX(inProg) = false;
+                        goto rechk;
+                    } else {
+                        CBX(didloop) = true;
+                    }
+                }
+                if (CBX(tmrlbl) && !CBX(didloop) && CBX(inProg)) tmrCheck();
+                if (CBX(evlbl) && !CBX(didloop) && CBX(inProg)) evCheck();
+            } else
+            {CBX(cmdl)++;}
+            if (!CBX(didloop)) {CBX(cp)++;} else {CBX(didloop) = false;}
+        } else {
+            if (!console) return false;
+            if (!inStr && (conbuf[concp] == '\'' || conbuf[concp] == '#')) comment = true;
+            if (!inStr && conbuf[concp] == '\n') comment = false;
+            if (!inStr) {conbuf[concp] = ((conbuf[concp] >= 'a' && conbuf[concp] <= 'z') ? conbuf[concp] - 32 : conbuf[concp]);}
+            if (conbuf[concp] == '"') {inStr = !inStr; CBX(cmdl)++;} else
+            if ((conbuf[concp] == ':' && !inStr) || conbuf[concp] == 0) {
+                while (conbuf[concp - CBX(cmdl)] == ' ' && CBX(cmdl) > 0) {CBX(cmdl)--;}
+                CBX(cmd) = (char*)realloc(CBX(cmd), CBX(cmdl) + 1);
+                CBX(cmdpos) = concp - CBX(cmdl);
+                copyStrSnip(conbuf, concp - CBX(cmdl), concp, CBX(cmd));
+                CBX(cmdl) = 0;
+                runcmd();
+                if (cmdint) {txtqunlock(); cmdint = false; return false;}
+                if (concp == -1) return false;
+                if (concp > -1 && conbuf[concp] == 0) {
+                    return false;
+                }
+                if (CBX(chkinProg)) return true;
+            } else
+            {CBX(cmdl)++;}
+            if (!CBX(didloop)) {if (comment) {conbuf[concp] = 0;} concp++;} else {CBX(didloop) = false;}
+        }
+    }
+}
 
 static inline uint64_t usTime() {
+    struct timeval time1;
     gettimeofday(&time1, NULL);
     return time1.tv_sec * 1000000 + time1.tv_usec;
 }
@@ -1203,7 +1796,7 @@ static inline void cb_wait(uint64_t d) {
     struct timespec dts;
     dts.tv_sec = d / 1000000;
     dts.tv_nsec = (d % 1000000) * 1000;
-    nanosleep(&dts, NULL);
+    while (nanosleep(&dts, &dts) == -1 && errno == EINTR && !cmdint) {}
     #else
     uint64_t t = d + usTime();
     while (t > usTime() && !cmdint) {
@@ -1284,132 +1877,141 @@ static inline void getCurPos() {
 }
 
 void unloadProg() {
-    for (int i = 1; i < progargc; ++i) {
-        nfree(progargs[i]);
-    }
-    nfree(progargs);
-    progargs = oldprogargs[progindex];
-    progargc = oldprogargc[progindex];
-    nfree(progbuf[progindex]);
-    nfree(progfn[progindex]);
-    progfn = (char**)realloc(progfn, progindex * sizeof(char*));
-    progbuf = (char**)realloc(progbuf, progindex * sizeof(char*));
-    for (int i = 0; i < gotomaxct; ++i) {
-        if (gotodata[i].used) nfree(gotodata[i].name);
-    }
-    nfree(gotodata);
-    gotodata = proggotodata[progindex];
-    gotomaxct = proggotomaxct[progindex];
-    cp = progcp[progindex];
-    cmdl = progcmdl[progindex];
-    progLine = proglinebuf[progindex];
-    brkinfo = oldbrkinfo[progindex];
-    dlstackp = mindlstackp[progindex];
-    itstackp = minitstackp[progindex];
-    fnstackp = minfnstackp[progindex];
-    progcp = (int32_t*)realloc(progcp, progindex * sizeof(int32_t));
-    progcmdl = (int*)realloc(progcmdl, progindex * sizeof(int));
-    proglinebuf = (int*)realloc(proglinebuf, progindex * sizeof(int));
-    mindlstackp = (int*)realloc(mindlstackp, progindex * sizeof(int));
-    minitstackp = (int*)realloc(minitstackp, progindex * sizeof(int));
-    minfnstackp = (int*)realloc(minfnstackp, progindex * sizeof(int));
-    oldbrkinfo = (cb_brkinfo*)realloc(oldbrkinfo, progindex * sizeof(cb_brkinfo));
-    proggotodata = (cb_goto**)realloc(proggotodata, progindex * sizeof(cb_goto*));
-    proggotomaxct = (int*)realloc(proggotomaxct, progindex * sizeof(int));
-    progindex--;
-    if (progindex < 0) inProg = false;
+    if (CBX(comaxct) && CBX(progindex) == CBX(coprog)) coFreeAll();
+    if (CBX(evlbl) && CBX(progindex) == CBX(evprog)) {nfree(CBX(evlbl)); CBX(evgs) = 0;}
+    if (CBX(tmrlbl) && CBX(progindex) == CBX(tmrprog)) tmrStop();
+    for (int i = 1; i < CBX(progargc); ++i) {
+        nfree(CBX(progargs)[i]);
+    }
+    nfree(CBX(progargs));
+    CBX(progargs) = CBX(oldprogargs)[CBX(progindex)];
+    CBX(progargc) = CBX(oldprogargc)[CBX(progindex)];
+    nfree(CBX(progbuf)[CBX(progindex)]);
+    nfree(CBX(progfn)[CBX(progindex)]);
+    CBX(progfn) = (char**)realloc(CBX(progfn), CBX(progindex) * sizeof(char*));
+    CBX(progbuf) = (char**)realloc(CBX(progbuf), CBX(progindex) * sizeof(char*));
+    for (int i = 0; i < CBX(gotomaxct); ++i) {
+        if (CBX(gotodata)[i].used) nfree(CBX(gotodata)[i].name);
+    }
+    nfree(CBX(gotodata));
+    CBX(gotodata) = CBX(proggotodata)[CBX(progindex)];
+    CBX(gotomaxct) = CBX(proggotomaxct)[CBX(progindex)];
+    CBX(cp) = CBX(progcp)[CBX(progindex)];
+    CBX(cmdl) = CBX(progcmdl)[CBX(progindex)];
+    CBX(progLine) = CBX(proglinebuf)[CBX(progindex)];
+    CBX(brkinfo) = CBX(oldbrkinfo)[CBX(progindex)];
+    CBX(dlstackp) = CBX(mindlstackp)[CBX(progindex)];
+    CBX(itstackp) = CBX(minitstackp)[CBX(progindex)];
+    CBX(fnstackp) = CBX(minfnstackp)[CBX(progindex)];
+    CBX(progcp) = (int32_t*)realloc(CBX(progcp), CBX(progindex) * sizeof(int32_t));
+    CBX(progcmdl) = (int*)realloc(CBX(progcmdl), CBX(progindex) * sizeof(int));
+    CBX(proglinebuf) = (int*)realloc(CBX(proglinebuf), CBX(progindex) * sizeof(int));
+    CBX(mindlstackp) = (int*)realloc(CBX(mindlstackp), CBX(progindex) * sizeof(int));
+    CBX(minitstackp) = (int*)realloc(CBX(minitstackp), CBX(progindex) * sizeof(int));
+    CBX(minfnstackp) = (int*)realloc(CBX(minfnstackp), CBX(progindex) * sizeof(int));
+    CBX(oldbrkinfo) = (cb_brkinfo*)realloc(CBX(oldbrkinfo), CBX(progindex) * sizeof(cb_brkinfo));
+    CBX(proggotodata) = (cb_goto**)realloc(CBX(proggotodata), CBX(progindex) * sizeof(cb_goto*));
+    CBX(proggotomaxct) = (int*)realloc(CBX(proggotomaxct), CBX(progindex) * sizeof(int));
+    CBX(progindex)--;
+    if (CBX(progindex) < 0) CBX(inProg) = false;
     if (autorun) autorun = false;
 }
 
 void unloadAllProg() {
-    for (int i = 0; i <= progindex; ++i) {
+    while (CBX(progindex) > -1) {
         unloadProg();
     }
 }
 
+static void pushProg(char* fullname, const char* data, int32_t len) {
+    ++CBX(progindex);
+    CBX(progfn) = (char**)realloc(CBX(progfn), (CBX(progindex) + 1) * sizeof(char*));
+    CBX(progfn)[CBX(progindex)] = fullname;
+    ++CBX(progindex);
+    CBX(progbuf) = (char**)realloc(CBX(progbuf), CBX(progindex) * sizeof(char*));
+    CBX(progcp) = (int32_t*)realloc(CBX(progcp), CBX(progindex) * sizeof(int32_t));
+    CBX(progcmdl) = (int*)realloc(CBX(progcmdl), CBX(progindex) * sizeof(int));
+    CBX(proglinebuf) = (int*)realloc(CBX(proglinebuf), CBX(progindex) * sizeof(int));
+    CBX(mindlstackp) = (int*)realloc(CBX(mindlstackp), CBX(progindex) * sizeof(int));
+    CBX(minitstackp) = (int*)realloc(CBX(minitstackp), CBX(progindex) * sizeof(int));
+    CBX(oldbrkinfo) = (cb_brkinfo*)realloc(CBX(oldbrkinfo), CBX(progindex) * sizeof(cb_brkinfo));
+    CBX(minfnstackp) = (int*)realloc(CBX(minfnstackp), CBX(progindex) * sizeof(int));
+    CBX(proggotodata) = (cb_goto**)realloc(CBX(proggotodata), CBX(progindex) * sizeof(cb_goto*));
+    CBX(proggotomaxct) = (int*)realloc(CBX(proggotomaxct), CBX(progindex) * sizeof(int));
+    CBX(oldprogargc) = (int*)realloc(CBX(oldprogargc), CBX(progindex) * sizeof(int));
+    CBX(oldprogargs) = (char***)realloc(CBX(oldprogargs), CBX(progindex) * sizeof(char**));
+    --CBX(progindex);
+    CBX(progcp)[CBX(progindex)] = CBX(cp);
+    CBX(progcmdl)[CBX(progindex)] = CBX(cmdl);
+    CBX(proglinebuf)[CBX(progindex)] = CBX(progLine);
+    CBX(mindlstackp)[CBX(progindex)] = CBX(dlstackp);
+    CBX(minitstackp)[CBX(progindex)] = CBX(itstackp);
+    CBX(oldbrkinfo)[CBX(progindex)] = CBX(brkinfo);
+    CBX(minfnstackp)[CBX(progindex)] = CBX(fnstackp);
+    CBX(proggotodata)[CBX(progindex)] = CBX(gotodata);
+    CBX(proggotomaxct)[CBX(progindex)] = CBX(gotomaxct);
+    CBX(oldprogargc)[CBX(progindex)] = CBX(progargc);
+    CBX(oldprogargs)[CBX(progindex)] = CBX(progargs);
+    CBX(gotodata) = NULL;
+    CBX(gotomaxct) = 0;
+    CBX(cp) = 0;
+    CBX(cmdl) = 0;
+    CBX(progLine) = 1;
+    memset(&CBX(brkinfo), 0, sizeof(CBX(brkinfo)));
+    if (CBX(argslater)) {
+        CBX(argslater) = false;
+    } else {
+        CBX(progargc) = CBX(newprogargc);
+        CBX(newprogargc) = 0;
+        CBX(progargs) = CBX(newprogargs);
+        CBX(newprogargs) = NULL;
+    }
+    CBX(progbuf)[CBX(progindex)] = (char*)malloc(len + 1);
+    int32_t j = 0;
+    bool comment = false;
+    bool inStr = false;
+    bool sawCmd = false;
+    for (int32_t i = 0; i < len; ++i) {
+        int tmpc = data[i];
+        if (tmpc == '"') inStr = !inStr;
+        if (!inStr && !sawCmd && tmpc == ' ') {sawCmd = true; inStr = false;}
+        if (!inStr && (tmpc == '\'' || tmpc == '#')) comment = true;
+        if (tmpc == '\n') {comment = false; inStr = false;}
+        if (tmpc == '\r' || tmpc == '\t') tmpc = ' ';
+        if (!comment) {CBX(progbuf)[CBX(progindex)][j] = (char)((inStr) ? tmpc : ((tmpc >= 'a' && tmpc <= 'z') ? tmpc -= 32 : tmpc)); j++;}
+    }
+    CBX(progbuf)[CBX(progindex)][j] = 0;
+}
+
 bool loadProg(char* filename) {
     #if defined(_WIN32) && !defined(_WIN_NO_VT)
     enablevt();
     #endif
-    retval = 0;
+    CBX(retval) = 0;
     seterrstr(filename);
-    cerr = 27;
+    CBX(cerr) = 27;
     FILE* prog = fopen(filename, "r");
     if (!prog) {
-        if (errno == ENOENT) cerr = 15;
+        if (errno == ENOENT) CBX(cerr) = 15;
         return false;
     }
     if (!isFile(filename)) {
         fclose(prog);
-        cerr = 18;
+        CBX(cerr) = 18;
         return false;
     }
-    ++progindex;
     fseek(prog, 0, SEEK_END);
-    progfn = (char**)realloc(progfn, (progindex + 1) * sizeof(char*));
-    #ifdef _WIN32
-    progfn[progindex] = _fullpath(NULL, filename, CB_BUF_SIZE);
-    #else
-    progfn[progindex] = realpath(filename, NULL);
-    #endif
-    ++progindex;
-    progbuf = (char**)realloc(progbuf, progindex * sizeof(char*));
-    progcp = (int32_t*)realloc(progcp, progindex * sizeof(int32_t));
-    progcmdl = (int*)realloc(progcmdl, progindex * sizeof(int));
-    proglinebuf = (int*)realloc(proglinebuf, progindex * sizeof(int));
-    mindlstackp = (int*)realloc(mindlstackp, progindex * sizeof(int));
-    minitstackp = (int*)realloc(minitstackp, progindex * sizeof(int));
-    oldbrkinfo = (cb_brkinfo*)realloc(oldbrkinfo, progindex * sizeof(cb_brkinfo));
-    minfnstackp = (int*)realloc(minfnstackp, progindex * sizeof(int));
-    proggotodata = (cb_goto**)realloc(proggotodata, progindex * sizeof(cb_goto*));
-    proggotomaxct = (int*)realloc(proggotomaxct, progindex * sizeof(int));
-    oldprogargc = (int*)realloc(oldprogargc, progindex * sizeof(int));
-    oldprogargs = (char***)realloc(oldprogargs, progindex * sizeof(char**));
-    --progindex;
-    progcp[progindex] = cp;
-    progcmdl[progindex] = cmdl;
-    proglinebuf[progindex] = progLine;
-    mindlstackp[progindex] = dlstackp;
-    minitstackp[progindex] = itstackp;
-    oldbrkinfo[progindex] = brkinfo;
-    minfnstackp[progindex] = fnstackp;
-    proggotodata[progindex] = gotodata;
-    proggotomaxct[progindex] = gotomaxct;
-    oldprogargc[progindex] = progargc;
-    oldprogargs[progindex] = progargs;
-    gotodata = NULL;
-    gotomaxct = 0;
-    cp = 0;
-    cmdl = 0;
-    progLine = 1;
-    memset(&brkinfo, 0, sizeof(brkinfo));
-    if (argslater) {
-        argslater = false;
-    } else {
-        progargc = newprogargc;
-        newprogargc = 0;
-        progargs = newprogargs;
-        newprogargs = NULL;
-    }
     int32_t fsize = (uint32_t)ftell(prog);
     fseek(prog, 0, SEEK_SET);
-    progbuf[progindex] = (char*)malloc(fsize + 1);
-    int32_t j = 0;
-    bool comment = false;
-    bool inStr = false;
-    bool sawCmd = false;
-    while (j < fsize && !feof(prog)) {
-        int tmpc = fgetc(prog);
-        if (tmpc == '"') inStr = !inStr;
-        if (!inStr && !sawCmd && tmpc == ' ') {sawCmd = true; inStr = false;}
-        if (!inStr && (tmpc == '\'' || tmpc == '#')) comment = true;
-        if (tmpc == '\n') {comment = false; inStr = false;}
-        if (tmpc == '\r' || tmpc == '\t') tmpc = ' ';
-        if (tmpc < 0) tmpc = 0;
-        if (!comment) {progbuf[progindex][j] = (char)((inStr) ? tmpc : ((tmpc >= 'a' && tmpc <= 'z') ? tmpc -= 32 : tmpc)); j++;}
-    }
-    progbuf[progindex][j] = 0;
+    char* data = (char*)malloc(fsize + 1);
+    fsize = fread(data, 1, fsize, prog);
     fclose(prog);
+    #ifdef _WIN32
+    pushProg(_fullpath(NULL, filename, CB_BUF_SIZE), data, fsize);
+    #else
+    pushProg(realpath(filename, NULL), data, fsize);
+    #endif
+    free(data);
     return true;
 }
 
@@ -1419,21 +2021,19 @@ static inline double randNum(double num1, double num2) {
     return num1 + (rand() / div);
 }
 
-char* chkCmdPtr = NULL;
-
 static inline bool chkCmd(int ct, ...) {
     va_list args;
     va_start(args, ct);
     #ifdef BUILT_IN_COMMAND_COMPARE
     for (int32_t i = 0; i < ct; ++i) {
         char* str2 = va_arg(args, char*);
-        if (!strcmp(chkCmdPtr, str2)) return true;
+        if (!strcmp(CBX(chkCmdPtr), str2)) return true;
     }
     return false;
     #else
     bool match = false;
     for (int i = 0; i < ct; ++i) {
-        char* str1 = chkCmdPtr;
+        char* str1 = CBX(chkCmdPtr);
         char* str2 = va_arg(args, char*);
         while (1) {
             if (!*str1 && !*str2) break;
@@ -1590,8 +2190,8 @@ static inline void lowCase(char* str) {
 
 static inline void seterrstr(char* newstr) {
     size_t nslen = strlen(newstr);
-    errstr = (char*)realloc(errstr, nslen + 1);
-    copyStr(newstr, errstr);
+    CBX(errstr) = (char*)realloc(CBX(errstr), nslen + 1);
+    copyStr(newstr, CBX(errstr));
 }
 
 static inline void updateTxtAttrib() {
@@ -1648,8 +2248,6 @@ static inline void updateTxtAttrib() {
     fflush(stdout);
 }
 
-char buf[CB_BUF_SIZE];
-
 static inline void getStr(char* str1, char* str2) {
     int32_t j = 0, i;
     for (i = 0; str1[i]; ++i) {
@@ -1685,11 +2283,11 @@ static inline void getStr(char* str1, char* str2) {
                 default: --i; break;
             }
         }
-        buf[j] = c;
+        CBX(getstrbuf)[j] = c;
         ++j;
     }
-    buf[j] = 0;
-    copyStr(buf, str2);
+    CBX(getstrbuf)[j] = 0;
+    copyStr(CBX(getstrbuf), str2);
 }
 
 static inline uint8_t getType(char* str) {
@@ -1713,17 +2311,57 @@ static inline bool isLineNumber(char* str) {
     return true;
 }
 
-int cbrmIndex = 0;
+#ifndef _WIN32
+static bool cbrmDir(int fd) {
+    DIR* d = fdopendir(fd);
+    if (!d) {CBX(fileerror) = errno; close(fd); return false;}
+    bool ok = true;
+    struct dirent* ent;
+    struct stat st;
+    while ((ent = readdir(d))) {
+        if (ent->d_name[0] == '.' && (!ent->d_name[1] || (ent->d_name[1] == '.' && !ent->d_name[2]))) continue;
+        bool isdir;
+        #ifdef _DIRENT_HAVE_D_TYPE
+        if (ent->d_type != DT_UNKNOWN) {isdir = (ent->d_type == DT_DIR);} else
+        #endif
+        isdir = (!fstatat(dirfd(d), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) && S_ISDIR(st.st_mode));
+        if (isdir) {
+            int sfd = openat(dirfd(d), ent->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (sfd < 0) {CBX(fileerror) = errno; ok = false; continue;}
+            if (!cbrmDir(sfd)) ok = false;
+        }
+        if (unlinkat(dirfd(d), ent->d_name, (isdir) ? AT_REMOVEDIR : 0)) {CBX(fileerror) = errno; ok = false;}
+    }
+    closedir(d);
+    return ok;
+}
 
 bool cbrm(char* path) {
-    fileerror = 0;
-    if (isFile(path)) {
-        if (remove(path)) {fileerror = errno; return false;}
+    CBX(fileerror) = 0;
+    struct stat st;
+    if (lstat(path, &st)) {CBX(fileerror) = errno; return false;}
+    if (!S_ISDIR(st.st_mode)) {
+        if (remove(path)) {CBX(fileerror) = errno; return false;}
         return true;
     }
-    char* odir = (cbrmIndex) ? NULL : getcwd(NULL, 0);
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {CBX(fileerror) = errno; return false;}
+    cbrmDir(fd);
+    if (rmdir(path)) {CBX(fileerror) = errno; return false;}
+    return true;
+}
+#else
+int cbrmIndex = 0;
+
+bool cbrm(char* path) {
+    CBX(fileerror) = 0;
+    if (isFile(path)) {
+        if (remove(path)) {CBX(fileerror) = errno; return false;}
+        return true;
+    }
+    char* odir = (cbrmIndex) ? NULL : getcwd(NULL, 0);
     ++cbrmIndex;
-    if (chdir(path)) {fileerror = errno; goto cbrm_fail;}
+    if (chdir(path)) {CBX(fileerror) = errno; goto cbrm_fail;}
     DIR* cwd = opendir(".");
     struct dirent* dir;
     struct stat pathstat;
@@ -1737,401 +2375,4287 @@ bool cbrm(char* path) {
     --cbrmIndex;
     int ret = chdir((cbrmIndex) ? ".." : odir);
     if (!cbrmIndex) nfree(odir);
-    if (rmdir(path)) {fileerror = errno; return false;}
+    if (rmdir(path)) {CBX(fileerror) = errno; return false;}
     return true;
     cbrm_fail:;
     --cbrmIndex;
     ret = chdir((cbrmIndex) ? ".." : odir);
     (void)ret;
     if (!cbrmIndex) nfree(odir);
-    if (rmdir(path)) fileerror = errno;
+    if (rmdir(path)) CBX(fileerror) = errno;
     return false;
 }
+#endif
 
-static inline int getArg(int, char*, char*);
-static inline int getArgO(int, char*, char*, int32_t);
-static inline int getArgCt(char*);
+bool copyFile(char* src, char* dst) {
+    CBX(fileerror) = 0;
+    #ifndef _WIN32
+    int in = open(src, O_RDONLY | O_CLOEXEC);
+    if (in < 0) {CBX(fileerror) = errno; return false;}
+    struct stat st;
+    if (fstat(in, &st)) {CBX(fileerror) = errno; close(in); return false;}
+    if (S_ISDIR(st.st_mode)) {CBX(fileerror) = EISDIR; close(in); return false;}
+    struct stat dst_st;
+    if (!stat(dst, &dst_st) && dst_st.st_dev == st.st_dev && dst_st.st_ino == st.st_ino) {CBX(fileerror) = EINVAL; close(in); return false;}
+    int out = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
+    if (out < 0) {CBX(fileerror) = errno; close(in); return false;}
+    int64_t left = st.st_size;
+    #ifdef __linux__
+    #ifdef FICLONE
+    if (S_ISREG(st.st_mode) && !ioctl(out, FICLONE, in)) left = 0;
+    #endif
+    #ifdef SYS_copy_file_range
+    while (left > 0) {
+        ssize_t r = syscall(SYS_copy_file_range, in, NULL, out, NULL, (size_t)((left > 0x40000000) ? 0x40000000 : left), 0);
+        if (r <= 0) break;
+        left -= r;
+    }
+    #endif
+    while (left > 0) {
+        ssize_t r = sendfile(out, in, NULL, (size_t)((left > 0x40000000) ? 0x40000000 : left));
+        if (r <= 0) break;
+        left -= r;
+    }
+    #endif
+    if (left > 0 || !S_ISREG(st.st_mode)) {
+        char* buf = malloc(CB_FILE_BUF_SIZE);
+        ssize_t r;
+        while ((r = read(in, buf, CB_FILE_BUF_SIZE)) > 0) {
+            for (ssize_t w = 0; w < r;) {
+                ssize_t wr = write(out, buf + w, r - w);
+                if (wr < 0) {
+                    if (errno == EINTR) continue;
+                    CBX(fileerror) = errno;
+                    r = -1;
+                    break;
+                }
+                w += wr;
+            }
+            if (r < 0) break;
+        }
+        if (r < 0 && !CBX(fileerror)) CBX(fileerror) = errno;
+        free(buf);
+    }
+    close(in);
+    if (close(out) && !CBX(fileerror)) CBX(fileerror) = errno;
+    return !CBX(fileerror);
+    #else
+    if (!CopyFileA(src, dst, FALSE)) {CBX(fileerror) = EIO; return false;}
+    return true;
+    #endif
+}
 
-uint16_t getFuncIndex = 0;
-char* getFunc_gftmp[2] = {NULL, NULL};
 
-uint8_t getFunc(char* inbuf, char* outbuf) {
-    char** farg;
-    uint8_t* fargt;
-    int32_t* flen;
-    int fargct;
-    int ftmpct = 0;
-    int ftype = 0;
-    char* gftmp[2];
-    bool skipfargsolve = false;
-    if (getFuncIndex) {
-        gftmp[0] = malloc(CB_BUF_SIZE);
-        gftmp[1] = malloc(CB_BUF_SIZE);
-    } else {
-        gftmp[0] = getFunc_gftmp[0];
-        gftmp[1] = getFunc_gftmp[1];
+typedef struct {
+    uint8_t algo;
+    uint64_t len;
+    uint32_t crc;
+    uint64_t xxh[4];
+    uint32_t sha[8];
+    uint8_t buf[64];
+    uint32_t buflen;
+} cb_hash;
+
+static uint32_t crc32ctable[256];
+static const uint32_t sha256k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+static int8_t hashhw = -1;
+
+#define CB_XXH_P1 11400714785074694791ULL
+#define CB_XXH_P2 14029467366897019727ULL
+#define CB_XXH_P3 1609587929392839161ULL
+#define CB_XXH_P4 9650029242287828579ULL
+#define CB_XXH_P5 2870177450012600261ULL
+#define rotl32(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+#define rotr32(x, r) (((x) >> (r)) | ((x) << (32 - (r))))
+#define rotl64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline uint64_t readLE64(uint8_t* p) {uint64_t v; memcpy(&v, p, 8); return v;}
+static inline uint32_t readLE32(uint8_t* p) {uint32_t v; memcpy(&v, p, 4); return v;}
+
+static void hashDetectOnce() {
+    int8_t hw = 0;
+    #ifdef CB_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) hw |= 1;
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA) && __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3")) hw |= 2;
+    #endif
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int j = 0; j < 8; ++j) {c = (c >> 1) ^ ((c & 1) ? 0x82f63b78 : 0);}
+        crc32ctable[i] = c;
     }
-    ++getFuncIndex;
-    int extsas = -1;
-    {
-        int32_t i;
-        bool invalName = false;
-        for (i = 0; inbuf[i] != '('; ++i) {if (!isValidVarChar(inbuf[i])) {invalName = true;}}
-        if (invalName) {copyStrTo(inbuf, i, gpbuf); seterrstr(gpbuf); cerr = 4; return 0;}
-        int32_t j = strlen(inbuf) - 1;
-        copyStrSnip(inbuf, i + 1, j, gftmp[0]);
-        fargct = getArgCt(gftmp[0]);
-        farg = malloc((fargct + 1) * sizeof(char*));
-        flen = malloc((fargct + 1) * sizeof(int32_t));
-        fargt = malloc((fargct + 1) * sizeof(uint8_t));
-        for (int j = 0; j <= fargct; ++j) {
-            farg[j] = NULL;
+    hashhw = hw;
+}
+
+#ifndef _WIN32
+static pthread_once_t hashonce = PTHREAD_ONCE_INIT;
+#endif
+
+// Tasks can hash at the same time, so the table is filled once before anyone reads hashhw
+static inline void hashDetect() {
+    #ifndef _WIN32
+    pthread_once(&hashonce, hashDetectOnce);
+    #else
+    if (hashhw == -1) hashDetectOnce();
+    #endif
+}
+
+#ifdef CB_X86
+__attribute__((target("sse4.2"))) static uint32_t crc32cHW(uint32_t crc, uint8_t* p, size_t len) {
+    #ifdef __x86_64__
+    uint64_t c = crc;
+    for (; len >= 8; len -= 8, p += 8) {c = _mm_crc32_u64(c, readLE64(p));}
+    crc = c;
+    #endif
+    for (; len >= 4; len -= 4, p += 4) {crc = _mm_crc32_u32(crc, readLE32(p));}
+    for (; len; --len, ++p) {crc = _mm_crc32_u8(crc, *p);}
+    return crc;
+}
+
+__attribute__((target("sha,sse4.1,ssse3"))) static void sha256HW(uint32_t* state, uint8_t* data, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i tmp, st0, st1, msg, m[4], abef, cdgh;
+    tmp = _mm_loadu_si128((__m128i*)&state[0]);
+    st1 = _mm_loadu_si128((__m128i*)&state[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xb1);
+    st1 = _mm_shuffle_epi32(st1, 0x1b);
+    st0 = _mm_alignr_epi8(tmp, st1, 8);
+    st1 = _mm_blend_epi16(st1, tmp, 0xf0);
+    for (; blocks; --blocks, data += 64) {
+        abef = st0;
+        cdgh = st1;
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4) m[i] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(data + i * 16)), mask);
+            msg = _mm_add_epi32(m[i & 3], _mm_loadu_si128((__m128i*)&sha256k[i * 4]));
+            st1 = _mm_sha256rnds2_epu32(st1, st0, msg);
+            if (i >= 3 && i < 15) {
+                tmp = _mm_alignr_epi8(m[i & 3], m[(i + 3) & 3], 4);
+                m[(i + 1) & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(m[(i + 1) & 3], tmp), m[i & 3]);
+            }
+            msg = _mm_shuffle_epi32(msg, 0x0e);
+            st0 = _mm_sha256rnds2_epu32(st0, st1, msg);
+            if (i >= 1 && i < 13) m[(i + 3) & 3] = _mm_sha256msg1_epu32(m[(i + 3) & 3], m[i & 3]);
         }
-        int32_t gptr = 0;
-        for (int j = 0; j <= fargct; ++j) {
-            if (j == 0) {
-                flen[0] = i;
-                farg[0] = (char*)malloc(flen[0] + 1);
-                copyStrTo(inbuf, i, farg[0]);
-                for (int i = extmaxct - 1; i > -1; --i) {
-                    if (extdata[i].inuse && extdata[i].chkfuncsolve) {
-                        if ((skipfargsolve = extdata[i].chkfuncsolve(farg[0]))) {extsas = i; break;}
-                    }
-                }
-                if (extsas == -1) {
-                    if (!strcmp(farg[0], "~") || !strcmp(farg[0], "_TEST")) {
-                        ftype = 2;
-                        if (fargct != 1) {cerr = 3; goto fexit;}
-                        cerr = 0;
-                        if (getArgO(0, gftmp[0], gftmp[1], 0) == -1) {outbuf[0] = 0; goto fexit;}
-                        int ret = logictest(gftmp[1]);
-                        if (ret == -1) {outbuf[0] = 0; goto fexit;}
-                        outbuf[0] = '0' + ret;
-                        outbuf[1] = 0;
-                        goto fexit;
-                    } else if (!strcmp(farg[0], "EXECA") || !strcmp(farg[0], "EXECA$")) {
-                        skipfargsolve = true;
-                    }
-                }
+        st0 = _mm_add_epi32(st0, abef);
+        st1 = _mm_add_epi32(st1, cdgh);
+    }
+    tmp = _mm_shuffle_epi32(st0, 0x1b);
+    st1 = _mm_shuffle_epi32(st1, 0xb1);
+    st0 = _mm_blend_epi16(tmp, st1, 0xf0);
+    st1 = _mm_alignr_epi8(st1, tmp, 8);
+    _mm_storeu_si128((__m128i*)&state[0], st0);
+    _mm_storeu_si128((__m128i*)&state[4], st1);
+}
+#endif
+
+static void sha256SW(uint32_t* state, uint8_t* data, size_t blocks) {
+    uint32_t w[64];
+    for (; blocks; --blocks, data += 64) {
+        for (int i = 0; i < 16; ++i) {
+            w[i] = ((uint32_t)data[i * 4] << 24) | ((uint32_t)data[i * 4 + 1] << 16) | ((uint32_t)data[i * 4 + 2] << 8) | data[i * 4 + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + sha256k[i] + w[i];
+            uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+static inline uint64_t xxh64Round(uint64_t acc, uint64_t in) {
+    acc += in * CB_XXH_P2;
+    acc = rotl64(acc, 31);
+    return acc * CB_XXH_P1;
+}
+
+static inline void hashBlocks(cb_hash* h, uint8_t* p, size_t blocks) {
+    switch (h->algo) {
+        case 2:;
+            for (; blocks; --blocks, p += 32) {
+                h->xxh[0] = xxh64Round(h->xxh[0], readLE64(p));
+                h->xxh[1] = xxh64Round(h->xxh[1], readLE64(p + 8));
+                h->xxh[2] = xxh64Round(h->xxh[2], readLE64(p + 16));
+                h->xxh[3] = xxh64Round(h->xxh[3], readLE64(p + 24));
+            }
+            break;
+        case 3:;
+            #ifdef CB_X86
+            if (hashhw & 2) {sha256HW(h->sha, p, blocks); break;}
+            #endif
+            sha256SW(h->sha, p, blocks);
+            break;
+    }
+}
+
+int hashAlgo(char* name) {
+    char tmp[16];
+    int len = 0;
+    for (; *name; ++name) {
+        if (*name == '-' || *name == '_') continue;
+        if (len == 15) return 0;
+        tmp[len++] = toupper(*name);
+    }
+    tmp[len] = 0;
+    if (!strcmp(tmp, "CRC32C")) return 1;
+    if (!strcmp(tmp, "XXH64") || !strcmp(tmp, "XXHASH64")) return 2;
+    if (!strcmp(tmp, "SHA256")) return 3;
+    return 0;
+}
+
+void hashInit(cb_hash* h, int algo) {
+    static const uint32_t shainit[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    hashDetect();
+    h->algo = algo;
+    h->len = 0;
+    h->buflen = 0;
+    h->crc = 0xffffffff;
+    h->xxh[0] = CB_XXH_P1 + CB_XXH_P2;
+    h->xxh[1] = CB_XXH_P2;
+    h->xxh[2] = 0;
+    h->xxh[3] = -CB_XXH_P1;
+    memcpy(h->sha, shainit, sizeof(shainit));
+}
+
+void hashUpdate(cb_hash* h, uint8_t* p, size_t len) {
+    h->len += len;
+    if (h->algo == 1) {
+        #ifdef CB_X86
+        if (hashhw & 1) {h->crc = crc32cHW(h->crc, p, len); return;}
+        #endif
+        uint32_t c = h->crc;
+        for (; len; --len, ++p) {c = crc32ctable[(c ^ *p) & 0xff] ^ (c >> 8);}
+        h->crc = c;
+        return;
+    }
+    uint32_t bs = (h->algo == 2) ? 32 : 64;
+    if (h->buflen) {
+        uint32_t n = bs - h->buflen;
+        if (n > len) n = len;
+        memcpy(&h->buf[h->buflen], p, n);
+        h->buflen += n;
+        p += n;
+        len -= n;
+        if (h->buflen < bs) return;
+        hashBlocks(h, h->buf, 1);
+        h->buflen = 0;
+    }
+    if (len >= bs) {
+        hashBlocks(h, p, len / bs);
+        p += len - len % bs;
+        len %= bs;
+    }
+    memcpy(h->buf, p, len);
+    h->buflen = len;
+}
+
+void hashFinal(cb_hash* h, char* out) {
+    switch (h->algo) {
+        case 1:;
+            sprintf(out, "%08" PRIx32, ~h->crc);
+            break;
+        case 2:; {
+            uint64_t v;
+            if (h->len >= 32) {
+                v = rotl64(h->xxh[0], 1) + rotl64(h->xxh[1], 7) + rotl64(h->xxh[2], 12) + rotl64(h->xxh[3], 18);
+                for (int i = 0; i < 4; ++i) {v = (v ^ xxh64Round(0, h->xxh[i])) * CB_XXH_P1 + CB_XXH_P4;}
             } else {
-                farg[j] = malloc(CB_BUF_SIZE);
-                int32_t ngptr = getArgO(j - 1, gftmp[0], farg[j], gptr);
-                if (ngptr == -1) {outbuf[0] = 0; goto fexit;}
-                int32_t tmpsize = ngptr - gptr;
-                gptr = ngptr;
-                if (skipfargsolve) {
-                    flen[j] = tmpsize;
-                    farg[j] = realloc(farg[j], tmpsize + 1);
-                } else {
-                    fargt[j] = getVal(farg[j], farg[j]);
-                    if (fargt[j] == 0) goto fnoerrscan;
-                    if (fargt[j] == 255) fargt[j] = 0;
-                    flen[j] = strlen(farg[j]);
-                    farg[j] = realloc(farg[j], flen[j] + 1);
-                }
-                ftmpct++;
+                v = CB_XXH_P5;
             }
+            v += h->len;
+            uint8_t* p = h->buf;
+            uint32_t len = h->buflen;
+            for (; len >= 8; len -= 8, p += 8) {v = rotl64(v ^ xxh64Round(0, readLE64(p)), 27) * CB_XXH_P1 + CB_XXH_P4;}
+            if (len >= 4) {v = rotl64(v ^ ((uint64_t)readLE32(p) * CB_XXH_P1), 23) * CB_XXH_P2 + CB_XXH_P3; len -= 4; p += 4;}
+            for (; len; --len, ++p) {v = rotl64(v ^ (*p * CB_XXH_P5), 11) * CB_XXH_P1;}
+            v ^= v >> 33;
+            v *= CB_XXH_P2;
+            v ^= v >> 29;
+            v *= CB_XXH_P3;
+            v ^= v >> 32;
+            sprintf(out, "%016" PRIx64, v);
+            break;
+        }
+        case 3:; {
+            uint64_t bits = h->len * 8;
+            uint8_t pad[72] = {0x80};
+            uint32_t padlen = ((h->buflen < 56) ? 56 : 120) - h->buflen;
+            for (int i = 0; i < 8; ++i) {pad[padlen + i] = bits >> (56 - i * 8);}
+            hashUpdate(h, pad, padlen + 8);
+            for (int i = 0; i < 8; ++i) {sprintf(&out[i * 8], "%08" PRIx32, h->sha[i]);}
+            break;
         }
     }
-    outbuf[0] = 0;
-    cerr = 127;
-    chkCmdPtr = farg[0];
-    #include "functions.c"
-    fexit:;
-    if (cerr > 124 && cerr < 128) seterrstr(farg[0]);
-    fnoerrscan:;
-    for (int j = 0; j <= ftmpct; ++j) {
-        nfree(farg[j]);
+}
+
+bool hashFile(int algo, char* path, char* out) {
+    CBX(fileerror) = 0;
+    #ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    #else
+    int fd = open(path, O_RDONLY | O_BINARY);
+    #endif
+    if (fd < 0) {CBX(fileerror) = errno; return false;}
+    #ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    #endif
+    cb_hash h;
+    hashInit(&h, algo);
+    size_t bs = CB_FILE_BUF_SIZE * 4;
+    uint8_t* buf = malloc(bs);
+    ssize_t r;
+    while ((r = read(fd, buf, bs)) > 0) {
+        hashUpdate(&h, buf, r);
     }
-    nfree(farg);
-    nfree(flen);
-    nfree(fargt);
-    --getFuncIndex;
-    if (getFuncIndex) {nfree(gftmp[0]); nfree(gftmp[1]);}
-    if (cerr) return 0;
-    return ftype;
+    if (r < 0) CBX(fileerror) = errno;
+    free(buf);
+    close(fd);
+    if (CBX(fileerror)) return false;
+    hashFinal(&h, out);
+    return true;
 }
 
-bool chkvar = true;
+static inline char* csvScan(char* p, char* end) {
+    #if defined(CB_X86) && defined(__SSE2__)
+    const __m128i c = _mm_set1_epi8(','), q = _mm_set1_epi8('"'), n = _mm_set1_epi8('\n'), r = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((__m128i*)p);
+        int m = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, c), _mm_cmpeq_epi8(v, q)), _mm_or_si128(_mm_cmpeq_epi8(v, n), _mm_cmpeq_epi8(v, r))));
+        if (m) return p + __builtin_ctz(m);
+        p += 16;
+    }
+    #endif
+    while (p < end && *p != ',' && *p != '"' && *p != '\n' && *p != '\r') {++p;}
+    return p;
+}
 
-uint16_t getVarIndex = 0;
-char* getVarBuf = NULL;
+static inline int csvNext(char** pp, char* end, char** fs, size_t* fl, bool* fq) {
+    char* p = *pp;
+    *fq = false;
+    if (p < end && *p == '"') {
+        *fq = true;
+        *fs = ++p;
+        while ((p = memchr(p, '"', end - p)) && p + 1 < end && p[1] == '"') {p += 2;}
+        if (!p) p = end;
+        *fl = p - *fs;
+        if (p < end) ++p;
+        p = csvScan(p, end);
+        while (p < end && *p == '"') {p = csvScan(p + 1, end);}
+    } else {
+        *fs = p;
+        p = csvScan(p, end);
+        while (p < end && *p == '"') {p = csvScan(p + 1, end);}
+        *fl = p - *fs;
+    }
+    int term = 2;
+    if (p < end) {
+        if (*p == ',') {term = 0; ++p;}
+        else {term = 1; if (*p++ == '\r' && p < end && *p == '\n') ++p;}
+    }
+    *pp = p;
+    return term;
+}
 
-uint8_t getVar(char* vn, char* varout) {
-    char* lgetVarBuf = (getVarIndex) ? malloc(CB_BUF_SIZE) : getVarBuf;
-    ++getVarIndex;
-    uint8_t ret = 0;
-    int32_t vnlen = strlen(vn);
-    if (vn[vnlen - 1] == ')') {
-        ret = getFunc(vn, varout);
-        goto gvret;
+static inline bool csvIsNum(char* s, size_t l) {
+    size_t i = (l && s[0] == '-'), dot = 0;
+    if (i == l || l > 22) return false;
+    if (s[i] == '0' && ((i + 1 == l) ? i : s[i + 1] != '.')) return false;
+    for (size_t j = i; j < l; ++j) {
+        if (s[j] == '.') {if (dot || j == i) return false; dot = j;}
+        else if (s[j] < '0' || s[j] > '9') return false;
+    }
+    if (dot) return (dot - i <= 15 && dot < l - 1 && l - dot - 1 <= 6 && s[l - 1] != '0');
+    return (l - i <= 15);
+}
+
+static inline void csvStore(char** dest, char* fs, size_t fl, bool fq, uint8_t t) {
+    if (fl > CB_BUF_SIZE - 1) fl = CB_BUF_SIZE - 1;
+    if (t == 2 && !csvIsNum(fs, fl)) {
+        char tmp[512];
+        if (fl > 63) fl = 63;
+        memcpy(tmp, fs, fl);
+        tmp[fl] = 0;
+        char* ep;
+        double d = strtod(tmp, &ep);
+        if (ep == tmp) {
+            *dest = realloc(*dest, 2);
+            (*dest)[0] = '0';
+            (*dest)[1] = 0;
+            return;
+        }
+        sprintf(tmp, "%lf", d);
+        int32_t j = strlen(tmp) - 1;
+        while (tmp[j] == '0') {--j;}
+        if (tmp[j] == '.') {--j;}
+        tmp[j + 1] = 0;
+        if (!strcmp(tmp, "-0")) {tmp[0] = '0'; tmp[1] = 0;}
+        *dest = realloc(*dest, j + 2);
+        memcpy(*dest, tmp, j + 2);
+        return;
+    }
+    char* s = *dest = realloc(*dest, fl + 1);
+    if (fq) {
+        char* fe = fs + fl;
+        char* q;
+        while ((q = memchr(fs, '"', fe - fs))) {
+            size_t n = q - fs + 1;
+            memcpy(s, fs, n);
+            s += n;
+            fs = q + 2;
+            if (fs > fe) fs = fe;
+        }
+        memcpy(s, fs, fe - fs);
+        s += fe - fs;
+    } else {
+        memcpy(s, fs, fl);
+        s += fl;
+    }
+    *s = 0;
+}
+
+int32_t csvLoad(char* path, int32_t cols, char* vn) {
+    CBX(fileerror) = 0;
+    uint8_t t = (vn[strlen(vn) - 1] == '$') ? 1 : 2;
+    #ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    #else
+    int fd = open(path, O_RDONLY | O_BINARY);
+    #endif
+    if (fd < 0) {CBX(fileerror) = errno; CBX(cerr) = 15; seterrstr(path); return -1;}
+    struct stat st;
+    if (fstat(fd, &st)) {CBX(fileerror) = errno; close(fd); CBX(cerr) = 15; seterrstr(path); return -1;}
+    size_t len = (st.st_size > 0) ? st.st_size : 0;
+    char* data = NULL;
+    if (len) {
+        #ifndef _WIN32
+        data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {CBX(fileerror) = errno; close(fd); CBX(cerr) = 15; seterrstr(path); return -1;}
+        posix_madvise(data, len, POSIX_MADV_SEQUENTIAL);
+        #else
+        data = malloc(len);
+        ssize_t r = read(fd, data, len);
+        if (r < 0) {CBX(fileerror) = errno; free(data); close(fd); CBX(cerr) = 15; seterrstr(path); return -1;}
+        len = r;
+        #endif
+    }
+    close(fd);
+    char* end = data + len;
+    char* fs;
+    size_t fl;
+    bool fq;
+    int64_t rows = 0;
+    for (char* p = data; p < end;) {
+        char* rs = p;
+        int term;
+        while (!(term = csvNext(&p, end, &fs, &fl, &fq))) {}
+        if (fs != rs || fl || fq) ++rows;
+    }
+    int v = -1;
+    if (rows * cols > INT32_MAX) {CBX(cerr) = 16; seterrstr(path);}
+    else {v = dimVar(vn, t, (rows) ? rows * cols - 1 : 0);}
+    if (v != -1) {
+        int32_t i = 0;
+        for (char* p = data; p < end;) {
+            int32_t c = 0;
+            int term;
+            do {
+                term = csvNext(&p, end, &fs, &fl, &fq);
+                if (!c && term && !fl && !fq) break;
+                if (c < cols) csvStore(&CBX(vardata)[v].data[i + c], fs, fl, fq, t);
+                ++c;
+            } while (!term);
+            if (!c) continue;
+            for (; c < cols; ++c) {csvStore(&CBX(vardata)[v].data[i + c], "", 0, false, t);}
+            i += cols;
+        }
+        if (!rows) csvStore(&CBX(vardata)[v].data[0], "", 0, false, t);
+    }
+    #ifndef _WIN32
+    if (data) munmap(data, len);
+    #else
+    free(data);
+    #endif
+    return (v == -1) ? -1 : rows;
+}
+
+typedef struct {
+    cb_ctx* ctx;
+    bool done;
+    bool detached;
+    int ret;
+} cb_task;
+
+typedef struct {
+    cb_task** data;
+    int head;
+    int tail;
+    int cap;
+    #ifndef _WIN32
+    pthread_mutex_t lock;
+    #endif
+} cb_taskq;
+
+cb_task** taskdata = NULL;
+int taskmaxct = 0;
+cb_taskq* taskq = NULL;
+int taskworkers = 0;
+int taskpending = 0;
+CB_TLS int taskself = -1;
+#ifndef _WIN32
+pthread_mutex_t tasklock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t taskcond = PTHREAD_COND_INITIALIZER;
+pthread_once_t taskonce = PTHREAD_ONCE_INIT;
+#endif
+
+static inline void taskLock() {
+    #ifndef _WIN32
+    pthread_mutex_lock(&tasklock);
+    #endif
+}
+
+static inline void taskUnlock() {
+    #ifndef _WIN32
+    pthread_mutex_unlock(&tasklock);
+    #endif
+}
+
+static inline void taskqPush(cb_taskq* q, cb_task* t) {
+    #ifndef _WIN32
+    pthread_mutex_lock(&q->lock);
+    #endif
+    if (q->tail - q->head == q->cap) {
+        int ncap = (q->cap) ? q->cap * 2 : 64;
+        cb_task** ndata = (cb_task**)malloc(ncap * sizeof(cb_task*));
+        for (int i = q->head; i < q->tail; ++i) {ndata[i - q->head] = q->data[i % q->cap];}
+        free(q->data);
+        q->data = ndata;
+        q->tail -= q->head;
+        q->head = 0;
+        q->cap = ncap;
+    }
+    q->data[q->tail++ % q->cap] = t;
+    #ifndef _WIN32
+    pthread_mutex_unlock(&q->lock);
+    #endif
+}
+
+// The owner takes its newest task, thieves take the oldest
+static inline cb_task* taskqPop(cb_taskq* q, bool steal) {
+    cb_task* t = NULL;
+    #ifndef _WIN32
+    pthread_mutex_lock(&q->lock);
+    #endif
+    if (q->head != q->tail) {
+        t = (steal) ? q->data[q->head++ % q->cap] : q->data[--q->tail % q->cap];
+        if (q->head == q->tail) q->head = q->tail = 0;
+    }
+    #ifndef _WIN32
+    pthread_mutex_unlock(&q->lock);
+    #endif
+    return t;
+}
+
+static cb_task* taskTake() {
+    int self = (taskself > -1) ? taskself : taskworkers;
+    for (int i = 0; i <= taskworkers; ++i) {
+        int n = (self + i) % (taskworkers + 1);
+        cb_task* t = taskqPop(&taskq[n], n != self);
+        if (t) {
+            taskLock();
+            --taskpending;
+            taskUnlock();
+            return t;
+        }
+    }
+    return NULL;
+}
+
+static void taskRun(cb_task* t) {
+    cb_ctx* oldctx = cbctx;
+    cbctx = t->ctx;
+    runLoop(false);
+    int ret = CBX(lasterr);
+    cbctx = oldctx;
+    taskLock();
+    t->ret = ret;
+    t->done = true;
+    bool detached = t->detached;
+    #ifndef _WIN32
+    pthread_cond_broadcast(&taskcond);
+    #endif
+    taskUnlock();
+    if (detached) {
+        destroyCtx(t->ctx);
+        free(t);
+    }
+}
+
+#ifndef _WIN32
+static void* taskWorker(void* data) {
+    taskself = (intptr_t)data;
+    while (1) {
+        cb_task* t = taskTake();
+        if (t) {taskRun(t); continue;}
+        pthread_mutex_lock(&tasklock);
+        while (!taskpending) {pthread_cond_wait(&taskcond, &tasklock);}
+        pthread_mutex_unlock(&tasklock);
+    }
+    return NULL;
+}
+#endif
+
+static void taskInit() {
+    #ifndef _WIN32
+    int ct = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ct < 1) ct = 1;
+    taskq = (cb_taskq*)calloc(ct + 1, sizeof(cb_taskq));
+    for (int i = 0; i <= ct; ++i) {pthread_mutex_init(&taskq[i].lock, NULL);}
+    taskworkers = ct;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&attr, 8 * 1024 * 1024);
+    for (int i = 0; i < ct; ++i) {
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, taskWorker, (void*)(intptr_t)i)) break;
+    }
+    pthread_attr_destroy(&attr);
+    #else
+    taskq = (cb_taskq*)calloc(1, sizeof(cb_taskq));
+    #endif
+}
+
+static inline void taskPoolInit() {
+    #ifndef _WIN32
+    pthread_once(&taskonce, taskInit);
+    #else
+    if (!taskq) taskInit();
+    #endif
+}
+
+static int taskQueue(cb_ctx* ctx, bool detached) {
+    cb_task* t = (cb_task*)calloc(1, sizeof(cb_task));
+    t->ctx = ctx;
+    t->detached = detached;
+    int id = 0;
+    if (!detached) {
+        taskLock();
+        while (id < taskmaxct && taskdata[id]) {++id;}
+        if (id == taskmaxct) {
+            ++taskmaxct;
+            taskdata = (cb_task**)realloc(taskdata, taskmaxct * sizeof(cb_task*));
+        }
+        taskdata[id] = t;
+        taskUnlock();
+    }
+    taskqPush(&taskq[(taskself > -1) ? taskself : taskworkers], t);
+    taskLock();
+    ++taskpending;
+    #ifndef _WIN32
+    pthread_cond_broadcast(&taskcond);
+    #endif
+    taskUnlock();
+    return id + 1;
+}
+
+// Starts label as a GOSUB on a copy of the running program in a new context, args become _ARG$(1)...
+int taskSpawn(char* lbl, int argc, char** args, bool detached) {
+    if (!CBX(inProg)) {CBX(cerr) = 125; seterrstr("SPAWN"); return -1;}
+    int g = -1;
+    for (int i = 0; i < CBX(gotomaxct); ++i) {
+        if (CBX(gotodata)[i].used && !strcmp(CBX(gotodata)[i].name, lbl)) {g = i; break;}
+    }
+    if (g == -1) {CBX(cerr) = 29; return -1;}
+    taskPoolInit();
+    char* src = CBX(progbuf)[CBX(progindex)];
+    char* fn = malloc(strlen(CBX(progfn)[CBX(progindex)]) + 1);
+    strcpy(fn, CBX(progfn)[CBX(progindex)]);
+    cb_goto* pgotodata = CBX(gotodata);
+    int pgotomaxct = CBX(gotomaxct);
+    cb_ctx* ctx = newCtx();
+    cb_ctx* oldctx = cbctx;
+    cbctx = ctx;
+    CBX(newprogargs) = (char**)malloc((argc + 1) * sizeof(char*));
+    CBX(newprogargs)[0] = NULL;
+    for (int i = 0; i < argc; ++i) {
+        CBX(newprogargs)[i + 1] = malloc(strlen(args[i]) + 1);
+        strcpy(CBX(newprogargs)[i + 1], args[i]);
+    }
+    CBX(newprogargc) = argc + 1;
+    int32_t len = strlen(src);
+    pushProg(fn, src, len);
+    CBX(gotodata) = (cb_goto*)malloc(pgotomaxct * sizeof(cb_goto));
+    for (int i = 0; i < pgotomaxct; ++i) {
+        if (!pgotodata[i].used) continue;
+        CBX(gotodata)[CBX(gotomaxct)] = pgotodata[i];
+        CBX(gotodata)[CBX(gotomaxct)].name = malloc(strlen(pgotodata[i].name) + 1);
+        strcpy(CBX(gotodata)[CBX(gotomaxct)].name, pgotodata[i].name);
+        CBX(gotodata)[CBX(gotomaxct)].dlsp = CBX(gotodata)[CBX(gotomaxct)].fnsp = CBX(gotodata)[CBX(gotomaxct)].itsp = -1;
+        ++CBX(gotomaxct);
+    }
+    CBX(gsstackp) = 0;
+    CBX(gsstack)[0].cp = len;
+    CBX(gsstack)[0].pl = pgotodata[g].pl;
+    CBX(gsstack)[0].dlsp = CBX(gsstack)[0].fnsp = CBX(gsstack)[0].itsp = -1;
+    CBX(cp) = pgotodata[g].cp;
+    CBX(progLine) = pgotodata[g].pl;
+    CBX(lockpl) = true;
+    CBX(inProg) = true;
+    cbctx = oldctx;
+    return taskQueue(ctx, detached);
+}
+
+// Waits for a task, running queued tasks meanwhile, and takes it out of the task list
+static cb_task* taskWait(int id) {
+    taskLock();
+    cb_task* t = (id > 0 && id <= taskmaxct) ? taskdata[id - 1] : NULL;
+    if (t) taskdata[id - 1] = NULL;
+    taskUnlock();
+    if (!t) return NULL;
+    while (1) {
+        taskLock();
+        bool done = t->done;
+        taskUnlock();
+        if (done) break;
+        cb_task* o = taskTake();
+        if (o) {taskRun(o); continue;}
+        #ifndef _WIN32
+        pthread_mutex_lock(&tasklock);
+        while (!t->done && !taskpending) {pthread_cond_wait(&taskcond, &tasklock);}
+        pthread_mutex_unlock(&tasklock);
+        #endif
+    }
+    return t;
+}
+
+// Returns the error code of a finished task, or -1 if id is not a task
+int taskJoin(int id) {
+    cb_task* t = taskWait(id);
+    if (!t) return -1;
+    int ret = t->ret;
+    destroyCtx(t->ctx);
+    free(t);
+    return ret;
+}
+
+// Finds the NEXT matching the FOR or PARFOR that ends at pos, returns where the NEXT ends or -1 and
+// counts the lines in between
+static int32_t parForFindNext(char* p, int32_t pos, int* lines) {
+    int depth = 0;
+    *lines = 0;
+    while (p[pos]) {
+        if (p[pos] == '\n') ++*lines;
+        ++pos;
+        while (p[pos] == ' ') {++pos;}
+        int32_t ws = pos;
+        bool inStr = false;
+        while (p[pos] && p[pos] != '\n' && (inStr || p[pos] != ':')) {
+            if (p[pos] == '"') inStr = !inStr;
+            ++pos;
+        }
+        char w[8];
+        int wl = 0;
+        while (wl < 7 && ws + wl < pos && p[ws + wl] != ' ') {
+            w[wl] = (p[ws + wl] >= 'a' && p[ws + wl] <= 'z') ? p[ws + wl] - 32 : p[ws + wl];
+            ++wl;
+        }
+        w[wl] = 0;
+        if (!strcmp(w, "FOR") || !strcmp(w, "PARFOR")) {
+            ++depth;
+        } else if (!strcmp(w, "NEXT")) {
+            if (!depth) return pos;
+            --depth;
+        }
+    }
+    return -1;
+}
+
+static inline bool parForShared(cb_var* vars, int ct, char** data) {
+    for (int i = 0; i < ct; ++i) {
+        if (vars[i].inuse && vars[i].size >= 0 && vars[i].data == data) return true;
+    }
+    return false;
+}
+
+// Arrays shared with the program that started a PARFOR chunk cannot be resized or deleted by it
+static inline bool parForFixed(int v) {
+    if (!CBX(parvars) || !parForShared(CBX(parvars), CBX(parvarct), CBX(vardata)[v].data)) return false;
+    CBX(cerr) = 38;
+    seterrstr(CBX(vardata)[v].name);
+    return true;
+}
+
+// Value a chunk starts a REDUCE variable at: the identity of + and *, and for MIN and MAX the
+// variable's own value, which folding in again does not change
+static inline double parForSeed(cb_parred* red) {
+    switch (red->op) {
+        case 0: return 0;
+        case 1: return 1;
+        default: return red->val;
+    }
+}
+
+// Runs the body of a PARFOR (the program text from the end of the PARFOR to its NEXT) for var = a
+// to b in chunks on the task pool. Each chunk runs a copy of the program with the PARFOR replaced by
+// a FOR over its part of the range and an EXIT after the NEXT, and gets the labels seen so far.
+// Chunks get private copies of scalars, share arrays (elements can be set but the arrays cannot be
+// resized or deleted), and start REDUCE variables at parForSeed(); the partial results are folded
+// back in. Returns an error code, negated if a chunk stopped on it and already printed it
+int parFor(char* var, double a, double b, cb_parred* reds, int redct) {
+    char* p = (CBX(inProg)) ? CBX(progbuf)[CBX(progindex)] : conbuf;
+    int32_t pos = (CBX(inProg)) ? CBX(cp) : concp;
+    int32_t ps = CBX(cmdpos);
+    int lines;
+    int32_t end = parForFindNext(p, pos, &lines);
+    if (end == -1) return 37;
+    for (int r = 0; r < redct; ++r) {
+        if (getVar(reds[r].var, CBX(runcmdbuf)[0]) != 2) return (CBX(cerr)) ? CBX(cerr) : 2;
+        reds[r].val = atof(CBX(runcmdbuf)[0]);
+    }
+    int64_t ct = (b >= a) ? (int64_t)(b - a) + 1 : 0;
+    int ret = 0;
+    if (ct > 0) {
+        taskPoolInit();
+        int64_t chunks = 2 * (taskworkers + 1);
+        if (chunks > ct) chunks = ct;
+        int* ids = (int*)malloc(chunks * sizeof(int));
+        int32_t blen = end - pos;
+        int32_t tlen = strlen(&p[end]);
+        char* src = malloc(ps + blen + tlen + 3 * CB_BUF_SIZE / 32);
+        memcpy(src, p, ps);
+        cb_ctx* pctx = cbctx;
+        cb_var* pvars = CBX(vardata);
+        int pvarct = CBX(varmaxct);
+        cb_goto* pgotodata = CBX(gotodata);
+        int pgotomaxct = CBX(gotomaxct);
+        for (int64_t k = 0; k < chunks; ++k) {
+            int l = sprintf(&src[ps], "FOR %s, %.17g, %s <= %.17g, 1", var, a + (double)(ct * k / chunks), var, a + (double)(ct * (k + 1) / chunks) - 1);
+            memcpy(&src[ps + l], &p[pos], blen);
+            memcpy(&src[ps + l + blen], ":EXIT", 5);
+            memcpy(&src[ps + l + blen + 5], &p[end], tlen);
+            char* name = malloc((CBX(inProg)) ? strlen(CBX(progfn)[CBX(progindex)]) + 1 : 9);
+            strcpy(name, (CBX(inProg)) ? CBX(progfn)[CBX(progindex)] : "(parfor)");
+            int line = CBX(progLine);
+            cb_var* pvardata = CBX(vardata);
+            int pvarmaxct = CBX(varmaxct);
+            cb_shm* pshmdata = CBX(shmdata);
+            int pshmmaxct = CBX(shmmaxct);
+            cb_ctx* ctx = newCtx();
+            cbctx = ctx;
+            CBX(shmmaxct) = pshmmaxct;
+            CBX(shmdata) = (cb_shm*)malloc(pshmmaxct * sizeof(cb_shm));
+            for (int i = 0; i < pshmmaxct; ++i) {
+                CBX(shmdata)[i] = pshmdata[i];
+                if (!CBX(shmdata)[i].inuse) continue;
+                CBX(shmdata)[i].borrowed = true;
+                CBX(shmdata)[i].name = malloc(strlen(pshmdata[i].name) + 1);
+                strcpy(CBX(shmdata)[i].name, pshmdata[i].name);
+                CBX(shmdata)[i].key = malloc(strlen(pshmdata[i].key) + 1);
+                strcpy(CBX(shmdata)[i].key, pshmdata[i].key);
+            }
+            CBX(parvars) = pvardata;
+            CBX(parvarct) = pvarmaxct;
+            CBX(varmaxct) = pvarmaxct;
+            CBX(vardata) = (cb_var*)malloc(pvarmaxct * sizeof(cb_var));
+            for (int i = 0; i < pvarmaxct; ++i) {
+                CBX(vardata)[i] = pvardata[i];
+                if (!CBX(vardata)[i].inuse) continue;
+                CBX(vardata)[i].name = malloc(strlen(pvardata[i].name) + 1);
+                strcpy(CBX(vardata)[i].name, pvardata[i].name);
+                if (CBX(vardata)[i].size == -1) {
+                    CBX(vardata)[i].data = (char**)malloc(sizeof(char*));
+                    CBX(vardata)[i].data[0] = malloc(strlen(pvardata[i].data[0]) + 1);
+                    strcpy(CBX(vardata)[i].data[0], pvardata[i].data[0]);
+                }
+            }
+            for (int r = 0; r < redct; ++r) {
+                sprintf(CBX(runcmdbuf)[0], "%lf", parForSeed(&reds[r]));
+                setVar(reds[r].var, CBX(runcmdbuf)[0], 2, -1);
+            }
+            pushProg(name, src, ps + l + blen + 5 + tlen);
+            // labels keep their place, those after the PARFOR move by what the FOR and EXIT add
+            CBX(gotodata) = (cb_goto*)malloc((pgotomaxct + 1) * sizeof(cb_goto));
+            for (int i = 0; i < pgotomaxct; ++i) {
+                if (!pgotodata[i].used) continue;
+                CBX(gotodata)[CBX(gotomaxct)] = pgotodata[i];
+                CBX(gotodata)[CBX(gotomaxct)].name = malloc(strlen(pgotodata[i].name) + 1);
+                strcpy(CBX(gotodata)[CBX(gotomaxct)].name, pgotodata[i].name);
+                if (pgotodata[i].cp >= end) CBX(gotodata)[CBX(gotomaxct)].cp += l + 5 - (pos - ps);
+                else if (pgotodata[i].cp >= pos) CBX(gotodata)[CBX(gotomaxct)].cp += l - (pos - ps);
+                CBX(gotodata)[CBX(gotomaxct)].dlsp = CBX(gotodata)[CBX(gotomaxct)].fnsp = CBX(gotodata)[CBX(gotomaxct)].itsp = -1;
+                ++CBX(gotomaxct);
+            }
+            CBX(cp) = ps;
+            CBX(progLine) = line;
+            CBX(lockpl) = true;
+            CBX(inProg) = true;
+            cbctx = pctx;
+            ids[k] = taskQueue(ctx, false);
+        }
+        free(src);
+        for (int64_t k = 0; k < chunks; ++k) {
+            cb_task* t = taskWait(ids[k]);
+            if (t->ret && !ret) ret = t->ret;
+            cbctx = t->ctx;
+            for (int r = 0; r < redct; ++r) {
+                getVar(reds[r].var, CBX(runcmdbuf)[0]);
+                double v = atof(CBX(runcmdbuf)[0]);
+                switch (reds[r].op) {
+                    case 0: reds[r].val += v; break;
+                    case 1: reds[r].val *= v; break;
+                    case 2: if (v < reds[r].val) {reds[r].val = v;} break;
+                    case 3: if (v > reds[r].val) {reds[r].val = v;} break;
+                }
+            }
+            for (int i = 0; i < CBX(varmaxct); ++i) {
+                if (CBX(vardata)[i].inuse && CBX(vardata)[i].size >= 0 && parForShared(pvars, pvarct, CBX(vardata)[i].data)) {
+                    nfree(CBX(vardata)[i].name);
+                    CBX(vardata)[i].inuse = false;
+                }
+            }
+            cbctx = pctx;
+            destroyCtx(t->ctx);
+            free(t);
+        }
+        free(ids);
+    }
+    if (ret) return -ret;
+    for (int r = 0; r < redct; ++r) {
+        sprintf(CBX(runcmdbuf)[0], "%lf", reds[r].val);
+        setVar(reds[r].var, CBX(runcmdbuf)[0], 2, -1);
+    }
+    // like FOR, the variable ends at the first value past the range
+    sprintf(CBX(runcmdbuf)[0], "%lf", a + (double)ct);
+    setVar(var, CBX(runcmdbuf)[0], 2, -1);
+    if (CBX(inProg)) {
+        CBX(cp) = end;
+    } else {
+        concp = end;
+    }
+    CBX(progLine) += lines;
+    CBX(didloop) = true;
+    return 0;
+}
+
+static void coSave(cb_co* co) {
+    co->cp = CBX(cp);
+    co->cl = CBX(cmdl);
+    co->pl = CBX(progLine);
+    co->lock = CBX(lockpl);
+    co->looped = CBX(didloop);
+    co->brkinfo = CBX(brkinfo);
+    co->dlsp = CBX(dlstackp);
+    co->itsp = CBX(itstackp);
+    co->fnsp = CBX(fnstackp);
+    co->gssp = CBX(gsstackp);
+    int n = CBX(dlstackp);
+    if (CBX(itstackp) > n) n = CBX(itstackp);
+    if (CBX(fnstackp) > n) n = CBX(fnstackp);
+    if (CBX(gsstackp) > n) n = CBX(gsstackp);
+    n += 2;
+    if (n > CB_PROG_LOGIC_MAX) n = CB_PROG_LOGIC_MAX;
+    co->depth = CBX(codepth) = n;
+    memcpy(co->dl, CBX(dlstack), n * sizeof(cb_jump));
+    memcpy(co->dld, CBX(dldcmd), n * sizeof(bool));
+    memcpy(co->itd, CBX(itdcmd), n * sizeof(bool));
+    memcpy(co->ite, CBX(didelse), n * sizeof(bool));
+    memcpy(co->itei, CBX(didelseif), n * sizeof(bool));
+    memcpy(co->fn, CBX(fnstack), n * sizeof(cb_jump));
+    memcpy(co->fnd, CBX(fndcmd), n * sizeof(bool));
+    memcpy(co->fni, CBX(fninfor), n * sizeof(bool));
+    memcpy(co->gs, CBX(gsstack), n * sizeof(cb_gosub));
+}
+
+// Restores a coroutine and resets the stack entries the previous one used past its depth
+static void coLoad(cb_co* co) {
+    CBX(cp) = co->cp;
+    CBX(cmdl) = co->cl;
+    CBX(progLine) = co->pl;
+    CBX(lockpl) = co->lock;
+    CBX(didloop) = co->looped;
+    CBX(brkinfo) = co->brkinfo;
+    CBX(dlstackp) = co->dlsp;
+    CBX(itstackp) = co->itsp;
+    CBX(fnstackp) = co->fnsp;
+    CBX(gsstackp) = co->gssp;
+    int n = co->depth;
+    memcpy(CBX(dlstack), co->dl, n * sizeof(cb_jump));
+    memcpy(CBX(dldcmd), co->dld, n * sizeof(bool));
+    memcpy(CBX(itdcmd), co->itd, n * sizeof(bool));
+    memcpy(CBX(didelse), co->ite, n * sizeof(bool));
+    memcpy(CBX(didelseif), co->itei, n * sizeof(bool));
+    memcpy(CBX(fnstack), co->fn, n * sizeof(cb_jump));
+    memcpy(CBX(fndcmd), co->fnd, n * sizeof(bool));
+    memcpy(CBX(fninfor), co->fni, n * sizeof(bool));
+    memcpy(CBX(gsstack), co->gs, n * sizeof(cb_gosub));
+    for (int i = n; i < CBX(codepth); ++i) {
+        memset(&CBX(dlstack)[i], 0, sizeof(cb_jump));
+        CBX(dldcmd)[i] = false;
+        CBX(itdcmd)[i] = false;
+        CBX(didelse)[i] = false;
+        CBX(didelseif)[i] = false;
+        memset(&CBX(fnstack)[i], 0, sizeof(cb_jump));
+        CBX(fnstack)[i].cp = -1;
+        CBX(fndcmd)[i] = false;
+        CBX(fninfor)[i] = false;
+        memset(&CBX(gsstack)[i], 0, sizeof(cb_gosub));
+    }
+}
+
+void coFreeAll() {
+    for (int i = 0; i < CBX(comaxct); ++i) {
+        nfree(CBX(codata)[i]);
+    }
+    nfree(CBX(codata));
+    CBX(comaxct) = 0;
+    CBX(coself) = 0;
+}
+
+// Starts label as a coroutine of the running program, it runs when the others yield and ends at
+// its last RETURN
+int coStart(char* lbl) {
+    int g = -1;
+    for (int i = 0; i < CBX(gotomaxct); ++i) {
+        if (CBX(gotodata)[i].used && !strcmp(CBX(gotodata)[i].name, lbl)) {g = i; break;}
+    }
+    if (g == -1) {CBX(cerr) = 29; return -1;}
+    if (!CBX(comaxct)) {
+        CBX(codata) = (cb_co**)malloc(sizeof(cb_co*));
+        CBX(codata)[0] = (cb_co*)calloc(1, sizeof(cb_co));
+        CBX(comaxct) = 1;
+        CBX(coself) = 0;
+        CBX(coprog) = CBX(progindex);
+    } else if (CBX(progindex) != CBX(coprog)) {
+        CBX(cerr) = 16;
+        return -1;
+    }
+    int id = 1;
+    while (id < CBX(comaxct) && CBX(codata)[id]) {++id;}
+    if (id == CBX(comaxct)) {
+        ++CBX(comaxct);
+        CBX(codata) = (cb_co**)realloc(CBX(codata), CBX(comaxct) * sizeof(cb_co*));
+    }
+    cb_co* co = CBX(codata)[id] = (cb_co*)calloc(1, sizeof(cb_co));
+    co->fd = -1;
+    co->cp = CBX(gotodata)[g].cp;
+    co->pl = CBX(gotodata)[g].pl;
+    co->lock = true;
+    co->looped = true;
+    co->dlsp = CBX(mindlstackp)[CBX(progindex)];
+    co->itsp = CBX(minitstackp)[CBX(progindex)];
+    co->fnsp = CBX(minfnstackp)[CBX(progindex)];
+    co->gssp = 0;
+    return id;
+}
+
+int coCount() {
+    int ct = 0;
+    for (int i = 1; i < CBX(comaxct); ++i) {
+        if (CBX(codata)[i]) ++ct;
+    }
+    return ct;
+}
+
+// Switches to the next coroutine that is not waiting, round-robin, and blocks on the files and
+// deadlines of the waiting ones if there is none; end drops the running coroutine
+void coYield(bool end) {
+    if (!CBX(comaxct) || CBX(progindex) != CBX(coprog)) return;
+    int self = CBX(coself);
+    if (end) {
+        nfree(CBX(codata)[self]);
+        while (CBX(comaxct) > 1 && !CBX(codata)[CBX(comaxct) - 1]) {--CBX(comaxct);}
+    } else {
+        coSave(CBX(codata)[self]);
+    }
+    int next = -1;
+    #ifndef _WIN32
+    struct pollfd* pfd = NULL;
+    int* pco = NULL;
+    #endif
+    while (1) {
+        uint64_t now = usTime();
+        int64_t wait = -1;
+        int pct = 0;
+        for (int k = 1; k <= CBX(comaxct); ++k) {
+            int i = (self + k) % CBX(comaxct);
+            cb_co* co = CBX(codata)[i];
+            if (!co) continue;
+            if (co->waiting && co->until && now >= co->until) co->waiting = false;
+            if (!co->waiting) {next = i; break;}
+            if (co->until && (wait == -1 || (int64_t)(co->until - now) < wait)) wait = co->until - now;
+            if (co->fd > -1) ++pct;
+        }
+        if (next > -1 || cmdint) break;
+        #ifndef _WIN32
+        if (pct) {
+            pfd = (struct pollfd*)realloc(pfd, pct * sizeof(struct pollfd));
+            pco = (int*)realloc(pco, pct * sizeof(int));
+            pct = 0;
+            for (int i = 0; i < CBX(comaxct); ++i) {
+                if (!CBX(codata)[i] || !CBX(codata)[i]->waiting || CBX(codata)[i]->fd < 0) continue;
+                pfd[pct].fd = CBX(codata)[i]->fd;
+                pfd[pct].events = POLLIN;
+                pfd[pct].revents = 0;
+                pco[pct++] = i;
+            }
+            if (poll(pfd, pct, (wait == -1) ? -1 : (int)((wait + 999) / 1000)) > 0) {
+                for (int i = 0; i < pct; ++i) {
+                    if (pfd[i].revents) CBX(codata)[pco[i]]->waiting = false;
+                }
+            }
+            continue;
+        }
+        #endif
+        cb_wait(wait);
+    }
+    #ifndef _WIN32
+    free(pfd);
+    free(pco);
+    #endif
+    if (next == -1) next = (CBX(codata)[self]) ? self : 0;
+    CBX(codata)[next]->waiting = false;
+    CBX(codata)[next]->fd = -1;
+    CBX(codata)[next]->until = 0;
+    CBX(coself) = next;
+    if (next != self || end) coLoad(CBX(codata)[next]);
+}
+
+// Makes the running coroutine wait for a file descriptor to be readable and/or for a number of
+// seconds while the others run
+void coWait(double secs, int fd) {
+    #ifdef _WIN32
+    if (fd > -1) {fd = -1; if (secs < 0) secs = 0;}
+    #endif
+    if (!CBX(comaxct) || CBX(progindex) != CBX(coprog)) {
+        #ifndef _WIN32
+        if (fd > -1) {
+            struct pollfd pfd = {.fd = fd, .events = POLLIN};
+            while (poll(&pfd, 1, (secs < 0) ? -1 : (int)(secs * 1000)) == -1 && errno == EINTR && !cmdint) {}
+            return;
+        }
+        #endif
+        cb_wait(secs * 1000000);
+        return;
+    }
+    cb_co* co = CBX(codata)[CBX(coself)];
+    co->waiting = true;
+    co->fd = fd;
+    co->until = (secs < 0) ? 0 : usTime() + (uint64_t)(secs * 1000000);
+    coYield(false);
+}
+
+// Event sources are epoll'd on Linux with timers as timerfds; other systems poll() the files and
+// emulate the timers with deadlines
+
+static int evSlot() {
+    int i = 0;
+    while (i < CBX(evmaxct) && CBX(evdata)[i].inuse) {++i;}
+    if (i == CBX(evmaxct)) {
+        ++CBX(evmaxct);
+        CBX(evdata) = (cb_ev*)realloc(CBX(evdata), CBX(evmaxct) * sizeof(cb_ev));
+    }
+    memset(&CBX(evdata)[i], 0, sizeof(cb_ev));
+    CBX(evdata)[i].inuse = true;
+    CBX(evdata)[i].fd = -1;
+    return i;
+}
+
+#ifdef __linux__
+static int evEpoll() {
+    if (!CBX(evepok)) {
+        CBX(evep) = epoll_create1(EPOLL_CLOEXEC);
+        CBX(evepok) = (CBX(evep) > -1);
+    }
+    return (CBX(evepok)) ? CBX(evep) : -1;
+}
+#endif
+
+static void evDrop(int i) {
+    cb_ev* ev = &CBX(evdata)[i];
+    #ifdef __linux__
+    if (ev->polled && CBX(evepok)) epoll_ctl(CBX(evep), EPOLL_CTL_DEL, ev->fd, NULL);
+    if (ev->timer && ev->fd > -1) close(ev->fd);
+    #endif
+    ev->inuse = false;
+    if (CBX(evpend) == i + 1) CBX(evpend) = 0;
+    while (CBX(evmaxct) > 0 && !CBX(evdata)[CBX(evmaxct) - 1].inuse) {--CBX(evmaxct);}
+}
+
+// Watches a file for data to read (-1 for stdin) and returns the event id, or -1 with fileerror set
+int evWatch(int fnum) {
+    CBX(fileerror) = 0;
+    #ifndef _WIN32
+    FILE* f = stdin;
+    if (fnum != -1) {
+        if (fnum < 0 || fnum >= CBX(filemaxct) || !CBX(filedata)[fnum].fptr) {CBX(fileerror) = EBADF; return -1;}
+        f = CBX(filedata)[fnum].fptr;
+    }
+    for (int i = 0; i < CBX(evmaxct); ++i) {
+        if (CBX(evdata)[i].inuse && !CBX(evdata)[i].timer && CBX(evdata)[i].fnum == fnum) return i + 1;
+    }
+    int i = evSlot();
+    cb_ev* ev = &CBX(evdata)[i];
+    ev->fnum = fnum;
+    ev->fd = fileno(f);
+    ev->polled = !(fnum > -1 && (CBX(filedata)[fnum].map || CBX(filedata)[fnum].ra));
+    #ifdef __linux__
+    if (ev->polled) {
+        struct epoll_event e = {.events = EPOLLIN, .data.u32 = i + 1};
+        int ep = evEpoll();
+        if (ep == -1 || epoll_ctl(ep, EPOLL_CTL_ADD, ev->fd, &e)) {
+            if (ep == -1 || errno != EPERM) {CBX(fileerror) = errno; ev->polled = false; evDrop(i); return -1;}
+            ev->polled = false;
+        }
+    }
+    #else
+    struct stat st;
+    if (ev->polled && !fstat(ev->fd, &st) && S_ISREG(st.st_mode)) ev->polled = false;
+    #endif
+    return i + 1;
+    #else
+    (void)fnum;
+    CBX(fileerror) = ENOSYS;
+    return -1;
+    #endif
+}
+
+// Adds a timer that fires every secs seconds, or once, and returns the event id
+int evTimer(double secs, bool once) {
+    CBX(fileerror) = 0;
+    if (secs <= 0) {CBX(fileerror) = EINVAL; return -1;}
+    #ifndef _WIN32
+    uint64_t us = secs * 1000000;
+    if (!us) us = 1;
+    int i = evSlot();
+    cb_ev* ev = &CBX(evdata)[i];
+    ev->timer = true;
+    ev->interval = (once) ? 0 : us;
+    ev->next = usTime() + us;
+    #ifdef __linux__
+    struct itimerspec its = {
+        .it_value = {.tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000},
+        .it_interval = {.tv_sec = ev->interval / 1000000, .tv_nsec = (ev->interval % 1000000) * 1000}
+    };
+    struct epoll_event e = {.events = EPOLLIN, .data.u32 = i + 1};
+    int ep = evEpoll();
+    if (ep > -1) ev->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (ev->fd == -1 || timerfd_settime(ev->fd, 0, &its, NULL) || epoll_ctl(ep, EPOLL_CTL_ADD, ev->fd, &e)) {
+        CBX(fileerror) = errno;
+        evDrop(i);
+        return -1;
+    }
+    ev->polled = true;
+    #endif
+    return i + 1;
+    #else
+    (void)once;
+    CBX(fileerror) = ENOSYS;
+    return -1;
+    #endif
+}
+
+// Stops watching an event source, -1 drops all of them
+bool evUnwatch(int id) {
+    if (id == -1) {
+        for (int i = CBX(evmaxct) - 1; i > -1; --i) {
+            if (CBX(evdata)[i].inuse) evDrop(i);
+        }
+        nfree(CBX(evdata));
+        CBX(evmaxct) = 0;
+        CBX(evpend) = 0;
+        #ifdef __linux__
+        if (CBX(evepok)) {close(CBX(evep)); CBX(evepok) = false;}
+        #endif
+        return true;
+    }
+    if (id < 1 || id > CBX(evmaxct) || !CBX(evdata)[id - 1].inuse) return false;
+    evDrop(id - 1);
+    return true;
+}
+
+static void evUnwatchFile(int fnum) {
+    for (int i = CBX(evmaxct) - 1; i > -1; --i) {
+        if (CBX(evdata)[i].inuse && !CBX(evdata)[i].timer && (CBX(evdata)[i].fnum == fnum || (fnum == -1 && CBX(evdata)[i].fnum > -1))) evDrop(i);
+    }
+}
+
+// Sources that are ready without waiting: unpollable files before EOF, streams with data left in
+// their read buffer, and due emulated timers (stdin is ready when its descriptor is, the clibasic
+// executable keeps it unbuffered so stdio holds nothing back)
+static inline bool evReady(cb_ev* ev) {
+    if (ev->timer) {
+        #ifndef __linux__
+        return (usTime() >= ev->next);
+        #else
+        return false;
+        #endif
+    }
+    if (!ev->polled) return !fileEOF(ev->fnum);
+    return (ev->fnum > -1 && CBX(filedata)[ev->fnum].pos < CBX(filedata)[ev->fnum].rdct);
+}
+
+static int evFire(int i) {
+    cb_ev* ev = &CBX(evdata)[i];
+    if (ev->timer) {
+        #ifdef __linux__
+        uint64_t n;
+        if (read(ev->fd, &n, sizeof(n)) != sizeof(n)) return 0;
+        #else
+        uint64_t now = usTime();
+        if (ev->interval) {
+            while (ev->next <= now) {ev->next += ev->interval;}
+        }
+        #endif
+        if (!ev->interval) evDrop(i);
+    }
+    CBX(evlast) = i + 1;
+    return i + 1;
+}
+
+// Blocks until an event source is ready or secs pass (forever if negative) and returns its id, 0
+// on timeout, or -1 if interrupted or on error
+int evWait(double secs) {
+    CBX(fileerror) = 0;
+    uint64_t until = (secs < 0) ? 0 : usTime() + (uint64_t)(secs * 1000000);
+    #ifndef _WIN32
+    #ifndef __linux__
+    struct pollfd* pfd = NULL;
+    int* pev = NULL;
+    #endif
+    int id = -1;
+    while (!cmdint) {
+        uint64_t now = usTime();
+        int64_t wait = (secs < 0) ? -1 : (until > now) ? (int64_t)(until - now) : 0;
+        int64_t t = tmrLeft(now);
+        if (!t) {id = -1; goto ret;}
+        if (t > 0 && (wait == -1 || t < wait)) wait = t;
+        for (int k = 0; k < CBX(evmaxct); ++k) {
+            int i = (CBX(evlast) + k) % CBX(evmaxct);
+            cb_ev* ev = &CBX(evdata)[i];
+            if (!ev->inuse) continue;
+            if (evReady(ev) && (id = evFire(i)) > 0) goto ret;
+            #ifndef __linux__
+            if (ev->timer && (wait == -1 || (int64_t)(ev->next - now) < wait)) wait = (ev->next > now) ? ev->next - now : 0;
+            #endif
+        }
+        int ms = (wait == -1 || wait > 86400000000LL) ? -1 : (int)((wait + 999) / 1000);
+        if (t > 0 && wait == t) {
+            // wake up on time for the tick, the last part of a millisecond is slept off
+            ms = wait / 1000;
+            if (!ms) {cb_wait(wait); continue;}
+        }
+        #ifdef __linux__
+        int ep = evEpoll();
+        struct epoll_event e;
+        int r = (ep > -1) ? epoll_wait(ep, &e, 1, ms) : -1;
+        if (r == 1 && e.data.u32 > 0 && (int)e.data.u32 <= CBX(evmaxct) && CBX(evdata)[e.data.u32 - 1].inuse) {
+            if ((id = evFire(e.data.u32 - 1)) > 0) goto ret;
+        }
+        #else
+        int pct = 0;
+        for (int i = 0; i < CBX(evmaxct); ++i) {
+            if (CBX(evdata)[i].inuse && !CBX(evdata)[i].timer && CBX(evdata)[i].polled) ++pct;
+        }
+        pfd = (struct pollfd*)realloc(pfd, (pct + 1) * sizeof(struct pollfd));
+        pev = (int*)realloc(pev, (pct + 1) * sizeof(int));
+        pct = 0;
+        for (int i = 0; i < CBX(evmaxct); ++i) {
+            if (!CBX(evdata)[i].inuse || CBX(evdata)[i].timer || !CBX(evdata)[i].polled) continue;
+            pfd[pct].fd = CBX(evdata)[i].fd;
+            pfd[pct].events = POLLIN;
+            pfd[pct].revents = 0;
+            pev[pct++] = i;
+        }
+        int r = poll(pfd, pct, ms);
+        if (r > 0) {
+            for (int i = 0; i < pct; ++i) {
+                if (pfd[i].revents && (id = evFire(pev[i])) > 0) goto ret;
+            }
+        }
+        #endif
+        if (r == -1 && errno != EINTR) {CBX(fileerror) = errno; id = -1; goto ret;}
+        if (secs >= 0 && usTime() >= until) {id = 0; goto ret;}
+    }
+    id = -1;
+    ret:;
+    #ifndef __linux__
+    free(pfd);
+    free(pev);
+    #endif
+    return id;
+    #else
+    if (secs < 0) secs = 0;
+    cb_wait(secs * 1000000);
+    CBX(fileerror) = ENOSYS;
+    return (cmdint) ? -1 : 0;
+    #endif
+}
+
+static inline bool isLabel(char* lbl) {
+    for (int i = 0; i < CBX(gotomaxct); ++i) {
+        if (CBX(gotodata)[i].used && !strcmp(CBX(gotodata)[i].name, lbl)) return true;
+    }
+    return false;
+}
+
+// Returns true while runcmd is skipping statements (a false IF, a loop being left, or a BREAK), when
+// a handler must not be jumped to yet
+static inline bool cmdSkipped() {
+    if (CBX(dlstackp) > CBX(mindlstackp)[CBX(progindex)] && CBX(dldcmd)[CBX(dlstackp)]) return true;
+    if (CBX(itstackp) > CBX(minitstackp)[CBX(progindex)] && CBX(itdcmd)[CBX(itstackp)]) return true;
+    if (CBX(fnstackp) > CBX(minfnstackp)[CBX(progindex)] && CBX(fndcmd)[CBX(fnstackp)]) return true;
+    return false;
+}
+
+// Jumps to a label of the running program like GOSUB and returns the new gsstackp + 1, or 0 if
+// the label is not defined or the stack is full
+static int gosubLabel(char* lbl) {
+    if (CBX(gsstackp) >= CB_PROG_LOGIC_MAX - 1) return 0;
+    int g = -1;
+    for (int i = 0; i < CBX(gotomaxct); ++i) {
+        if (CBX(gotodata)[i].used && !strcmp(CBX(gotodata)[i].name, lbl)) {g = i; break;}
+    }
+    if (g == -1) return 0;
+    ++CBX(gsstackp);
+    CBX(gsstack)[CBX(gsstackp)].cp = CBX(cp);
+    CBX(gsstack)[CBX(gsstackp)].pl = CBX(progLine);
+    CBX(gsstack)[CBX(gsstackp)].dlsp = CBX(dlstackp);
+    CBX(gsstack)[CBX(gsstackp)].fnsp = CBX(fnstackp);
+    CBX(gsstack)[CBX(gsstackp)].itsp = CBX(itstackp);
+    CBX(gsstack)[CBX(gsstackp)].brkinfo = CBX(brkinfo);
+    CBX(cp) = CBX(gotodata)[g].cp;
+    CBX(progLine) = CBX(gotodata)[g].pl;
+    CBX(didloop) = true;
+    CBX(lockpl) = true;
+    return CBX(gsstackp) + 1;
+}
+
+// Runs the ON EVENT handler like a GOSUB when an event is pending or a source is ready, checking
+// the sources at most once a millisecond; nothing is taken while statements are being skipped
+static void evCheck() {
+    if (CBX(progindex) != CBX(evprog) || cmdSkipped()) return;
+    if (CBX(evgs)) {
+        if (CBX(gsstackp) >= CBX(evgs) - 1) return;
+        CBX(evgs) = 0;
+    }
+    int id = CBX(evpend);
+    if (!id) {
+        uint64_t now = usTime();
+        if (now < CBX(evchk)) return;
+        CBX(evchk) = now + 1000;
+        if (!CBX(evmaxct) || (id = evWait(0)) < 1) return;
+    }
+    CBX(evpend) = 0;
+    CBX(evgs) = gosubLabel(CBX(evlbl));
+}
+
+// ON TIMER keeps a deadline per interpreter (so tasks and embedders each have their own timer and
+// no signal is used), runLoop compares it with the clock between statements only while armed
+
+// Arms the timer to run label every ms milliseconds (at least 1)
+bool tmrStart(double ms, char* lbl) {
+    if (ms < 1) {CBX(cerr) = 16; return false;}
+    CBX(tmrlbl) = realloc(CBX(tmrlbl), strlen(lbl) + 1);
+    strcpy(CBX(tmrlbl), lbl);
+    CBX(tmrprog) = CBX(progindex);
+    CBX(tmrgs) = 0;
+    CBX(tmrint) = ms * 1000;
+    CBX(tmrnext) = usTime() + CBX(tmrint);
+    return true;
+}
+
+void tmrStop() {
+    nfree(CBX(tmrlbl));
+    CBX(tmrgs) = 0;
+}
+
+// Returns how many microseconds are left until the ON TIMER handler is due (0 if it is), or -1 if
+// no tick can run now (no timer, another program, or the handler is still running)
+static inline int64_t tmrLeft(uint64_t now) {
+    if (!CBX(tmrlbl) || !CBX(inProg) || CBX(progindex) != CBX(tmrprog)) return -1;
+    if (CBX(tmrgs)) {
+        if (CBX(gsstackp) >= CBX(tmrgs) - 1) return -1;
+        CBX(tmrgs) = 0;
+    }
+    return (CBX(tmrnext) > now) ? (int64_t)(CBX(tmrnext) - now) : 0;
+}
+
+// Runs the ON TIMER handler like a GOSUB once a tick is due and statements are not being skipped,
+// ticks missed while it runs are merged
+static void tmrCheck() {
+    uint64_t now = usTime();
+    if (tmrLeft(now) || cmdSkipped()) return;
+    CBX(tmrnext) += CBX(tmrint);
+    if (CBX(tmrnext) <= now) CBX(tmrnext) = now + CBX(tmrint);
+    CBX(tmrgs) = gosubLabel(CBX(tmrlbl));
+}
+
+// Sleeps for WAIT, WAITMS, and WAITUS, a due tick ends the sleep early to run the ON TIMER handler
+// and the statement is run again when it returns to sleep for whatever is left
+static void progWait(uint64_t d) {
+    uint64_t now = usTime();
+    uint64_t end = now + d;
+    if (CBX(waitend) && CBX(waitcp) == CBX(cmdpos)) {end = CBX(waitend); CBX(waitend) = 0;}
+    while (!cmdint && now < end) {
+        int64_t t = tmrLeft(now);
+        if (!t) {
+            CBX(waitend) = end;
+            CBX(waitcp) = CBX(cmdpos);
+            CBX(cp) = CBX(cmdpos);
+            tmrCheck();
+            return;
+        }
+        cb_wait((t > 0 && (uint64_t)t < end - now) ? (uint64_t)t : end - now);
+        now = usTime();
+    }
+}
+
+// Channels are bounded lock-free MPMC rings (Vyukov): each cell's sequence number says whether
+// it is free for the enqueue position or filled for the dequeue position
+// An ID is gen * CB_CHAN_MAX + slot, a slot is only reused once its old ID is dead (closed and
+// drained) and no sender or receiver still holds it (refs)
+
+typedef struct {
+    size_t seq;
+    char* val;
+} cb_chancell;
+
+typedef struct {
+    cb_chancell* cells;
+    size_t mask;
+    size_t enq;
+    char pad[64 - sizeof(size_t)];
+    size_t deq;
+    int gen;
+    int refs;
+    bool closed;
+    bool inuse;
+} cb_chan;
+
+cb_chan chandata[CB_CHAN_MAX];
+
+int chanOpen(int32_t cap) {
+    size_t size = 2;
+    while (size < (size_t)cap) {size *= 2;}
+    taskLock();
+    int c = -1;
+    for (int i = 0; i < CB_CHAN_MAX; ++i) {
+        cb_chan* ch = &chandata[i];
+        if (ch->inuse) {
+            if (!__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE) || __atomic_load_n(&ch->enq, __ATOMIC_ACQUIRE) != __atomic_load_n(&ch->deq, __ATOMIC_ACQUIRE)) continue;
+            // retire the old ID first so a chanGet() racing with the refs check below either sees the
+            // new generation or is seen holding a reference
+            __atomic_store_n(&ch->inuse, false, __ATOMIC_SEQ_CST);
+            __atomic_store_n(&ch->gen, ch->gen + 1, __ATOMIC_SEQ_CST);
+        }
+        if (__atomic_load_n(&ch->refs, __ATOMIC_SEQ_CST)) continue;
+        c = i;
+        break;
+    }
+    if (c != -1) {
+        cb_chan* ch = &chandata[c];
+        if (ch->gen < 1 || ch->gen >= INT_MAX / CB_CHAN_MAX) ch->gen = 1;
+        if (ch->cells && ch->mask + 1 != size) nfree(ch->cells);
+        if (!ch->cells) ch->cells = (cb_chancell*)malloc(size * sizeof(cb_chancell));
+        for (size_t i = 0; i < size; ++i) {ch->cells[i].seq = i; ch->cells[i].val = NULL;}
+        ch->mask = size - 1;
+        ch->enq = ch->deq = 0;
+        ch->closed = false;
+        __atomic_store_n(&ch->inuse, true, __ATOMIC_SEQ_CST);
+        c += ch->gen * CB_CHAN_MAX;
+    }
+    taskUnlock();
+    return c;
+}
+
+// Takes a reference on the channel with that ID, chanPut() gives it back
+static inline cb_chan* chanGet(int c) {
+    if (c < CB_CHAN_MAX) return NULL;
+    cb_chan* ch = &chandata[c % CB_CHAN_MAX];
+    __atomic_add_fetch(&ch->refs, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ch->gen, __ATOMIC_SEQ_CST) != c / CB_CHAN_MAX || !__atomic_load_n(&ch->inuse, __ATOMIC_SEQ_CST)) {
+        __atomic_sub_fetch(&ch->refs, 1, __ATOMIC_SEQ_CST);
+        return NULL;
+    }
+    return ch;
+}
+
+static inline void chanPut(cb_chan* ch) {
+    __atomic_sub_fetch(&ch->refs, 1, __ATOMIC_SEQ_CST);
+}
+
+bool chanClose(int c) {
+    cb_chan* ch = chanGet(c);
+    if (!ch) return false;
+    __atomic_store_n(&ch->closed, true, __ATOMIC_RELEASE);
+    chanPut(ch);
+    return true;
+}
+
+static inline bool chanTryPush(cb_chan* ch, char* val) {
+    size_t pos = __atomic_load_n(&ch->enq, __ATOMIC_RELAXED);
+    cb_chancell* cell;
+    while (1) {
+        cell = &ch->cells[pos & ch->mask];
+        intptr_t dif = (intptr_t)__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (intptr_t)pos;
+        if (!dif) {
+            if (__atomic_compare_exchange_n(&ch->enq, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&ch->enq, __ATOMIC_RELAXED);
+        }
+    }
+    cell->val = val;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static inline char* chanTryPop(cb_chan* ch) {
+    size_t pos = __atomic_load_n(&ch->deq, __ATOMIC_RELAXED);
+    cb_chancell* cell;
+    while (1) {
+        cell = &ch->cells[pos & ch->mask];
+        intptr_t dif = (intptr_t)__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (intptr_t)(pos + 1);
+        if (!dif) {
+            if (__atomic_compare_exchange_n(&ch->deq, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&ch->deq, __ATOMIC_RELAXED);
+        }
+    }
+    char* val = cell->val;
+    __atomic_store_n(&cell->seq, pos + ch->mask + 1, __ATOMIC_RELEASE);
+    return val;
+}
+
+// Spins briefly, then sleeps for up to 1ms at a time
+static inline void chanBackoff(int* spins) {
+    if (*spins < 64) {
+        ++*spins;
+        #ifndef _WIN32
+        sched_yield();
+        #endif
+    } else {
+        if (*spins < 80) ++*spins;
+        cb_wait((*spins < 80) ? 50 * (*spins - 64) : 1000);
+    }
+}
+
+bool chanSend(int c, char* val) {
+    cb_chan* ch = chanGet(c);
+    if (!ch) {CBX(cerr) = 16; return false;}
+    if (__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) {chanPut(ch); CBX(cerr) = 16; return false;}
+    char* tmp = malloc(strlen(val) + 1);
+    strcpy(tmp, val);
+    int spins = 0;
+    while (!chanTryPush(ch, tmp)) {
+        if (cmdint || __atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) {chanPut(ch); free(tmp); CBX(cerr) = (cmdint) ? 0 : 16; return false;}
+        chanBackoff(&spins);
+    }
+    chanPut(ch);
+    return true;
+}
+
+bool chanRecv(int c, char* out) {
+    cb_chan* ch = chanGet(c);
+    if (!ch) {CBX(cerr) = 16; return false;}
+    int spins = 0;
+    char* val;
+    while (!(val = chanTryPop(ch))) {
+        if (__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) {
+            if ((val = chanTryPop(ch))) break;
+            chanPut(ch);
+            CBX(cerr) = 16;
+            return false;
+        }
+        if (cmdint) {chanPut(ch); out[0] = 0; return true;}
+        chanBackoff(&spins);
+    }
+    chanPut(ch);
+    copyStr(val, out);
+    free(val);
+    return true;
+}
+
+#ifndef _WIN32
+static inline void shpoolKill(cb_shworker* w) {
+    if (!w->pid) return;
+    close(w->in);
+    close(w->out);
+    waitpid(w->pid, NULL, 0);
+    w->pid = 0;
+    nfree(w->cwd);
+}
+
+static inline bool shpoolSpawn(cb_shworker* w) {
+    int in[2], out[2];
+    if (pipe(in)) return false;
+    if (pipe(out)) {close(in[0]); close(in[1]); return false;}
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(in[0]); close(in[1]);
+        close(out[0]); close(out[1]);
+        return false;
+    }
+    if (pid == 0) {
+        int tin = fcntl(0, F_DUPFD, 10), tout = fcntl(1, F_DUPFD, 10);
+        int pin = fcntl(in[0], F_DUPFD, 10), pout = fcntl(out[1], F_DUPFD, 10);
+        close(in[0]); close(in[1]);
+        close(out[0]); close(out[1]);
+        dup2(pin, 0); dup2(pout, 1);
+        dup2(tout, 3); dup2(tin, 4);
+        close(pin); close(pout);
+        close(tin); close(tout);
+        execl("/bin/sh", "sh", (char*)NULL);
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    fcntl(in[1], F_SETFD, FD_CLOEXEC);
+    fcntl(out[0], F_SETFD, FD_CLOEXEC);
+    w->pid = pid;
+    w->in = in[1];
+    w->out = out[0];
+    w->cwd = NULL;
+    w->gen = __atomic_load_n(&shpoolgen, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void shpoolFree() {
+    for (int i = 0; i < shpoolct; ++i) {
+        shpoolKill(&shpool[i]);
+        pthread_mutex_destroy(&shpool[i].lock);
+    }
+    nfree(shpool);
+    shpoolct = 0;
+    shpoolnext = 0;
+}
+
+// Only called on exit, skips the cleanup if a task is still using the pool
+void shpoolStop() {
+    if (pthread_rwlock_trywrlock(&shpoollock)) return;
+    shpoolFree();
+    pthread_rwlock_unlock(&shpoollock);
+}
+
+// Picks the pool's nonce, so output that merely looks like the end marker cannot end a command early
+static void shpoolNewNonce() {
+    uint64_t n = 0;
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd == -1 || read(fd, &n, sizeof(n)) != sizeof(n)) {
+        n = usTime() ^ ((uint64_t)getpid() << 32) ^ (uint64_t)(uintptr_t)&n;
+        n = (n ^ (n >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        n = (n ^ (n >> 27)) * 0x94D049BB133111EBULL;
+        n ^= n >> 31;
+    }
+    if (fd > -1) close(fd);
+    sprintf(shpoolnonce, "%016llx", (unsigned long long)n);
+}
+
+bool shpoolStart(int ct) {
+    pthread_rwlock_wrlock(&shpoollock);
+    shpoolFree();
+    bool ret = true;
+    if (ct > 0) {
+        shpoolNewNonce();
+        shpool = (cb_shworker*)calloc(ct, sizeof(cb_shworker));
+        shpoolct = ct;
+        for (int i = 0; i < ct; ++i) {pthread_mutex_init(&shpool[i].lock, NULL);}
+        for (int i = 0; i < ct; ++i) {
+            if (!shpoolSpawn(&shpool[i])) {shpoolFree(); ret = false; break;}
+        }
+    }
+    pthread_rwlock_unlock(&shpoollock);
+    return ret;
+}
+
+static inline void shpoolQuote(char* str, char* out) {
+    while (*out) {++out;}
+    *out++ = '\'';
+    for (; *str; ++str) {
+        if (*str == '\'') {*out++ = '\''; *out++ = '\\'; *out++ = '\''; *out++ = '\'';}
+        else {*out++ = *str;}
+    }
+    *out++ = '\'';
+    *out = 0;
+}
+
+// SIGPIPE is ignored process-wide while writing, the lock keeps tasks from restoring it under
+// each other
+static inline bool shpoolWrite(int fd, char* str, size_t len) {
+    bool ret = true;
+    pthread_mutex_lock(&shpoolsiglock);
+    void* oldsig = setsig(SIGPIPE, SIG_IGN);
+    while (len > 0) {
+        ssize_t r = write(fd, str, len);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            ret = false;
+            break;
+        }
+        str += r;
+        len -= r;
+    }
+    setsig(SIGPIPE, oldsig);
+    pthread_mutex_unlock(&shpoolsiglock);
+    return ret;
+}
+
+static int shpoolExec(cb_shworker*, char*, char*, bool);
+
+// Runs a command on an idle worker, or waits for the next one in turn if all are busy
+int shpoolRun(char* cmdstr, char* outbuf, bool silent) {
+    pthread_rwlock_rdlock(&shpoollock);
+    if (!shpoolct) {pthread_rwlock_unlock(&shpoollock); return -1;}
+    unsigned n = __atomic_fetch_add(&shpoolnext, 1, __ATOMIC_RELAXED);
+    cb_shworker* w = NULL;
+    for (int k = 0; k < shpoolct && !w; ++k) {
+        cb_shworker* t = &shpool[(n + k) % shpoolct];
+        if (!pthread_mutex_trylock(&t->lock)) w = t;
+    }
+    if (!w) {
+        w = &shpool[n % shpoolct];
+        pthread_mutex_lock(&w->lock);
+    }
+    if (w->pid && w->gen != __atomic_load_n(&shpoolgen, __ATOMIC_RELAXED)) shpoolKill(w);
+    int ret = shpoolExec(w, cmdstr, outbuf, silent);
+    pthread_mutex_unlock(&w->lock);
+    pthread_rwlock_unlock(&shpoollock);
+    return ret;
+}
+
+static int shpoolExec(cb_shworker* w, char* cmdstr, char* outbuf, bool silent) {
+    char* tmpcwd = getcwd(NULL, 0);
+    char* script = malloc(strlen(cmdstr) * 4 + ((tmpcwd) ? strlen(tmpcwd) * 4 : 0) + 128);
+    bool retry = true;
+    shpoolsend:;
+    if (!w->pid && !shpoolSpawn(w)) {free(script); nfree(tmpcwd); return -1;}
+    script[0] = 0;
+    if (tmpcwd && (!w->cwd || strcmp(w->cwd, tmpcwd))) {
+        copyStrApnd("cd -- ", script);
+        shpoolQuote(tmpcwd, script);
+        copyStrApnd(" 2>/dev/null\n", script);
+        nfree(w->cwd);
+        w->cwd = malloc(strlen(tmpcwd) + 1);
+        copyStr(tmpcwd, w->cwd);
+    }
+    copyStrApnd("eval ", script);
+    shpoolQuote(cmdstr, script);
+    if (outbuf) copyStrApnd(" <&4 2>&1", script);
+    else if (silent) copyStrApnd(" <&4 >/dev/null 2>&1", script);
+    else copyStrApnd(" <&4 >&3 2>&1", script);
+    copyStrApnd("; printf '\\036CB", script);
+    copyStrApnd(shpoolnonce, script);
+    copyStrApnd(":%d\\n' \"$?\"\n", script);
+    fflush(stdout);
+    if (!shpoolWrite(w->in, script, strlen(script))) {
+        shpoolKill(w);
+        if (retry) {retry = false; goto shpoolsend;}
+        free(script);
+        nfree(tmpcwd);
+        return -1;
+    }
+    free(script);
+    nfree(tmpcwd);
+    char rbuf[4096];
+    char tail[32];
+    int tl = 0;
+    int32_t ol = 0;
+    int64_t tot = 0;
+    while (1) {
+        ssize_t r = read(w->out, rbuf, sizeof(rbuf));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) {
+            int status = 127 << 8;
+            close(w->in);
+            close(w->out);
+            if (waitpid(w->pid, &status, 0) != w->pid) status = 127 << 8;
+            w->pid = 0;
+            nfree(w->cwd);
+            if (outbuf) outbuf[ol] = 0;
+            return status;
+        }
+        if (outbuf && ol < CB_BUF_SIZE - 1) {
+            int32_t cl = (r < CB_BUF_SIZE - 1 - ol) ? r : CB_BUF_SIZE - 1 - ol;
+            memcpy(&outbuf[ol], rbuf, cl);
+            ol += cl;
+        }
+        tot += r;
+        if (r >= (ssize_t)sizeof(tail)) {
+            memcpy(tail, &rbuf[r - sizeof(tail)], sizeof(tail));
+            tl = sizeof(tail);
+        } else {
+            int keep = (tl + r > (int)sizeof(tail)) ? (int)sizeof(tail) - r : tl;
+            memmove(tail, &tail[tl - keep], keep);
+            memcpy(&tail[keep], rbuf, r);
+            tl = keep + r;
+        }
+        if (tail[tl - 1] != '\n') continue;
+        int s = tl - 2;
+        while (s >= 0 && tail[s] >= '0' && tail[s] <= '9') {--s;}
+        // the marker is "\036CB", the nonce, ':', and the exit code
+        int ms = s - 19;
+        if (ms < 0 || s == tl - 2 || tail[s] != ':' || memcmp(&tail[ms], "\036CB", 3) || memcmp(&tail[ms + 3], shpoolnonce, 16)) continue;
+        int code = atoi(&tail[s + 1]);
+        if (outbuf) {
+            int64_t cl = tot - (tl - ms);
+            outbuf[(cl < ol) ? cl : ol] = 0;
+        }
+        return (code & 0xFF) << 8;
+    }
+}
+#endif
+
+static inline int getArg(int, char*, char*);
+static inline int getArgO(int, char*, char*, int32_t);
+static inline int getArgCt(char*);
+
+
+uint8_t getFunc(char* inbuf, char* outbuf) {
+    char** farg;
+    uint8_t* fargt;
+    int32_t* flen;
+    int fargct;
+    int ftmpct = 0;
+    int ftype = 0;
+    char* gftmp[2];
+    bool skipfargsolve = false;
+    if (CBX(getFuncIndex)) {
+        gftmp[0] = malloc(CB_BUF_SIZE);
+        gftmp[1] = malloc(CB_BUF_SIZE);
+    } else {
+        gftmp[0] = CBX(getFunc_gftmp)[0];
+        gftmp[1] = CBX(getFunc_gftmp)[1];
+    }
+    ++CBX(getFuncIndex);
+    int extsas = -1;
+    {
+        int32_t i;
+        bool invalName = false;
+        for (i = 0; inbuf[i] != '('; ++i) {if (!isValidVarChar(inbuf[i])) {invalName = true;}}
+        if (invalName) {copyStrTo(inbuf, i, CBX(gpbuf)); seterrstr(CBX(gpbuf)); CBX(cerr) = 4; return 0;}
+        int32_t j = strlen(inbuf) - 1;
+        copyStrSnip(inbuf, i + 1, j, gftmp[0]);
+        fargct = getArgCt(gftmp[0]);
+        farg = malloc((fargct + 1) * sizeof(char*));
+        flen = malloc((fargct + 1) * sizeof(int32_t));
+        fargt = malloc((fargct + 1) * sizeof(uint8_t));
+        for (int j = 0; j <= fargct; ++j) {
+            farg[j] = NULL;
+        }
+        int32_t gptr = 0;
+        for (int j = 0; j <= fargct; ++j) {
+            if (j == 0) {
+                flen[0] = i;
+                farg[0] = (char*)malloc(flen[0] + 1);
+                copyStrTo(inbuf, i, farg[0]);
+                for (int i = extmaxct - 1; i > -1; --i) {
+                    if (extdata[i].inuse && extdata[i].chkfuncsolve) {
+                        if ((skipfargsolve = extdata[i].chkfuncsolve(farg[0]))) {extsas = i; break;}
+                    }
+                }
+                if (extsas == -1) {
+                    if (!strcmp(farg[0], "~") || !strcmp(farg[0], "_TEST")) {
+                        ftype = 2;
+                        if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+                        CBX(cerr) = 0;
+                        if (getArgO(0, gftmp[0], gftmp[1], 0) == -1) {outbuf[0] = 0; goto fexit;}
+                        int ret = logictest(gftmp[1]);
+                        if (ret == -1) {outbuf[0] = 0; goto fexit;}
+                        outbuf[0] = '0' + ret;
+                        outbuf[1] = 0;
+                        goto fexit;
+                    } else if (!strcmp(farg[0], "EXECA") || !strcmp(farg[0], "EXECA$") || !strcmp(farg[0], "FGREP") || !strcmp(farg[0], "DIRLIST") || !strcmp(farg[0], "CSVLOAD") || !strcmp(farg[0], "SPAWN") || !strcmp(farg[0], "COSTART")) {
+                        skipfargsolve = true;
+                    }
+                }
+            } else {
+                farg[j] = malloc(CB_BUF_SIZE);
+                int32_t ngptr = getArgO(j - 1, gftmp[0], farg[j], gptr);
+                if (ngptr == -1) {outbuf[0] = 0; goto fexit;}
+                int32_t tmpsize = ngptr - gptr;
+                gptr = ngptr;
+                if (skipfargsolve) {
+                    flen[j] = tmpsize;
+                    farg[j] = realloc(farg[j], tmpsize + 1);
+                } else {
+                    fargt[j] = getVal(farg[j], farg[j]);
+                    if (fargt[j] == 0) goto fnoerrscan;
+                    if (fargt[j] == 255) fargt[j] = 0;
+                    flen[j] = strlen(farg[j]);
+                    farg[j] = realloc(farg[j], flen[j] + 1);
+                }
+                ftmpct++;
+            }
+        }
+    }
+    outbuf[0] = 0;
+    CBX(cerr) = 127;
+    CBX(chkCmdPtr) = farg[0];
+    #include "functions.c"
+    fexit:;
+    if (CBX(cerr) > 124 && CBX(cerr) < 128) seterrstr(farg[0]);
+    fnoerrscan:;
+    for (int j = 0; j <= ftmpct; ++j) {
+        nfree(farg[j]);
+    }
+    nfree(farg);
+    nfree(flen);
+    nfree(fargt);
+    --CBX(getFuncIndex);
+    if (CBX(getFuncIndex)) {nfree(gftmp[0]); nfree(gftmp[1]);}
+    if (CBX(cerr)) return 0;
+    return ftype;
+}
+
+bool chkvar = true;
+
+
+uint8_t getVar(char* vn, char* varout) {
+    char* lgetVarBuf = (CBX(getVarIndex)) ? malloc(CB_BUF_SIZE) : CBX(getVarBuf);
+    ++CBX(getVarIndex);
+    uint8_t ret = 0;
+    int32_t vnlen = strlen(vn);
+    if (vn[vnlen - 1] == ')') {
+        ret = getFunc(vn, varout);
+        goto gvret;
+    }
+    if (!vn[0] || vn[0] == '[' || vn[0] == ']') {
+        CBX(cerr) = 4;
+        seterrstr(vn);
+        goto gvret;
+    }
+    if (getType(vn) != 255) {
+        CBX(cerr) = 4;
+        seterrstr(vn);
+        goto gvret;
+    }
+    bool isArray = false;
+    int32_t aindex = 0;
+    for (register int32_t i = 0; vn[i]; ++i) {
+        if (chkvar && !isValidVarChar(vn[i])) {
+            CBX(cerr) = 4;
+            seterrstr(vn);
+            goto gvret;
+        }
+        if (vn[i] == ']') {
+            CBX(cerr) = 1;
+            goto gvret;
+        }
+        if (vn[i] == '[') {
+            if (vn[vnlen - 1] != ']') {CBX(cerr) = 1; goto gvret;}
+            copyStrSnip(vn, i + 1, vnlen - 1, lgetVarBuf);
+            if (!lgetVarBuf[0]) {CBX(cerr) = 1; goto gvret;}
+            CBX(cerr) = 2;
+            uint8_t tmpt = getVal(lgetVarBuf, lgetVarBuf);
+            if (tmpt != 2) goto gvret;
+            CBX(cerr) = 0;
+            aindex = atoi(lgetVarBuf);
+            vn[i] = 0;
+            vnlen = strlen(vn);
+            isArray = true;
+            break;
+        }
+    }
+    if (CBX(shmmaxct)) {
+        int s = shmFind(vn);
+        if (s != -1) {ret = shmGet(s, isArray, aindex, varout); goto gvret;}
+    }
+    int v = -1;
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(vn, CBX(vardata)[i].name)) {v = i; break;}
+    }
+    if (v == -1) {
+        if (isArray) {
+            CBX(cerr) = 23;
+            seterrstr(vn);
+            goto gvret;
+        }
+        if (vn[vnlen - 1] == '$') {varout[0] = 0; ret = 1; goto gvret;}
+        else {varout[0] = '0'; varout[1] = 0; ret = 2; goto gvret;}
+    } else {
+        if (CBX(vardata)[v].size == -1) {
+            if (isArray) {
+                CBX(cerr) = 23;
+                seterrstr(vn);
+                goto gvret;
+            }
+        } else {
+            if (!isArray) {
+                CBX(cerr) = 24;
+                seterrstr(vn);
+                goto gvret;
+            }
+            if (aindex < 0 || aindex > CBX(vardata)[v].size) {
+                CBX(cerr) = 22;
+                sprintf(lgetVarBuf, "%s[%li]", vn, (long int)aindex);
+                seterrstr(lgetVarBuf);
+                goto gvret;
+            }
+        }
+        copyStr(CBX(vardata)[v].data[aindex], varout);
+        ret = CBX(vardata)[v].type;
+        goto gvret;
+    }
+    gvret:;
+    --CBX(getVarIndex);
+    if (CBX(getVarIndex)) free(lgetVarBuf);
+    return ret;
+}
+
+
+bool setVar(char* vn, char* val, uint8_t t, int32_t s) {
+    int32_t vnlen = strlen(vn);
+    if (!vn[0] || vn[0] == '[' || vn[0] == ']') {
+        CBX(cerr) = 4;
+        seterrstr(vn);
+        return false;
+    }
+    if (getType(vn) != 255) {
+        CBX(cerr) = 4;
+        seterrstr(vn);
+        return false;
+    }
+    bool isArray = false;
+    int32_t aindex = 0;
+    for (register int32_t i = 0; vn[i]; ++i) {
+        if (chkvar && !isValidVarChar(vn[i])) {
+            CBX(cerr) = 4;
+            seterrstr(vn);
+            return false;
+        }
+        if (vn[i] == ']') {
+            CBX(cerr) = 1;
+            return 0;
+        }
+        if (vn[i] == '[') {
+            if (vn[vnlen - 1] != ']') {CBX(cerr) = 1; return 0;}
+            if (s != -1) {CBX(cerr) = 4; seterrstr(vn); return 0;}
+            copyStrSnip(vn, i + 1, vnlen - 1, CBX(setVarBuf));
+            if (!CBX(setVarBuf)[0]) {CBX(cerr) = 1; return 0;}
+            CBX(cerr) = 2;
+            uint8_t tmpt = getVal(CBX(setVarBuf), CBX(setVarBuf));
+            if (tmpt != 2) {return 0;}
+            CBX(cerr) = 0;
+            aindex = atoi(CBX(setVarBuf));
+            vn[i] = 0;
+            vnlen = strlen(vn);
+            isArray = true;
+            break;
+        }
+    }
+    if (CBX(shmmaxct)) {
+        int m = shmFind(vn);
+        if (m != -1) return shmSet(m, isArray, aindex, val, t, s);
+    }
+    int v = -1;
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(vn, CBX(vardata)[i].name)) {v = i; break;}
+    }
+    if (v == -1) {
+        if (isArray) {
+            CBX(cerr) = 23;
+            seterrstr(vn);
+            return false;
+        }
+        for (register int i = 0; i < CBX(varmaxct); ++i) {
+            if (!CBX(vardata)[i].inuse) {v = i; break;}
+        }
+        if (v == -1) {
+            v = CBX(varmaxct);
+            CBX(varmaxct)++;
+            CBX(vardata) = (cb_var*)realloc(CBX(vardata), CBX(varmaxct) * sizeof(cb_var));
+        }
+        CBX(vardata)[v].inuse = true;
+        CBX(vardata)[v].name = (char*)malloc(vnlen + 1);
+        copyStr(vn, CBX(vardata)[v].name);
+        CBX(vardata)[v].size = s;
+        CBX(vardata)[v].type = t;
+        if (s == -1) s = 0;
+        CBX(vardata)[v].data = (char**)malloc((s + 1) * sizeof(char*));
+        for (int32_t i = 0; i <= s; ++i) {
+            CBX(vardata)[v].data[i] = (char*)malloc(strlen(val) + 1);
+            copyStr(val, CBX(vardata)[v].data[i]);
+        }
+    } else {
+        if (s != -1) {CBX(cerr) = 25; return false;}
+        if (t != CBX(vardata)[v].type) {CBX(cerr) = 2; return false;}
+        if (isArray && (aindex < 0 || aindex > CBX(vardata)[v].size)) {
+            CBX(cerr) = 22;
+            sprintf(CBX(setVarBuf), "%s[%li]", vn, (long int)aindex);
+            seterrstr(CBX(setVarBuf));
+            return 0;
+        }
+        CBX(vardata)[v].data[aindex] = (char*)realloc(CBX(vardata)[v].data[aindex], strlen(val) + 1);
+        copyStr(val, CBX(vardata)[v].data[aindex]);
+    }
+    return true;
+}
+
+void resizeVar(int v, int32_t s) {
+    int32_t os = CBX(vardata)[v].size;
+    if (s == os) return;
+    CBX(vardata)[v].size = s;
+    char** newdata = (char**)malloc((s + 1) * sizeof(char*));
+    int32_t i = 0;
+    for (; i <= s && i <= os; ++i) {
+        newdata[i] = CBX(vardata)[v].data[i];
+    }
+    for (; i <= s; ++i) {
+        newdata[i] = malloc(CBX(vardata)[v].type);
+        if (CBX(vardata)[v].type == 1) {
+            newdata[i][0] = 0;
+        } else {
+            newdata[i][0] = '0';
+            newdata[i][1] = 0;
+        }
+    }
+    for (i = s + 1; i <= os; ++i) {
+        free(CBX(vardata)[v].data[i]);
+    }
+    free(CBX(vardata)[v].data);
+    CBX(vardata)[v].data = newdata;
+}
+
+int dimVar(char* vn, uint8_t t, int32_t s) {
+    int v = -1;
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(vn, CBX(vardata)[i].name)) {v = i; break;}
+    }
+    if (v == -1) {
+        if (!setVar(vn, ((t == 1) ? "" : "0"), t, s)) return -1;
+        for (register int i = 0; i < CBX(varmaxct); ++i) {
+            if (CBX(vardata)[i].inuse && !strcmp(vn, CBX(vardata)[i].name)) {v = i; break;}
+        }
+        return v;
+    }
+    if (CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(vn); return -1;}
+    if (CBX(vardata)[v].type != t) {CBX(cerr) = 2; return -1;}
+    if (parForFixed(v)) return -1;
+    resizeVar(v, s);
+    return v;
+}
+
+bool delVar(char* vn) {
+    if (!vn[0] || vn[0] == '[' || vn[0] == ']') {
+        CBX(cerr) = 4;
+        seterrstr(vn);
+        return false;
+    }
+    if (getType(vn) != 255) {
+        CBX(cerr) = 4;
+        seterrstr(vn);
+        return false;
+    }
+    for (register int32_t i = 0; vn[i]; ++i) {
+        if (chkvar && !isValidVarChar(vn[i])) {
+            CBX(cerr) = 4;
+            seterrstr(vn);
+            return false;
+        }
+        if (vn[i] == '[') {
+            CBX(cerr) = 4;
+            seterrstr(vn);
+            return false;
+        }
+    }
+    if (CBX(shmmaxct)) {
+        int m = shmFind(vn);
+        if (m != -1) {shmDrop(m); return true;}
+    }
+    int v = -1;
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(vn, CBX(vardata)[i].name)) {v = i; break;}
+    }
+    if (v != -1) {
+        if (parForFixed(v)) return false;
+        CBX(vardata)[v].inuse = false;
+        nfree(CBX(vardata)[v].name);
+        for (int32_t i = 0; i <= CBX(vardata)[v].size; ++i) {
+            nfree(CBX(vardata)[v].data[i]);
+        }
+        nfree(CBX(vardata)[v].data);
+        if (v == CBX(varmaxct) - 1) {
+            while (!CBX(vardata)[v].inuse && v >= 0) {CBX(varmaxct)--; v--;}
+            CBX(vardata) = (cb_var*)realloc(CBX(vardata), CBX(varmaxct) * sizeof(cb_var));
+        }
+    }
+    return true;
+}
+
+#ifndef _WIN32
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int fd;
+    char* blk[CB_READAHEAD_BLOCKS];
+    int32_t len[CB_READAHEAD_BLOCKS];
+    uint32_t head;
+    uint32_t tail;
+    int32_t off;
+    bool stop;
+} cb_readahead;
+
+static void* raThread(void* data) {
+    cb_readahead* ra = data;
+    while (1) {
+        uint32_t head = ra->head;
+        pthread_mutex_lock(&ra->lock);
+        while (!__atomic_load_n(&ra->stop, __ATOMIC_ACQUIRE) && head - __atomic_load_n(&ra->tail, __ATOMIC_ACQUIRE) >= CB_READAHEAD_BLOCKS) {
+            pthread_cond_wait(&ra->cond, &ra->lock);
+        }
+        pthread_mutex_unlock(&ra->lock);
+        if (__atomic_load_n(&ra->stop, __ATOMIC_ACQUIRE)) break;
+        int b = head % CB_READAHEAD_BLOCKS;
+        ssize_t r;
+        while ((r = read(ra->fd, ra->blk[b], CB_FILE_BUF_SIZE)) < 0 && errno == EINTR) {}
+        ra->len[b] = (r < 0) ? 0 : r;
+        __atomic_store_n(&ra->head, head + 1, __ATOMIC_RELEASE);
+        pthread_mutex_lock(&ra->lock);
+        pthread_cond_signal(&ra->cond);
+        pthread_mutex_unlock(&ra->lock);
+        if (r <= 0) break;
+    }
+    return NULL;
+}
+
+static inline void raStart(cb_readahead* ra) {
+    ra->head = 0;
+    ra->tail = 0;
+    ra->off = 0;
+    ra->stop = false;
+    pthread_create(&ra->thread, NULL, raThread, ra);
+}
+
+static inline void raStop(cb_readahead* ra) {
+    __atomic_store_n(&ra->stop, true, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&ra->lock);
+    pthread_cond_signal(&ra->cond);
+    pthread_mutex_unlock(&ra->lock);
+    pthread_join(ra->thread, NULL);
+}
+
+static inline cb_readahead* raOpen(int fd) {
+    cb_readahead* ra = malloc(sizeof(cb_readahead));
+    ra->fd = fd;
+    for (int i = 0; i < CB_READAHEAD_BLOCKS; ++i) {
+        ra->blk[i] = malloc(CB_FILE_BUF_SIZE);
+    }
+    pthread_mutex_init(&ra->lock, NULL);
+    pthread_cond_init(&ra->cond, NULL);
+    raStart(ra);
+    return ra;
+}
+
+static inline void raClose(cb_readahead* ra) {
+    raStop(ra);
+    pthread_mutex_destroy(&ra->lock);
+    pthread_cond_destroy(&ra->cond);
+    for (int i = 0; i < CB_READAHEAD_BLOCKS; ++i) {
+        free(ra->blk[i]);
+    }
+    free(ra);
+}
+
+// Returns the unread part of the current block, waiting for the reader if needed; 0 bytes means end of file
+static inline char* raPeek(cb_readahead* ra, int32_t* avail) {
+    while (1) {
+        uint32_t tail = ra->tail;
+        if (tail == __atomic_load_n(&ra->head, __ATOMIC_ACQUIRE)) {
+            pthread_mutex_lock(&ra->lock);
+            while (tail == __atomic_load_n(&ra->head, __ATOMIC_ACQUIRE)) {
+                pthread_cond_wait(&ra->cond, &ra->lock);
+            }
+            pthread_mutex_unlock(&ra->lock);
+        }
+        int b = tail % CB_READAHEAD_BLOCKS;
+        if (!ra->len[b]) {*avail = 0; return NULL;}
+        if (ra->off < ra->len[b]) {
+            *avail = ra->len[b] - ra->off;
+            return &ra->blk[b][ra->off];
+        }
+        ra->off = 0;
+        __atomic_store_n(&ra->tail, tail + 1, __ATOMIC_RELEASE);
+        pthread_mutex_lock(&ra->lock);
+        pthread_cond_signal(&ra->cond);
+        pthread_mutex_unlock(&ra->lock);
+    }
+}
+#endif
+
+#ifndef _WIN32
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Connects to or listens on "unix:path" or "tcp:host:port" (an empty host is the loopback
+// address) and returns the descriptor, or -1 with errno set
+static int sockOpen(char* addr, bool srv) {
+    int fd = -1, e = EINVAL;
+    if (!strncmp(addr, "unix:", 5)) {
+        struct sockaddr_un sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sun_family = AF_UNIX;
+        if (!addr[5] || strlen(addr + 5) >= sizeof(sa.sun_path)) {errno = EINVAL; return -1;}
+        strcpy(sa.sun_path, addr + 5);
+        if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) return -1;
+        struct stat st;
+        if (srv && !lstat(sa.sun_path, &st) && S_ISSOCK(st.st_mode)) {
+            // only replace a socket file nobody is listening on anymore
+            if (connect(fd, (struct sockaddr*)&sa, sizeof(sa)) == -1 && errno == ECONNREFUSED) unlink(sa.sun_path);
+            close(fd);
+            if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) return -1;
+        }
+        if ((srv) ? (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) || listen(fd, SOMAXCONN)) : connect(fd, (struct sockaddr*)&sa, sizeof(sa))) {
+            e = errno;
+            close(fd);
+            errno = e;
+            return -1;
+        }
+    } else if (!strncmp(addr, "tcp:", 4)) {
+        char host[256];
+        char* port = strrchr(addr + 4, ':');
+        if (!port || !port[1] || port - (addr + 4) >= (int)sizeof(host)) {errno = EINVAL; return -1;}
+        char* h = addr + 4;
+        int hl = port - h;
+        if (hl > 1 && h[0] == '[' && h[hl - 1] == ']') {++h; hl -= 2;}
+        memcpy(host, h, hl);
+        host[hl] = 0;
+        struct addrinfo hints, * res, * ai;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        int r = getaddrinfo((hl) ? host : NULL, port + 1, &hints, &res);
+        if (r) {errno = (r == EAI_SYSTEM) ? errno : EHOSTUNREACH; return -1;}
+        for (ai = res; ai; ai = ai->ai_next) {
+            if ((fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol)) == -1) {e = errno; continue;}
+            int one = 1;
+            if (srv) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            else setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (!((srv) ? (bind(fd, ai->ai_addr, ai->ai_addrlen) || listen(fd, SOMAXCONN)) : connect(fd, ai->ai_addr, ai->ai_addrlen))) break;
+            e = errno;
+            close(fd);
+            fd = -1;
+        }
+        freeaddrinfo(res);
+        if (fd == -1) {errno = e; return -1;}
+    } else {
+        errno = EINVAL;
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    #ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+    #endif
+    return fd;
+}
+
+static FILE* sockFile(int fd) {
+    FILE* f = (fd > -1) ? fdopen(fd, "r") : NULL;
+    if (fd > -1 && !f) {
+        int e = errno;
+        close(fd);
+        errno = e;
+    }
+    return f;
+}
+#endif
+
+static inline void fileBuffer(int j) {
+    CBX(filedata)[j].bufsize = CB_FILE_BUF_SIZE;
+    CBX(filedata)[j].buf = malloc(CB_FILE_BUF_SIZE);
+    setvbuf(CBX(filedata)[j].fptr, CBX(filedata)[j].buf, _IOFBF, CB_FILE_BUF_SIZE);
+}
+
+// Puts an open stream in a free slot of the file table and returns its number, an unbuffered
+// stream gets its buffer (or _IONBF) from the caller before it is used, pipes, sockets, and
+// terminals are read with read(2) into buf so EVWATCH sees everything that is left to read
+static int fileAdd(FILE* f, bool sock, bool buffered) {
+    int j = 0;
+    while (j < CBX(filemaxct) && CBX(filedata)[j].fptr) {++j;}
+    if (j == CBX(filemaxct)) {
+        ++CBX(filemaxct);
+        CBX(filedata) = (cb_file*)realloc(CBX(filedata), CBX(filemaxct) * sizeof(cb_file));
+    }
+    CBX(filedata)[j].fptr = f;
+    CBX(filedata)[j].map = NULL;
+    CBX(filedata)[j].pos = 0;
+    CBX(filedata)[j].wvct = -1;
+    CBX(filedata)[j].ra = NULL;
+    CBX(filedata)[j].reclen = 0;
+    CBX(filedata)[j].rc = NULL;
+    CBX(filedata)[j].sock = sock;
+    CBX(filedata)[j].rdct = -1;
+    CBX(filedata)[j].bufsize = CB_FILE_BUF_SIZE;
+    CBX(filedata)[j].buf = NULL;
+    #ifndef _WIN32
+    struct stat st;
+    if (buffered && !fstat(fileno(f), &st) && (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode) || S_ISCHR(st.st_mode))) {
+        CBX(filedata)[j].buf = malloc(CB_FILE_BUF_SIZE);
+        CBX(filedata)[j].rdct = 0;
+        return j;
+    }
+    #endif
+    if (buffered) fileBuffer(j);
+    return j;
+}
+
+int openFile(char* path, char* mode) {
+    CBX(fileerror) = 0;
+    bool map = false, vec = false, pre = false, sock = false;
+    char* fmode = malloc(strlen(mode) + 1);
+    fmode[0] = 0;
+    for (int i = 0; mode[i]; ++i) {
+        if (mode[i] == 'm' || mode[i] == 'M') {map = true;}
+        else if (mode[i] == 'v' || mode[i] == 'V') {vec = true;}
+        else if (mode[i] == 'p' || mode[i] == 'P') {pre = true;}
+        else if (mode[i] == 's' || mode[i] == 'S') {sock = true;}
+        else {strApndChar(fmode, mode[i]);}
+    }
+    #ifdef _WIN32
+    if (sock) {free(fmode); CBX(fileerror) = ENOSYS; return -1;}
+    #endif
+    FILE* f = NULL;
+    #ifndef _WIN32
+    if (sock) {
+        // "s" connects to the "unix:path" or "tcp:host:port" socket named by path
+        map = vec = pre = false;
+        f = sockFile(sockOpen(path, false));
+    } else
+    if (vec && !map) {
+        int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+        if (fd > -1 && !(f = fdopen(fd, "a"))) close(fd);
+    } else
+    #endif
+    f = fopen(path, (map || pre) ? "r" : ((vec) ? "a" : fmode));
+    free(fmode);
+    if (!f) {
+        CBX(fileerror) = errno;
+        return -1;
+    }
+    bool vbuf = false;
+    #ifndef _WIN32
+    vbuf = (vec && !map && !pre);
+    #endif
+    int j = fileAdd(f, sock, !(map || pre || vbuf));
+    if (vbuf) {
+        // "v" files never write through stdio, buf holds the writes queued for writev
+        setvbuf(f, NULL, _IONBF, 0);
+        CBX(filedata)[j].buf = malloc(CB_FILE_BUF_SIZE);
+        CBX(filedata)[j].wvct = 0;
+    }
+    fileSize(j);
+    #ifndef _WIN32
+    if (map && CBX(filedata)[j].size > 0 && (uint64_t)CBX(filedata)[j].size <= SIZE_MAX) {
+        void* m = mmap(NULL, CBX(filedata)[j].size, PROT_READ, MAP_PRIVATE, fileno(CBX(filedata)[j].fptr), 0);
+        if (m != MAP_FAILED) {
+            posix_madvise(m, CBX(filedata)[j].size, POSIX_MADV_SEQUENTIAL);
+            CBX(filedata)[j].map = m;
+        }
+    }
+    if (pre && !CBX(filedata)[j].map) CBX(filedata)[j].ra = raOpen(fileno(CBX(filedata)[j].fptr));
+    #endif
+    // mapped and read-ahead files never read through stdio, the others fall back to a buffer
+    if (CBX(filedata)[j].map || CBX(filedata)[j].ra) setvbuf(f, NULL, _IONBF, 0);
+    else if (map || pre) fileBuffer(j);
+    return j;
+}
+
+// Opens a listening socket as a file for ACCEPT, returns -1 with fileerror set on failure
+int sockListen(char* addr) {
+    CBX(fileerror) = 0;
+    #ifndef _WIN32
+    FILE* f = sockFile(sockOpen(addr, true));
+    if (!f) {CBX(fileerror) = errno; return -1;}
+    return fileAdd(f, true, true);
+    #else
+    (void)addr;
+    CBX(fileerror) = ENOSYS;
+    return -1;
+    #endif
+}
+
+// Waits for a connection on a listening socket and opens it as a file
+int sockAccept(int num) {
+    CBX(fileerror) = 0;
+    if (num < 0 || num >= CBX(filemaxct) || !CBX(filedata)[num].fptr || !CBX(filedata)[num].sock) {CBX(fileerror) = EBADF; return -1;}
+    #ifndef _WIN32
+    int lfd = fileno(CBX(filedata)[num].fptr);
+    struct pollfd pfd = {.fd = lfd, .events = POLLIN};
+    int fd = -1;
+    while (!cmdint) {
+        if (poll(&pfd, 1, -1) == -1) {
+            if (errno == EINTR) continue;
+            CBX(fileerror) = errno;
+            return -1;
+        }
+        if ((fd = accept(lfd, NULL, NULL)) > -1) break;
+        if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED) {CBX(fileerror) = errno; return -1;}
+    }
+    if (fd == -1) return -1;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    FILE* f = sockFile(fd);
+    if (!f) {CBX(fileerror) = errno; return -1;}
+    return fileAdd(f, true, true);
+    #else
+    CBX(fileerror) = ENOSYS;
+    return -1;
+    #endif
+}
+
+typedef struct {
+    int32_t perpage;
+    int32_t ct;
+    int64_t* page;
+    int32_t* len;
+    uint64_t* used;
+    char** data;
+    uint64_t tick;
+} cb_reccache;
+
+static inline ssize_t recRead(int num, char* buf, size_t len, int64_t off) {
+    #ifndef _WIN32
+    ssize_t r;
+    while ((r = pread(fileno(CBX(filedata)[num].fptr), buf, len, off)) < 0 && errno == EINTR) {}
+    return r;
+    #else
+    if (fseeko(CBX(filedata)[num].fptr, off, SEEK_SET)) return -1;
+    return fread(buf, 1, len, CBX(filedata)[num].fptr);
+    #endif
+}
+
+static inline ssize_t recWrite(int num, char* buf, size_t len, int64_t off) {
+    #ifndef _WIN32
+    ssize_t r;
+    while ((r = pwrite(fileno(CBX(filedata)[num].fptr), buf, len, off)) < 0 && errno == EINTR) {}
+    return r;
+    #else
+    if (fseeko(CBX(filedata)[num].fptr, off, SEEK_SET)) return -1;
+    ssize_t r = fwrite(buf, 1, len, CBX(filedata)[num].fptr);
+    fflush(CBX(filedata)[num].fptr);
+    return r;
+    #endif
+}
+
+int openRecFile(char* path, int32_t reclen, int32_t pages) {
+    int j = openFile(path, (isFile(path) == 1) ? "r+" : "w+");
+    if (j == -1) return -1;
+    CBX(filedata)[j].reclen = reclen;
+    nfree(CBX(filedata)[j].buf);
+    setvbuf(CBX(filedata)[j].fptr, NULL, _IONBF, 0);
+    if (pages > 0) {
+        cb_reccache* rc = malloc(sizeof(cb_reccache));
+        rc->perpage = (reclen < CB_REC_PAGE_SIZE) ? CB_REC_PAGE_SIZE / reclen : 1;
+        rc->ct = pages;
+        rc->page = (int64_t*)malloc(pages * sizeof(int64_t));
+        rc->len = (int32_t*)malloc(pages * sizeof(int32_t));
+        rc->used = (uint64_t*)calloc(pages, sizeof(uint64_t));
+        rc->data = (char**)calloc(pages, sizeof(char*));
+        for (int i = 0; i < pages; ++i) {rc->page[i] = -1;}
+        rc->tick = 0;
+        CBX(filedata)[j].rc = rc;
+    }
+    return j;
+}
+
+static inline void freeRecCache(int num) {
+    cb_reccache* rc = CBX(filedata)[num].rc;
+    if (!rc) return;
+    for (int i = 0; i < rc->ct; ++i) {
+        nfree(rc->data[i]);
+    }
+    free(rc->page);
+    free(rc->len);
+    free(rc->used);
+    free(rc->data);
+    free(rc);
+    CBX(filedata)[num].rc = NULL;
+}
+
+// Copies record n into buf (NUL-terminated, reclen + 1 bytes) and returns false if it is past the end of the file
+bool fileGetRec(int num, int64_t n, char* buf) {
+    int32_t reclen = CBX(filedata)[num].reclen;
+    cb_reccache* rc = CBX(filedata)[num].rc;
+    buf[0] = 0;
+    if (!rc) {
+        ssize_t r = recRead(num, buf, reclen, n * reclen);
+        if (r <= 0) return false;
+        buf[r] = 0;
+        return true;
+    }
+    int64_t page = n / rc->perpage;
+    int32_t off = (n % rc->perpage) * reclen;
+    int p = -1, lru = 0;
+    for (int i = 0; i < rc->ct; ++i) {
+        if (rc->page[i] == page) {p = i; break;}
+        if (rc->used[i] < rc->used[lru]) lru = i;
+    }
+    if (p == -1) {
+        p = lru;
+        if (!rc->data[p]) rc->data[p] = malloc((size_t)rc->perpage * reclen);
+        ssize_t r = recRead(num, rc->data[p], (size_t)rc->perpage * reclen, page * rc->perpage * reclen);
+        if (r < 0) {rc->page[p] = -1; return false;}
+        rc->page[p] = page;
+        rc->len[p] = r;
+    }
+    rc->used[p] = ++rc->tick;
+    if (off >= rc->len[p]) return false;
+    int32_t len = (rc->len[p] - off < reclen) ? rc->len[p] - off : reclen;
+    memcpy(buf, &rc->data[p][off], len);
+    buf[len] = 0;
+    return true;
+}
+
+// Writes data into record n, padding with NUL bytes or truncating to the record length
+bool filePutRec(int num, int64_t n, char* data) {
+    int32_t reclen = CBX(filedata)[num].reclen;
+    char* rec = calloc(reclen, 1);
+    int32_t len = strlen(data);
+    memcpy(rec, data, (len < reclen) ? len : reclen);
+    bool ret = (recWrite(num, rec, reclen, n * reclen) == reclen);
+    cb_reccache* rc = CBX(filedata)[num].rc;
+    if (ret && rc) {
+        int64_t page = n / rc->perpage;
+        int32_t off = (n % rc->perpage) * reclen;
+        for (int i = 0; i < rc->ct; ++i) {
+            if (rc->page[i] == page) {
+                if (off > rc->len[i]) memset(&rc->data[i][rc->len[i]], 0, off - rc->len[i]);
+                memcpy(&rc->data[i][off], rec, reclen);
+                if (off + reclen > rc->len[i]) rc->len[i] = off + reclen;
+                break;
+            }
+        }
+    }
+    free(rec);
+    return ret;
+}
+
+static inline void unmapFile(int num) {
+    #ifndef _WIN32
+    if (CBX(filedata)[num].map) munmap(CBX(filedata)[num].map, CBX(filedata)[num].size);
+    if (CBX(filedata)[num].ra) raClose(CBX(filedata)[num].ra);
+    #endif
+    freeRecCache(num);
+    CBX(filedata)[num].reclen = 0;
+    CBX(filedata)[num].map = NULL;
+    CBX(filedata)[num].ra = NULL;
+    if (CBX(filedata)[num].wvct > -1) {
+        fileFlush(num);
+        CBX(filedata)[num].wvct = -1;
+    }
+}
+
+static int fcloseFile(int num) {
+    #ifndef _WIN32
+    if (CBX(filedata)[num].sock) {
+        // remove the socket file of a unix listener when it is closed
+        struct sockaddr_un sa;
+        socklen_t sl = sizeof(sa);
+        int lst = 0;
+        socklen_t ll = sizeof(lst);
+        int fd = fileno(CBX(filedata)[num].fptr);
+        memset(&sa, 0, sizeof(sa));
+        bool rm = !getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &lst, &ll) && lst && !getsockname(fd, (struct sockaddr*)&sa, &sl) && sa.sun_family == AF_UNIX && sa.sun_path[0];
+        int r = fclose(CBX(filedata)[num].fptr);
+        if (rm) unlink(sa.sun_path);
+        return r;
+    }
+    #endif
+    return fclose(CBX(filedata)[num].fptr);
+}
+
+bool closeFile(int num) {
+    CBX(fileerror) = 0;
+    if (num > -1 && num < CBX(filemaxct)) {
+        if (CBX(filedata)[num].fptr) {
+            evUnwatchFile(num);
+            unmapFile(num);
+            if (fcloseFile(num)) {
+                CBX(fileerror) = errno;
+                CBX(filedata)[num].fptr = NULL;
+                nfree(CBX(filedata)[num].buf);
+                return false;
+            }
+            CBX(filedata)[num].fptr = NULL;
+            nfree(CBX(filedata)[num].buf);
+            for (int i = CBX(filemaxct) - 1; i > -1; --i) {
+                if (!(CBX(filedata)[i].fptr)) {
+                    --CBX(filemaxct);
+                } else {
+                    break;
+                }
+            }
+            CBX(filedata) = (cb_file*)realloc(CBX(filedata), CBX(filemaxct) * sizeof(cb_file));
+        } else {
+            return false;
+        }
+    } else {
+        if (num == -1) {
+            evUnwatchFile(-1);
+            for (int i = 0; i < CBX(filemaxct); ++i) {
+                if (CBX(filedata)[i].fptr) {
+                    unmapFile(i);
+                    fcloseFile(i);
+                    CBX(filedata)[i].fptr = NULL;
+                    nfree(CBX(filedata)[i].buf);
+                }
+            }
+            CBX(filemaxct) = 0;
+        } else {
+            CBX(fileerror) = EINVAL;
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifndef _WIN32
+#define CBKV_PAGE 4096
+#define CBKV_MAGIC "CBKVLOG1"
+#define CBKV_TOMB 0xFFFFFFFF
+
+// header words: magic, bucket count, live keys, dead bytes, log end
+#define kvhdr(kv) ((uint64_t*)(kv)->map)
+#define kvbucket(kv) ((uint64_t*)((kv)->map + CBKV_PAGE))
+
+static inline uint64_t kvHash(char* key, uint32_t len) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (uint32_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)key[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+static inline int64_t kvLogStart(uint64_t nb) {
+    return CBKV_PAGE + ((nb * 8 + CBKV_PAGE - 1) / CBKV_PAGE) * CBKV_PAGE;
+}
+
+static inline bool kvMap(cb_kv* kv, int64_t cap) {
+    if (kv->map) munmap(kv->map, kv->cap);
+    kv->map = NULL;
+    if (ftruncate(kv->fd, cap)) return false;
+    void* m = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_SHARED, kv->fd, 0);
+    if (m == MAP_FAILED) return false;
+    kv->map = m;
+    kv->cap = cap;
+    return true;
+}
+
+static inline bool kvInit(cb_kv* kv, uint64_t nb) {
+    int64_t start = kvLogStart(nb);
+    if (!kvMap(kv, start + CB_KV_GROW)) return false;
+    memset(kv->map, 0, start);
+    memcpy(kv->map, CBKV_MAGIC, 8);
+    kvhdr(kv)[1] = nb;
+    kvhdr(kv)[4] = start;
+    return true;
+}
+
+// Returns the offset of the newest record for key (which may be a tombstone) or 0 if there is none
+static inline uint64_t kvFind(cb_kv* kv, char* key, uint32_t klen) {
+    uint64_t o = kvbucket(kv)[kvHash(key, klen) & (kvhdr(kv)[1] - 1)];
+    while (o) {
+        uint32_t rklen;
+        memcpy(&rklen, kv->map + o + 8, 4);
+        if (rklen == klen && !memcmp(kv->map + o + 16, key, klen)) return o;
+        memcpy(&o, kv->map + o, 8);
+    }
+    return 0;
+}
+
+static inline uint64_t kvRecSize(cb_kv* kv, uint64_t o) {
+    uint32_t klen, vlen;
+    memcpy(&klen, kv->map + o + 8, 4);
+    memcpy(&vlen, kv->map + o + 12, 4);
+    return 16 + (uint64_t)klen + ((vlen == CBKV_TOMB) ? 0 : vlen);
+}
+
+static inline bool kvAppend(cb_kv* kv, char* key, uint32_t klen, char* val, uint32_t vlen) {
+    uint64_t size = 16 + (uint64_t)klen + ((vlen == CBKV_TOMB) ? 0 : vlen);
+    uint64_t end = kvhdr(kv)[4];
+    if ((int64_t)(end + size) > kv->cap) {
+        int64_t cap = kv->cap + ((kv->cap / 4 > CB_KV_GROW) ? kv->cap / 4 : CB_KV_GROW);
+        if (cap < (int64_t)(end + size)) cap = end + size + CB_KV_GROW;
+        if (!kvMap(kv, cap)) return false;
+    }
+    uint64_t* b = &kvbucket(kv)[kvHash(key, klen) & (kvhdr(kv)[1] - 1)];
+    char* r = kv->map + end;
+    memcpy(r, b, 8);
+    memcpy(r + 8, &klen, 4);
+    memcpy(r + 12, &vlen, 4);
+    memcpy(r + 16, key, klen);
+    if (vlen != CBKV_TOMB) memcpy(r + 16 + klen, val, vlen);
+    *b = end;
+    kvhdr(kv)[4] = end + size;
+    return true;
+}
+
+static inline bool kvOpenFd(cb_kv* kv, char* path) {
+    kv->map = NULL;
+    kv->cap = 0;
+    if ((kv->fd = open(path, O_RDWR | O_CREAT, 0666)) < 0) return false;
+    fcntl(kv->fd, F_SETFD, FD_CLOEXEC);
+    struct stat st;
+    if (fstat(kv->fd, &st)) {close(kv->fd); return false;}
+    if (!st.st_size) {
+        if (!kvInit(kv, CB_KV_BUCKETS)) {close(kv->fd); return false;}
+        return true;
+    }
+    if (st.st_size < CBKV_PAGE || !kvMap(kv, st.st_size) || memcmp(kv->map, CBKV_MAGIC, 8)) {
+        if (kv->map) munmap(kv->map, kv->cap);
+        close(kv->fd);
+        errno = EINVAL;
+        return false;
+    }
+    uint64_t nb = kvhdr(kv)[1];
+    if (!nb || (nb & (nb - 1)) || (int64_t)kvhdr(kv)[4] > kv->cap || (int64_t)kvhdr(kv)[4] < kvLogStart(nb)) {
+        munmap(kv->map, kv->cap);
+        close(kv->fd);
+        errno = EINVAL;
+        return false;
+    }
+    return true;
+}
+
+static inline void kvCloseFd(cb_kv* kv, bool trim) {
+    int64_t end = kvhdr(kv)[4];
+    munmap(kv->map, kv->cap);
+    kv->map = NULL;
+    if (trim && ftruncate(kv->fd, end)) {}
+    close(kv->fd);
+}
+
+// Rewrites the live records into a new file with a bucket count sized for them and swaps it in
+static inline bool kvCompact(cb_kv* kv) {
+    uint64_t nb = CB_KV_BUCKETS;
+    while (nb < kvhdr(kv)[2]) {nb <<= 1;}
+    char* tmppath = malloc(strlen(kv->path) + 9);
+    copyStr(kv->path, tmppath);
+    copyStrApnd(".compact", tmppath);
+    cb_kv nkv;
+    unlink(tmppath);
+    if (!kvOpenFd(&nkv, tmppath)) {free(tmppath); return false;}
+    bool ret = (nb == CB_KV_BUCKETS || kvInit(&nkv, nb));
+    uint64_t onb = kvhdr(kv)[1];
+    for (uint64_t i = 0; ret && i < onb; ++i) {
+        uint64_t o = kvbucket(kv)[i];
+        while (o) {
+            uint32_t klen, vlen;
+            memcpy(&klen, kv->map + o + 8, 4);
+            memcpy(&vlen, kv->map + o + 12, 4);
+            if (vlen != CBKV_TOMB && kvFind(kv, kv->map + o + 16, klen) == o) {
+                if (!kvAppend(&nkv, kv->map + o + 16, klen, kv->map + o + 16 + klen, vlen)) {ret = false; break;}
+            }
+            memcpy(&o, kv->map + o, 8);
+        }
+    }
+    if (ret) {
+        kvhdr(&nkv)[2] = kvhdr(kv)[2];
+        ret = !msync(nkv.map, kvhdr(&nkv)[4], MS_SYNC);
+    }
+    kvCloseFd(&nkv, true);
+    if (ret && !rename(tmppath, kv->path)) {
+        kvCloseFd(kv, false);
+        ret = kvOpenFd(kv, kv->path);
+    } else {
+        unlink(tmppath);
+        ret = false;
+    }
+    free(tmppath);
+    return ret;
+}
+
+static inline void kvChkCompact(cb_kv* kv) {
+    uint64_t* h = kvhdr(kv);
+    uint64_t used = h[4] - kvLogStart(h[1]);
+    if ((h[3] > CB_KV_GROW && h[3] > used / 2) || h[2] > h[1] * 4) kvCompact(kv);
+}
+
+int kvOpen(char* path) {
+    CBX(fileerror) = 0;
+    int j = -1;
+    for (int i = 0; i < CBX(kvmaxct); ++i) {
+        if (!CBX(kvdata)[i].inuse) {j = i; break;}
+    }
+    if (j == -1) {
+        j = CBX(kvmaxct)++;
+        CBX(kvdata) = (cb_kv*)realloc(CBX(kvdata), CBX(kvmaxct) * sizeof(cb_kv));
+    }
+    CBX(kvdata)[j].inuse = false;
+    if (!kvOpenFd(&CBX(kvdata)[j], path)) {
+        CBX(fileerror) = errno;
+        return -1;
+    }
+    CBX(kvdata)[j].inuse = true;
+    CBX(kvdata)[j].path = malloc(strlen(path) + 1);
+    copyStr(path, CBX(kvdata)[j].path);
+    return j;
+}
+
+static inline bool kvValid(int num) {
+    if (num < 0 || num >= CBX(kvmaxct) || !CBX(kvdata)[num].inuse) {CBX(fileerror) = EINVAL; return false;}
+    return true;
+}
+
+bool kvClose(int num) {
+    CBX(fileerror) = 0;
+    if (num == -1) {
+        for (int i = 0; i < CBX(kvmaxct); ++i) {
+            if (CBX(kvdata)[i].inuse) kvClose(i);
+        }
+        nfree(CBX(kvdata));
+        CBX(kvmaxct) = 0;
+        return true;
+    }
+    if (!kvValid(num)) return false;
+    kvCloseFd(&CBX(kvdata)[num], true);
+    nfree(CBX(kvdata)[num].path);
+    CBX(kvdata)[num].inuse = false;
+    return true;
+}
+
+bool kvGet(int num, char* key, char* outbuf) {
+    CBX(fileerror) = 0;
+    outbuf[0] = 0;
+    if (!kvValid(num)) return false;
+    cb_kv* kv = &CBX(kvdata)[num];
+    uint64_t o = kvFind(kv, key, strlen(key));
+    if (!o) return false;
+    uint32_t klen, vlen;
+    memcpy(&klen, kv->map + o + 8, 4);
+    memcpy(&vlen, kv->map + o + 12, 4);
+    if (vlen == CBKV_TOMB) return false;
+    if (vlen > CB_BUF_SIZE - 1) vlen = CB_BUF_SIZE - 1;
+    memcpy(outbuf, kv->map + o + 16 + klen, vlen);
+    outbuf[vlen] = 0;
+    return true;
+}
+
+bool kvPut(int num, char* key, char* val) {
+    CBX(fileerror) = 0;
+    if (!kvValid(num)) return false;
+    cb_kv* kv = &CBX(kvdata)[num];
+    uint32_t klen = strlen(key);
+    uint64_t o = kvFind(kv, key, klen);
+    bool had = false;
+    if (o) {
+        uint32_t vlen;
+        memcpy(&vlen, kv->map + o + 12, 4);
+        had = (vlen != CBKV_TOMB);
+    }
+    uint64_t osize = (had) ? kvRecSize(kv, o) : 0;
+    if (!kvAppend(kv, key, klen, val, strlen(val))) {CBX(fileerror) = errno; return false;}
+    if (had) kvhdr(kv)[3] += osize;
+    else ++kvhdr(kv)[2];
+    kvChkCompact(kv);
+    return true;
+}
+
+bool kvDel(int num, char* key) {
+    CBX(fileerror) = 0;
+    if (!kvValid(num)) return false;
+    cb_kv* kv = &CBX(kvdata)[num];
+    uint32_t klen = strlen(key);
+    uint64_t o = kvFind(kv, key, klen);
+    if (!o) return false;
+    uint32_t vlen;
+    memcpy(&vlen, kv->map + o + 12, 4);
+    if (vlen == CBKV_TOMB) return false;
+    uint64_t osize = kvRecSize(kv, o);
+    if (!kvAppend(kv, key, klen, NULL, CBKV_TOMB)) {CBX(fileerror) = errno; return false;}
+    kvhdr(kv)[3] += osize + 16 + klen;
+    --kvhdr(kv)[2];
+    kvChkCompact(kv);
+    return true;
+}
+#else
+int kvOpen(char* path) {(void)path; CBX(fileerror) = ENOSYS; return -1;}
+bool kvClose(int num) {CBX(fileerror) = (num == -1) ? 0 : ENOSYS; return (num == -1);}
+bool kvGet(int num, char* key, char* outbuf) {(void)num; (void)key; outbuf[0] = 0; CBX(fileerror) = ENOSYS; return false;}
+bool kvPut(int num, char* key, char* val) {(void)num; (void)key; (void)val; CBX(fileerror) = ENOSYS; return false;}
+bool kvDel(int num, char* key) {(void)num; (void)key; CBX(fileerror) = ENOSYS; return false;}
+#endif
+
+#define CBSHM_MAGIC "CBSHMAR1"
+#define CBSHM_HDR 64
+
+// header: magic, then type, max index, and element width as int32s
+#define shmhdr(map) ((int32_t*)((map) + 8))
+
+static inline int shmFind(char* vn) {
+    for (int i = 0; i < CBX(shmmaxct); ++i) {
+        if (CBX(shmdata)[i].inuse && !strcmp(vn, CBX(shmdata)[i].name)) return i;
+    }
+    return -1;
+}
+
+static void shmDrop(int i) {
+    #ifndef _WIN32
+    if (!CBX(shmdata)[i].borrowed) {
+        munmap(CBX(shmdata)[i].map, CBX(shmdata)[i].maplen);
+        if (CBX(shmdata)[i].owner) shm_unlink(CBX(shmdata)[i].key);
+    }
+    #endif
+    nfree(CBX(shmdata)[i].name);
+    nfree(CBX(shmdata)[i].key);
+    CBX(shmdata)[i].inuse = false;
+}
+
+void shmFreeAll() {
+    for (int i = 0; i < CBX(shmmaxct); ++i) {
+        if (CBX(shmdata)[i].inuse) shmDrop(i);
+    }
+    nfree(CBX(shmdata));
+    CBX(shmmaxct) = 0;
+}
+
+// Maps the shared memory segment key (default "/clibasic.<name>") as the array vn. A size of -1
+// attaches to an existing segment, otherwise a new one is made unless one with the same key and
+// shape exists (another --jobs shard got there first), which is then joined and left to its creator
+// to unlink
+bool shmDim(char* vn, int32_t size, int32_t width, char* key) {
+    CBX(fileerror) = 0;
+    int32_t vnlen = strlen(vn);
+    if (!vn[0] || getType(vn) != 255) {CBX(cerr) = 4; seterrstr(vn); return false;}
+    for (int32_t i = 0; vn[i]; ++i) {
+        if (!isValidVarChar(vn[i]) || vn[i] == '[' || vn[i] == ']') {CBX(cerr) = 4; seterrstr(vn); return false;}
+    }
+    if (shmFind(vn) != -1) {CBX(cerr) = 25; return false;}
+    for (int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(vn, CBX(vardata)[i].name)) {CBX(cerr) = 25; return false;}
+    }
+    uint8_t t = (vn[vnlen - 1] == '$') ? 1 : 2;
+    if (t == 2) width = sizeof(double);
+    char* fullkey = malloc(((key) ? strlen(key) : (size_t)vnlen + 9) + 2);
+    if (key) {
+        fullkey[0] = '/';
+        copyStr(key, &fullkey[key[0] != '/']);
+    } else {
+        copyStr("/clibasic.", fullkey);
+        copyStrApnd(vn, fullkey);
+    }
+    #ifndef _WIN32
+    bool owner = false;
+    int fd = -1;
+    size_t len = 0;
+    if (size >= 0) {
+        len = CBSHM_HDR + ((size_t)size + 1) * width;
+        if ((fd = shm_open(fullkey, O_RDWR | O_CREAT | O_EXCL, 0600)) > -1) owner = true;
+        else if (errno == EEXIST) fd = shm_open(fullkey, O_RDWR, 0);
+    } else {
+        fd = shm_open(fullkey, O_RDWR, 0);
+    }
+    if (fd == -1) {CBX(fileerror) = errno; free(fullkey); return false;}
+    if (owner) {
+        if (ftruncate(fd, len)) {CBX(fileerror) = errno; close(fd); shm_unlink(fullkey); free(fullkey); return false;}
+    } else {
+        // the creator may still be sizing the segment
+        struct stat st;
+        int r;
+        for (int i = 0; !(r = fstat(fd, &st)) && st.st_size < CBSHM_HDR && i < 1000; ++i) {cb_wait(1000);}
+        if (r || st.st_size < CBSHM_HDR) {CBX(fileerror) = (r) ? errno : EINVAL; close(fd); free(fullkey); return false;}
+        len = st.st_size;
+    }
+    char* map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        CBX(fileerror) = errno;
+        if (owner) shm_unlink(fullkey);
+        free(fullkey);
+        return false;
+    }
+    if (owner) {
+        // the magic goes in last, it tells the programs joining that the header is complete
+        shmhdr(map)[0] = t;
+        shmhdr(map)[1] = size;
+        shmhdr(map)[2] = width;
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(map, CBSHM_MAGIC, 8);
+    } else {
+        for (int i = 0; memcmp(map, CBSHM_MAGIC, 8) && i < 1000; ++i) {cb_wait(1000);}
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        int32_t hsize = shmhdr(map)[1], hwidth = shmhdr(map)[2];
+        if (memcmp(map, CBSHM_MAGIC, 8) || hsize < 0 || hwidth < 1 || len < CBSHM_HDR + ((size_t)hsize + 1) * hwidth) {
+            CBX(fileerror) = EINVAL;
+            munmap(map, len);
+            free(fullkey);
+            return false;
+        }
+        if (shmhdr(map)[0] != t) {CBX(cerr) = 2; munmap(map, len); free(fullkey); return false;}
+        if (size >= 0 && (hsize != size || hwidth != width)) {CBX(fileerror) = EEXIST; munmap(map, len); free(fullkey); return false;}
+        size = hsize;
+        width = hwidth;
+    }
+    int j = -1;
+    for (int i = 0; i < CBX(shmmaxct); ++i) {
+        if (!CBX(shmdata)[i].inuse) {j = i; break;}
+    }
+    if (j == -1) {
+        j = CBX(shmmaxct)++;
+        CBX(shmdata) = (cb_shm*)realloc(CBX(shmdata), CBX(shmmaxct) * sizeof(cb_shm));
+    }
+    CBX(shmdata)[j].inuse = true;
+    CBX(shmdata)[j].owner = owner;
+    CBX(shmdata)[j].borrowed = false;
+    CBX(shmdata)[j].name = malloc(vnlen + 1);
+    copyStr(vn, CBX(shmdata)[j].name);
+    CBX(shmdata)[j].key = fullkey;
+    CBX(shmdata)[j].type = t;
+    CBX(shmdata)[j].size = size;
+    CBX(shmdata)[j].width = width;
+    CBX(shmdata)[j].map = map;
+    CBX(shmdata)[j].maplen = len;
+    return true;
+    #else
+    (void)size;
+    free(fullkey);
+    CBX(fileerror) = ENOSYS;
+    return false;
+    #endif
+}
+
+static inline char* shmElem(int i, bool isArray, int32_t aindex) {
+    if (!isArray) {CBX(cerr) = 24; seterrstr(CBX(shmdata)[i].name); return NULL;}
+    if (aindex < 0 || aindex > CBX(shmdata)[i].size) {
+        CBX(cerr) = 22;
+        char* tmp = malloc(strlen(CBX(shmdata)[i].name) + 16);
+        sprintf(tmp, "%s[%li]", CBX(shmdata)[i].name, (long int)aindex);
+        seterrstr(tmp);
+        free(tmp);
+        return NULL;
+    }
+    return CBX(shmdata)[i].map + CBSHM_HDR + (size_t)aindex * CBX(shmdata)[i].width;
+}
+
+static uint8_t shmGet(int i, bool isArray, int32_t aindex, char* out) {
+    char* p = shmElem(i, isArray, aindex);
+    if (!p) return 0;
+    if (CBX(shmdata)[i].type == 1) {
+        char* e = memchr(p, 0, CBX(shmdata)[i].width);
+        int32_t l = (e) ? e - p : CBX(shmdata)[i].width;
+        memcpy(out, p, l);
+        out[l] = 0;
+        return 1;
+    }
+    uint64_t bits = __atomic_load_n((uint64_t*)p, __ATOMIC_ACQUIRE);
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    sprintf(out, "%lf", d);
+    int32_t j = strlen(out) - 1;
+    while (out[j] == '0') {--j;}
+    if (out[j] == '.') {--j;}
+    out[j + 1] = 0;
+    if (!strcmp(out, "-0")) {out[0] = '0'; out[1] = 0;}
+    return 2;
+}
+
+static bool shmSet(int i, bool isArray, int32_t aindex, char* val, uint8_t t, int32_t s) {
+    if (s != -1) {CBX(cerr) = 25; return false;}
+    if (t != CBX(shmdata)[i].type) {CBX(cerr) = 2; return false;}
+    char* p = shmElem(i, isArray, aindex);
+    if (!p) return false;
+    if (t == 1) {
+        int32_t l = strlen(val);
+        if (l > CBX(shmdata)[i].width) l = CBX(shmdata)[i].width;
+        memcpy(p, val, l);
+        if (l < CBX(shmdata)[i].width) p[l] = 0;
+        return true;
+    }
+    double d = atof(val);
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    __atomic_store_n((uint64_t*)p, bits, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Atomically adds to an element of a numeric shared array given as name[index]
+bool shmAdd(char* vn, double v) {
+    int32_t vnlen = strlen(vn);
+    char* b = strchr(vn, '[');
+    if (!b || vn[vnlen - 1] != ']') {CBX(cerr) = 1; return false;}
+    *b = 0;
+    int i = shmFind(vn);
+    if (i == -1) {CBX(cerr) = 23; seterrstr(vn); return false;}
+    if (CBX(shmdata)[i].type != 2) {CBX(cerr) = 2; return false;}
+    char* tmp = malloc(CB_BUF_SIZE);
+    copyStrSnip(b + 1, 0, strlen(b + 1) - 1, tmp);
+    CBX(cerr) = 2;
+    uint8_t tmpt = getVal(tmp, tmp);
+    int32_t aindex = atoi(tmp);
+    free(tmp);
+    if (tmpt != 2) return false;
+    CBX(cerr) = 0;
+    uint64_t* p = (uint64_t*)shmElem(i, true, aindex);
+    if (!p) return false;
+    uint64_t o = __atomic_load_n(p, __ATOMIC_RELAXED), n;
+    double d;
+    do {
+        memcpy(&d, &o, sizeof(d));
+        d += v;
+        memcpy(&n, &d, sizeof(n));
+    } while (!__atomic_compare_exchange_n(p, &o, n, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    return true;
+}
+
+typedef struct {
+    char* s;
+    int32_t len;
+} cb_sortline;
+
+typedef struct {
+    char* arena;
+    int64_t used;
+    int64_t cap;
+    cb_sortline* lines;
+    int64_t ct;
+    int64_t linecap;
+    char* path;
+    bool ok;
+    cb_sortopts* opts;
+    #ifndef _WIN32
+    pthread_t thread;
+    #endif
+    bool active;
+} cb_sortrun;
+
+static inline char* sortKey(cb_sortopts* o, char* s) {
+    if (o->key < 2) return s;
+    int f = 1;
+    if (o->sep) {
+        while (*s && f < o->key) {if (*s++ == o->sep) ++f;}
+    } else {
+        while (*s && f < o->key) {
+            while (*s == ' ' || *s == '\t') {++s;}
+            while (*s && *s != ' ' && *s != '\t') {++s;}
+            ++f;
+        }
+    }
+    return s;
+}
+
+static inline int sortCmpStr(cb_sortopts* o, char* a, char* b) {
+    int r = 0;
+    if (o->num) {
+        double x = strtod(a, NULL), y = strtod(b, NULL);
+        r = (x > y) - (x < y);
+    }
+    if (!r && o->fold) {
+        for (; *a && tolower((unsigned char)*a) == tolower((unsigned char)*b); ++a, ++b) {}
+        r = tolower((unsigned char)*a) - tolower((unsigned char)*b);
+    } else if (!r) {
+        r = strcmp(a, b);
+    }
+    return (o->rev) ? -r : r;
+}
+
+static inline int sortCmp(cb_sortopts* o, cb_sortline* a, cb_sortline* b) {
+    return sortCmpStr(o, sortKey(o, a->s), sortKey(o, b->s));
+}
+
+// Bottom-up merge sort, qsort has no way to pass the options to the compare function
+static void sortLines(cb_sortopts* o, cb_sortline* lines, int64_t n) {
+    if (n < 2) return;
+    cb_sortline* l = lines;
+    cb_sortline* t = (cb_sortline*)malloc(n * sizeof(cb_sortline));
+    for (int64_t w = 1; w < n; w *= 2) {
+        for (int64_t lo = 0; lo < n; lo += w * 2) {
+            int64_t mid = (lo + w < n) ? lo + w : n, hi = (lo + w * 2 < n) ? lo + w * 2 : n;
+            int64_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {t[k++] = (sortCmp(o, &l[j], &l[i]) < 0) ? l[j++] : l[i++];}
+            while (i < mid) {t[k++] = l[i++];}
+            while (j < hi) {t[k++] = l[j++];}
+        }
+        cb_sortline* tmp = l;
+        l = t;
+        t = tmp;
+    }
+    if (l != lines) {
+        memcpy(lines, l, n * sizeof(cb_sortline));
+        t = l;
+    }
+    free(t);
+}
+
+static inline char* sortTmpName() {
+    #ifndef _WIN32
+    char* tmpdir = getenv("TMPDIR");
+    if (!tmpdir || !tmpdir[0]) tmpdir = "/tmp";
+    char* path = malloc(strlen(tmpdir) + 16);
+    copyStr(tmpdir, path);
+    copyStrApnd("/cbsortXXXXXX", path);
+    int fd = mkstemp(path);
+    if (fd < 0) {free(path); return NULL;}
+    close(fd);
+    #else
+    char* tmp = tmpnam(NULL);
+    if (!tmp) return NULL;
+    char* path = malloc(strlen(tmp) + 1);
+    copyStr(tmp, path);
+    #endif
+    return path;
+}
+
+static inline FILE* sortOpen(char* path, char* mode, char** buf) {
+    FILE* f = fopen(path, mode);
+    if (!f) return NULL;
+    *buf = malloc(CB_FILE_BUF_SIZE);
+    setvbuf(f, *buf, _IOFBF, CB_FILE_BUF_SIZE);
+    return f;
+}
+
+static inline bool sortClose(FILE* f, char* buf) {
+    bool ret = !fclose(f);
+    free(buf);
+    return ret;
+}
+
+static void* sortRunThread(void* data) {
+    cb_sortrun* run = data;
+    sortLines(run->opts, run->lines, run->ct);
+    char* buf;
+    FILE* f = sortOpen(run->path, "wb", &buf);
+    run->ok = (f != NULL);
+    if (!f) return NULL;
+    for (int64_t i = 0; i < run->ct; ++i) {
+        if (run->opts->uniq && i > 0 && !sortCmp(run->opts, &run->lines[i - 1], &run->lines[i])) continue;
+        fwrite(run->lines[i].s, 1, run->lines[i].len, f);
+        putc('\n', f);
+    }
+    run->ok = !ferror(f) && sortClose(f, buf);
+    return NULL;
+}
+
+static inline void sortRunStart(cb_sortrun* run) {
+    run->active = true;
+    #ifndef _WIN32
+    if (!pthread_create(&run->thread, NULL, sortRunThread, run)) return;
+    #endif
+    sortRunThread(run);
+    run->active = false;
+}
+
+static inline void sortRunWait(cb_sortrun* run) {
+    #ifndef _WIN32
+    if (run->active) pthread_join(run->thread, NULL);
+    #endif
+    run->active = false;
+}
+
+typedef struct {
+    FILE* f;
+    char* buf;
+    char* line;
+    size_t cap;
+} cb_sortsrc;
+
+static inline bool sortNext(cb_sortsrc* src) {
+    ssize_t r = getline(&src->line, &src->cap, src->f);
+    if (r < 0) return false;
+    if (r > 0 && src->line[r - 1] == '\n') src->line[r - 1] = 0;
+    return true;
+}
+
+static inline int sortHeapCmp(cb_sortopts* o, cb_sortsrc* a, cb_sortsrc* b) {
+    return sortCmpStr(o, sortKey(o, a->line), sortKey(o, b->line));
+}
+
+static inline void sortHeapDown(cb_sortopts* o, cb_sortsrc** heap, int ct, int i) {
+    while (1) {
+        int l = i * 2 + 1, m = i;
+        if (l < ct && sortHeapCmp(o, heap[l], heap[m]) < 0) m = l;
+        if (l + 1 < ct && sortHeapCmp(o, heap[l + 1], heap[m]) < 0) m = l + 1;
+        if (m == i) return;
+        cb_sortsrc* tmp = heap[i];
+        heap[i] = heap[m];
+        heap[m] = tmp;
+        i = m;
+    }
+}
+
+// k-way merges the runs in paths into outpath and removes the runs
+static inline bool sortMerge(cb_sortopts* o, char** paths, int ct, char* outpath) {
+    cb_sortsrc* src = (cb_sortsrc*)calloc(ct, sizeof(cb_sortsrc));
+    cb_sortsrc** heap = (cb_sortsrc**)malloc(ct * sizeof(cb_sortsrc*));
+    int hct = 0;
+    bool ret = true;
+    for (int i = 0; i < ct; ++i) {
+        if (!(src[i].f = sortOpen(paths[i], "rb", &src[i].buf))) {ret = false; continue;}
+        if (sortNext(&src[i])) heap[hct++] = &src[i];
+    }
+    char* obuf;
+    FILE* out = (ret) ? sortOpen(outpath, "wb", &obuf) : NULL;
+    if (out) {
+        for (int i = hct / 2 - 1; i >= 0; --i) {sortHeapDown(o, heap, hct, i);}
+        char* last = NULL;
+        size_t lastcap = 0;
+        bool havelast = false;
+        while (hct > 0) {
+            cb_sortsrc* s = heap[0];
+            if (!o->uniq || !havelast || sortCmpStr(o, sortKey(o, last), sortKey(o, s->line))) {
+                fputs(s->line, out);
+                putc('\n', out);
+                if (o->uniq) {
+                    size_t len = strlen(s->line) + 1;
+                    if (len > lastcap) {last = realloc(last, len); lastcap = len;}
+                    memcpy(last, s->line, len);
+                    havelast = true;
+                }
+            }
+            if (!sortNext(s)) heap[0] = heap[--hct];
+            sortHeapDown(o, heap, hct, 0);
+        }
+        nfree(last);
+        ret = !ferror(out) && sortClose(out, obuf);
+    } else {
+        ret = false;
     }
-    if (!vn[0] || vn[0] == '[' || vn[0] == ']') {
-        cerr = 4;
-        seterrstr(vn);
-        goto gvret;
+    for (int i = 0; i < ct; ++i) {
+        if (src[i].f) sortClose(src[i].f, src[i].buf);
+        nfree(src[i].line);
+        cbrm(paths[i]);
     }
-    if (getType(vn) != 255) {
-        cerr = 4;
-        seterrstr(vn);
-        goto gvret;
+    free(src);
+    free(heap);
+    return ret;
+}
+
+bool sortParseOpts(char* opts, cb_sortopts* so) {
+    *so = (cb_sortopts){false, false, false, false, 0, 0, CB_SORT_MEM, 1};
+    #ifndef _WIN32
+    so->jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    #endif
+    for (char* o = opts; *o; ++o) {
+        switch (*o) {
+            case 'r': case 'R': so->rev = true; break;
+            case 'n': case 'N': so->num = true; break;
+            case 'f': case 'F': so->fold = true; break;
+            case 'u': case 'U': so->uniq = true; break;
+            case 'k': case 'K': so->key = strtol(o + 1, &o, 10); --o; if (so->key < 1) return false; break;
+            case 'm': case 'M': so->mem = strtoll(o + 1, &o, 10) * 1048576; --o; if (so->mem < 1048576) return false; break;
+            case 'j': case 'J': so->jobs = strtol(o + 1, &o, 10); --o; if (so->jobs < 1) return false; break;
+            case 't': case 'T': if (!o[1]) return false; so->sep = *++o; break;
+            case ' ': case ',': break;
+            default: return false;
+        }
     }
-    bool isArray = false;
-    int32_t aindex = 0;
-    for (register int32_t i = 0; vn[i]; ++i) {
-        if (chkvar && !isValidVarChar(vn[i])) {
-            cerr = 4;
-            seterrstr(vn);
-            goto gvret;
+    if (so->jobs < 1) so->jobs = 1;
+    return true;
+}
+
+bool sortFile(char* inpath, char* outpath, cb_sortopts* so) {
+    CBX(fileerror) = 0;
+    char* ibuf;
+    FILE* in = sortOpen(inpath, "rb", &ibuf);
+    if (!in) {CBX(fileerror) = errno; return false;}
+    int jobs = so->jobs;
+    int64_t chunk = so->mem / (jobs + 1);
+    cb_sortrun* runs = (cb_sortrun*)calloc(jobs + 1, sizeof(cb_sortrun));
+    char** paths = NULL;
+    int pathct = 0;
+    int cur = 0;
+    bool ret = true;
+    bool done = false;
+    bool pending = false;
+    ssize_t r = 0;
+    char* line = NULL;
+    size_t linecap = 0;
+    while (!done && ret) {
+        cb_sortrun* run = &runs[cur];
+        sortRunWait(run);
+        if (run->path && !run->ok) {ret = false; break;}
+        run->path = NULL;
+        run->opts = so;
+        run->used = 0;
+        run->ct = 0;
+        while (1) {
+            if (!pending) {
+                if ((r = getline(&line, &linecap, in)) < 0) {done = true; break;}
+                if (r > 0 && line[r - 1] == '\n') --r;
+            }
+            pending = false;
+            if (run->used + r + 1 > run->cap) {
+                if (run->used) {pending = true; break;}
+                run->cap = (chunk > r + 1) ? chunk : r + 1;
+                run->arena = realloc(run->arena, run->cap);
+            }
+            if (run->ct == run->linecap) {
+                run->linecap = (run->linecap) ? run->linecap * 2 : 65536;
+                run->lines = (cb_sortline*)realloc(run->lines, run->linecap * sizeof(cb_sortline));
+            }
+            memcpy(&run->arena[run->used], line, r);
+            run->arena[run->used + r] = 0;
+            run->lines[run->ct].s = (char*)(intptr_t)run->used;
+            run->lines[run->ct++].len = r;
+            run->used += r + 1;
         }
-        if (vn[i] == ']') {
-            cerr = 1;
-            goto gvret;
+        for (int64_t i = 0; i < run->ct; ++i) {
+            run->lines[i].s = run->arena + (intptr_t)run->lines[i].s;
         }
-        if (vn[i] == '[') {
-            if (vn[vnlen - 1] != ']') {cerr = 1; goto gvret;}
-            copyStrSnip(vn, i + 1, vnlen - 1, lgetVarBuf);
-            if (!lgetVarBuf[0]) {cerr = 1; goto gvret;}
-            cerr = 2;
-            uint8_t tmpt = getVal(lgetVarBuf, lgetVarBuf);
-            if (tmpt != 2) goto gvret;
-            cerr = 0;
-            aindex = atoi(lgetVarBuf);
-            vn[i] = 0;
-            vnlen = strlen(vn);
-            isArray = true;
+        if (done && !pathct) {
+            run->path = outpath;
+            sortRunThread(run);
+            ret = run->ok;
+            run->path = NULL;
             break;
         }
+        if (!(run->path = sortTmpName())) {CBX(fileerror) = errno; ret = false; break;}
+        paths = (char**)realloc(paths, (pathct + 1) * sizeof(char*));
+        paths[pathct++] = run->path;
+        sortRunStart(run);
+        cur = (cur + 1) % (jobs + 1);
     }
-    int v = -1;
-    for (register int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse && !strcmp(vn, vardata[i].name)) {v = i; break;}
+    for (int i = 0; i <= jobs; ++i) {
+        sortRunWait(&runs[i]);
+        if (runs[i].path && !runs[i].ok) ret = false;
+        nfree(runs[i].arena);
+        nfree(runs[i].lines);
     }
-    if (v == -1) {
-        if (isArray) {
-            cerr = 23;
-            seterrstr(vn);
-            goto gvret;
-        }
-        if (vn[vnlen - 1] == '$') {varout[0] = 0; ret = 1; goto gvret;}
-        else {varout[0] = '0'; varout[1] = 0; ret = 2; goto gvret;}
-    } else {
-        if (vardata[v].size == -1) {
-            if (isArray) {
-                cerr = 23;
-                seterrstr(vn);
-                goto gvret;
-            }
-        } else {
-            if (!isArray) {
-                cerr = 24;
-                seterrstr(vn);
-                goto gvret;
-            }
-            if (aindex < 0 || aindex > vardata[v].size) {
-                cerr = 22;
-                sprintf(lgetVarBuf, "%s[%li]", vn, (long int)aindex);
-                seterrstr(lgetVarBuf);
-                goto gvret;
+    free(runs);
+    nfree(line);
+    sortClose(in, ibuf);
+    while (ret && pathct > CB_SORT_MAXRUNS) {
+        int nct = 0;
+        for (int i = 0; i < pathct; i += CB_SORT_MAXRUNS) {
+            int ct = (pathct - i < CB_SORT_MAXRUNS) ? pathct - i : CB_SORT_MAXRUNS;
+            char* tmp = sortTmpName();
+            if (!tmp || !sortMerge(so, &paths[i], ct, tmp)) {
+                ret = false;
+                nfree(tmp);
+                for (int j = (tmp) ? i + ct : i; j < pathct; ++j) {cbrm(paths[j]);}
+                for (int j = i; j < pathct; ++j) {free(paths[j]);}
+                pathct = nct;
+                break;
             }
+            for (int j = i; j < i + ct; ++j) {free(paths[j]);}
+            paths[nct++] = tmp;
         }
-        copyStr(vardata[v].data[aindex], varout);
-        ret = vardata[v].type;
-        goto gvret;
+        if (ret) pathct = nct;
     }
-    gvret:;
-    --getVarIndex;
-    if (getVarIndex) free(lgetVarBuf);
+    if (ret && pathct) ret = sortMerge(so, paths, pathct, outpath);
+    else for (int i = 0; i < pathct; ++i) {cbrm(paths[i]);}
+    for (int i = 0; i < pathct; ++i) {free(paths[i]);}
+    nfree(paths);
+    if (!ret && !CBX(fileerror)) CBX(fileerror) = (errno) ? errno : EIO;
     return ret;
 }
 
-char setVarBuf[CB_BUF_SIZE];
+typedef struct {
+    char* path;
+    char** res;
+    int32_t resct;
+} cb_grepfile;
 
-bool setVar(char* vn, char* val, uint8_t t, int32_t s) {
-    int32_t vnlen = strlen(vn);
-    if (!vn[0] || vn[0] == '[' || vn[0] == ']') {
-        cerr = 4;
-        seterrstr(vn);
-        return false;
+typedef struct {
+    cb_grepfile* files;
+    int32_t ct;
+    int32_t next;
+    char* pat;
+    size_t patlen;
+} cb_grepjob;
+
+static inline void grepAddFile(cb_grepjob* job, char* path, int32_t* cap) {
+    if (job->ct == *cap) {
+        *cap = (*cap) ? *cap * 2 : 256;
+        job->files = (cb_grepfile*)realloc(job->files, *cap * sizeof(cb_grepfile));
     }
-    if (getType(vn) != 255) {
-        cerr = 4;
-        seterrstr(vn);
-        return false;
+    cb_grepfile* f = &job->files[job->ct++];
+    f->path = malloc(strlen(path) + 1);
+    copyStr(path, f->path);
+    f->res = NULL;
+    f->resct = 0;
+}
+
+static void grepCollect(cb_grepjob* job, char* path, int32_t* cap) {
+    struct stat st;
+    if (stat(path, &st)) return;
+    if (!S_ISDIR(st.st_mode)) {
+        if (S_ISREG(st.st_mode)) grepAddFile(job, path, cap);
+        return;
     }
-    bool isArray = false;
-    int32_t aindex = 0;
-    for (register int32_t i = 0; vn[i]; ++i) {
-        if (chkvar && !isValidVarChar(vn[i])) {
-            cerr = 4;
-            seterrstr(vn);
-            return false;
-        }
-        if (vn[i] == ']') {
-            cerr = 1;
-            return 0;
-        }
-        if (vn[i] == '[') {
-            if (vn[vnlen - 1] != ']') {cerr = 1; return 0;}
-            if (s != -1) {cerr = 4; seterrstr(vn); return 0;}
-            copyStrSnip(vn, i + 1, vnlen - 1, setVarBuf);
-            if (!setVarBuf[0]) {cerr = 1; return 0;}
-            cerr = 2;
-            uint8_t tmpt = getVal(setVarBuf, setVarBuf);
-            if (tmpt != 2) {return 0;}
-            cerr = 0;
-            aindex = atoi(setVarBuf);
-            vn[i] = 0;
-            vnlen = strlen(vn);
-            isArray = true;
-            break;
+    DIR* dir = opendir(path);
+    if (!dir) return;
+    struct dirent* ent;
+    size_t plen = strlen(path);
+    char* sub = malloc(plen + 258);
+    copyStr(path, sub);
+    if (plen && sub[plen - 1] != '/') {sub[plen++] = '/'; sub[plen] = 0;}
+    while ((ent = readdir(dir))) {
+        if (ent->d_name[0] == '.' && (!ent->d_name[1] || (ent->d_name[1] == '.' && !ent->d_name[2]))) continue;
+        size_t nlen = strlen(ent->d_name);
+        sub = realloc(sub, plen + nlen + 1);
+        memcpy(&sub[plen], ent->d_name, nlen + 1);
+        #ifdef _DIRENT_HAVE_D_TYPE
+        if (ent->d_type == DT_REG) {grepAddFile(job, sub, cap); continue;}
+        if (ent->d_type == DT_DIR) {grepCollect(job, sub, cap); continue;}
+        if (ent->d_type != DT_UNKNOWN && ent->d_type != DT_LNK) continue;
+        #endif
+        if (stat(sub, &st)) continue;
+        if (S_ISREG(st.st_mode)) grepAddFile(job, sub, cap);
+        #ifdef _DIRENT_HAVE_D_TYPE
+        else if (S_ISDIR(st.st_mode) && ent->d_type == DT_UNKNOWN) grepCollect(job, sub, cap);
+        #else
+        else if (S_ISDIR(st.st_mode)) grepCollect(job, sub, cap);
+        #endif
+    }
+    free(sub);
+    closedir(dir);
+}
+
+static inline char* grepFind(char* p, size_t len, char* pat, size_t patlen) {
+    if (!patlen) return p;
+    if (patlen > len) return NULL;
+    char* last = p + len - patlen;
+    char first = pat[0], lastc = pat[patlen - 1];
+    while (p <= last) {
+        p = memchr(p, first, last - p + 1);
+        if (!p) return NULL;
+        if (p[patlen - 1] == lastc && !memcmp(p + 1, pat + 1, patlen - 1)) return p;
+        ++p;
+    }
+    return NULL;
+}
+
+static inline void grepFile(cb_grepjob* job, cb_grepfile* f) {
+    int fd = open(f->path, O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX) {close(fd); return;}
+    size_t len = st.st_size;
+    #ifndef _WIN32
+    char* data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return;
+    posix_madvise(data, len, POSIX_MADV_SEQUENTIAL);
+    #else
+    char* data = malloc(len);
+    ssize_t r = read(fd, data, len);
+    close(fd);
+    if (r < 0) {free(data); return;}
+    len = r;
+    #endif
+    char* p = data;
+    char* end = data + len;
+    char* lnpos = data;
+    int64_t lineno = 1;
+    int32_t rescap = 0;
+    size_t plen = strlen(f->path);
+    while (p < end) {
+        char* m = grepFind(p, end - p, job->pat, job->patlen);
+        if (!m) break;
+        char* ls = m;
+        while (ls > p && ls[-1] != '\n') {--ls;}
+        char* q;
+        while ((q = memchr(lnpos, '\n', ls - lnpos))) {++lineno; lnpos = q + 1;}
+        char* le = memchr(m, '\n', end - m);
+        if (!le) le = end;
+        size_t tlen = le - ls;
+        if (tlen && ls[tlen - 1] == '\r') --tlen;
+        if (plen + tlen + 24 > CB_BUF_SIZE) tlen = (CB_BUF_SIZE > plen + 24) ? CB_BUF_SIZE - plen - 24 : 0;
+        if (f->resct == rescap) {
+            rescap = (rescap) ? rescap * 2 : 16;
+            f->res = (char**)realloc(f->res, rescap * sizeof(char*));
         }
+        char* res = malloc(plen + tlen + 24);
+        int hl = sprintf(res, "%s:%" PRId64 ":", f->path, lineno);
+        memcpy(&res[hl], ls, tlen);
+        res[hl + tlen] = 0;
+        f->res[f->resct++] = res;
+        p = le + 1;
+        lnpos = p;
+        ++lineno;
     }
-    int v = -1;
-    for (register int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse && !strcmp(vn, vardata[i].name)) {v = i; break;}
+    #ifndef _WIN32
+    munmap(data, len);
+    #else
+    free(data);
+    #endif
+}
+
+static void* grepThread(void* data) {
+    cb_grepjob* job = data;
+    int32_t i;
+    while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->ct) {
+        grepFile(job, &job->files[i]);
     }
-    if (v == -1) {
-        if (isArray) {
-            cerr = 23;
-            seterrstr(vn);
-            return false;
+    return NULL;
+}
+
+// Searches path (a file or a directory tree) for pat and puts the matching lines as "file:line:text" into the array vn
+int32_t grepFiles(char* pat, char* path, char* vn) {
+    cb_grepjob job = {NULL, 0, 0, pat, strlen(pat)};
+    int32_t cap = 0;
+    grepCollect(&job, path, &cap);
+    #ifndef _WIN32
+    int tct = sysconf(_SC_NPROCESSORS_ONLN);
+    if (tct > job.ct) tct = job.ct;
+    if (tct > 1) {
+        pthread_t* threads = (pthread_t*)malloc(tct * sizeof(pthread_t));
+        int started = 0;
+        for (; started < tct - 1; ++started) {
+            if (pthread_create(&threads[started], NULL, grepThread, &job)) break;
         }
-        for (register int i = 0; i < varmaxct; ++i) {
-            if (!vardata[i].inuse) {v = i; break;}
+        grepThread(&job);
+        for (int i = 0; i < started; ++i) {
+            pthread_join(threads[i], NULL);
         }
-        if (v == -1) {
-            v = varmaxct;
-            varmaxct++;
-            vardata = (cb_var*)realloc(vardata, varmaxct * sizeof(cb_var));
-        }
-        vardata[v].inuse = true;
-        vardata[v].name = (char*)malloc(vnlen + 1);
-        copyStr(vn, vardata[v].name);
-        vardata[v].size = s;
-        vardata[v].type = t;
-        if (s == -1) s = 0;
-        vardata[v].data = (char**)malloc((s + 1) * sizeof(char*));
-        for (int32_t i = 0; i <= s; ++i) {
-            vardata[v].data[i] = (char*)malloc(strlen(val) + 1);
-            copyStr(val, vardata[v].data[i]);
+        free(threads);
+    } else
+    #endif
+    grepThread(&job);
+    int32_t total = 0;
+    for (int32_t i = 0; i < job.ct; ++i) {
+        total += job.files[i].resct;
+    }
+    int v = dimVar(vn, 1, (total) ? total - 1 : 0);
+    int32_t n = 0;
+    for (int32_t i = 0; i < job.ct; ++i) {
+        for (int32_t j = 0; j < job.files[i].resct; ++j) {
+            if (v != -1) {
+                swap(CBX(vardata)[v].data[n], job.files[i].res[j]);
+                ++n;
+            }
+            free(job.files[i].res[j]);
         }
-    } else {
-        if (s != -1) {cerr = 25; return false;}
-        if (t != vardata[v].type) {cerr = 2; return false;}
-        if (isArray && (aindex < 0 || aindex > vardata[v].size)) {
-            cerr = 22;
-            sprintf(setVarBuf, "%s[%li]", vn, (long int)aindex);
-            seterrstr(setVarBuf);
-            return 0;
+        nfree(job.files[i].res);
+        free(job.files[i].path);
+    }
+    nfree(job.files);
+    if (v == -1) return -1;
+    if (!total) {
+        CBX(vardata)[v].data[0] = realloc(CBX(vardata)[v].data[0], 1);
+        CBX(vardata)[v].data[0][0] = 0;
+    }
+    return total;
+}
+
+typedef struct {
+    char** names;
+    int32_t ct;
+    int32_t cap;
+} cb_dirlist;
+
+static inline void dirListAdd(cb_dirlist* dl, char* pre, size_t plen, char* name, bool isdir) {
+    if (dl->ct >= dl->cap) {
+        dl->cap = (dl->cap) ? dl->cap * 2 : 256;
+        dl->names = (char**)realloc(dl->names, dl->cap * sizeof(char*));
+    }
+    size_t nlen = strlen(name);
+    char* s = malloc(plen + nlen + 2);
+    memcpy(s, pre, plen);
+    memcpy(&s[plen], name, nlen);
+    #ifdef _WIN32
+    if (isdir) s[plen + nlen++] = '\\';
+    #else
+    if (isdir) s[plen + nlen++] = '/';
+    #endif
+    s[plen + nlen] = 0;
+    dl->names[dl->ct++] = s;
+}
+
+static void dirListWalk(cb_dirlist* dl, DIR* dir, char* base, char* pre, size_t plen, bool rec) {
+    struct dirent* ent;
+    struct stat st;
+    while ((ent = readdir(dir))) {
+        if (ent->d_name[0] == '.' && (!ent->d_name[1] || (ent->d_name[1] == '.' && !ent->d_name[2]))) continue;
+        bool isdir;
+        #ifndef _WIN32
+        (void)base;
+        #ifdef _DIRENT_HAVE_D_TYPE
+        if (ent->d_type != DT_UNKNOWN) {isdir = (ent->d_type == DT_DIR);} else
+        #endif
+        isdir = (!fstatat(dirfd(dir), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) && S_ISDIR(st.st_mode));
+        #else
+        char* full = malloc(strlen(base) + plen + strlen(ent->d_name) + 2);
+        sprintf(full, "%s\\%.*s%s", base, (int)plen, pre, ent->d_name);
+        isdir = (!stat(full, &st) && S_ISDIR(st.st_mode));
+        #endif
+        dirListAdd(dl, pre, plen, ent->d_name, isdir);
+        if (rec && isdir) {
+            #ifndef _WIN32
+            int fd = openat(dirfd(dir), ent->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            DIR* sub = (fd < 0) ? NULL : fdopendir(fd);
+            if (!sub && fd >= 0) close(fd);
+            #else
+            DIR* sub = opendir(full);
+            #endif
+            if (sub) {
+                char* spre = dl->names[dl->ct - 1];
+                dirListWalk(dl, sub, base, spre, strlen(spre), rec);
+                closedir(sub);
+            }
         }
-        vardata[v].data[aindex] = (char*)realloc(vardata[v].data[aindex], strlen(val) + 1);
-        copyStr(val, vardata[v].data[aindex]);
+        #ifdef _WIN32
+        free(full);
+        #endif
     }
-    return true;
 }
 
-bool delVar(char* vn) {
-    if (!vn[0] || vn[0] == '[' || vn[0] == ']') {
-        cerr = 4;
-        seterrstr(vn);
-        return false;
+int32_t dirList(char* path, char* vn, bool rec) {
+    if (!path[0]) path = ".";
+    int tmpret = isFile(path);
+    if (tmpret) {
+        if (tmpret == -1) {CBX(cerr) = 15; seterrstr(path);}
+        else {CBX(cerr) = 19;}
+        return -1;
     }
-    if (getType(vn) != 255) {
-        cerr = 4;
-        seterrstr(vn);
-        return false;
+    DIR* dir = opendir(path);
+    if (!dir) {CBX(cerr) = 15; seterrstr(path); return -1;}
+    cb_dirlist dl = {NULL, 0, 0};
+    dirListWalk(&dl, dir, path, "", 0, rec);
+    closedir(dir);
+    int v = dimVar(vn, 1, (dl.ct) ? dl.ct - 1 : 0);
+    for (int32_t i = 0; i < dl.ct; ++i) {
+        if (v != -1) swap(CBX(vardata)[v].data[i], dl.names[i]);
+        free(dl.names[i]);
     }
-    for (register int32_t i = 0; vn[i]; ++i) {
-        if (chkvar && !isValidVarChar(vn[i])) {
-            cerr = 4;
-            seterrstr(vn);
-            return false;
+    nfree(dl.names);
+    if (v == -1) return -1;
+    if (!dl.ct) {
+        CBX(vardata)[v].data[0] = realloc(CBX(vardata)[v].data[0], 1);
+        CBX(vardata)[v].data[0][0] = 0;
+    }
+    return dl.ct;
+}
+
+#ifndef _WIN32
+// Refills the read buffer of a stream once it is drained and returns how much is left in it, 0 at
+// EOF or on error
+static inline int32_t fileFill(int num) {
+    if (CBX(filedata)[num].pos < CBX(filedata)[num].rdct) return CBX(filedata)[num].rdct - CBX(filedata)[num].pos;
+    ssize_t r;
+    while ((r = read(fileno(CBX(filedata)[num].fptr), CBX(filedata)[num].buf, CBX(filedata)[num].bufsize)) < 0 && errno == EINTR && !cmdint) {}
+    CBX(filedata)[num].pos = 0;
+    CBX(filedata)[num].rdct = (r > 0) ? r : 0;
+    return CBX(filedata)[num].rdct;
+}
+#endif
+
+static inline int fileGetc(int num) {
+    #ifndef _WIN32
+    if (CBX(filedata)[num].rdct > -1) {
+        if (!fileFill(num)) return EOF;
+        return (unsigned char)CBX(filedata)[num].buf[CBX(filedata)[num].pos++];
+    }
+    #endif
+    if (CBX(filedata)[num].map) {
+        if (CBX(filedata)[num].pos >= CBX(filedata)[num].size) return EOF;
+        return (unsigned char)CBX(filedata)[num].map[CBX(filedata)[num].pos++];
+    }
+    #ifndef _WIN32
+    if (CBX(filedata)[num].ra) {
+        int32_t avail;
+        char* p = raPeek(CBX(filedata)[num].ra, &avail);
+        if (!avail) return EOF;
+        ((cb_readahead*)CBX(filedata)[num].ra)->off++;
+        CBX(filedata)[num].pos++;
+        return (unsigned char)*p;
+    }
+    #endif
+    return getc(CBX(filedata)[num].fptr);
+}
+
+static inline int32_t fileRead(int num, char* buf, int32_t len) {
+    int32_t r;
+    if (CBX(filedata)[num].map) {
+        r = (CBX(filedata)[num].size - CBX(filedata)[num].pos < len) ? CBX(filedata)[num].size - CBX(filedata)[num].pos : len;
+        memcpy(buf, &CBX(filedata)[num].map[CBX(filedata)[num].pos], r);
+        CBX(filedata)[num].pos += r;
+    #ifndef _WIN32
+    } else if (CBX(filedata)[num].ra) {
+        r = 0;
+        while (r < len) {
+            int32_t avail;
+            char* p = raPeek(CBX(filedata)[num].ra, &avail);
+            if (!avail) break;
+            if (avail > len - r) avail = len - r;
+            memcpy(&buf[r], p, avail);
+            ((cb_readahead*)CBX(filedata)[num].ra)->off += avail;
+            r += avail;
         }
-        if (vn[i] == '[') {
-            cerr = 4;
-            seterrstr(vn);
-            return false;
+        CBX(filedata)[num].pos += r;
+    } else if (CBX(filedata)[num].rdct > -1) {
+        // streams return what has arrived, only waiting while nothing has
+        r = 0;
+        int32_t avail;
+        while (r < len && (!r || CBX(filedata)[num].pos < CBX(filedata)[num].rdct) && (avail = fileFill(num))) {
+            if (avail > len - r) avail = len - r;
+            memcpy(&buf[r], &CBX(filedata)[num].buf[CBX(filedata)[num].pos], avail);
+            CBX(filedata)[num].pos += avail;
+            r += avail;
         }
+    #endif
+    } else {
+        r = fread(buf, 1, len, CBX(filedata)[num].fptr);
     }
-    int v = -1;
-    for (register int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse && !strcmp(vn, vardata[i].name)) {v = i; break;}
+    buf[r] = 0;
+    return r;
+}
+
+static inline int32_t fileReadLine(int num, char* buf, int32_t len) {
+    int32_t r;
+    if (CBX(filedata)[num].map) {
+        int64_t left = CBX(filedata)[num].size - CBX(filedata)[num].pos;
+        if (left <= 0) {buf[0] = 0; return -1;}
+        char* start = &CBX(filedata)[num].map[CBX(filedata)[num].pos];
+        r = (left < len - 1) ? left : len - 1;
+        char* nl = memchr(start, '\n', r);
+        if (nl) r = nl - start + 1;
+        memcpy(buf, start, r);
+        buf[r] = 0;
+        CBX(filedata)[num].pos += r;
+    #ifndef _WIN32
+    } else if (CBX(filedata)[num].ra) {
+        r = 0;
+        while (r < len - 1) {
+            int32_t avail;
+            char* p = raPeek(CBX(filedata)[num].ra, &avail);
+            if (!avail) break;
+            if (avail > len - 1 - r) avail = len - 1 - r;
+            char* nl = memchr(p, '\n', avail);
+            if (nl) avail = nl - p + 1;
+            memcpy(&buf[r], p, avail);
+            ((cb_readahead*)CBX(filedata)[num].ra)->off += avail;
+            r += avail;
+            if (nl) break;
+        }
+        buf[r] = 0;
+        CBX(filedata)[num].pos += r;
+        if (!r) return -1;
+    } else if (CBX(filedata)[num].rdct > -1) {
+        r = 0;
+        int32_t avail;
+        while (r < len - 1 && (avail = fileFill(num))) {
+            char* p = &CBX(filedata)[num].buf[CBX(filedata)[num].pos];
+            if (avail > len - 1 - r) avail = len - 1 - r;
+            char* nl = memchr(p, '\n', avail);
+            if (nl) avail = nl - p + 1;
+            memcpy(&buf[r], p, avail);
+            CBX(filedata)[num].pos += avail;
+            r += avail;
+            if (nl) break;
+        }
+        buf[r] = 0;
+        if (!r) return -1;
+    #endif
+    } else {
+        if (!fgets(buf, len, CBX(filedata)[num].fptr)) {buf[0] = 0; return -1;}
+        r = strlen(buf);
     }
-    if (v != -1) {
-        vardata[v].inuse = false;
-        nfree(vardata[v].name);
-        for (int32_t i = 0; i <= vardata[v].size; ++i) {
-            nfree(vardata[v].data[i]);
+    if (r > 0 && r == len - 1 && buf[r - 1] != '\n') {
+        // the line did not fit, the rest of it is dropped and EOVERFLOW is left in errno
+        int c = fileGetc(num);
+        if (c == '\n') {
+            if (buf[r - 1] == '\r') buf[--r] = 0;
+        } else if (c != EOF) {
+            while ((c = fileGetc(num)) != EOF && c != '\n') {}
+            errno = EOVERFLOW;
         }
-        nfree(vardata[v].data);
-        if (v == varmaxct - 1) {
-            while (!vardata[v].inuse && v >= 0) {varmaxct--; v--;}
-            vardata = (cb_var*)realloc(vardata, varmaxct * sizeof(cb_var));
+    } else if (r > 0 && buf[r - 1] == '\n') {
+        buf[--r] = 0;
+        if (r > 0 && buf[r - 1] == '\r') buf[--r] = 0;
+    }
+    return r;
+}
+
+static inline bool fileEOF(int num) {
+    if (CBX(filedata)[num].map) return (CBX(filedata)[num].pos >= CBX(filedata)[num].size);
+    #ifndef _WIN32
+    if (CBX(filedata)[num].ra) {
+        int32_t avail;
+        raPeek(CBX(filedata)[num].ra, &avail);
+        return !avail;
+    }
+    if (CBX(filedata)[num].rdct > -1) return !fileFill(num);
+    #endif
+    int c = getc(CBX(filedata)[num].fptr);
+    if (c == EOF) return true;
+    ungetc(c, CBX(filedata)[num].fptr);
+    return false;
+}
+
+static inline int64_t fileTell(int num) {
+    if (CBX(filedata)[num].map || CBX(filedata)[num].ra) return CBX(filedata)[num].pos;
+    if (CBX(filedata)[num].wvct > 0) fileFlush(num);
+    return ftello(CBX(filedata)[num].fptr);
+}
+
+static inline int64_t fileSize(int num) {
+    if (CBX(filedata)[num].map) return CBX(filedata)[num].size;
+    if (CBX(filedata)[num].wvct > 0) fileFlush(num);
+    struct stat st;
+    if (!fstat(fileno(CBX(filedata)[num].fptr), &st)) {
+        CBX(filedata)[num].size = st.st_size;
+        if (!CBX(filedata)[num].ra) {
+            int64_t pos = ftello(CBX(filedata)[num].fptr);
+            if (pos > CBX(filedata)[num].size) CBX(filedata)[num].size = pos;
         }
+    } else {
+        off_t prev = ftello(CBX(filedata)[num].fptr);
+        fseeko(CBX(filedata)[num].fptr, 0, SEEK_END);
+        CBX(filedata)[num].size = ftello(CBX(filedata)[num].fptr);
+        fseeko(CBX(filedata)[num].fptr, prev, SEEK_SET);
     }
-    return true;
+    return CBX(filedata)[num].size;
 }
 
-int openFile(char* path, char* mode) {
-    fileerror = 0;
-    int i = 0;
-    int j = -1;
-    for (; i < filemaxct; ++i) {
-        if (!filedata[i].fptr) {j = i; break;}
+static inline bool fileSeek(int num, int64_t pos) {
+    if (pos > fileSize(num)) pos = CBX(filedata)[num].size;
+    if (CBX(filedata)[num].map) {
+        CBX(filedata)[num].pos = pos;
+        return true;
     }
-    if (j == -1) {
-        j = filemaxct;
-        ++filemaxct;
-        filedata = (cb_file*)realloc(filedata, filemaxct * sizeof(cb_file));
-    }
-    if (!(filedata[j].fptr = fopen(path, mode))) {
-        fileerror = errno;
-        --filemaxct;
-        filedata = (cb_file*)realloc(filedata, filemaxct * sizeof(cb_file));
-        return -1;
+    #ifndef _WIN32
+    if (CBX(filedata)[num].ra) {
+        cb_readahead* ra = CBX(filedata)[num].ra;
+        raStop(ra);
+        bool ret = (lseek(ra->fd, pos, SEEK_SET) != -1);
+        if (ret) CBX(filedata)[num].pos = pos;
+        raStart(ra);
+        return ret;
     }
-    fseek(filedata[j].fptr, 0, SEEK_END);
-    filedata[j].size = ftell(filedata[j].fptr);
-    fseek(filedata[j].fptr, 0, SEEK_SET);
-    return j;
+    #endif
+    if (CBX(filedata)[num].wvct > 0) fileFlush(num);
+    return !fseeko(CBX(filedata)[num].fptr, pos, SEEK_SET);
 }
 
-bool closeFile(int num) {
-    fileerror = 0;
-    if (num > -1 && num < filemaxct) {
-        if (filedata[num].fptr) {
-            if (fclose(filedata[num].fptr)) {
-                fileerror = errno;
-                filedata[num].fptr = NULL;
-                return false;
-            }
-            filedata[num].fptr = NULL;
-            for (int i = filemaxct - 1; i > -1; --i) {
-                if (!(filedata[i].fptr)) {
-                    --filemaxct;
-                } else {
-                    break;
-                }
-            }
-            filedata = (cb_file*)realloc(filedata, filemaxct * sizeof(cb_file));
-        } else {
-            return false;
+#ifndef _WIN32
+static char fileNewline[] = "\n";
+
+// Sends the bytes queued in buf followed by str (and a newline) with one writev
+static inline bool fileWritev(int num, char* str, size_t len, bool nl) {
+    struct iovec v[3] = {{.iov_base = CBX(filedata)[num].buf, .iov_len = CBX(filedata)[num].wvct}, {.iov_base = str, .iov_len = len}, {.iov_base = fileNewline, .iov_len = nl}};
+    struct iovec* p = v;
+    int ct = 3;
+    int fd = fileno(CBX(filedata)[num].fptr);
+    bool ret = true;
+    while (ct) {
+        ssize_t r = writev(fd, p, ct);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            ret = false;
+            break;
         }
-    } else {
-        if (num == -1) {
-            for (int i = 0; i < filemaxct; ++i) {
-                if (filedata[i].fptr) {
-                    fclose(filedata[i].fptr);
-                    filedata[i].fptr = NULL;
-                }
+        while (ct && (size_t)r >= p->iov_len) {r -= p->iov_len; ++p; --ct;}
+        if (ct) {p->iov_base = (char*)p->iov_base + r; p->iov_len -= r;}
+    }
+    CBX(filedata)[num].wvct = 0;
+    return ret;
+}
+#endif
+
+#ifndef _WIN32
+// Sockets are written with sendmsg straight away, the stream only buffers reads
+static bool sockSend(int num, char* str, bool nl) {
+    struct iovec v[2] = {{.iov_base = str, .iov_len = strlen(str)}, {.iov_base = fileNewline, .iov_len = nl}};
+    struct msghdr m;
+    memset(&m, 0, sizeof(m));
+    m.msg_iov = v;
+    m.msg_iovlen = 2;
+    int fd = fileno(CBX(filedata)[num].fptr);
+    while (m.msg_iovlen) {
+        ssize_t r = sendmsg(fd, &m, MSG_NOSIGNAL);
+        if (r < 0) {
+            if (errno == EINTR && !cmdint) continue;
+            if (errno == EAGAIN) {
+                struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+                poll(&pfd, 1, -1);
+                continue;
             }
-            filemaxct = 0;
-        } else {
-            fileerror = EINVAL;
             return false;
         }
+        while (m.msg_iovlen && (size_t)r >= m.msg_iov->iov_len) {r -= m.msg_iov->iov_len; ++m.msg_iov; --m.msg_iovlen;}
+        if (m.msg_iovlen) {m.msg_iov->iov_base = (char*)m.msg_iov->iov_base + r; m.msg_iov->iov_len -= r;}
+    }
+    return true;
+}
+#endif
+
+static inline bool fileWrite(int num, char* str, bool nl) {
+    #ifndef _WIN32
+    if (CBX(filedata)[num].sock) return sockSend(num, str, nl);
+    if (CBX(filedata)[num].wvct > -1) {
+        // writes are copied together into buf, one that does not fit is sent along with it
+        size_t len = strlen(str);
+        if (CBX(filedata)[num].wvct + len + nl > (size_t)CBX(filedata)[num].bufsize) return fileWritev(num, str, len, nl);
+        memcpy(CBX(filedata)[num].buf + CBX(filedata)[num].wvct, str, len);
+        CBX(filedata)[num].wvct += len;
+        if (nl) CBX(filedata)[num].buf[CBX(filedata)[num].wvct++] = '\n';
+        return true;
+    }
+    #endif
+    if (fputs(str, CBX(filedata)[num].fptr) == EOF) return false;
+    if (nl && putc('\n', CBX(filedata)[num].fptr) == EOF) return false;
+    return true;
+}
+
+static inline bool fileFlush(int num) {
+    #ifndef _WIN32
+    if (CBX(filedata)[num].sock) return true;
+    if (CBX(filedata)[num].wvct > 0 && !fileWritev(num, NULL, 0, false)) return false;
+    #endif
+    return (fflush(CBX(filedata)[num].fptr) != EOF);
+}
+
+static inline bool fileSetBuf(int num, int32_t size) {
+    if (size < 0) return false;
+    if (CBX(filedata)[num].map) return true;
+    if (CBX(filedata)[num].rdct > -1) {
+        // streams keep what is left to read, and read at least a byte at a time
+        int32_t left = CBX(filedata)[num].rdct - CBX(filedata)[num].pos;
+        if (size < left) return false;
+        if (!size) size = 1;
+        char* buf = malloc(size);
+        memcpy(buf, &CBX(filedata)[num].buf[CBX(filedata)[num].pos], left);
+        nfree(CBX(filedata)[num].buf);
+        CBX(filedata)[num].buf = buf;
+        CBX(filedata)[num].bufsize = size;
+        CBX(filedata)[num].pos = 0;
+        CBX(filedata)[num].rdct = left;
+        return true;
     }
+    if (CBX(filedata)[num].wvct > -1) {
+        if (!fileFlush(num)) return false;
+        nfree(CBX(filedata)[num].buf);
+        CBX(filedata)[num].buf = (size) ? malloc(size) : NULL;
+        CBX(filedata)[num].bufsize = size;
+        return true;
+    }
+    fflush(CBX(filedata)[num].fptr);
+    char* buf = (size) ? malloc(size) : NULL;
+    if (setvbuf(CBX(filedata)[num].fptr, buf, (size) ? _IOFBF : _IONBF, size)) {
+        nfree(buf);
+        return false;
+    }
+    nfree(CBX(filedata)[num].buf);
+    CBX(filedata)[num].buf = buf;
+    CBX(filedata)[num].bufsize = size;
     return true;
 }
 
@@ -2139,37 +6663,35 @@ static inline bool gvchkchar(char* tmp, int32_t i) {
     if (isSpChar(tmp[i + 1])) {
         if (tmp[i + 1] == '-') {
             if (isSpChar(tmp[i + 2])) {
-                cerr = 1; return false;
+                CBX(cerr) = 1; return false;
             }
         } else {
-            cerr = 1; return false;
+            CBX(cerr) = 1; return false;
         }
     } else {
         if (i > 0 && isSpChar(tmp[i - 1])) {
-            cerr = 1; return false;
+            CBX(cerr) = 1; return false;
         }
     }
     return true;
 }
 
-uint16_t getValIndex = 0;
-char* getVal_tmp[4] = {NULL, NULL, NULL, NULL};
 
 uint8_t getVal(char* inbuf, char* outbuf) {
     if (inbuf[0] == 0) {return 255;}
     char* tmp[4];
-    if (getValIndex) {
+    if (CBX(getValIndex)) {
         tmp[0] = malloc(CB_BUF_SIZE);
         tmp[1] = malloc(CB_BUF_SIZE);
         tmp[2] = malloc(CB_BUF_SIZE);
         tmp[3] = malloc(CB_BUF_SIZE);
     } else {
-        tmp[0] = getVal_tmp[0];
-        tmp[1] = getVal_tmp[1];
-        tmp[2] = getVal_tmp[2];
-        tmp[3] = getVal_tmp[3];
+        tmp[0] = CBX(getVal_tmp)[0];
+        tmp[1] = CBX(getVal_tmp)[1];
+        tmp[2] = CBX(getVal_tmp)[2];
+        tmp[3] = CBX(getVal_tmp)[3];
     }
-    getValIndex++;
+    CBX(getValIndex)++;
     int32_t ip = 0, jp = 0;
     uint8_t t = 0;
     uint8_t dt = 0;
@@ -2179,7 +6701,7 @@ uint8_t getVal(char* inbuf, char* outbuf) {
     register double num3 = 0;
     int numAct;
     bool* seenStr = NULL;
-    if ((isSpChar(inbuf[0]) && inbuf[0] != '-') || isSpChar(inbuf[strlen(inbuf) - 1])) {cerr = 1; dt = 0; goto gvreturn;}
+    if ((isSpChar(inbuf[0]) && inbuf[0] != '-') || isSpChar(inbuf[strlen(inbuf) - 1])) {CBX(cerr) = 1; dt = 0; goto gvreturn;}
     int pct = 0, bct = 0;
     tmp[0][0] = 0; tmp[1][0] = 0; tmp[2][0] = 0; tmp[3][0] = 0;
     seenStr = malloc(sizeof(bool));
@@ -2200,7 +6722,7 @@ uint8_t getVal(char* inbuf, char* outbuf) {
                 inStr = !inStr;
                 if (inStr && seenStr[pct]) {
                     dt = 0;
-                    cerr = 1;
+                    CBX(cerr) = 1;
                     goto gvreturn;
                 }
                 seenStr[pct] = true;
@@ -2224,7 +6746,7 @@ uint8_t getVal(char* inbuf, char* outbuf) {
                     if (t == 0) {dt = 0; goto gvreturn;}
                     if (dt == 0) dt = t;
                     if (t == 255) {t = 1; dt = 1;}
-                    if (t != dt) {cerr = 2; dt = 0; goto gvreturn;}
+                    if (t != dt) {CBX(cerr) = 2; dt = 0; goto gvreturn;}
                     copyStrFrom(inbuf, jp + 1, tmp[1]);
                     inbuf[ip] = 0;
                     if (t == 1) copyStrApndQ(tmp[0], inbuf);
@@ -2245,7 +6767,7 @@ uint8_t getVal(char* inbuf, char* outbuf) {
                 break;
         }
     }
-    if (pct || bct) {cerr = 1; dt = 0; goto gvreturn;}
+    if (pct || bct) {CBX(cerr) = 1; dt = 0; goto gvreturn;}
     ip = 0; jp = 0;
     tmp[0][0] = 0; tmp[1][0] = 0; tmp[2][0] = 0; tmp[3][0] = 0;
     while (1) {
@@ -2267,7 +6789,7 @@ uint8_t getVal(char* inbuf, char* outbuf) {
             jp++;
         }
         gvwhileexit1:;
-        if (inStr) {dt = 0; cerr = 1; goto gvreturn;}
+        if (inStr) {dt = 0; CBX(cerr) = 1; goto gvreturn;}
         copyStrSnip(inbuf, ip, jp, tmp[0]);
         t = getType(tmp[0]);
         if (t == 1) getStr(tmp[0], tmp[0]);
@@ -2281,9 +6803,9 @@ uint8_t getVal(char* inbuf, char* outbuf) {
             }
         }
         if (t && dt == 0) {dt = t;} else
-        if ((t && t != dt)) {cerr = 2; dt = 0; goto gvreturn;} else
-        if (t == 0) {cerr = 1; dt = 0; goto gvreturn;}
-        if ((dt == 1 && inbuf[jp] != '+') && inbuf[jp]) {cerr = 1; dt = 0; goto gvreturn;}
+        if ((t && t != dt)) {CBX(cerr) = 2; dt = 0; goto gvreturn;} else
+        if (t == 0) {CBX(cerr) = 1; dt = 0; goto gvreturn;}
+        if ((dt == 1 && inbuf[jp] != '+') && inbuf[jp]) {CBX(cerr) = 1; dt = 0; goto gvreturn;}
         if (t == 1) {copyStrSnip(tmp[0], 1, strlen(tmp[0]) - 1, tmp[2]); copyStrApnd(tmp[2], tmp[1]);} else
         if (t == 2) {
             if (inbuf[jp - 1]) copyStrFrom(inbuf, jp, tmp[1]);
@@ -2365,12 +6887,12 @@ uint8_t getVal(char* inbuf, char* outbuf) {
                 if (p2 == 0) {
                     if (p3 == 0) {
                         t = getType(tmp[0]);
-                        if (t == 0) {cerr = 1; dt = 0; goto gvreturn;} else
+                        if (t == 0) {CBX(cerr) = 1; dt = 0; goto gvreturn;} else
                         if (t == 255) {
                             t = getVar(tmp[0], tmp[0]);
                             if (t == 0) {dt = 0; goto gvreturn;}
                             if (t == 255) {t = 2; tmp[0][0] = '0'; tmp[0][1] = 0;}
-                            if (t != 2) {cerr = 2; dt = 0; goto gvreturn;}
+                            if (t != 2) {CBX(cerr) = 2; dt = 0; goto gvreturn;}
                         }
                     }
                     swap(tmp[0], tmp[1]);
@@ -2411,23 +6933,23 @@ uint8_t getVal(char* inbuf, char* outbuf) {
                 if (p1 != 0 && isSpChar(tmp[0][p1])) p1++;
                 copyStrSnip(tmp[0], p1, p2, tmp[2]);
                 t = getType(tmp[2]);
-                if (t == 0) {cerr = 1; dt = 0; goto gvreturn;} else
-                if (t == 255) {t = getVar(tmp[2], tmp[2]); if (t == 0) {dt = 0; goto gvreturn;} if (t != 2) {cerr = 2; dt = 0; goto gvreturn;}}
+                if (t == 0) {CBX(cerr) = 1; dt = 0; goto gvreturn;} else
+                if (t == 255) {t = getVar(tmp[2], tmp[2]); if (t == 0) {dt = 0; goto gvreturn;} if (t != 2) {CBX(cerr) = 2; dt = 0; goto gvreturn;}}
                 copyStrSnip(tmp[0], p2 + 1, p3, tmp[3]);
                 t = getType(tmp[3]);
-                if (t == 0) {cerr = 1; dt = 0; goto gvreturn;} else
-                if (t == 255) {t = getVar(tmp[3], tmp[3]); if (t == 0) {dt = 0; goto gvreturn;} if (t != 2) {cerr = 2; dt = 0; goto gvreturn;}}
-                if (!strcmp(tmp[2], ".")) {cerr = 1; dt = 0; goto gvreturn;}
+                if (t == 0) {CBX(cerr) = 1; dt = 0; goto gvreturn;} else
+                if (t == 255) {t = getVar(tmp[3], tmp[3]); if (t == 0) {dt = 0; goto gvreturn;} if (t != 2) {CBX(cerr) = 2; dt = 0; goto gvreturn;}}
+                if (!strcmp(tmp[2], ".")) {CBX(cerr) = 1; dt = 0; goto gvreturn;}
                 num1 = atof(tmp[2]);
-                if (!strcmp(tmp[2], ".")) {cerr = 1; dt = 0; goto gvreturn;}
+                if (!strcmp(tmp[2], ".")) {CBX(cerr) = 1; dt = 0; goto gvreturn;}
                 num2 = atof(tmp[3]);
                 switch (numAct) {
                     case 0: num3 = num1 + num2; break;
                     case 1: num3 = num1 - num2; break;
                     case 2: num3 = num1 * num2; break;
-                    case 3: if (num2 == 0) {cerr = 5; dt = 0; goto gvreturn;} num3 = num1 / num2; break;
+                    case 3: if (num2 == 0) {CBX(cerr) = 5; dt = 0; goto gvreturn;} num3 = num1 / num2; break;
                     case 4:;
-                        if (num1 == 0) {if (num2 == 0) {cerr = 5; dt = 0; goto gvreturn;} num3 = 0; break;}
+                        if (num1 == 0) {if (num2 == 0) {CBX(cerr) = 5; dt = 0; goto gvreturn;} num3 = 0; break;}
                         if (num2 == 0) {num3 = 1; break;}
                         num3 = pow(num1, num2);
                         break;
@@ -2456,7 +6978,7 @@ uint8_t getVal(char* inbuf, char* outbuf) {
     }
     gvfexit:;
     if (dt == 2) {
-        if (!strcmp(tmp[1], ".")) {cerr = 1; dt = 0; goto gvreturn;}
+        if (!strcmp(tmp[1], ".")) {CBX(cerr) = 1; dt = 0; goto gvreturn;}
         int32_t i = 0, j = strlen(tmp[1]) - 1;
         bool dp = false;
         while (tmp[1][i]) {if (tmp[1][i++] == '.') {dp = true; tmp[1][i + 6] = 0; break;}}
@@ -2473,24 +6995,24 @@ uint8_t getVal(char* inbuf, char* outbuf) {
     }
     if (outbuf[0] == 0 && dt != 1) {outbuf[0] = '0'; outbuf[1] = 0; dt = 2;}
     gvreturn:;
-    getValIndex--;
+    CBX(getValIndex)--;
     nfree(seenStr);
-    if (getValIndex) {nfree(tmp[0]); nfree(tmp[1]); nfree(tmp[2]); nfree(tmp[3]);}
+    if (CBX(getValIndex)) {nfree(tmp[0]); nfree(tmp[1]); nfree(tmp[2]); nfree(tmp[3]);}
     return dt;
 }
 
 static inline bool solvearg(int i) {
     if (i == 0) {
-        argt[0] = 0;
-        argl[0] = strlen(arg[0]);
+        CBX(argt)[0] = 0;
+        CBX(argl)[0] = strlen(CBX(arg)[0]);
         return true;
     }
-    argt[i] = 0;
-    arg[i] = realloc(arg[i], CB_BUF_SIZE);
-    argt[i] = getVal(arg[i], arg[i]);
-    if (argt[i] == 0) return false;
-    if (argt[i] == 255) {argt[i] = 0;}
-    argl[i] = strlen(arg[i]);
+    CBX(argt)[i] = 0;
+    CBX(arg)[i] = realloc(CBX(arg)[i], CB_BUF_SIZE);
+    CBX(argt)[i] = getVal(CBX(arg)[i], CBX(arg)[i]);
+    if (CBX(argt)[i] == 0) return false;
+    if (CBX(argt)[i] == 255) {CBX(argt)[i] = 0;}
+    CBX(argl)[i] = strlen(CBX(arg)[i]);
     return true;
 }
 
@@ -2540,7 +7062,7 @@ static inline int getArg(int num, char* inbuf, char* outbuf) {
             }
             if (inStr || inbuf[i] != ' ') {
                 if (!isExSpChar(inbuf[i])) sawSpChar = false;
-                if (lookingForSpChar) {outbuf[0] = 0; cerr = 1; return -1;}
+                if (lookingForSpChar) {outbuf[0] = 0; CBX(cerr) = 1; return -1;}
                 outbuf[len] = inbuf[i];
                 ++len;
             }
@@ -2575,7 +7097,7 @@ static inline int getArgO(int num, char* inbuf, char* outbuf, int32_t i) {
             }
             if (inStr || inbuf[i] != ' ') {
                 if (!isExSpChar(inbuf[i])) sawSpChar = false;
-                if (lookingForSpChar) {outbuf[0] = 0; cerr = 1; return -1;}
+                if (lookingForSpChar) {outbuf[0] = 0; CBX(cerr) = 1; return -1;}
                 outbuf[len] = inbuf[i];
                 ++len;
             }
@@ -2585,64 +7107,61 @@ static inline int getArgO(int num, char* inbuf, char* outbuf, int32_t i) {
     return i;
 }
 
-char tmpbuf[2][CB_BUF_SIZE];
 
 static inline void mkargs() {
     int32_t j = 0;
-    while (cmd[j] == ' ') {++j;}
+    while (CBX(cmd)[j] == ' ') {++j;}
     int32_t h = j;
     bool sccmd = false;
-    if (cmd[j] == '$' || cmd[j] == '@' || cmd[j] == '%') {
+    if (CBX(cmd)[j] == '$' || CBX(cmd)[j] == '@' || CBX(cmd)[j] == '%') {
         int32_t tmpj = j + 1;
-        while (cmd[tmpj] == ' ') {++tmpj;}
-        if (cmd[tmpj] != '=') sccmd = true;
+        while (CBX(cmd)[tmpj] == ' ') {++tmpj;}
+        if (CBX(cmd)[tmpj] != '=') sccmd = true;
     }
     if (!sccmd) {
-        while (cmd[h] != ' ' && cmd[h] != '=' && cmd[h]) {++h;}
+        while (CBX(cmd)[h] != ' ' && CBX(cmd)[h] != '=' && CBX(cmd)[h]) {++h;}
     }
-    copyStrFrom(cmd, (cmd[h]) ? h + 1 : h, tmpbuf[0]);
+    copyStrFrom(CBX(cmd), (CBX(cmd)[h]) ? h + 1 : h, CBX(runcmdbuf)[0]);
     if (!sccmd) {
         int32_t tmph = h;
-        while (cmd[tmph] == ' ' && cmd[tmph]) {++tmph;}
-        if (cmd[tmph] == '=') {
-            strcpy(tmpbuf[1], "SET ");
-            cmd[tmph] = ',';
-            copyStrApnd(cmd, tmpbuf[1]);
-            cmd = (char*)realloc(cmd, strlen(tmpbuf[1]) + 1);
-            copyStr(tmpbuf[1], cmd);
-            copyStr(tmpbuf[1], tmpbuf[0]);
-            tmpbuf[1][0] = 0;
+        while (CBX(cmd)[tmph] == ' ' && CBX(cmd)[tmph]) {++tmph;}
+        if (CBX(cmd)[tmph] == '=') {
+            strcpy(CBX(runcmdbuf)[1], "SET ");
+            CBX(cmd)[tmph] = ',';
+            copyStrApnd(CBX(cmd), CBX(runcmdbuf)[1]);
+            CBX(cmd) = (char*)realloc(CBX(cmd), strlen(CBX(runcmdbuf)[1]) + 1);
+            copyStr(CBX(runcmdbuf)[1], CBX(cmd));
+            copyStr(CBX(runcmdbuf)[1], CBX(runcmdbuf)[0]);
+            CBX(runcmdbuf)[1][0] = 0;
             h = 3;
             j = 0;
         }
     }
-    for (int i = 0; i <= argct; ++i) {
-        nfree(arg[i]);
+    for (int i = 0; i <= CBX(argct); ++i) {
+        nfree(CBX(arg)[i]);
     }
-    argct = getArgCt(tmpbuf[0]);
-    arg = (char**)realloc(arg, (argct + 1) * sizeof(char*));
-    argt = (uint8_t*)realloc(argt, (argct + 1) * sizeof(uint8_t));
-    argl = (int32_t*)realloc(argl, (argct + 1) * sizeof(int32_t));
+    CBX(argct) = getArgCt(CBX(runcmdbuf)[0]);
+    CBX(arg) = (char**)realloc(CBX(arg), (CBX(argct) + 1) * sizeof(char*));
+    CBX(argt) = (uint8_t*)realloc(CBX(argt), (CBX(argct) + 1) * sizeof(uint8_t));
+    CBX(argl) = (int32_t*)realloc(CBX(argl), (CBX(argct) + 1) * sizeof(int32_t));
     int32_t gptr = 0;
-    copyStrSnip(cmd, j, ((sccmd) ? h + 1 : h), tmpbuf[0]);
-    argl[0] = strlen(tmpbuf[0]);
-    arg[0] = malloc(argl[0] + 1);
-    copyStr(tmpbuf[0], arg[0]);
-    copyStrFrom(cmd, (h >= argl[0]) ? argl[0] : h + 1, tmpbuf[0]);
-    for (int i = 1; i <= argct; ++i) {
-        int32_t ngptr = getArgO(i - 1, tmpbuf[0], tmpbuf[1], gptr);
+    copyStrSnip(CBX(cmd), j, ((sccmd) ? h + 1 : h), CBX(runcmdbuf)[0]);
+    CBX(argl)[0] = strlen(CBX(runcmdbuf)[0]);
+    CBX(arg)[0] = malloc(CBX(argl)[0] + 1);
+    copyStr(CBX(runcmdbuf)[0], CBX(arg)[0]);
+    copyStrFrom(CBX(cmd), (h >= CBX(argl)[0]) ? CBX(argl)[0] : h + 1, CBX(runcmdbuf)[0]);
+    for (int i = 1; i <= CBX(argct); ++i) {
+        int32_t ngptr = getArgO(i - 1, CBX(runcmdbuf)[0], CBX(runcmdbuf)[1], gptr);
         if (ngptr == -1) return;
-        argl[i] = ngptr - gptr;
+        CBX(argl)[i] = ngptr - gptr;
         gptr = ngptr;
-        arg[i] = malloc(argl[i] + 1);
-        copyStr(tmpbuf[1], arg[i]);
-        arg[i][argl[i]] = 0;
+        CBX(arg)[i] = malloc(CBX(argl)[i] + 1);
+        copyStr(CBX(runcmdbuf)[1], CBX(arg)[i]);
+        CBX(arg)[i][CBX(argl)[i]] = 0;
     }
-    if (argct == 1 && arg[1][0] == 0) {argct = 0;}
+    if (CBX(argct) == 1 && CBX(arg)[1][0] == 0) {CBX(argct) = 0;}
 }
 
-char* lttmp_tmp[3];
-int logictestexpr_index = 0;
 
 static inline uint8_t logictestexpr(char* inbuf) {
     int32_t tmpp = 0;
@@ -2655,18 +7174,18 @@ static inline uint8_t logictestexpr(char* inbuf) {
     int pct = 0, bct = 0;
     int ret = 255;
     char* lttmp[3];
-    if (!logictestexpr_index) {
-        lttmp[0] = lttmp_tmp[0];
-        lttmp[1] = lttmp_tmp[1];
-        lttmp[2] = lttmp_tmp[2];
+    if (!CBX(logictestexpr_index)) {
+        lttmp[0] = CBX(lttmp_tmp)[0];
+        lttmp[1] = CBX(lttmp_tmp)[1];
+        lttmp[2] = CBX(lttmp_tmp)[2];
     } else {
         lttmp[0] = malloc(CB_BUF_SIZE);
         lttmp[1] = malloc(CB_BUF_SIZE);
         lttmp[2] = malloc(CB_BUF_SIZE);
     }
-    ++logictestexpr_index;
+    ++CBX(logictestexpr_index);
     while (inbuf[p] == ' ') {++p;}
-    if (!inbuf[p]) {cerr = 10; goto ltreturn;}
+    if (!inbuf[p]) {CBX(cerr) = 10; goto ltreturn;}
     bool ltskip = false;
     for (int32_t i = p; inbuf[i]; ++i) {
         if (!inStr) {
@@ -2686,7 +7205,7 @@ static inline uint8_t logictestexpr(char* inbuf) {
         }
         if (inStr || inbuf[i] != ' ') {
             if (!isExSpChar(inbuf[i])) sawSpChar = false;
-            if (lookingForSpChar) {cerr = 1; goto ltreturn;}
+            if (lookingForSpChar) {CBX(cerr) = 1; goto ltreturn;}
             lttmp[0][tmpp] = inbuf[i]; tmpp++;
         }
     }
@@ -2694,7 +7213,7 @@ static inline uint8_t logictestexpr(char* inbuf) {
     if (ltskip) goto ltskipget;
     tmpp = 0;
     for (int32_t i = p; true; ++i) {
-        if (tmpp > 2) {cerr = 1; goto ltreturn;}
+        if (tmpp > 2) {CBX(cerr) = 1; goto ltreturn;}
         if (inbuf[i] != '<' && inbuf[i] != '=' && inbuf[i] != '>') {p = i; break;} else
         {lttmp[1][tmpp] = inbuf[i]; tmpp++;}
     }
@@ -2715,7 +7234,7 @@ static inline uint8_t logictestexpr(char* inbuf) {
             }
         }
         if (inbuf[i] == '"') {inStr = !inStr;}
-        if (inbuf[i] == 0) {cerr = 1; goto ltreturn;}
+        if (inbuf[i] == 0) {CBX(cerr) = 1; goto ltreturn;}
         if ((inbuf[i] == '<' || inbuf[i] == '=' || inbuf[i] == '>') && !inStr && pct == 0 && bct == 0) {p = i; break;}
         if (!inStr && pct == 0 && bct == 0) {
             if (inbuf[i] == ' ' && !sawSpChar) {lookingForSpChar = true;}
@@ -2723,23 +7242,23 @@ static inline uint8_t logictestexpr(char* inbuf) {
         }
         if (inStr || inbuf[i] != ' ') {
             if (!isExSpChar(inbuf[i])) sawSpChar = false;
-            if (lookingForSpChar) {cerr = 1; goto ltreturn;}
+            if (lookingForSpChar) {CBX(cerr) = 1; goto ltreturn;}
             lttmp[2][tmpp] = inbuf[i]; tmpp++;
         }
     }
     lttmp[2][tmpp] = 0;
     t2 = getVal(lttmp[2], lttmp[2]);
     if (t2 == 0) goto ltreturn;
-    if (t2 == 255) {cerr = 1; goto ltreturn;}
+    if (t2 == 255) {CBX(cerr) = 1; goto ltreturn;}
     ltskipget:;
     t1 = getVal(lttmp[0], lttmp[0]);
     if (t1 == 0) goto ltreturn;
-    if (t1 == 255) {cerr = 1; goto ltreturn;}
+    if (t1 == 255) {CBX(cerr) = 1; goto ltreturn;}
     if (t2 == 255) {
         t2 = t1;
         if (t2 != 1) copyStr("0", lttmp[2]);
     }
-    if (t1 != t2) {cerr = 2; goto ltreturn;}
+    if (t1 != t2) {CBX(cerr) = 2; goto ltreturn;}
     if (!strcmp(lttmp[1], "=")) {
         ret = (uint8_t)(bool)!strcmp(lttmp[0], lttmp[2]);
         goto ltreturn;
@@ -2747,52 +7266,52 @@ static inline uint8_t logictestexpr(char* inbuf) {
         ret = (uint8_t)(bool)strcmp(lttmp[0], lttmp[2]);
         goto ltreturn;
     } else if (!strcmp(lttmp[1], ">")) {
-        if (t1 == 1) {cerr = 2; goto ltreturn;}
+        if (t1 == 1) {CBX(cerr) = 2; goto ltreturn;}
         double num1, num2;
         sscanf(lttmp[0], "%lf", &num1);
         sscanf(lttmp[2], "%lf", &num2);
         ret = num1 > num2;
         goto ltreturn;
     } else if (!strcmp(lttmp[1], "<")) {
-        if (t1 == 1) {cerr = 2; goto ltreturn;}
+        if (t1 == 1) {CBX(cerr) = 2; goto ltreturn;}
         double num1, num2;
         sscanf(lttmp[0], "%lf", &num1);
         sscanf(lttmp[2], "%lf", &num2);
         ret = num1 < num2;
         goto ltreturn;
     } else if (!strcmp(lttmp[1], ">=")) {
-        if (t1 == 1) {cerr = 2; goto ltreturn;}
+        if (t1 == 1) {CBX(cerr) = 2; goto ltreturn;}
         double num1, num2;
         sscanf(lttmp[0], "%lf", &num1);
         sscanf(lttmp[2], "%lf", &num2);
         ret = num1 >= num2;
         goto ltreturn;
     } else if (!strcmp(lttmp[1], "<=")) {
-        if (t1 == 1) {cerr = 2; goto ltreturn;}
+        if (t1 == 1) {CBX(cerr) = 2; goto ltreturn;}
         double num1, num2;
         sscanf(lttmp[0], "%lf", &num1);
         sscanf(lttmp[2], "%lf", &num2);
         ret = num1 <= num2;
         goto ltreturn;
     } else if (!strcmp(lttmp[1], "=>")) {
-        if (t1 == 1) {cerr = 2; goto ltreturn;}
+        if (t1 == 1) {CBX(cerr) = 2; goto ltreturn;}
         double num1, num2;
         sscanf(lttmp[0], "%lf", &num1);
         sscanf(lttmp[2], "%lf", &num2);
         ret = num1 >= num2;
         goto ltreturn;
     } else if (!strcmp(lttmp[1], "=<")) {
-        if (t1 == 1) {cerr = 2; goto ltreturn;}
+        if (t1 == 1) {CBX(cerr) = 2; goto ltreturn;}
         double num1, num2;
         sscanf(lttmp[0], "%lf", &num1);
         sscanf(lttmp[2], "%lf", &num2);
         ret = num1 <= num2;
         goto ltreturn;
     }
-    cerr = 1;
+    CBX(cerr) = 1;
     ltreturn:;
-    --logictestexpr_index;
-    if (logictestexpr_index) {
+    --CBX(logictestexpr_index);
+    if (CBX(logictestexpr_index)) {
         nfree(lttmp[0]);
         nfree(lttmp[1]);
         nfree(lttmp[2]);
@@ -2800,8 +7319,6 @@ static inline uint8_t logictestexpr(char* inbuf) {
     return ret;
 }
 
-char* ltbuf_tmp = NULL;
-int logictest_index = 0;
 
 uint8_t logictest(char* inbuf) {
     bool inStr = false;
@@ -2810,12 +7327,12 @@ uint8_t logictest(char* inbuf) {
     uint8_t ret = 0, out = 0;
     uint8_t logicActOld = 0;
     char* ltbuf;
-    if (!logictest_index) {
-        ltbuf = ltbuf_tmp;
+    if (!CBX(logictest_index)) {
+        ltbuf = CBX(ltbuf_tmp);
     } else {
         ltbuf = malloc(CB_BUF_SIZE);
     }
-    ++logictest_index;
+    ++CBX(logictest_index);
     while (inbuf[i]) {
         uint8_t logicAct = 0;
         for (;inbuf[j] && !logicAct; ++j) {
@@ -2847,101 +7364,100 @@ uint8_t logictest(char* inbuf) {
         }
         if (!inbuf[j]) break;
         i = ++j;
-        if (!inbuf[i]) {if (inbuf[j - 1] == '|' || inbuf[j - 1] == '&') {cerr = 10; out = 255;} break;}
+        if (!inbuf[i]) {if (inbuf[j - 1] == '|' || inbuf[j - 1] == '&') {CBX(cerr) = 10; out = 255;} break;}
         logicActOld = logicAct;
     }
     ltexit:;
-    --logictest_index;
-    if (logictest_index) nfree(ltbuf);
+    --CBX(logictest_index);
+    if (CBX(logictest_index)) nfree(ltbuf);
     return out;
 }
 
-char ltmp[2][CB_BUF_SIZE];
 
 bool runlogic() {
-    ltmp[0][0] = 0; ltmp[1][0] = 0;
+    CBX(ltmp)[0][0] = 0; CBX(ltmp)[1][0] = 0;
     int32_t i = 0;
-    while (cmd[i] == ' ') {++i;}
+    while (CBX(cmd)[i] == ' ') {++i;}
     int32_t j = i;
-    while (cmd[j] != ' ' && cmd[j]) {++j;}
+    while (CBX(cmd)[j] != ' ' && CBX(cmd)[j]) {++j;}
     int32_t h = j;
-    while (cmd[h] == ' ') {++h;}
-    if (cmd[h] == '=') return false;
-    copyStrSnip(cmd, i, j, ltmp[0]);
-    if (isLineNumber(ltmp[0])) {
+    while (CBX(cmd)[h] == ' ') {++h;}
+    if (CBX(cmd)[h] == '=') return false;
+    copyStrSnip(CBX(cmd), i, j, CBX(ltmp)[0]);
+    if (isLineNumber(CBX(ltmp)[0])) {
         int tmp = -1;
-        for (int j = 0; j < gotomaxct; ++j) {
-            if (!gotodata[j].used) {tmp = j; break;}
-            else if (!strcmp(gotodata[j].name, ltmp[0])) {
-                if (gotodata[j].cp == cmdpos) {goto skiplbl;}
-                cerr = 28; return true;
+        for (int j = 0; j < CBX(gotomaxct); ++j) {
+            if (!CBX(gotodata)[j].used) {tmp = j; break;}
+            else if (!strcmp(CBX(gotodata)[j].name, CBX(ltmp)[0])) {
+                if (CBX(gotodata)[j].cp == CBX(cmdpos)) {goto skiplbl;}
+                CBX(cerr) = 28; return true;
             }
         }
         if (tmp == -1) {
-            tmp = gotomaxct;
-            ++gotomaxct;
-            gotodata = realloc(gotodata, gotomaxct * sizeof(cb_goto));
-        }
-        gotodata[tmp].name = malloc(strlen(ltmp[0]) + 1);
-        copyStr(ltmp[0], gotodata[tmp].name);
-        gotodata[tmp].cp = cmdpos;
-        gotodata[tmp].pl = progLine;
-        gotodata[tmp].used = true;
-        gotodata[tmp].dlsp = dlstackp;
-        gotodata[tmp].fnsp = fnstackp;
-        gotodata[tmp].itsp = itstackp;
+            tmp = CBX(gotomaxct);
+            ++CBX(gotomaxct);
+            CBX(gotodata) = realloc(CBX(gotodata), CBX(gotomaxct) * sizeof(cb_goto));
+        }
+        CBX(gotodata)[tmp].name = malloc(strlen(CBX(ltmp)[0]) + 1);
+        copyStr(CBX(ltmp)[0], CBX(gotodata)[tmp].name);
+        CBX(gotodata)[tmp].cp = CBX(cmdpos);
+        CBX(gotodata)[tmp].pl = CBX(progLine);
+        CBX(gotodata)[tmp].used = true;
+        CBX(gotodata)[tmp].dlsp = CBX(dlstackp);
+        CBX(gotodata)[tmp].fnsp = CBX(fnstackp);
+        CBX(gotodata)[tmp].itsp = CBX(itstackp);
         skiplbl:;
-        while (cmd[i] != ' ' && cmd[i]) {++i;}
-        while (cmd[i] == ' ') {++i;}
+        while (CBX(cmd)[i] != ' ' && CBX(cmd)[i]) {++i;}
+        while (CBX(cmd)[i] == ' ') {++i;}
         j = i;
-        while (cmd[j] != ' ' && cmd[j]) {++j;}
+        while (CBX(cmd)[j] != ' ' && CBX(cmd)[j]) {++j;}
         h = j;
-        while (cmd[h] == ' ') {++h;}
-        copyStrSnip(cmd, i, j, ltmp[0]);
-        copyStrFrom(cmd, i, cmd);
+        while (CBX(cmd)[h] == ' ') {++h;}
+        copyStrSnip(CBX(cmd), i, j, CBX(ltmp)[0]);
+        copyStrFrom(CBX(cmd), i, CBX(cmd));
         j -= i;
         i = 0;
     }
-    cerr = 0;
-    chkCmdPtr = ltmp[0];
+    CBX(cerr) = 0;
+    CBX(chkCmdPtr) = CBX(ltmp)[0];
     #include "logic.c"
     return false;
 }
 
 static inline void initBaseMem() {
-    getVal_tmp[0] = malloc(CB_BUF_SIZE);
-    getVal_tmp[1] = malloc(CB_BUF_SIZE);
-    getVal_tmp[2] = malloc(CB_BUF_SIZE);
-    getVal_tmp[3] = malloc(CB_BUF_SIZE);
-    getFunc_gftmp[0] = malloc(CB_BUF_SIZE);
-    getFunc_gftmp[1] = malloc(CB_BUF_SIZE);
-    bfnbuf = malloc(CB_BUF_SIZE);
-    ltbuf_tmp = malloc(CB_BUF_SIZE);
-    lttmp_tmp[0] = malloc(CB_BUF_SIZE);
-    lttmp_tmp[1] = malloc(CB_BUF_SIZE);
-    lttmp_tmp[2] = malloc(CB_BUF_SIZE);
-    getVarBuf = malloc(CB_BUF_SIZE);
+    CBX(getVal_tmp)[0] = malloc(CB_BUF_SIZE);
+    CBX(getVal_tmp)[1] = malloc(CB_BUF_SIZE);
+    CBX(getVal_tmp)[2] = malloc(CB_BUF_SIZE);
+    CBX(getVal_tmp)[3] = malloc(CB_BUF_SIZE);
+    CBX(getFunc_gftmp)[0] = malloc(CB_BUF_SIZE);
+    CBX(getFunc_gftmp)[1] = malloc(CB_BUF_SIZE);
+    CBX(bfnbuf) = malloc(CB_BUF_SIZE);
+    CBX(ltbuf_tmp) = malloc(CB_BUF_SIZE);
+    CBX(lttmp_tmp)[0] = malloc(CB_BUF_SIZE);
+    CBX(lttmp_tmp)[1] = malloc(CB_BUF_SIZE);
+    CBX(lttmp_tmp)[2] = malloc(CB_BUF_SIZE);
+    CBX(getVarBuf) = malloc(CB_BUF_SIZE);
 }
 
 static inline void freeBaseMem() {
-    nfree(getVal_tmp[0]);
-    nfree(getVal_tmp[1]);
-    nfree(getVal_tmp[2]);
-    nfree(getVal_tmp[3]);
-    nfree(getFunc_gftmp[0]);
-    nfree(getFunc_gftmp[1]);
-    nfree(bfnbuf);
-    nfree(ltbuf_tmp);
-    nfree(lttmp_tmp[0]);
-    nfree(lttmp_tmp[1]);
-    nfree(lttmp_tmp[2]);
-    nfree(getVarBuf);
+    nfree(CBX(getVal_tmp)[0]);
+    nfree(CBX(getVal_tmp)[1]);
+    nfree(CBX(getVal_tmp)[2]);
+    nfree(CBX(getVal_tmp)[3]);
+    nfree(CBX(getFunc_gftmp)[0]);
+    nfree(CBX(getFunc_gftmp)[1]);
+    nfree(CBX(bfnbuf));
+    nfree(CBX(ltbuf_tmp));
+    nfree(CBX(lttmp_tmp)[0]);
+    nfree(CBX(lttmp_tmp)[1]);
+    nfree(CBX(lttmp_tmp)[2]);
+    nfree(CBX(getVarBuf));
 }
 
 static inline void printError(int error) {
     getCurPos();
     if (curx != 1) putchar('\n');
-    if (inProg) {printf("Error %d on line %d of '%s':\n%s\n", error, progLine, basefilename(progfnstr), cmd);}
+    if (CBX(inProg)) {printf("Error %d on line %d of '%s':\n%s\n", error, CBX(progLine), basefilename(progfnstr), CBX(cmd));}
     else {printf("Error %d: ", error);}
     switch (error) {
         default:;
@@ -2957,7 +7473,7 @@ static inline void printError(int error) {
             fputs("Argument count mismatch", stdout);
             break;
         case 4:;
-            printf("Invalid variable name or identifier: '%s'", errstr);
+            printf("Invalid variable name or identifier: '%s'", CBX(errstr));
             break;
         case 5:;
             fputs("Operation resulted in undefined", stdout);
@@ -2990,13 +7506,13 @@ static inline void printError(int error) {
             fputs("Reached FOR limit", stdout);
             break;
         case 15:;
-            printf("File or directory not found: '%s'", errstr);
+            printf("File or directory not found: '%s'", CBX(errstr));
             break;
         case 16:;
             fputs("Invalid data or data range exceeded", stdout);
             break;
         case 17:;
-            printf("Cannot change to directory '%s' (errno: [%d] %s)", errstr, errno, strerror(errno));
+            printf("Cannot change to directory '%s' (errno: [%d] %s)", CBX(errstr), errno, strerror(errno));
             break;
         case 18:;
             fputs("Expected file instead of directory", stdout);
@@ -3008,16 +7524,16 @@ static inline void printError(int error) {
             fputs("File or directory error", stdout);
             break;
         case 21:;
-            printf("Permission error: '%s'", errstr);
+            printf("Permission error: '%s'", CBX(errstr));
             break;
         case 22:;
-            printf("Array index out of bounds: '%s'", errstr);
+            printf("Array index out of bounds: '%s'", CBX(errstr));
             break;
         case 23:;
-            printf("Variable is not an array: '%s'", errstr);
+            printf("Variable is not an array: '%s'", CBX(errstr));
             break;
         case 24:;
-            printf("Variable is an array: '%s'", errstr);
+            printf("Variable is an array: '%s'", CBX(errstr));
             break;
         case 25:;
             fputs("Array is already dimensioned", stdout);
@@ -3026,7 +7542,7 @@ static inline void printError(int error) {
             fputs("Memory error", stdout);
             break;
         case 27:;
-            printf("Failed to open file: '%s' (errno: [%d] %s)", errstr, errno, strerror(errno));
+            printf("Failed to open file: '%s' (errno: [%d] %s)", CBX(errstr), errno, strerror(errno));
             break;
         case 28:;
             fputs("Label is already defined", stdout);
@@ -3044,37 +7560,43 @@ static inline void printError(int error) {
             fputs("Reached GOSUB limit", stdout);
             break;
         case 33:;
-            printf("Failed to open library: '%s'", errstr);
+            printf("Failed to open library: '%s'", CBX(errstr));
             #ifndef _WIN32
             printf(" (%s)", dlerror());
             #endif
             break;
         case 34:;
-            printf("Not a CLIBASIC extension: '%s'", errstr);
+            printf("Not a CLIBASIC extension: '%s'", CBX(errstr));
             break;
         case 35:;
-            printf("Failed to initialize extension: '%s'", errstr);
+            printf("Failed to initialize extension: '%s'", CBX(errstr));
             break;
         case 36:;
-            printf("Extension already loaded: '%s'", errstr);
+            printf("Extension already loaded: '%s'", CBX(errstr));
+            break;
+        case 37:;
+            fputs("PARFOR without NEXT", stdout);
+            break;
+        case 38:;
+            printf("Array is shared with PARFOR: '%s'", CBX(errstr));
             break;
         case 125:;
-            printf("Function only valid in program: '%s'", errstr);
+            printf("Function only valid in program: '%s'", CBX(errstr));
             break;
         case 126:;
-            printf("Function not valid in program: '%s'", errstr);
+            printf("Function not valid in program: '%s'", CBX(errstr));
             break;
         case 127:;
-            printf("Not a function: '%s'", errstr);
+            printf("Not a function: '%s'", CBX(errstr));
             break;
         case 253:;
-            printf("Command only valid in program: '%s'", arg[0]);
+            printf("Command only valid in program: '%s'", CBX(arg)[0]);
             break;
         case 254:;
-            printf("Command not valid in program: '%s'", arg[0]);
+            printf("Command not valid in program: '%s'", CBX(arg)[0]);
             break;
         case 255:;
-            printf("Not a command: '%s'", arg[0]);
+            printf("Not a command: '%s'", CBX(arg)[0]);
             break;
     }
     putchar('\n');
@@ -3087,11 +7609,11 @@ int loadExt(char* path) {
     #else
     void* lib = LoadLibrary(path);
     #endif
-    if (!lib) {cerr = 33; return -1;}
+    if (!lib) {CBX(cerr) = 33; return -1;}
     char* oextname = (void*)dlsym(lib, "cbext_name");
     bool (*cbext_init)(cb_extargs) = (void*)dlsym(lib, "cbext_init");
-    if (!oextname | !cbext_init) {cerr = 34; goto loadfail;}
-    if (!oextname[0]) {cerr = 34; goto loadfail;}
+    if (!oextname | !cbext_init) {CBX(cerr) = 34; goto loadfail;}
+    if (!oextname[0]) {CBX(cerr) = 34; goto loadfail;}
     int e = -1;
     char* extname = (char*)malloc(strlen(oextname) + 1);
     copyStr(oextname, extname);
@@ -3099,7 +7621,7 @@ int loadExt(char* path) {
     for (register int i = 0; i < extmaxct; ++i) {
         if (extdata[i].inuse && !strcmp(extname, extdata[i].name)) {
             seterrstr(extname);
-            cerr = 36;
+            CBX(cerr) = 36;
             goto loadfail;
         }
     }
@@ -3108,10 +7630,10 @@ int loadExt(char* path) {
     }
     cb_extargs extargs = {
         VER, BVER, OSVER,
-        &cerr, &retval, &fileerror,
-        &varmaxct, vardata,
-        &filemaxct, filedata,
-        &chkCmdPtr,
+        &CBX(cerr), &CBX(retval), &CBX(fileerror),
+        &CBX(varmaxct), CBX(vardata),
+        &CBX(filemaxct), CBX(filedata),
+        &CBX(chkCmdPtr),
         &txtattrib,
         &curx, &cury,
         startcmd, roptstr,
@@ -3131,9 +7653,13 @@ int loadExt(char* path) {
         getVal,
         solvearg,
         logictest,
-        printError
+        printError,
+        getCtx, setCtx,
+        CB_EXT_API
     };
-    if (!cbext_init(extargs)) {cerr = 35; goto loadfail;}
+    int* extapi = (void*)dlsym(lib, "cbext_api");
+    if (extapi && *extapi != CB_EXT_API) {CBX(cerr) = 35; goto loadfail;}
+    if (!cbext_init(extargs)) {CBX(cerr) = 35; goto loadfail;}
     if (e == -1) {
         e = extmaxct;
         ++extmaxct;
@@ -3167,7 +7693,7 @@ bool unloadExt(int e) {
         free(extdata);
         extmaxct = 0;
     } else {
-        if (e < -1 || e >= extmaxct || !extdata[e].inuse) {cerr = 16; return false;}
+        if (e < -1 || e >= extmaxct || !extdata[e].inuse) {CBX(cerr) = 16; return false;}
         if (extdata[e].deinit) extdata[e].deinit();
         extdata[e].inuse = false;
         nfree(extdata[e].name);
@@ -3182,44 +7708,45 @@ bool unloadExt(int e) {
 }
 
 void runcmd() {
-    if (cmd[0] == 0) return;
-    cerr = 0;
+    if (CBX(cmd)[0] == 0) return;
+    CBX(cerr) = 0;
     bool lgc = runlogic();
     if (lgc) goto cmderr;
-    if (cmd[0] == 0) return;
+    if (CBX(cmd)[0] == 0) return;
     int32_t tmpi = 0;
-    while (cmd[tmpi] && cmd[tmpi] != ' ') {tmpi++;}
-    if (!cmd[tmpi]) tmpi = -1;
-    if (tmpi > -1) cmd[tmpi] = 0;
-    chkCmdPtr = cmd;
-    if (!chkCmd(2, "LABEL", "LBL") && cmd[0] != '@') {
-        if (tmpi > -1) cmd[tmpi] = ' ';
-        if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {if (dldcmd[dlstackp]) return;}
-        if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {if (itdcmd[itstackp]) return;}
-        if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {if (fndcmd[fnstackp]) return;}
-    }
-    if (tmpi > -1) cmd[tmpi] = ' ';
+    while (CBX(cmd)[tmpi] && CBX(cmd)[tmpi] != ' ') {tmpi++;}
+    if (!CBX(cmd)[tmpi]) tmpi = -1;
+    if (tmpi > -1) CBX(cmd)[tmpi] = 0;
+    CBX(chkCmdPtr) = CBX(cmd);
+    if (!chkCmd(2, "LABEL", "LBL") && CBX(cmd)[0] != '@') {
+        if (tmpi > -1) CBX(cmd)[tmpi] = ' ';
+        if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {if (CBX(dldcmd)[CBX(dlstackp)]) return;}
+        if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {if (CBX(itdcmd)[CBX(itstackp)]) return;}
+        if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {if (CBX(fndcmd)[CBX(fnstackp)]) return;}
+    }
+    if (tmpi > -1) CBX(cmd)[tmpi] = ' ';
     mkargs();
-    if (cerr) goto cmderr;
+    if (CBX(cerr)) goto cmderr;
     solvearg(0);
-    cerr = 255;
-    chkCmdPtr = arg[0];
+    CBX(cerr) = 255;
+    CBX(chkCmdPtr) = CBX(arg)[0];
     #include "commands.c"
     cmderr:;
-    if (cerr) {
-        err = 0;
-        if (runc || runfile) err = 1;
-        printError(cerr);
-        cp = -1;
-        concp = -1;
-        chkinProg = inProg = false;
+    if (CBX(cerr)) {
+        CBX(err) = 0;
+        if (runc || runfile) CBX(err) = 1;
+        printError(CBX(cerr));
+        CBX(lasterr) = CBX(cerr);
+        CBX(cp) = -1;
+        if (cbctx == &cbmainctx) concp = -1;
+        CBX(chkinProg) = CBX(inProg) = false;
     }
     noerr:;
     if (lgc) return;
-    for (int i = 0; i <= argct; ++i) {
-        nfree(arg[i]);
+    for (int i = 0; i <= CBX(argct); ++i) {
+        nfree(CBX(arg)[i]);
     }
-    argct = 0;
+    CBX(argct) = 0;
     return;
 }
 
@@ -47,6 +47,11 @@
 //     Clean up extension before exiting
 // 
 // 
+//   int cbext_api
+//     Set to CB_EXT_API so CLIBASIC can refuse to load an extension built against an
+//     incompatible version of this header
+// 
+// 
 // Notes:
 //   - It is a good idea to make all commands and functions adhere to '[Extension].[Cmd/Func]'
 //     (unless overriding internal CLIBASIC commands or functions) to avoid naming conflicts.
@@ -60,6 +65,10 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#define CB_EXT_API 9 // bumped when the layout of a shared struct changes (9: proc dropped from cb_file)
+
+typedef struct cb_ctx cb_ctx; // interpreter state of one running program, opaque to extensions
+
 typedef struct {
     bool inuse;   // true if the spot is in use, false otherwise
     char* name;   // name of the variable
@@ -70,7 +79,17 @@ typedef struct {
 
 typedef struct {
     FILE* fptr;   // pointer to FILE* struct to read from and write to the file
-    int32_t size; // file size at open
+    int64_t size; // file size, refreshed with fstat by FSIZE, FSEEK, and EOFD
+    char* buf;    // stdio buffer assigned with setvbuf, the writes queued in "v" mode, or the reads of a stream
+    char* map;    // read-only mapping of the file when opened with "m", NULL otherwise
+    int64_t pos;  // read position in map, the read-ahead ring, or buf for streams
+    int32_t bufsize; // size of buf
+    int wvct;     // number of bytes queued in buf in "v" mode, -1 if the file was not opened with "v"
+    int32_t rdct; // number of bytes read into buf for pipes, sockets, and terminals (streams), -1 for other files
+    void* ra;     // read-ahead thread state when opened with "p", NULL otherwise
+    int32_t reclen; // record length when opened with FOPENREC, 0 otherwise
+    void* rc;     // record page cache when opened with FOPENREC, NULL if disabled
+    bool sock;    // true for sockets from FOPEN "s", LISTEN, and ACCEPT, fptr only reads
 } cb_file;
 
 typedef struct {
@@ -148,4 +167,7 @@ typedef struct {
     bool (*solvearg)(int);                          // solves an argument for commands as some commands may want to read from raw input
     uint8_t (*logictest)(char*);                    // takes raw input, tests it, and returns -1 on failure, 0 if false, and 1 if true
     void (*printError)(int);                        // prints a built-in error string
+    cb_ctx* (*getCtx)(void);                        // returns the context bound to the calling thread (the pointers above belong to the context that loaded the extension)
+    void (*setCtx)(cb_ctx*);                        // binds a context to the calling thread before calling back into CLIBASIC from a thread CLIBASIC did not start (NULL binds the main context)
+    int api;                                        // CB_EXT_API of the running CLIBASIC
 } cb_extargs;
@@ -1,306 +1,433 @@
 int extcerr = 255;
 for (int i = extmaxct - 1; i > -1; --i) {
     if (extdata[i].inuse && extdata[i].runcmd) {
-        extcerr = extdata[i].runcmd(argct, arg, argt, argl);
+        extcerr = extdata[i].runcmd(CBX(argct), CBX(arg), CBX(argt), CBX(argl));
         if (extcerr != 255) {
-            cerr = extcerr;
+            CBX(cerr) = extcerr;
             if (!extcerr) goto noerr;
             else goto cmderr;
         }
     }
 }
-if (chkCmdPtr[0] == '_') goto _cmd;
+if (CBX(chkCmdPtr)[0] == '_') goto _cmd;
 if (chkCmd(2, "EXIT", "QUIT")) {
-    if (argct > 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    err = 0;
-    if (argct == 1) {
+    if (CBX(argct) > 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(err) = 0;
+    if (CBX(argct) == 1) {
         if (!solvearg(1)) goto cmderr;
-        err = atoi(arg[1]);
+        CBX(err) = atoi(CBX(arg)[1]);
         if (runfile) {
-            retval = err;
+            CBX(retval) = CBX(err);
         }
     } else {
-        err = 0;
-    }
-    if (inProg) {
-        if (progindex > 0) unloadProg();
-        else cmdint = true;
-        retval = err;
+        CBX(err) = 0;
+    }
+    if (CBX(inProg)) {
+        if (CBX(progindex) > 0) unloadProg();
+        else if (cbctx == &cbmainctx) cmdint = true;
+        else CBX(cp) = -1;
+        CBX(retval) = CBX(err);
+        CBX(exitcode) = CBX(err);
     } else {
         cleanExit();
     }
     goto cmderr;
 }
 if (chkCmd(1, "PUT")) {
-    cerr = 0;
-    for (int i = 1; i <= argct; i++) {if (!solvearg(i)) {goto cmderr;} fputs(arg[i], stdout);}
+    CBX(cerr) = 0;
+    for (int i = 1; i <= CBX(argct); i++) {if (!solvearg(i)) {goto cmderr;} fputs(CBX(arg)[i], stdout);}
     fflush(stdout);
     goto noerr;
 }
 if (chkCmd(2, "SET", "LET")) {
-    if (argct != 2) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(2)) goto cmderr;
-    if (!arg[1][0] || !argt[2]) {cerr = 1; goto cmderr;}
-    if (!setVar(arg[1], arg[2], argt[2], -1)) goto cmderr;
+    if (!CBX(arg)[1][0] || !CBX(argt)[2]) {CBX(cerr) = 1; goto cmderr;}
+    if (!setVar(CBX(arg)[1], CBX(arg)[2], CBX(argt)[2], -1)) goto cmderr;
     goto noerr;
 }
 if (chkCmd(1, "DIM")) {
-    if (argct < 2 || argct > 3) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) < 2 || CBX(argct) > 3) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(2)) goto cmderr;
-    if (argct == 3 && !solvearg(3)) goto cmderr;
-    if (argt[2] != 2) {cerr = 2; goto cmderr;}
-    int32_t asize = atoi(arg[2]);
-    if (asize < 0) {cerr = 16; goto cmderr;}
-    if (!arg[1][0]) {cerr = 4; seterrstr(""); goto cmderr;}
+    if (CBX(argct) == 3 && !solvearg(3)) goto cmderr;
+    if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int32_t asize = atoi(CBX(arg)[2]);
+    if (asize < 0) {CBX(cerr) = 16; goto cmderr;}
+    if (!CBX(arg)[1][0]) {CBX(cerr) = 4; seterrstr(""); goto cmderr;}
     char* val = NULL; uint8_t type = 0;
-    if (argct == 3) {
-        val = arg[3];
-        type = argt[3];
+    if (CBX(argct) == 3) {
+        val = CBX(arg)[3];
+        type = CBX(argt)[3];
     } else {
-        val = ((arg[1][argl[1] - 1] == '$') ? "" : "0");
-        type = 2 - (arg[1][argl[1] - 1] == '$');
+        val = ((CBX(arg)[1][CBX(argl)[1] - 1] == '$') ? "" : "0");
+        type = 2 - (CBX(arg)[1][CBX(argl)[1] - 1] == '$');
     }
-    if (!setVar(arg[1], val, type, asize)) goto cmderr;
+    if (!setVar(CBX(arg)[1], val, type, asize)) goto cmderr;
     goto noerr;
 }
 if (chkCmd(1, "REDIM")) {
-    if (argct < 2) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) < 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(2)) goto cmderr;
-    if (argt[2] != 2) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
     int v = -1;
-    for (register int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse && !strcmp(arg[1], vardata[i].name)) {v = i; break;}
-    }
-    if (v == -1 || vardata[v].size == -1) {cerr = 23; seterrstr(arg[1]); goto cmderr;}
-    int32_t s = atoi(arg[2]);
-    if (s == vardata[v].size) {goto noerr;}
-    int32_t os = vardata[v].size;
-    if (s < 0) {cerr = 16; goto cmderr;}
-    vardata[v].size = s;
-    char** newdata = (char**)malloc((s + 1) * sizeof(char*));
-    int32_t i = 0;
-    for (; i <= s && i <= os; ++i) {
-        newdata[i] = vardata[v].data[i];
-    }
-    for (; i <= s; ++i) {
-        newdata[i] = malloc(vardata[v].type);
-        if (vardata[v].type == 1) {
-            newdata[i][0] = 0;
-        } else {
-            newdata[i][0] = '0';
-            newdata[i][1] = 0;
-        }
-    }
-    for (i = s + 1; i <= os; ++i) {
-        free(vardata[v].data[i]);
-    }
-    free(vardata[v].data);
-    vardata[v].data = newdata;
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v = i; break;}
+    }
+    if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[1]); goto cmderr;}
+    int32_t s = atoi(CBX(arg)[2]);
+    if (s < 0) {CBX(cerr) = 16; goto cmderr;}
+    if (parForFixed(v)) goto cmderr;
+    resizeVar(v, s);
     goto noerr;
 }
 if (chkCmd(1, "FILL")) {
-    if (argct < 1 || argct > 2) {cerr = 3; goto cmderr;}
-    if (getType(arg[1]) != 255) {cerr = 4; seterrstr(arg[1]); goto cmderr;}
-    upCase(arg[1]);
+    if (CBX(argct) < 1 || CBX(argct) > 2) {CBX(cerr) = 3; goto cmderr;}
+    if (getType(CBX(arg)[1]) != 255) {CBX(cerr) = 4; seterrstr(CBX(arg)[1]); goto cmderr;}
+    upCase(CBX(arg)[1]);
     int v = -1;
-    for (register int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse && !strcmp(arg[1], vardata[i].name)) {v = i; break;}
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v = i; break;}
     }
-    if (v == -1 || vardata[v].size == -1) {cerr = 23; seterrstr(arg[1]); goto cmderr;}
-    for (int i = 0; i <= vardata[v].size; ++i) {
-        if (argct > 1) {
+    if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[1]); goto cmderr;}
+    for (int i = 0; i <= CBX(vardata)[v].size; ++i) {
+        if (CBX(argct) > 1) {
             uint8_t t = 0;
             char* tmpbuf = malloc(CB_BUF_SIZE);
-            if (!(t = getVal(arg[2], tmpbuf))) {free(tmpbuf); goto cmderr;}
-            if (t != vardata[v].type) {free(tmpbuf); cerr = 2; goto cmderr;}
+            if (!(t = getVal(CBX(arg)[2], tmpbuf))) {free(tmpbuf); goto cmderr;}
+            if (t != CBX(vardata)[v].type) {free(tmpbuf); CBX(cerr) = 2; goto cmderr;}
             tmpbuf = realloc(tmpbuf, strlen(tmpbuf) + 1);
-            swap(tmpbuf, vardata[v].data[i]);
+            swap(tmpbuf, CBX(vardata)[v].data[i]);
             free(tmpbuf);
         } else {
-            copyStr(((vardata[v].type == 1) ? "" : "0"), vardata[v].data[i]);
+            copyStr(((CBX(vardata)[v].type == 1) ? "" : "0"), CBX(vardata)[v].data[i]);
         }
     }
     goto noerr;
 }
 if (chkCmd(1, "SWAP")) {
-    if (argct != 2) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     int v1 = -1;
-    for (register int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse && !strcmp(arg[1], vardata[i].name)) {v1 = i; break;}
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v1 = i; break;}
     }
-    if (v1 == -1 || vardata[v1].size == -1) {cerr = 23; seterrstr(arg[1]); goto cmderr;}
+    if (v1 == -1 || CBX(vardata)[v1].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[1]); goto cmderr;}
     int v2 = -1;
-    for (register int i = 0; i < varmaxct; ++i) {
-        if (vardata[i].inuse && !strcmp(arg[2], vardata[i].name)) {v2 = i; break;}
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[2], CBX(vardata)[i].name)) {v2 = i; break;}
     }
-    if (v2 == -1 || vardata[v2].size == -1) {cerr = 23; seterrstr(arg[2]); goto cmderr;}
-    swap(vardata[v1].name, vardata[v2].name);
+    if (v2 == -1 || CBX(vardata)[v2].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[2]); goto cmderr;}
+    swap(CBX(vardata)[v1].name, CBX(vardata)[v2].name);
     goto noerr;
 }   
+if (chkCmd(1, "SHMDIM")) {
+    if (CBX(argct) < 2 || CBX(argct) > 4) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    for (int i = 2; i <= CBX(argct); ++i) {
+        if (!solvearg(i)) goto cmderr;
+    }
+    if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int32_t asize = atoi(CBX(arg)[2]);
+    if (asize < 0) {CBX(cerr) = 16; goto cmderr;}
+    bool isstr = (CBX(arg)[1][0] && CBX(arg)[1][strlen(CBX(arg)[1]) - 1] == '$');
+    int32_t width = 0;
+    char* key = NULL;
+    int i = 3;
+    if (isstr) {
+        if (CBX(argct) < 3 || CBX(argt)[3] != 2) {CBX(cerr) = 2; goto cmderr;}
+        width = atoi(CBX(arg)[3]);
+        if (width < 1 || width >= CB_BUF_SIZE) {CBX(cerr) = 16; goto cmderr;}
+        ++i;
+    }
+    if (i < CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    if (i == CBX(argct)) {
+        if (CBX(argt)[i] != 1) {CBX(cerr) = 2; goto cmderr;}
+        key = CBX(arg)[i];
+    }
+    if (!shmDim(CBX(arg)[1], asize, width, key) && CBX(cerr)) goto cmderr;
+    goto noerr;
+}
+if (chkCmd(1, "SHMATTACH")) {
+    if (CBX(argct) < 1 || CBX(argct) > 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) == 2) {
+        if (!solvearg(2)) goto cmderr;
+        if (CBX(argt)[2] != 1) {CBX(cerr) = 2; goto cmderr;}
+    }
+    if (!shmDim(CBX(arg)[1], -1, 0, (CBX(argct) == 2) ? CBX(arg)[2] : NULL) && CBX(cerr)) goto cmderr;
+    goto noerr;
+}
+if (chkCmd(1, "SHMADD")) {
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (!solvearg(2)) goto cmderr;
+    if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (!shmAdd(CBX(arg)[1], atof(CBX(arg)[2]))) goto cmderr;
+    goto noerr;
+}
 if (chkCmd(1, "DEL")) {
-    cerr = 0;
-    if (argct < 1) {cerr = 3; goto cmderr;}
-    for (int i = 1; i <= argct; ++i) {
-        if (!delVar(arg[i])) goto cmderr;
+    CBX(cerr) = 0;
+    if (CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    for (int i = 1; i <= CBX(argct); ++i) {
+        if (!delVar(CBX(arg)[i])) goto cmderr;
     }
     goto noerr;
 }
 if (chkCmd(1, "DEFRAG")) {
-    cerr = 0;
-    if (argct > 0) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (CBX(argct) > 0) {CBX(cerr) = 3; goto cmderr;}
     int vo = 0;
-    for (register int i = 0; i < varmaxct;) {
-        if (!vardata[i].inuse) {++vo; --varmaxct;}
+    for (register int i = 0; i < CBX(varmaxct);) {
+        if (!CBX(vardata)[i].inuse) {++vo; --CBX(varmaxct);}
         else {++i;}
-        if (vo) {vardata[i] = vardata[i + vo];}
+        if (vo) {CBX(vardata)[i] = CBX(vardata)[i + vo];}
     }
     goto noerr;
 }
 if (chkCmd(3, "@", "LABEL", "LBL")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    upCase(arg[1]);
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    upCase(CBX(arg)[1]);
     int i = -1;
-    for (int j = 0; j < gotomaxct; ++j) {
-        if (!gotodata[j].used) {i = j; break;}
-        else if (!strcmp(gotodata[j].name, arg[1])) {
-            if (gotodata[j].cp == cmdpos) {goto noerr;}
-            cerr = 28; goto cmderr;
+    for (int j = 0; j < CBX(gotomaxct); ++j) {
+        if (!CBX(gotodata)[j].used) {i = j; break;}
+        else if (!strcmp(CBX(gotodata)[j].name, CBX(arg)[1])) {
+            if (CBX(gotodata)[j].cp == CBX(cmdpos)) {goto noerr;}
+            CBX(cerr) = 28; goto cmderr;
         }
     }
     if (i == -1) {
-        i = gotomaxct;
-        ++gotomaxct;
-        gotodata = realloc(gotodata, gotomaxct * sizeof(cb_goto));
-    }
-    gotodata[i].name = malloc(strlen(arg[1]) + 1);
-    copyStr(arg[1], gotodata[i].name);
-    gotodata[i].cp = cmdpos;
-    gotodata[i].pl = progLine;
-    gotodata[i].used = true;
-    gotodata[i].dlsp = dlstackp;
-    gotodata[i].fnsp = fnstackp;
-    gotodata[i].itsp = itstackp;
+        i = CBX(gotomaxct);
+        ++CBX(gotomaxct);
+        CBX(gotodata) = realloc(CBX(gotodata), CBX(gotomaxct) * sizeof(cb_goto));
+    }
+    CBX(gotodata)[i].name = malloc(strlen(CBX(arg)[1]) + 1);
+    copyStr(CBX(arg)[1], CBX(gotodata)[i].name);
+    CBX(gotodata)[i].cp = CBX(cmdpos);
+    CBX(gotodata)[i].pl = CBX(progLine);
+    CBX(gotodata)[i].used = true;
+    CBX(gotodata)[i].dlsp = CBX(dlstackp);
+    CBX(gotodata)[i].fnsp = CBX(fnstackp);
+    CBX(gotodata)[i].itsp = CBX(itstackp);
     #ifdef _WIN32
     updatechars();
     #endif
     goto noerr;
 }
 if (chkCmd(3, "%", "GOTO", "GO")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    upCase(arg[1]);
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    upCase(CBX(arg)[1]);
     int i = -1;
-    for (int j = 0; j < gotomaxct; ++j) {
-        if (gotodata[j].used) {
-            if (!strcmp(gotodata[j].name, arg[1])) {i = j;}
+    for (int j = 0; j < CBX(gotomaxct); ++j) {
+        if (CBX(gotodata)[j].used) {
+            if (!strcmp(CBX(gotodata)[j].name, CBX(arg)[1])) {i = j;}
         }
     }
-    if (i == -1) {cerr = 29; goto cmderr;}
-    nfree(gotodata[i].name);
-    if (inProg) {
-        cp = gotodata[i].cp;
+    if (i == -1) {CBX(cerr) = 29; goto cmderr;}
+    nfree(CBX(gotodata)[i].name);
+    if (CBX(inProg)) {
+        CBX(cp) = CBX(gotodata)[i].cp;
     } else {
-        concp = gotodata[i].cp;
+        concp = CBX(gotodata)[i].cp;
     }
-    progLine = gotodata[i].pl;
-    dlstackp = gotodata[i].dlsp;
-    fnstackp = gotodata[i].fnsp;
-    itstackp = gotodata[i].itsp;
-    gotodata[i].used = false;
+    CBX(progLine) = CBX(gotodata)[i].pl;
+    CBX(dlstackp) = CBX(gotodata)[i].dlsp;
+    CBX(fnstackp) = CBX(gotodata)[i].fnsp;
+    CBX(itstackp) = CBX(gotodata)[i].itsp;
+    CBX(gotodata)[i].used = false;
     bool r = false;
-    while (gotomaxct > 0 && !gotodata[gotomaxct - 1].used) {--gotomaxct; r = true;}
-    if (r) gotodata = realloc(gotodata, gotomaxct * sizeof(cb_goto));
-    didloop = true;
-    lockpl = true;
+    while (CBX(gotomaxct) > 0 && !CBX(gotodata)[CBX(gotomaxct) - 1].used) {--CBX(gotomaxct); r = true;}
+    if (r) CBX(gotodata) = realloc(CBX(gotodata), CBX(gotomaxct) * sizeof(cb_goto));
+    CBX(didloop) = true;
+    CBX(lockpl) = true;
     goto noerr;
 }
 if (chkCmd(1, "GOSUB")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    if (gsstackp >= CB_PROG_LOGIC_MAX - 1) {cerr = 32; goto cmderr;}
-    upCase(arg[1]);
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (CBX(gsstackp) >= CB_PROG_LOGIC_MAX - 1) {CBX(cerr) = 32; goto cmderr;}
+    upCase(CBX(arg)[1]);
     int i = -1;
-    for (int j = 0; j < gotomaxct; ++j) {
-        if (gotodata[j].used) {
-            if (!strcmp(gotodata[j].name, arg[1])) {i = j;}
+    for (int j = 0; j < CBX(gotomaxct); ++j) {
+        if (CBX(gotodata)[j].used) {
+            if (!strcmp(CBX(gotodata)[j].name, CBX(arg)[1])) {i = j;}
         }
     }
-    if (i == -1) {cerr = 29; goto cmderr;}
-    nfree(gotodata[i].name);
-    ++gsstackp;
-    gsstack[gsstackp].cp = ((inProg) ? cp : concp);
-    gsstack[gsstackp].pl = progLine;
-    gsstack[gsstackp].dlsp = dlstackp;
-    gsstack[gsstackp].fnsp = fnstackp;
-    gsstack[gsstackp].itsp = itstackp;
-    gsstack[gsstackp].brkinfo = brkinfo;
-    if (inProg) {
-        cp = gotodata[i].cp;
+    if (i == -1) {CBX(cerr) = 29; goto cmderr;}
+    nfree(CBX(gotodata)[i].name);
+    ++CBX(gsstackp);
+    CBX(gsstack)[CBX(gsstackp)].cp = ((CBX(inProg)) ? CBX(cp) : concp);
+    CBX(gsstack)[CBX(gsstackp)].pl = CBX(progLine);
+    CBX(gsstack)[CBX(gsstackp)].dlsp = CBX(dlstackp);
+    CBX(gsstack)[CBX(gsstackp)].fnsp = CBX(fnstackp);
+    CBX(gsstack)[CBX(gsstackp)].itsp = CBX(itstackp);
+    CBX(gsstack)[CBX(gsstackp)].brkinfo = CBX(brkinfo);
+    if (CBX(inProg)) {
+        CBX(cp) = CBX(gotodata)[i].cp;
     } else {
-        concp = gotodata[i].cp;
+        concp = CBX(gotodata)[i].cp;
     }
-    progLine = gotodata[i].pl;
-    gotodata[i].used = false;
+    CBX(progLine) = CBX(gotodata)[i].pl;
+    CBX(gotodata)[i].used = false;
     bool r = false;
-    while (gotomaxct > 0 && !gotodata[gotomaxct - 1].used) {--gotomaxct; r = true;}
-    if (r) gotodata = realloc(gotodata, gotomaxct * sizeof(cb_goto));
-    didloop = true;
-    lockpl = true;
+    while (CBX(gotomaxct) > 0 && !CBX(gotodata)[CBX(gotomaxct) - 1].used) {--CBX(gotomaxct); r = true;}
+    if (r) CBX(gotodata) = realloc(CBX(gotodata), CBX(gotomaxct) * sizeof(cb_goto));
+    CBX(didloop) = true;
+    CBX(lockpl) = true;
     goto noerr;
 }
 if (chkCmd(1, "RETURN")) {
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    if (gsstackp < 0) {cerr = 31; goto cmderr;}
-    if (inProg) {
-        cp = gsstack[gsstackp].cp;
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (CBX(gsstackp) < 0) {CBX(cerr) = 31; goto cmderr;}
+    if (CBX(coself) > 0 && CBX(gsstackp) == 0 && CBX(progindex) == CBX(coprog)) {coYield(true); goto noerr;}
+    if (CBX(inProg)) {
+        CBX(cp) = CBX(gsstack)[CBX(gsstackp)].cp;
     } else {
-        concp = gsstack[gsstackp].cp;
+        concp = CBX(gsstack)[CBX(gsstackp)].cp;
+    }
+    CBX(progLine) = CBX(gsstack)[CBX(gsstackp)].pl;
+    CBX(dlstackp) = CBX(gsstack)[CBX(gsstackp)].dlsp;
+    CBX(fnstackp) = CBX(gsstack)[CBX(gsstackp)].fnsp;
+    CBX(itstackp) = CBX(gsstack)[CBX(gsstackp)].itsp;
+    CBX(brkinfo) = CBX(gsstack)[CBX(gsstackp)].brkinfo;
+    --CBX(gsstackp);
+    CBX(didloop) = true;
+    CBX(lockpl) = true;
+    goto noerr;
+}
+if (chkCmd(1, "SPAWN")) {
+    if (!CBX(inProg)) {CBX(cerr) = 253; goto cmderr;}
+    if (CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    for (int i = 2; i <= CBX(argct); ++i) {
+        if (!solvearg(i)) goto cmderr;
+    }
+    upCase(CBX(arg)[1]);
+    if (taskSpawn(CBX(arg)[1], CBX(argct) - 1, &CBX(arg)[2], true) == -1) goto cmderr;
+    goto noerr;
+}
+if (chkCmd(1, "JOIN")) {
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (!solvearg(1)) goto cmderr;
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (taskJoin(atoi(CBX(arg)[1])) == -1) {CBX(cerr) = 16; goto cmderr;}
+    goto noerr;
+}
+if (chkCmd(1, "COSTART")) {
+    if (!CBX(inProg)) {CBX(cerr) = 253; goto cmderr;}
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    upCase(CBX(arg)[1]);
+    if (coStart(CBX(arg)[1]) == -1) goto cmderr;
+    goto noerr;
+}
+if (chkCmd(1, "YIELD")) {
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    coYield(false);
+    goto noerr;
+}
+if (chkCmd(1, "COWAIT")) {
+    if (CBX(argct) < 1 || CBX(argct) > 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (!solvearg(1)) goto cmderr;
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    double d = atof(CBX(arg)[1]);
+    int fd = -1;
+    if (CBX(argct) == 2) {
+        if (!solvearg(2)) goto cmderr;
+        if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+        int fnum = atoi(CBX(arg)[2]);
+        if (fnum == -1) {
+            fd = 0;
+        } else if (fnum < 0 || fnum >= CBX(filemaxct) || !CBX(filedata)[fnum].fptr) {
+            CBX(cerr) = 16;
+            goto cmderr;
+        } else {
+            fd = fileno(CBX(filedata)[fnum].fptr);
+        }
+    } else if (d < 0) {
+        CBX(cerr) = 16;
+        goto cmderr;
     }
-    progLine = gsstack[gsstackp].pl;
-    dlstackp = gsstack[gsstackp].dlsp;
-    fnstackp = gsstack[gsstackp].fnsp;
-    itstackp = gsstack[gsstackp].itsp;
-    brkinfo = gsstack[gsstackp].brkinfo;
-    --gsstackp;
-    didloop = true;
-    lockpl = true;
+    coWait(d, fd);
+    goto noerr;
+}
+if (chkCmd(1, "EVUNWATCH")) {
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (!solvearg(1)) goto cmderr;
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (!evUnwatch(atoi(CBX(arg)[1]))) {CBX(cerr) = 16; goto cmderr;}
+    goto noerr;
+}
+if (chkCmd(1, "EVWAIT")) {
+    if (CBX(argct) > 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    double d = -1;
+    if (CBX(argct)) {
+        if (!solvearg(1)) goto cmderr;
+        if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+        d = atof(CBX(arg)[1]);
+    }
+    int id = evWait(d);
+    if (id > 0 && CBX(evlbl)) {CBX(evpend) = id; CBX(evchk) = 0;}
+    goto noerr;
+}
+if (chkCmd(1, "CHANSEND")) {
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (!solvearg(1) || !solvearg(2)) goto cmderr;
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (!chanSend(atoi(CBX(arg)[1]), CBX(arg)[2])) goto cmderr;
+    goto noerr;
+}
+if (chkCmd(1, "CHANCLOSE")) {
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (!solvearg(1)) goto cmderr;
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (!chanClose(atoi(CBX(arg)[1]))) {CBX(cerr) = 16; goto cmderr;}
     goto noerr;
 }
 if (chkCmd(2, "CONTINUE", "BREAK")) {
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    if (brkinfo.block == 1) {
-        dldcmd[dlstackp] = !dldcmd[dlstackp];
-    } else if (brkinfo.block == 2) {
-        fndcmd[fnstackp] = !fndcmd[fnstackp];
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (CBX(brkinfo).block == 1) {
+        CBX(dldcmd)[CBX(dlstackp)] = !CBX(dldcmd)[CBX(dlstackp)];
+    } else if (CBX(brkinfo).block == 2) {
+        CBX(fndcmd)[CBX(fnstackp)] = !CBX(fndcmd)[CBX(fnstackp)];
     } else {
-        cerr = 30;
+        CBX(cerr) = 30;
         goto cmderr;
     }
-    brkinfo.type = 1 + !strcmp(arg[0], "BREAK");
+    CBX(brkinfo).type = 1 + !strcmp(CBX(arg)[0], "BREAK");
     goto noerr;
 }
 if (chkCmd(1, "COLOR")) {
-    if (argct > 2 || argct < 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) > 2 || CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
     int32_t tmp = 0;
-    if (argt[1] == 0) {} else
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] == 0) {} else
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
     else {
-        tmp = atoi(arg[1]);
+        tmp = atoi(CBX(arg)[1]);
         if (txtattrib.truecolor) {
-            if (tmp < 0 || tmp > 0xFFFFFF) {cerr = 16; goto cmderr;}
+            if (tmp < 0 || tmp > 0xFFFFFF) {CBX(cerr) = 16; goto cmderr;}
             txtattrib.truefgc = tmp;
         } else {
-            if (tmp < 0 || tmp > 255) {cerr = 16; goto cmderr;}
+            if (tmp < 0 || tmp > 255) {CBX(cerr) = 16; goto cmderr;}
             txtattrib.fgc = (uint8_t)tmp;
         }
         #ifndef _WIN_NO_VT
@@ -312,17 +439,17 @@ if (chkCmd(1, "COLOR")) {
         updateTxtAttrib();
         #endif
     }
-    if (argct > 1) {
+    if (CBX(argct) > 1) {
         if (!solvearg(2)) goto cmderr;
-        if (argt[2] == 0) {} else
-        if (argt[2] != 2) {cerr = 2; goto cmderr;}
+        if (CBX(argt)[2] == 0) {} else
+        if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
         else {
-            tmp = atoi(arg[2]);
+            tmp = atoi(CBX(arg)[2]);
             if (txtattrib.truecolor) {
-                if (tmp < 0 || tmp > 0xFFFFFF) {cerr = 16; goto cmderr;}
+                if (tmp < 0 || tmp > 0xFFFFFF) {CBX(cerr) = 16; goto cmderr;}
                 txtattrib.truebgc = tmp;
             } else {
-                if (tmp < 0 || tmp > 255) {cerr = 16; goto cmderr;}
+                if (tmp < 0 || tmp > 255) {CBX(cerr) = 16; goto cmderr;}
                 txtattrib.bgc = (uint8_t)tmp;
             }
             #ifndef _WIN_NO_VT
@@ -339,15 +466,15 @@ if (chkCmd(1, "COLOR")) {
     goto noerr;
 }
 if (chkCmd(1, "LOCATE")) {
-    if (argct > 2 || argct < 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) > 2 || CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     int tmp = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] == 0) {}
-    else if (argt[1] != 2) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] == 0) {}
+    else if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
     else {
-        tmp = atoi(arg[1]);
-        if (tmp < 1) {cerr = 16; goto cmderr;}
+        tmp = atoi(CBX(arg)[1]);
+        if (tmp < 1) {CBX(cerr) = 16; goto cmderr;}
         else {
             #ifndef _WIN_NO_VT
             if (esc) printf("\e[%dG", tmp);
@@ -356,14 +483,14 @@ if (chkCmd(1, "LOCATE")) {
             #endif
         }
     }
-    if (argct > 1) {
+    if (CBX(argct) > 1) {
         if (!solvearg(2)) goto cmderr;
-        if (argt[1] == 0 && argt[2] == 0) {cerr = 3; goto cmderr;}
-        else if (argt[2] == 0) {}
-        else if (argt[2] != 2) {cerr = 2; goto cmderr;}
+        if (CBX(argt)[1] == 0 && CBX(argt)[2] == 0) {CBX(cerr) = 3; goto cmderr;}
+        else if (CBX(argt)[2] == 0) {}
+        else if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
         else {
-            tmp = atoi(arg[2]);
-            if (tmp < 1) {cerr = 16; goto cmderr;}
+            tmp = atoi(CBX(arg)[2]);
+            if (tmp < 1) {CBX(cerr) = 16; goto cmderr;}
             else {
                 #ifndef _WIN_NO_VT
                 if (esc) {
@@ -385,17 +512,17 @@ if (chkCmd(1, "LOCATE")) {
     goto noerr;
 }
 if (chkCmd(1, "RLOCATE")) {
-    if (argct > 2 || argct < 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) > 2 || CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     int tmp = 0;
     if (!solvearg(1)) goto cmderr;
     #ifndef _WIN_NO_VT
     getCurPos();
     #endif
-    if (argt[1] == 0) {}
-    else if (argt[1] != 2) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] == 0) {}
+    else if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
     else {
-        tmp = atoi(arg[1]);
+        tmp = atoi(CBX(arg)[1]);
         if (tmp == 0) {}
         else if (tmp < 0) {
             #ifndef _WIN_NO_VT
@@ -412,13 +539,13 @@ if (chkCmd(1, "RLOCATE")) {
             #endif
         }
     }
-    if (argct > 1) {
+    if (CBX(argct) > 1) {
         if (!solvearg(2)) goto cmderr;
-        if (argt[1] == 0 && argt[2] == 0) {cerr = 3; goto cmderr;}
-        else if (argt[2] == 0) {}
-        else if (argt[2] != 2) {cerr = 2; goto cmderr;}
+        if (CBX(argt)[1] == 0 && CBX(argt)[2] == 0) {CBX(cerr) = 3; goto cmderr;}
+        else if (CBX(argt)[2] == 0) {}
+        else if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
         else {
-            tmp = atoi(arg[2]);
+            tmp = atoi(CBX(arg)[2]);
             if (tmp == 0) {}
             else if (tmp < 0) {
                 #ifndef _WIN_NO_VT
@@ -444,27 +571,27 @@ if (chkCmd(1, "RLOCATE")) {
     goto noerr;
 }
 if (chkCmd(1, "CLS")) {
-    if (argct > 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) > 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     uint8_t tbgc = txtattrib.bgc;
     #ifndef _WIN_NO_VT
     uint32_t ttbgc = txtattrib.truebgc;
     #endif
-    if (argct) {
+    if (CBX(argct)) {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] != 2) {cerr = 2; goto cmderr;}
+        if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
         #ifndef _WIN_NO_VT
         if (txtattrib.truecolor) {
-            ttbgc = (uint32_t)atoi(arg[1]);
+            ttbgc = (uint32_t)atoi(CBX(arg)[1]);
         } else {
-            tbgc = (uint8_t)atoi(arg[1]);
+            tbgc = (uint8_t)atoi(CBX(arg)[1]);
         }
         #else
-        tbgc = (uint8_t)atoi(arg[1]);
+        tbgc = (uint8_t)atoi(CBX(arg)[1]);
         #endif
     }
     #ifndef _WIN_NO_VT
-    if (esc && argct) {
+    if (esc && CBX(argct)) {
         if (txtattrib.truecolor) printf("\e[48;2;%u;%u;%um", (uint8_t)(ttbgc >> 16), (uint8_t)(ttbgc >> 8), (uint8_t)ttbgc);
         else printf("\e[48;5;%um", tbgc);
     }
@@ -479,149 +606,149 @@ if (chkCmd(1, "CLS")) {
     goto noerr;
 }
 if (chkCmd(1, "WAITUS")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
-    if (arg[1][0] == '-') {cerr = 16; goto cmderr;}
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (CBX(arg)[1][0] == '-') {CBX(cerr) = 16; goto cmderr;}
     uint64_t d;
-    sscanf(arg[1], "%llu", (long long unsigned *)&d);
-    cb_wait(d);
+    sscanf(CBX(arg)[1], "%llu", (long long unsigned *)&d);
+    progWait(d);
     goto noerr;
 }
 if (chkCmd(1, "WAITMS")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
-    if (arg[1][0] == '-') {cerr = 16; goto cmderr;}
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (CBX(arg)[1][0] == '-') {CBX(cerr) = 16; goto cmderr;}
     double d;
-    sscanf(arg[1], "%lf", &d);
-    cb_wait(d * 1000);
+    sscanf(CBX(arg)[1], "%lf", &d);
+    progWait(d * 1000);
     goto noerr;
 }
 if (chkCmd(1, "WAIT")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
-    if (arg[1][0] == '-') {cerr = 16; goto cmderr;}
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    if (CBX(arg)[1][0] == '-') {CBX(cerr) = 16; goto cmderr;}
     double d;
-    sscanf(arg[1], "%lf", &d);
-    cb_wait(d * 1000000);
+    sscanf(CBX(arg)[1], "%lf", &d);
+    progWait(d * 1000000);
     goto noerr;
 }
 if (chkCmd(1, "RESETTIMER")) {
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     resetTimer();
     goto noerr;
 }
 if (chkCmd(2, "SRAND", "SRND")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
     double rs;
-    sscanf(arg[1], "%lf", &rs);
+    sscanf(CBX(arg)[1], "%lf", &rs);
     srand(rs);
     goto noerr;
 }
 if (chkCmd(2, "CALL", "CALLA")) {
-    if (argct < 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     bool execa = false;
     char** tmparg = NULL;
     int tmpargct = 0;
-    if (!strcmp(arg[0], "CALLA")) {
-        if (argct != 1) {cerr = 3; goto cmderr;}
+    if (!strcmp(CBX(arg)[0], "CALLA")) {
+        if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
         execa = true;
         int v = -1;
-        for (register int i = 0; i < varmaxct; ++i) {
-            if (vardata[i].inuse && !strcmp(arg[1], vardata[i].name)) {v = i; break;}
+        for (register int i = 0; i < CBX(varmaxct); ++i) {
+            if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v = i; break;}
         }
-        if (v == -1 || vardata[v].size == -1) {cerr = 23; seterrstr(arg[1]); goto cmderr;}
-        if (vardata[v].type != 1) {cerr = 2; goto cmderr;}
-        tmparg = arg;
-        tmpargct = argct;
-        arg = vardata[v].data - 1;
-        argct = vardata[v].size + 1;
+        if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[1]); goto cmderr;}
+        if (CBX(vardata)[v].type != 1) {CBX(cerr) = 2; goto cmderr;}
+        tmparg = CBX(arg);
+        tmpargct = CBX(argct);
+        CBX(arg) = CBX(vardata)[v].data - 1;
+        CBX(argct) = CBX(vardata)[v].size + 1;
     } else {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] != 1) {cerr = 2; goto cmderr;}
+        if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     }
-    newprogargc = argct;
-    newprogargs = (char**)malloc((argct + 1) * sizeof(char*));
-    for (int i = 2; i <= argct; ++i) {
+    CBX(newprogargc) = CBX(argct);
+    CBX(newprogargs) = (char**)malloc((CBX(argct) + 1) * sizeof(char*));
+    for (int i = 2; i <= CBX(argct); ++i) {
         if (!execa) {
             if (!solvearg(i)) {
                 for (int j = i - 1; j > 0; --j) {
-                    free(newprogargs[j]);
+                    free(CBX(newprogargs)[j]);
                 }
-                free(newprogargs);
+                free(CBX(newprogargs));
                 goto cmderr;
             }
         }
-        newprogargs[i - 1] = malloc(argl[i] + 1);
-        copyStr(arg[i], newprogargs[i - 1]);
+        CBX(newprogargs)[i - 1] = malloc(CBX(argl)[i] + 1);
+        copyStr(CBX(arg)[i], CBX(newprogargs)[i - 1]);
     }
     inprompt = !runfile;
     setsig(SIGINT, cleanExit);
-    if (!loadProg(arg[1])) goto cmderr;
-    chkinProg = true;
-    cp = 0;
-    didloop = true;
+    if (!loadProg(CBX(arg)[1])) goto cmderr;
+    CBX(chkinProg) = true;
+    CBX(cp) = 0;
+    CBX(didloop) = true;
     if (execa) {
-        argct = tmpargct;
-        arg = tmparg;
+        CBX(argct) = tmpargct;
+        CBX(arg) = tmparg;
     }
     goto noerr;
 }
 if (chkCmd(2, "RUN", "RUNA")) {
-    if (argct < 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     bool execa = false;
     char** tmparg = NULL;
     int tmpargct = 0;
-    if (!strcmp(arg[0], "RUNA")) {
-        if (argct != 1) {cerr = 3; goto cmderr;}
+    if (!strcmp(CBX(arg)[0], "RUNA")) {
+        if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
         execa = true;
         int v = -1;
-        for (register int i = 0; i < varmaxct; ++i) {
-            if (vardata[i].inuse && !strcmp(arg[1], vardata[i].name)) {v = i; break;}
+        for (register int i = 0; i < CBX(varmaxct); ++i) {
+            if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v = i; break;}
         }
-        if (v == -1 || vardata[v].size == -1) {cerr = 23; seterrstr(arg[1]); goto cmderr;}
-        if (vardata[v].type != 1) {cerr = 2; goto cmderr;}
-        tmparg = arg;
-        tmpargct = argct;
-        arg = vardata[v].data - 1;
-        argct = vardata[v].size + 1;
+        if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[1]); goto cmderr;}
+        if (CBX(vardata)[v].type != 1) {CBX(cerr) = 2; goto cmderr;}
+        tmparg = CBX(arg);
+        tmpargct = CBX(argct);
+        CBX(arg) = CBX(vardata)[v].data - 1;
+        CBX(argct) = CBX(vardata)[v].size + 1;
     } else {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] != 1) {cerr = 2; goto cmderr;}
+        if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     }
     #ifndef _WIN32
-    char** runargs = (char**)malloc((argct + 3) * sizeof(char*));
+    char** runargs = (char**)malloc((CBX(argct) + 3) * sizeof(char*));
     runargs[0] = startcmd;
     runargs[1] = roptstr;
-    runargs[2] = arg[1];
-    argct += 2;
+    runargs[2] = CBX(arg)[1];
+    CBX(argct) += 2;
     int argno = 3;
-    for (; argno < argct; argno++) {
+    for (; argno < CBX(argct); argno++) {
         if (!execa) if (!solvearg(argno - 1)) {free(runargs); goto cmderr;}
-        runargs[argno] = arg[argno - 1];
+        runargs[argno] = CBX(arg)[argno - 1];
     }
-    argct -= 2;
+    CBX(argct) -= 2;
     runargs[argno] = NULL;
     pid_t pid = fork();
-    if (pid < 0) cerr = -1;
+    if (pid < 0) CBX(cerr) = -1;
     else if (pid == 0) {
         execvp(startcmd, runargs);
         exit(0);
     }
     else if (pid > 0) {
-        while (wait(&retval) != pid) {}
-        retval = WEXITSTATUS(retval);
+        while (wait(&CBX(retval)) != pid) {}
+        CBX(retval) = WEXITSTATUS(CBX(retval));
     }
     free(runargs);
     #else
@@ -632,12 +759,12 @@ if (chkCmd(2, "RUN", "RUNA")) {
     copyStrApnd(startcmd, tmpcmd);
     if (nq) strApndChar(tmpcmd, '"');
     copyStrApnd(" -x", tmpcmd);
-    for (int argno = 1; argno <= argct; ++argno) {
+    for (int argno = 1; argno <= CBX(argct); ++argno) {
         if (!execa) if (argno > 1) if (!solvearg(argno)) {free(tmpcmd); goto cmderr;}
         strApndChar(tmpcmd, ' ');
-        bool nq = winArgNeedsQuotes(arg[argno]);
+        bool nq = winArgNeedsQuotes(CBX(arg)[argno]);
         if (nq) strApndChar(tmpcmd, '"');
-        copyStrApnd(arg[argno], tmpcmd);
+        copyStrApnd(CBX(arg)[argno], tmpcmd);
         if (nq) strApndChar(tmpcmd, '"');
     }
     int ret = system(tmpcmd);
@@ -645,62 +772,70 @@ if (chkCmd(2, "RUN", "RUNA")) {
     free(tmpcmd);
     #endif
     if (execa) {
-        argct = tmpargct;
-        arg = tmparg;
+        CBX(argct) = tmpargct;
+        CBX(arg) = tmparg;
     }
     updateTxtAttrib();
     goto noerr;
 }
 if (chkCmd(2, "$", "SH")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 1) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     #ifndef _WIN_NO_VT
     if (esc && sh_clearAttrib) fputs("\e[0m", stdout);
     #else
     if (sh_clearAttrib) SetConsoleTextAttribute(hConsole, ocAttrib);
     #endif
     fflush(stdout);
-    arg[1] = realloc(arg[1], strlen(arg[1]) + 6); copyStrApnd(" 2>&1", arg[1]);
+    #ifndef _WIN32
+    int shret = shpoolRun(CBX(arg)[1], NULL, sh_silent);
+    if (shret != -1) {
+        CBX(retval) = WEXITSTATUS(shret);
+        if (sh_restoreAttrib) updateTxtAttrib();
+        goto noerr;
+    }
+    #endif
+    CBX(arg)[1] = realloc(CBX(arg)[1], strlen(CBX(arg)[1]) + 6); copyStrApnd(" 2>&1", CBX(arg)[1]);
     #ifdef _WIN32
-    if (sh_silent) {arg[1] = realloc(arg[1], strlen(arg[1]) + 13); copyStrApnd(" 1>nul 2>nul", arg[1]);}
+    if (sh_silent) {CBX(arg)[1] = realloc(CBX(arg)[1], strlen(CBX(arg)[1]) + 13); copyStrApnd(" 1>nul 2>nul", CBX(arg)[1]);}
     #else
-    if (sh_silent) {arg[1] = realloc(arg[1], strlen(arg[1]) + 13); copyStrApnd(" &>/dev/null", arg[1]);}
+    if (sh_silent) {CBX(arg)[1] = realloc(CBX(arg)[1], strlen(CBX(arg)[1]) + 13); copyStrApnd(" &>/dev/null", CBX(arg)[1]);}
     #endif
     fflush(stdout);
     int duperr;
     duperr = dup(2);
     close(2);
-    retval = WEXITSTATUS(system(arg[1]));
+    CBX(retval) = WEXITSTATUS(system(CBX(arg)[1]));
     dup2(duperr, 2);
     close(duperr);
     if (sh_restoreAttrib) updateTxtAttrib();
-    cerr = 0;
+    CBX(cerr) = 0;
     goto noerr;
 }
 if (chkCmd(2, "EXEC", "EXECA")) {
-    if (argct < 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     bool execa = false;
     char** tmparg = NULL;
     int tmpargct = 0;
-    if (!strcmp(arg[0], "EXECA")) {
-        if (argct != 1) {cerr = 3; goto cmderr;}
+    if (!strcmp(CBX(arg)[0], "EXECA")) {
+        if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
         execa = true;
         int v = -1;
-        for (register int i = 0; i < varmaxct; ++i) {
-            if (vardata[i].inuse && !strcmp(arg[1], vardata[i].name)) {v = i; break;}
+        for (register int i = 0; i < CBX(varmaxct); ++i) {
+            if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v = i; break;}
         }
-        if (v == -1 || vardata[v].size == -1) {cerr = 23; seterrstr(arg[1]); goto cmderr;}
-        if (vardata[v].type != 1) {cerr = 2; goto cmderr;}
-        tmparg = arg;
-        tmpargct = argct;
-        arg = vardata[v].data - 1;
-        argct = vardata[v].size + 1;
+        if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[1]); goto cmderr;}
+        if (CBX(vardata)[v].type != 1) {CBX(cerr) = 2; goto cmderr;}
+        tmparg = CBX(arg);
+        tmpargct = CBX(argct);
+        CBX(arg) = CBX(vardata)[v].data - 1;
+        CBX(argct) = CBX(vardata)[v].size + 1;
     } else {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] != 1) {cerr = 2; goto cmderr;}
+        if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     }
     #ifndef _WIN_NO_VT
     if (esc && sh_clearAttrib) fputs("\e[0m", stdout);
@@ -709,12 +844,12 @@ if (chkCmd(2, "EXEC", "EXECA")) {
     #endif
     fflush(stdout);
     #ifndef _WIN32
-    char** runargs = (char**)malloc((argct + 1) * sizeof(char*));
-    runargs[0] = arg[1];
+    char** runargs = (char**)malloc((CBX(argct) + 1) * sizeof(char*));
+    runargs[0] = CBX(arg)[1];
     int argno = 1;
-    for (; argno < argct; ++argno) {
+    for (; argno < CBX(argct); ++argno) {
         if (!execa) if (!solvearg(argno + 1)) {free(runargs); goto cmderr;}
-        runargs[argno] = arg[argno + 1];
+        runargs[argno] = CBX(arg)[argno + 1];
     }
     runargs[argno] = NULL;
     int stdout_dup = 0, stderr_dup = 0;
@@ -726,14 +861,14 @@ if (chkCmd(2, "EXEC", "EXECA")) {
         dup2(fd, 2);
     }
     pid_t pid = fork();
-    if (pid < 0) cerr = -1;
+    if (pid < 0) CBX(cerr) = -1;
     if (pid == 0) {
         execvp(runargs[0], runargs);
         exit(127);
     }
     else if (pid > 0) {
-        while (wait(&retval) != pid) {}
-        retval = ((retval >> 8) & 0xFF);
+        while (wait(&CBX(retval)) != pid) {}
+        CBX(retval) = ((CBX(retval) >> 8) & 0xFF);
     }
     else if (sh_silent) {
         dup2(stdout_dup, 1);
@@ -745,16 +880,16 @@ if (chkCmd(2, "EXEC", "EXECA")) {
     char* tmpcmd = malloc(CB_BUF_SIZE);
     tmpcmd[0] = 0;
     bool winecho = false;
-    for (int argno = 1; argno <= argct; ++argno) {
+    for (int argno = 1; argno <= CBX(argct); ++argno) {
         if (!execa) if (argno > 1) if (!solvearg(argno)) {free(tmpcmd); goto cmderr;};
         strApndChar(tmpcmd, ' ');
-        bool nq = winArgNeedsQuotes(arg[argno]);
+        bool nq = winArgNeedsQuotes(CBX(arg)[argno]);
         if (argno == 1) {
-            upCase(arg[argno]);
-            winecho = !strcmp(arg[argno], "ECHO");
+            upCase(CBX(arg)[argno]);
+            winecho = !strcmp(CBX(arg)[argno], "ECHO");
         }
         if (nq && !winecho) copyStrApnd(" \"", tmpcmd);
-        copyStrApnd(arg[argno], tmpcmd);
+        copyStrApnd(CBX(arg)[argno], tmpcmd);
         if (nq && !winecho) strApndChar(tmpcmd, '"');
     }
     int stdout_dup = 0, stderr_dup = 0;
@@ -765,7 +900,7 @@ if (chkCmd(2, "EXEC", "EXECA")) {
         dup2(fd, 1);
         dup2(fd, 2);
     }
-    retval = WEXITSTATUS(system(tmpcmd));
+    CBX(retval) = WEXITSTATUS(system(tmpcmd));
     if (sh_silent) {
         dup2(stdout_dup, 1);
         dup2(stderr_dup, 2);
@@ -773,31 +908,236 @@ if (chkCmd(2, "EXEC", "EXECA")) {
     free(tmpcmd);
     #endif
     if (execa) {
-        argct = tmpargct;
-        arg = tmparg;
+        CBX(argct) = tmpargct;
+        CBX(arg) = tmparg;
     }
     if (sh_restoreAttrib) updateTxtAttrib();
-    if (cerr) goto cmderr;
+    if (CBX(cerr)) goto cmderr;
+    goto noerr;
+}
+if (chkCmd(1, "EXECPAR")) {
+    if (CBX(argct) < 2 || CBX(argct) > 4) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    for (int i = 1; i <= CBX(argct); ++i) {
+        if (i == 3) continue;
+        if (!CBX(arg)[i][0] || getType(CBX(arg)[i]) != 255) {CBX(cerr) = 4; seterrstr(CBX(arg)[i]); goto cmderr;}
+        upCase(CBX(arg)[i]);
+    }
+    if (CBX(arg)[2][strlen(CBX(arg)[2]) - 1] == '$') {CBX(cerr) = 2; goto cmderr;}
+    if (CBX(argct) > 3 && CBX(arg)[4][strlen(CBX(arg)[4]) - 1] != '$') {CBX(cerr) = 2; goto cmderr;}
+    int32_t limit = 0;
+    if (CBX(argct) > 2) {
+        if (!solvearg(3)) goto cmderr;
+        if (CBX(argt)[3] != 2) {CBX(cerr) = 2; goto cmderr;}
+        limit = atoi(CBX(arg)[3]);
+        if (limit < 0) {CBX(cerr) = 16; seterrstr(CBX(arg)[3]); goto cmderr;}
+    }
+    #ifndef _WIN32
+    if (!limit) limit = sysconf(_SC_NPROCESSORS_ONLN);
+    #endif
+    if (limit < 1) limit = 1;
+    int v = -1;
+    for (register int i = 0; i < CBX(varmaxct); ++i) {
+        if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v = i; break;}
+    }
+    if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(CBX(arg)[1]); goto cmderr;}
+    if (CBX(vardata)[v].type != 1) {CBX(cerr) = 2; goto cmderr;}
+    int32_t ct = CBX(vardata)[v].size + 1;
+    char** cmds = (char**)malloc(ct * sizeof(char*));
+    for (int32_t i = 0; i < ct; ++i) {
+        cmds[i] = malloc(strlen(CBX(vardata)[v].data[i]) + 1);
+        copyStr(CBX(vardata)[v].data[i], cmds[i]);
+    }
+    int* codes = (int*)calloc(ct, sizeof(int));
+    char** outs = (CBX(argct) > 3) ? (char**)calloc(ct, sizeof(char*)) : NULL;
+    #ifndef _WIN_NO_VT
+    if (esc && sh_clearAttrib) fputs("\e[0m", stdout);
+    #else
+    if (sh_clearAttrib) SetConsoleTextAttribute(hConsole, ocAttrib);
+    #endif
+    fflush(stdout);
+    #ifndef _WIN32
+    pid_t* pids = (pid_t*)calloc(ct, sizeof(pid_t));
+    int32_t* outl = (outs) ? (int32_t*)calloc(ct, sizeof(int32_t)) : NULL;
+    // with capture every child writes to a pipe that reaches EOF when it is done, without it the
+    // children are checked with WNOHANG (poll() skips their -1 fd and just sleeps), waiting a little
+    // longer each time none has exited, so only our own children are reaped; the internal fds are
+    // close-on-exec so the commands never inherit them
+    struct pollfd* pfds = (struct pollfd*)malloc(limit * sizeof(struct pollfd));
+    int32_t* pfdi = (int32_t*)malloc(limit * sizeof(int32_t));
+    int npfds = 0;
+    int32_t next = 0, running = 0;
+    int backoff = 1;
+    int nullfd = (sh_silent && !outs) ? open("/dev/null", O_WRONLY | O_CLOEXEC) : -1;
+    while (next < ct || running > 0) {
+        while (next < ct && running < limit) {
+            int p[2] = {-1, -1};
+            if (outs) {
+                if (pipe(p)) {codes[next++] = 127; continue;}
+                fcntl(p[0], F_SETFD, FD_CLOEXEC);
+                fcntl(p[1], F_SETFD, FD_CLOEXEC);
+            }
+            pid_t pid = fork();
+            if (pid == 0) {
+                if (outs) {
+                    dup2(p[1], 1);
+                    dup2(p[1], 2);
+                } else if (nullfd != -1) {
+                    dup2(nullfd, 1);
+                    dup2(nullfd, 2);
+                }
+                execl("/bin/sh", "sh", "-c", cmds[next], (char*)NULL);
+                _exit(127);
+            }
+            if (outs) close(p[1]);
+            if (pid < 0) {
+                if (outs) close(p[0]);
+                codes[next++] = 127;
+                continue;
+            }
+            pids[next] = pid;
+            if (outs) {
+                outs[next] = malloc(CB_BUF_SIZE);
+                outs[next][0] = 0;
+            }
+            pfds[npfds].fd = p[0];
+            pfds[npfds].events = POLLIN;
+            pfdi[npfds] = next;
+            ++npfds;
+            ++next;
+            ++running;
+        }
+        if (!running) continue;
+        if (poll(pfds, npfds, (outs) ? -1 : backoff) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (!outs) {
+            if (backoff < 16) backoff *= 2;
+            for (int i = 0; i < npfds; ++i) {
+                int32_t j = pfdi[i];
+                int status = 0;
+                pid_t r = waitpid(pids[j], &status, WNOHANG);
+                if (!r || (r < 0 && errno == EINTR)) continue;
+                codes[j] = (r < 0) ? 127 : (WIFSIGNALED(status)) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+                backoff = 1;
+                --running;
+                --npfds;
+                pfds[i] = pfds[npfds];
+                pfdi[i] = pfdi[npfds];
+                --i;
+            }
+            continue;
+        }
+        for (int i = 0; i < npfds; ++i) {
+            if (!pfds[i].revents) continue;
+            int32_t j = pfdi[i];
+            char rbuf[4096];
+            ssize_t r = read(pfds[i].fd, rbuf, sizeof(rbuf));
+            if (r < 0 && errno == EINTR) continue;
+            if (r > 0) {
+                if (outs) {
+                    int32_t cl = (r < CB_BUF_SIZE - 1 - outl[j]) ? r : CB_BUF_SIZE - 1 - outl[j];
+                    memcpy(&outs[j][outl[j]], rbuf, cl);
+                    outl[j] += cl;
+                }
+                continue;
+            }
+            if (outs) outs[j][outl[j]] = 0;
+            close(pfds[i].fd);
+            int status = 0;
+            while (waitpid(pids[j], &status, 0) < 0 && errno == EINTR) {}
+            codes[j] = (WIFSIGNALED(status)) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+            --running;
+            --npfds;
+            pfds[i] = pfds[npfds];
+            pfdi[i] = pfdi[npfds];
+            --i;
+        }
+    }
+    if (nullfd != -1) close(nullfd);
+    free(pids);
+    nfree(outl);
+    nfree(pfds);
+    nfree(pfdi);
+    getCurPos();
+    #else
+    for (int32_t i = 0; i < ct; ++i) {
+        if (outs) {
+            outs[i] = malloc(CB_BUF_SIZE);
+            outs[i][0] = 0;
+            FILE* p = _popen(cmds[i], "r");
+            if (p) {
+                outs[i][fread(outs[i], 1, CB_BUF_SIZE - 1, p)] = 0;
+                codes[i] = _pclose(p);
+            } else {
+                codes[i] = 127;
+            }
+        } else {
+            int stdout_dup = 0, stderr_dup = 0;
+            if (sh_silent) {
+                stdout_dup = dup(1);
+                stderr_dup = dup(2);
+                int fd = open("NUL", _O_WRONLY | _O_CREAT);
+                dup2(fd, 1);
+                dup2(fd, 2);
+            }
+            codes[i] = WEXITSTATUS(system(cmds[i]));
+            if (sh_silent) {
+                dup2(stdout_dup, 1);
+                dup2(stderr_dup, 2);
+            }
+        }
+    }
+    #endif
+    CBX(retval) = 0;
+    int rv = dimVar(CBX(arg)[2], 2, ct - 1);
+    if (rv != -1) {
+        for (int32_t i = 0; i < ct; ++i) {
+            if (codes[i] > CBX(retval)) CBX(retval) = codes[i];
+            CBX(vardata)[rv].data[i] = realloc(CBX(vardata)[rv].data[i], 12);
+            sprintf(CBX(vardata)[rv].data[i], "%d", codes[i]);
+        }
+    }
+    if (outs) {
+        int ov = (rv != -1) ? dimVar(CBX(arg)[4], 1, ct - 1) : -1;
+        for (int32_t i = 0; i < ct; ++i) {
+            if (ov != -1 && outs[i]) {
+                CBX(vardata)[ov].data[i] = realloc(CBX(vardata)[ov].data[i], strlen(outs[i]) + 1);
+                copyStr(outs[i], CBX(vardata)[ov].data[i]);
+            }
+            nfree(outs[i]);
+        }
+        free(outs);
+        if (ov == -1) rv = -1;
+    }
+    for (int32_t i = 0; i < ct; ++i) {
+        free(cmds[i]);
+    }
+    free(cmds);
+    free(codes);
+    if (sh_restoreAttrib) updateTxtAttrib();
+    if (rv == -1) goto cmderr;
     goto noerr;
 }
 if (chkCmd(1, "BELL")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     int ct = 1;
     double d = 750;
-    if (argct > 2) {cerr = 3; goto cmderr;}
-    if (argct >= 1) {
+    if (CBX(argct) > 2) {CBX(cerr) = 3; goto cmderr;}
+    if (CBX(argct) >= 1) {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] == 0) {cerr = 3; goto cmderr;}
-        if (argt[1] != 2) {cerr = 2; goto cmderr;}
-        ct = atoi(arg[1]);
-        if (ct < 1) {cerr = 16; goto cmderr;}
+        if (CBX(argt)[1] == 0) {CBX(cerr) = 3; goto cmderr;}
+        if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+        ct = atoi(CBX(arg)[1]);
+        if (ct < 1) {CBX(cerr) = 16; goto cmderr;}
     }
-    if (argct == 2) {
+    if (CBX(argct) == 2) {
         if (!solvearg(2)) goto cmderr;
-        if (argt[2] == 0) {cerr = 3; goto cmderr;}
-        if (argt[2] != 2) {cerr = 2; goto cmderr;}
-        if (arg[2][0] == '-') {cerr = 16; goto cmderr;}
-        sscanf(arg[2], "%lf", &d);
+        if (CBX(argt)[2] == 0) {CBX(cerr) = 3; goto cmderr;}
+        if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+        if (CBX(arg)[2][0] == '-') {CBX(cerr) = 16; goto cmderr;}
+        sscanf(CBX(arg)[2], "%lf", &d);
     }
     putchar('\a');
     fflush(stdout);
@@ -810,31 +1150,31 @@ if (chkCmd(1, "BELL")) {
     goto noerr;
 }
 if (chkCmd(1, "FILES")) {
-    cerr = 0;
-    if (argct > 1) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (CBX(argct) > 1) {CBX(cerr) = 3; goto cmderr;}
     char* olddn = NULL;
-    if (argct) {
+    if (CBX(argct)) {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] != 1) {cerr = 2; goto cmderr;}
-        int tmpret = isFile(arg[1]);
+        if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
+        int tmpret = isFile(CBX(arg)[1]);
         if (tmpret) {
-            if (tmpret == -1) {cerr = 15; seterrstr(arg[1]);}
-            else {cerr = 19;}
+            if (tmpret == -1) {CBX(cerr) = 15; seterrstr(CBX(arg)[1]);}
+            else {CBX(cerr) = 19;}
             goto cmderr;
         }
         olddn = malloc(CB_BUF_SIZE);
         char* bret = getcwd(olddn, CB_BUF_SIZE);
         (void)bret;
-        if (chdir(arg[1])) {
+        if (chdir(CBX(arg)[1])) {
             free(olddn);
-            seterrstr(arg[1]);
-            cerr = 17;
+            seterrstr(CBX(arg)[1]);
+            CBX(cerr) = 17;
             goto cmderr;
         }
     }
     DIR* cwd = opendir(".");
     int ret;
-    if (!cwd) {if (argct) {ret = chdir(olddn); free(olddn);} goto noerr;}
+    if (!cwd) {if (CBX(argct)) {ret = chdir(olddn); free(olddn);} goto noerr;}
     struct dirent* dir;
     #ifdef _WIN32
         #define DIRPFS "%s\\\n"
@@ -854,7 +1194,7 @@ if (chkCmd(1, "FILES")) {
         stat(dir->d_name, &pathstat);
         if (!(S_ISDIR(pathstat.st_mode))) puts(dir->d_name);
     }
-    if (argct) {
+    if (CBX(argct)) {
         ret = chdir(olddn);
         free(olddn);
     }
@@ -862,162 +1202,274 @@ if (chkCmd(1, "FILES")) {
     (void)ret;
     goto noerr;
 }
+if (chkCmd(1, "DIRLIST")) {
+    CBX(cerr) = 0;
+    if (CBX(argct) < 2 || CBX(argct) > 3) {CBX(cerr) = 3; goto cmderr;}
+    if (!solvearg(1)) goto cmderr;
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
+    if (!CBX(arg)[2][0] || getType(CBX(arg)[2]) != 255) {CBX(cerr) = 4; seterrstr(CBX(arg)[2]); goto cmderr;}
+    upCase(CBX(arg)[2]);
+    if (CBX(arg)[2][strlen(CBX(arg)[2]) - 1] != '$') {CBX(cerr) = 2; goto cmderr;}
+    bool rec = false;
+    if (CBX(argct) == 3) {
+        if (!solvearg(3)) goto cmderr;
+        if (CBX(argt)[3] != 2) {CBX(cerr) = 2; goto cmderr;}
+        rec = (atof(CBX(arg)[3]) != 0.0);
+    }
+    if (dirList(CBX(arg)[1], CBX(arg)[2], rec) < 0) goto cmderr;
+    goto noerr;
+}
 if (chkCmd(1, "EXTENSIONS")) {
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     for (register int i = 0; i < extmaxct; ++i) {
         if (extdata[i].inuse) {puts(extdata[i].name);}
     }
     goto noerr;
 }
 if (chkCmd(2, "CHDIR", "CD")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 1) {cerr = 2; goto cmderr;}
-    if (chdir(arg[1])) {
-        seterrstr(arg[1]);
-        cerr = 17;
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
+    if (chdir(CBX(arg)[1])) {
+        seterrstr(CBX(arg)[1]);
+        CBX(cerr) = 17;
         goto cmderr;
     }
     goto noerr;
 }
 if (chkCmd(1, "FCLOSE")) {
-    cerr = 0;
-    fileerror = 0;
-    if (argct != 1) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
     if (!solvearg(1)) {goto cmderr;}
-    if (argt[1] != 2) {cerr = 3; goto cmderr;}
-    if (!closeFile(atoi(arg[1]))) {cerr = 16; goto cmderr;}
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 3; goto cmderr;}
+    if (!closeFile(atoi(CBX(arg)[1]))) {CBX(cerr) = 16; goto cmderr;}
     goto noerr;
 }
-if (chkCmd(1, "FWRITE")) {
-    cerr = 0;
-    fileerror = 0;
-    if (argct != 2) {cerr = 3; goto cmderr;}
+if (chkCmd(2, "FWRITE", "FWRITELN")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
     if (!solvearg(1)) {goto cmderr;}
     if (!solvearg(2)) {goto cmderr;}
-    if (argt[1] != 2 || argt[2] != 1) {cerr = 2; goto cmderr;}
-    int fnum = atoi(arg[1]);
-    if (fnum < 0 || fnum >= filemaxct) {
-        cerr = 16;
+    if (CBX(argt)[1] != 2 || CBX(argt)[2] != 1) {CBX(cerr) = 2; goto cmderr;}
+    int fnum = atoi(CBX(arg)[1]);
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(cerr) = 16;
         goto cmderr;
     } else {
         errno = 0;
-        fputs(arg[2], filedata[fnum].fptr);
-        fileerror = errno;
+        fileWrite(fnum, CBX(arg)[2], !strcmp(CBX(arg)[0], "FWRITELN"));
+        CBX(fileerror) = errno;
+    }
+    goto noerr;
+}
+if (chkCmd(1, "FBUFFER")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
+    if (!solvearg(1)) {goto cmderr;}
+    if (!solvearg(2)) {goto cmderr;}
+    if (CBX(argt)[1] != 2 || CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int fnum = atoi(CBX(arg)[1]);
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(cerr) = 16;
+        goto cmderr;
+    }
+    if (atoi(CBX(arg)[2]) < 0) {CBX(cerr) = 16; goto cmderr;}
+    errno = 0;
+    fileSetBuf(fnum, atoi(CBX(arg)[2]));
+    CBX(fileerror) = errno;
+    goto noerr;
+}
+if (chkCmd(1, "PUTREC")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 3) {CBX(cerr) = 3; goto cmderr;}
+    if (!solvearg(1)) {goto cmderr;}
+    if (!solvearg(2)) {goto cmderr;}
+    if (!solvearg(3)) {goto cmderr;}
+    if (CBX(argt)[1] != 2 || CBX(argt)[2] != 2 || CBX(argt)[3] != 1) {CBX(cerr) = 2; goto cmderr;}
+    int fnum = atoi(CBX(arg)[1]);
+    int64_t rec = strtoll(CBX(arg)[2], NULL, 10);
+    if (fnum < 0 || fnum >= CBX(filemaxct) || !CBX(filedata)[fnum].reclen || rec < 0) {
+        CBX(cerr) = 16;
+        goto cmderr;
     }
+    errno = 0;
+    filePutRec(fnum, rec, CBX(arg)[3]);
+    CBX(fileerror) = errno;
+    goto noerr;
+}
+if (chkCmd(1, "KVPUT")) {
+    CBX(cerr) = 0;
+    if (CBX(argct) != 3) {CBX(cerr) = 3; goto cmderr;}
+    if (!solvearg(1)) {goto cmderr;}
+    if (!solvearg(2)) {goto cmderr;}
+    if (!solvearg(3)) {goto cmderr;}
+    if (CBX(argt)[1] != 2 || CBX(argt)[2] != 1 || CBX(argt)[3] != 1) {CBX(cerr) = 2; goto cmderr;}
+    if (!kvPut(atoi(CBX(arg)[1]), CBX(arg)[2], CBX(arg)[3]) && CBX(fileerror) == EINVAL) {CBX(cerr) = 16; goto cmderr;}
+    goto noerr;
+}
+if (chkCmd(2, "KVDEL", "KVCLOSE")) {
+    CBX(cerr) = 0;
+    bool kvdel = !strcmp(CBX(arg)[0], "KVDEL");
+    if (CBX(argct) != 1 + kvdel) {CBX(cerr) = 3; goto cmderr;}
+    if (!solvearg(1)) {goto cmderr;}
+    if (kvdel && !solvearg(2)) {goto cmderr;}
+    if (CBX(argt)[1] != 2 || (kvdel && CBX(argt)[2] != 1)) {CBX(cerr) = 2; goto cmderr;}
+    if (kvdel) kvDel(atoi(CBX(arg)[1]), CBX(arg)[2]);
+    else kvClose(atoi(CBX(arg)[1]));
+    if (CBX(fileerror) == EINVAL) {CBX(cerr) = 16; goto cmderr;}
     goto noerr;
 }
 if (chkCmd(1, "FSEEK")) {
-    cerr = 0;
-    fileerror = 0;
-    if (argct != 2) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
     if (!solvearg(1)) {goto cmderr;}
     if (!solvearg(2)) {goto cmderr;}
-    if (argt[1] != 2 || argt[2] != 2) {cerr = 2; goto cmderr;}
-    int fnum = atoi(arg[1]);
-    if (fnum < 0 || fnum >= filemaxct) {
-        cerr = 16;
+    if (CBX(argt)[1] != 2 || CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int fnum = atoi(CBX(arg)[1]);
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(cerr) = 16;
         goto cmderr;
     } else {
         errno = 0;
-        int32_t pos = atoi(arg[2]);
+        int64_t pos = strtoll(CBX(arg)[2], NULL, 10);
         if (pos < 0) {
-            cerr = 16;
+            CBX(cerr) = 16;
         } else {
-            fseek(filedata[fnum].fptr, (pos > filedata[fnum].size) ? filedata[fnum].size : pos, SEEK_SET);
-            fileerror = errno;
+            fileSeek(fnum, pos);
+            CBX(fileerror) = errno;
         }
     }
     goto noerr;
 }
 if (chkCmd(1, "FLUSH")) {
-    cerr = 0;
-    fileerror = 0;
-    if (argct != 1) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
     if (!solvearg(1)) {goto cmderr;}
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
-    int fnum = atoi(arg[1]);
-    if (fnum < 0 || fnum >= filemaxct) {
-        cerr = 16;
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int fnum = atoi(CBX(arg)[1]);
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(cerr) = 16;
         goto cmderr;
     }
     errno = 0;
-    fflush(filedata[fnum].fptr);
-    fileerror = errno;
+    fileFlush(fnum);
+    CBX(fileerror) = errno;
     goto noerr;
 }
 if (chkCmd(2, "MD", "MKDIR")) {
-    cerr = 0;
-    fileerror = 0;
-    if (argct != 1) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
     if (!solvearg(1)) {goto cmderr;}
-    if (argt[1] != 1) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     errno = 0;
     #ifndef _WIN32
-    mkdir(arg[1], S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    mkdir(CBX(arg)[1], S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
     #else
-    mkdir(arg[1]);
+    mkdir(CBX(arg)[1]);
     #endif
-    fileerror = errno;
+    CBX(fileerror) = errno;
     goto noerr;
 }
 if (chkCmd(2, "RM", "REMOVE")) {
-    cerr = 0;
-    fileerror = 0;
-    if (argct != 1) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
     if (!solvearg(1)) {goto cmderr;}
-    if (argt[1] != 1) {cerr = 2; goto cmderr;}
-    cbrm(arg[1]);
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
+    cbrm(CBX(arg)[1]);
+    goto noerr;
+}
+if (chkCmd(2, "COPY", "CP")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
+    if (!solvearg(1)) {goto cmderr;}
+    if (!solvearg(2)) {goto cmderr;}
+    if (CBX(argt)[1] != 1 || CBX(argt)[2] != 1) {CBX(cerr) = 2; goto cmderr;}
+    copyFile(CBX(arg)[1], CBX(arg)[2]);
+    goto noerr;
+}
+if (chkCmd(1, "CSVLOAD")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 3) {CBX(cerr) = 3; goto cmderr;}
+    if (!solvearg(1) || !solvearg(2)) goto cmderr;
+    if (CBX(argt)[1] != 1 || CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int32_t cols = atoi(CBX(arg)[2]);
+    if (cols < 1) {CBX(cerr) = 16; seterrstr(CBX(arg)[2]); goto cmderr;}
+    if (!CBX(arg)[3][0] || getType(CBX(arg)[3]) != 255) {CBX(cerr) = 4; seterrstr(CBX(arg)[3]); goto cmderr;}
+    upCase(CBX(arg)[3]);
+    if (csvLoad(CBX(arg)[1], cols, CBX(arg)[3]) < 0) goto cmderr;
+    goto noerr;
+}
+if (chkCmd(1, "SORTFILE")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) < 2 || CBX(argct) > 3) {CBX(cerr) = 3; goto cmderr;}
+    for (int i = 1; i <= CBX(argct); ++i) {
+        if (!solvearg(i)) {goto cmderr;}
+        if (CBX(argt)[i] != 1) {CBX(cerr) = 2; goto cmderr;}
+    }
+    cb_sortopts so;
+    if (!sortParseOpts((CBX(argct) == 3) ? CBX(arg)[3] : "", &so)) {CBX(cerr) = 16; seterrstr(CBX(arg)[3]); goto cmderr;}
+    sortFile(CBX(arg)[1], CBX(arg)[2], &so);
     goto noerr;
 }
 if (chkCmd(4, "MV", "MOVE", "REN", "RENAME")) {
-    cerr = 0;
-    fileerror = 0;
-    if (argct != 2) {cerr = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
     if (!solvearg(1)) {goto cmderr;}
     if (!solvearg(2)) {goto cmderr;}
-    if (argt[1] != 1 || argt[2] != 1) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 1 || CBX(argt)[2] != 1) {CBX(cerr) = 2; goto cmderr;}
     errno = 0;
-    rename(arg[1], arg[2]);
-    fileerror = errno;
+    rename(CBX(arg)[1], CBX(arg)[2]);
+    CBX(fileerror) = errno;
     goto noerr;
 }
 if (chkCmd(1, "LOADEXT")) {
-    if (argct < 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    for (int i = 1; i <= argct; i++) {
-        if (!solvearg(i) || argt[i] != 1) {cerr = 2; goto cmderr;}
-        if (loadExt(arg[i]) < 0) {goto cmderr;}
+    if (CBX(argct) < 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    for (int i = 1; i <= CBX(argct); i++) {
+        if (!solvearg(i) || CBX(argt)[i] != 1) {CBX(cerr) = 2; goto cmderr;}
+        if (loadExt(CBX(arg)[i]) < 0) {goto cmderr;}
     }
     goto noerr;
 }
 if (chkCmd(1, "UNLOADEXT")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] == 1) {
-        upCase(arg[1]);
+    if (CBX(argt)[1] == 1) {
+        upCase(CBX(arg)[1]);
         for (register int i = 0; i < extmaxct; ++i) {
-            if (extdata[i].inuse && !strcmp(arg[1], extdata[i].name)) {
+            if (extdata[i].inuse && !strcmp(CBX(arg)[1], extdata[i].name)) {
                 unloadExt(i);
                 goto noerr;
             }
         }
-        cerr = 16;
+        CBX(cerr) = 16;
         goto cmderr;
     } else {
-        if (!unloadExt(atoi(arg[1]))) goto cmderr;
+        if (!unloadExt(atoi(CBX(arg)[1]))) goto cmderr;
     }
     goto noerr;
 }
 goto cmderr;
 _cmd:;
 if (chkCmd(1, "_RESETTITLE")) {
-    if (inProg) {cerr = 254; goto cmderr;}
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(inProg)) {CBX(cerr) = 254; goto cmderr;}
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     #ifndef _WIN_NO_VT
     if (esc) {
         if (!changedtitle) {
@@ -1036,10 +1488,10 @@ if (chkCmd(1, "_RESETTITLE")) {
     goto noerr;
 }
 if (chkCmd(1, "_TITLE")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 1) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     #ifndef _WIN_NO_VT
     if (esc) {
         if (!changedtitle) {
@@ -1048,72 +1500,77 @@ if (chkCmd(1, "_TITLE")) {
             changedtitle = true;
         }
         changedtitlecmd = true;
-        printf("\e]2;%s%c", arg[1], 7);
+        printf("\e]2;%s%c", CBX(arg)[1], 7);
     }
     #else
-    SetConsoleTitleA(arg[1]);
+    SetConsoleTitleA(CBX(arg)[1]);
     #endif
     goto noerr;
 }
 if (chkCmd(1, "_SETENV")) {
-    if (argct != 2) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
     if (!solvearg(2)) goto cmderr;
-    if (argt[1] != 1 || argt[2] != 1) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 1 || CBX(argt)[2] != 1) {CBX(cerr) = 2; goto cmderr;}
     #ifndef _WIN32
-    setenv(arg[1], arg[2], 1);
+    setenv(CBX(arg)[1], CBX(arg)[2], 1);
+    __atomic_add_fetch(&shpoolgen, 1, __ATOMIC_RELAXED);
     #else
-    SetEnvironmentVariable(arg[1], arg[2]);
+    SetEnvironmentVariable(CBX(arg)[1], CBX(arg)[2]);
     #endif
     goto noerr;
 }
 if (chkCmd(1, "_UNSETENV")) {
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 1) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     #ifndef _WIN32
-    unsetenv(arg[1]);
+    unsetenv(CBX(arg)[1]);
+    __atomic_add_fetch(&shpoolgen, 1, __ATOMIC_RELAXED);
     #else
-    SetEnvironmentVariable(arg[1], "");
+    SetEnvironmentVariable(CBX(arg)[1], "");
     #endif
     goto noerr;
 }
 if (chkCmd(1, "_PROMPT")) {
-    if (inProg && !autorun) {cerr = 254; goto cmderr;}
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    copyStr(arg[1], prompt);
+    if (CBX(inProg) && !autorun) {CBX(cerr) = 254; goto cmderr;}
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    copyStr(CBX(arg)[1], prompt);
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 1) {cerr = 2; goto cmderr;}
+    if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
     goto noerr;
 }
 if (chkCmd(1, "_PROMPTTAB")) {
-    if (inProg && !autorun) {cerr = 254; goto cmderr;}
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(inProg) && !autorun) {CBX(cerr) = 254; goto cmderr;}
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
-    tab_width = atoi(arg[1]);
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    tab_width = atoi(CBX(arg)[1]);
     goto noerr;
 }
 if (chkCmd(1, "_AUTOCMDHIST")) {
-    if (inProg) {cerr = 254; goto cmderr;}
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(inProg)) {CBX(cerr) = 254; goto cmderr;}
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     autohist = true;
     goto noerr;
 }
 if (chkCmd(1, "_SAVECMDHIST")) {
-    if (inProg && !autorun) {cerr = 254; goto cmderr;}
-    if (argct > 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
-    if (argct) {
+    if (CBX(inProg) && !autorun) {CBX(cerr) = 254; goto cmderr;}
+    if (CBX(argct) > 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (CBX(argct)) {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] != 1) {cerr = 2; goto cmderr;}
-        write_history(arg[1]);
+        if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
+        #ifndef CB_LIB
+        write_history(CBX(arg)[1]);
+        #endif
     } else {
+        #ifndef CB_LIB
         char* tmpcwd = getcwd(NULL, 0);
         int ret = chdir(gethome());
         write_history(HIST_FILE);
@@ -1122,46 +1579,68 @@ if (chkCmd(1, "_SAVECMDHIST")) {
         #endif
         ret = chdir(tmpcwd);
         (void)ret;
+        #endif
     }
     goto noerr;
 }
 if (chkCmd(1, "_LOADCMDHIST")) {
-    if (inProg && !autorun) {cerr = 254; goto cmderr;}
-    if (argct > 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(inProg) && !autorun) {CBX(cerr) = 254; goto cmderr;}
+    if (CBX(argct) > 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    #ifndef CB_LIB
     clear_history();
-    if (argct) {
+    #endif
+    if (CBX(argct)) {
         if (!solvearg(1)) goto cmderr;
-        if (argt[1] != 1) {cerr = 2; goto cmderr;}
-        read_history(arg[1]);
+        if (CBX(argt)[1] != 1) {CBX(cerr) = 2; goto cmderr;}
+        #ifndef CB_LIB
+        read_history(CBX(arg)[1]);
+        #endif
     } else {
+        #ifndef CB_LIB
         char* tmpcwd = getcwd(NULL, 0);
         int ret = chdir(gethome());
         read_history(".clibasic_history");
         ret = chdir(tmpcwd);
         (void)ret;
+        #endif
     }
     goto noerr;
 }
 if (chkCmd(1, "_LIMITCMDHIST")) {
-    if (inProg && !autorun) {cerr = 254; goto cmderr;}
-    if (argct != 1) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(inProg) && !autorun) {CBX(cerr) = 254; goto cmderr;}
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] != 2) {cerr = 2; goto cmderr;}
-    int32_t l = atoi(arg[1]);
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int32_t l = atoi(CBX(arg)[1]);
     if (l < -1) {
-        cerr = 16; goto cmderr;
-    } else if (l == -1) {
+        CBX(cerr) = 16; goto cmderr;
+    }
+    #ifndef CB_LIB
+    if (l == -1) {
         unstifle_history();
     } else {
         stifle_history(l);
     }
+    #endif
+    goto noerr;
+}
+if (chkCmd(1, "_SHPOOL")) {
+    if (CBX(argct) != 1) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
+    if (!solvearg(1)) goto cmderr;
+    if (CBX(argt)[1] != 2) {CBX(cerr) = 2; goto cmderr;}
+    int ct = atoi(CBX(arg)[1]);
+    if (ct < 0 || ct > 256) {CBX(cerr) = 16; seterrstr(CBX(arg)[1]); goto cmderr;}
+    #ifndef _WIN32
+    if (!shpoolStart(ct)) {CBX(cerr) = 16; seterrstr(CBX(arg)[1]); goto cmderr;}
+    #endif
     goto noerr;
 }
 if (chkCmd(1, "_TXTLOCK")) {
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     #ifndef _WIN32
     if (!textlock) {
         tcgetattr(0, &term);
@@ -1174,8 +1653,8 @@ if (chkCmd(1, "_TXTLOCK")) {
     goto noerr;
 }
 if (chkCmd(1, "_TXTUNLOCK")) {
-    if (argct) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct)) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     #ifndef _WIN32
     if (textlock) tcsetattr(0, TCSANOW, &restore);
     #endif
@@ -1183,62 +1662,62 @@ if (chkCmd(1, "_TXTUNLOCK")) {
     goto noerr;
 }
 if (chkCmd(1, "_TXTATTRIB")) {
-    if (argct < 1 || argct > 2) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) < 1 || CBX(argct) > 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] == 0) {cerr = 3; goto cmderr;}
+    if (CBX(argt)[1] == 0) {CBX(cerr) = 3; goto cmderr;}
     int attrib = 0;
-    if (argt[1] == 1) {
-        for (int32_t i = 0; arg[1][i]; i++) {
-            if (arg[1][i] >= 'a' && arg[1][i] <= 'z') arg[1][i] -= 32;
-            if (arg[1][i] == ' ') arg[1][i] = '_';
+    if (CBX(argt)[1] == 1) {
+        for (int32_t i = 0; CBX(arg)[1][i]; i++) {
+            if (CBX(arg)[1][i] >= 'a' && CBX(arg)[1][i] <= 'z') CBX(arg)[1][i] -= 32;
+            if (CBX(arg)[1][i] == ' ') CBX(arg)[1][i] = '_';
         }
-        if (!strcmp(arg[1], "RESET")) attrib = 0; else
-        if (!strcmp(arg[1], "BOLD")) attrib = 1; else
-        if (!strcmp(arg[1], "ITALIC")) attrib = 2; else
-        if (!strcmp(arg[1], "UNDERLINE")) attrib = 3; else
-        if (!strcmp(arg[1], "DBL_UNDERLINE") || !strcmp(arg[1], "DOUBLE_UNDERLINE")) attrib = 4; else
-        if (!strcmp(arg[1], "SQG_UNDERLINE") || !strcmp(arg[1], "SQUIGGLY_UNDERLINE")) attrib = 5; else
-        if (!strcmp(arg[1], "STRIKETHROUGH")) attrib = 6; else
-        if (!strcmp(arg[1], "OVERLINE")) attrib = 7; else
-        if (!strcmp(arg[1], "DIM")) attrib = 8; else
-        if (!strcmp(arg[1], "BLINK")) attrib = 9; else
-        if (!strcmp(arg[1], "HIDDEN")) attrib = 10; else
-        if (!strcmp(arg[1], "REVERSE")) attrib = 11; else
-        if (!strcmp(arg[1], "UNDERLINE_COLOR")) attrib = 12; else
-        if (!strcmp(arg[1], "FGC")) attrib = 13; else
-        if (!strcmp(arg[1], "BGC")) attrib = 14; else
-        if (!strcmp(arg[1], "TRUECOLOR") || !strcmp(arg[1], "TRUE_COLOR") || !strcmp(arg[1], "24BITCOLOR") || !strcmp(arg[1], "24BIT_COLOR")) attrib = 15; else
-        {cerr = 16; goto cmderr;}
+        if (!strcmp(CBX(arg)[1], "RESET")) attrib = 0; else
+        if (!strcmp(CBX(arg)[1], "BOLD")) attrib = 1; else
+        if (!strcmp(CBX(arg)[1], "ITALIC")) attrib = 2; else
+        if (!strcmp(CBX(arg)[1], "UNDERLINE")) attrib = 3; else
+        if (!strcmp(CBX(arg)[1], "DBL_UNDERLINE") || !strcmp(CBX(arg)[1], "DOUBLE_UNDERLINE")) attrib = 4; else
+        if (!strcmp(CBX(arg)[1], "SQG_UNDERLINE") || !strcmp(CBX(arg)[1], "SQUIGGLY_UNDERLINE")) attrib = 5; else
+        if (!strcmp(CBX(arg)[1], "STRIKETHROUGH")) attrib = 6; else
+        if (!strcmp(CBX(arg)[1], "OVERLINE")) attrib = 7; else
+        if (!strcmp(CBX(arg)[1], "DIM")) attrib = 8; else
+        if (!strcmp(CBX(arg)[1], "BLINK")) attrib = 9; else
+        if (!strcmp(CBX(arg)[1], "HIDDEN")) attrib = 10; else
+        if (!strcmp(CBX(arg)[1], "REVERSE")) attrib = 11; else
+        if (!strcmp(CBX(arg)[1], "UNDERLINE_COLOR")) attrib = 12; else
+        if (!strcmp(CBX(arg)[1], "FGC")) attrib = 13; else
+        if (!strcmp(CBX(arg)[1], "BGC")) attrib = 14; else
+        if (!strcmp(CBX(arg)[1], "TRUECOLOR") || !strcmp(CBX(arg)[1], "TRUE_COLOR") || !strcmp(CBX(arg)[1], "24BITCOLOR") || !strcmp(CBX(arg)[1], "24BIT_COLOR")) attrib = 15; else
+        {CBX(cerr) = 16; goto cmderr;}
     } else {
-        attrib = atoi(arg[1]);
-        if (attrib < 0 || attrib > 12) {cerr = 16; goto cmderr;}
+        attrib = atoi(CBX(arg)[1]);
+        if (attrib < 0 || attrib > 12) {CBX(cerr) = 16; goto cmderr;}
     }
     int val = 0;
     if (attrib == 0) {
-        if (argct == 2) {cerr = 3; goto cmderr;}
+        if (CBX(argct) == 2) {CBX(cerr) = 3; goto cmderr;}
         memset(&txtattrib, 0, sizeof(cb_txt));
         txtattrib.fgce = true;
         goto cmderr;
-    } else if (argct != 2) {
-        if (attrib == 12) {cerr = 16; goto cmderr;}
+    } else if (CBX(argct) != 2) {
+        if (attrib == 12) {CBX(cerr) = 16; goto cmderr;}
         val = 1;
     } else {
         if (!solvearg(2)) goto cmderr;
         if (attrib == 12) {
-            if (argt[2] != 2) {cerr = 2; goto cmderr;}
-            val = atoi(arg[2]);
-            if (val < 0 || val > 255) {cerr = 16; goto cmderr;}
+            if (CBX(argt)[2] != 2) {CBX(cerr) = 2; goto cmderr;}
+            val = atoi(CBX(arg)[2]);
+            if (val < 0 || val > 255) {CBX(cerr) = 16; goto cmderr;}
         } else {
-            if (argt[2] == 0) {cerr = 3; goto cmderr;}
-            if (argt[2] == 1) {
-                upCase(arg[2]);
-                if (!strcmp(arg[2], "ON") || !strcmp(arg[2], "TRUE") || !strcmp(arg[2], "YES")) val = 1; else
-                if (!strcmp(arg[2], "OFF") || !strcmp(arg[2], "FALSE") || !strcmp(arg[2], "NO")) val = 0; else
-                {cerr = 16; goto cmderr;}
+            if (CBX(argt)[2] == 0) {CBX(cerr) = 3; goto cmderr;}
+            if (CBX(argt)[2] == 1) {
+                upCase(CBX(arg)[2]);
+                if (!strcmp(CBX(arg)[2], "ON") || !strcmp(CBX(arg)[2], "TRUE") || !strcmp(CBX(arg)[2], "YES")) val = 1; else
+                if (!strcmp(CBX(arg)[2], "OFF") || !strcmp(CBX(arg)[2], "FALSE") || !strcmp(CBX(arg)[2], "NO")) val = 0; else
+                {CBX(cerr) = 16; goto cmderr;}
             } else {
-                sscanf(arg[2], "%d", &val);
-                if (val < 0 || val > 1) {cerr = 16; goto cmderr;}
+                sscanf(CBX(arg)[2], "%d", &val);
+                if (val < 0 || val > 1) {CBX(cerr) = 16; goto cmderr;}
             }
         }
     }
@@ -1263,46 +1742,46 @@ if (chkCmd(1, "_TXTATTRIB")) {
     goto noerr;
 }
 if (chkCmd(1, "_SHATTRIB")) {
-    if (argct < 1 || argct > 2) {cerr = 3; goto cmderr;}
-    cerr = 0;
+    if (CBX(argct) < 1 || CBX(argct) > 2) {CBX(cerr) = 3; goto cmderr;}
+    CBX(cerr) = 0;
     if (!solvearg(1)) goto cmderr;
-    if (argt[1] == 0) {cerr = 3; goto cmderr;}
+    if (CBX(argt)[1] == 0) {CBX(cerr) = 3; goto cmderr;}
     int attrib = 0;
-    if (argt[1] == 1) {
-        for (int32_t i = 0; arg[1][i]; i++) {
-            if (arg[1][i] >= 'a' && arg[1][i] <= 'z') arg[1][i] -= 32;
-            if (arg[1][i] == ' ') arg[1][i] = '_';
+    if (CBX(argt)[1] == 1) {
+        for (int32_t i = 0; CBX(arg)[1][i]; i++) {
+            if (CBX(arg)[1][i] >= 'a' && CBX(arg)[1][i] <= 'z') CBX(arg)[1][i] -= 32;
+            if (CBX(arg)[1][i] == ' ') CBX(arg)[1][i] = '_';
         }
-        if (!strcmp(arg[1], "RESET")) attrib = 0; else
-        if (!strcmp(arg[1], "SILENT")) attrib = 1; else
-        if (!strcmp(arg[1], "CLEARATTRIB")) attrib = 2; else
-        if (!strcmp(arg[1], "RESTOREATTRIB")) attrib = 3; else
-        {cerr = 16; goto cmderr;}
+        if (!strcmp(CBX(arg)[1], "RESET")) attrib = 0; else
+        if (!strcmp(CBX(arg)[1], "SILENT")) attrib = 1; else
+        if (!strcmp(CBX(arg)[1], "CLEARATTRIB")) attrib = 2; else
+        if (!strcmp(CBX(arg)[1], "RESTOREATTRIB")) attrib = 3; else
+        {CBX(cerr) = 16; goto cmderr;}
     } else {
-        attrib = atoi(arg[1]);
-        if (attrib < 0 || attrib > 12) {cerr = 16; goto cmderr;}
+        attrib = atoi(CBX(arg)[1]);
+        if (attrib < 0 || attrib > 12) {CBX(cerr) = 16; goto cmderr;}
     }
     int val = 0;
     if (attrib == 0) {
-        if (argct == 2) {cerr = 3; goto cmderr;}
+        if (CBX(argct) == 2) {CBX(cerr) = 3; goto cmderr;}
         sh_silent = false;
         sh_clearAttrib = true;
         sh_restoreAttrib = true;
         goto cmderr;
-    } else if (argct != 2) {
-        if (attrib == 12) {cerr = 16; goto cmderr;}
+    } else if (CBX(argct) != 2) {
+        if (attrib == 12) {CBX(cerr) = 16; goto cmderr;}
         val = 1;
     } else {
         if (!solvearg(2)) goto cmderr;
-        if (argt[2] == 0) {cerr = 3; goto cmderr;}
-        if (argt[2] == 1) {
-            upCase(arg[2]);
-            if (!strcmp(arg[2], "ON") || !strcmp(arg[2], "TRUE") || !strcmp(arg[2], "YES")) val = 1; else
-            if (!strcmp(arg[2], "OFF") || !strcmp(arg[2], "FALSE") || !strcmp(arg[2], "NO")) val = 0; else
-            {cerr = 16; goto cmderr;}
+        if (CBX(argt)[2] == 0) {CBX(cerr) = 3; goto cmderr;}
+        if (CBX(argt)[2] == 1) {
+            upCase(CBX(arg)[2]);
+            if (!strcmp(CBX(arg)[2], "ON") || !strcmp(CBX(arg)[2], "TRUE") || !strcmp(CBX(arg)[2], "YES")) val = 1; else
+            if (!strcmp(CBX(arg)[2], "OFF") || !strcmp(CBX(arg)[2], "FALSE") || !strcmp(CBX(arg)[2], "NO")) val = 0; else
+            {CBX(cerr) = 16; goto cmderr;}
         } else {
-            sscanf(arg[2], "%d", &val);
-            if (val < 0 || val > 1) {cerr = 16; goto cmderr;}
+            sscanf(CBX(arg)[2], "%d", &val);
+            if (val < 0 || val > 1) {CBX(cerr) = 16; goto cmderr;}
         }
     }
     switch (attrib) {
@@ -0,0 +1,48 @@
+// Measures how many evaluations per second a host program gets out of libclibasic
+// Build and run with 'make bench'
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <libclibasic.h>
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(cb_ctx* ctx, const char* name, const char* src, int n) {
+    double t = now();
+    for (int i = 0; i < n; ++i) {
+        if (cbEval(ctx, src)) {fprintf(stderr, "%s: evaluation failed\n", name); exit(1);}
+    }
+    t = now() - t;
+    printf("%-12s %10d evals  %8.3f s  %12.0f evals/s\n", name, n, t, n / t);
+}
+
+int main(int argc, char** argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 200000;
+    if (n < 1) n = 1;
+    cb_ctx* ctx = cbCreate();
+    if (!ctx) {fputs("cbCreate failed\n", stderr); return 1;}
+    bench(ctx, "statement", "I = I + 1", n);
+    bench(ctx, "expression", "X = (I * 3 + 7) / 2 - ABS(SIN(I))", n);
+    bench(ctx, "string", "A$ = \"N\" + STR$(I)", n);
+    bench(ctx, "multiline", "J = 0\nDO\nJ = J + 1\nLOOPWHILE J < 10", n / 10);
+    char out[CB_LIB_BUF_SIZE];
+    double t = now();
+    for (int i = 0; i < n; ++i) {
+        sprintf(out, "%d", i);
+        cbSetVar(ctx, "K", out, 2);
+        cbGetVar(ctx, "K", out);
+    }
+    t = now() - t;
+    printf("%-12s %10d pairs  %8.3f s  %12.0f pairs/s\n", "set+get", n, t, n / t);
+    if (cbGetVar(ctx, "I", out) != 2 || atoi(out) != n) {fprintf(stderr, "I = %s, expected %d\n", out, n); return 1;}
+    cbDestroy(ctx);
+    return 0;
+}
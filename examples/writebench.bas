@@ -0,0 +1,34 @@
+# Compares FWRITELN throughput of the stdio append mode "a" with the writev append mode "av"
+# Run with 'make writebench' or 'clibasic examples/writebench.bas [records] [file]'
+
+N = 1000000
+IF _ARGC() > 0
+N = VAL(_ARG$(1))
+ENDIF
+P$ = "writebench.tmp"
+IF _ARGC() > 1
+P$ = _ARG$(2)
+ENDIF
+DIM M$, 1, ""
+M$[0] = "a"
+M$[1] = "av"
+FOR I, 0, I < 2, 1
+F = FOPEN(P$, "w")
+FCLOSE F
+F = FOPEN(P$, M$[I])
+T = TIMERUS()
+FOR J, 0, J < N, 1
+FWRITELN F, "record"
+NEXT
+FCLOSE F
+T = TIMERUS() - T
+F = FOPEN(P$, "r")
+S = FSIZE(F)
+FCLOSE F
+IF S <> N * 7
+PRINT "mode "; M$[I]; ": wrote "; S; " bytes, expected "; N * 7
+EXIT 1
+ENDIF
+PRINT "mode "; M$[I]; ": "; N; " records in "; T / 1000; " ms, "; INT(N / (T / 1000000)); " records/s"
+NEXT
+RM P$
@@ -13,120 +13,129 @@ for (int i = extmaxct - 1; i > -1; --i) {
         }
         extfr = extdata[i].runfunc(fargct, farg, fargt, flen, outbuf);
         if (extfr.cerr != 127) {
-            cerr = extfr.cerr;
+            CBX(cerr) = extfr.cerr;
             ftype = extfr.ftype;
             goto fexit;
         }
     }
 }
-if (chkCmdPtr[0] == '_') goto _func;
+if (CBX(chkCmdPtr)[0] == '_') goto _func;
 if (chkCmd(1, "CHR$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     outbuf[0] = (char)atoi(farg[1]);
     outbuf[1] = 0;
     goto fexit;
 }
 if (chkCmd(1, "ASC")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
     int32_t pos = 0;
-    if (fargct != 1 && fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1 && fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     if (fargct == 2) {
-        if (fargt[2] != 2) {cerr = 2; goto fexit;}
+        if (fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
         pos = atoi(farg[2]);
-        if (pos < 0) {cerr = 16; goto fexit;}
+        if (pos < 0) {CBX(cerr) = 16; goto fexit;}
         if (pos > (int32_t)strlen(farg[1])) pos = (int32_t)strlen(farg[1]);
     }
     sprintf(outbuf, "%u", farg[1][pos]);
     goto fexit;
 }
 if (chkCmd(1, "CHRAT$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
     int32_t pos = 0;
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     pos = atoi(farg[2]);
-    if (pos < 0) {cerr = 16; goto fexit;}
+    if (pos < 0) {CBX(cerr) = 16; goto fexit;}
     if (pos > (int32_t)strlen(farg[1])) pos = strlen(farg[1]);
     sprintf(outbuf, "%c", farg[1][pos]);
     goto fexit;
 }
 if (chkCmd(2, "RND", "RAND")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
     double min = 0;
     double max;
     if (fargct == 1) {
-        if (fargt[1] != 2) {cerr = 2; goto fexit;}
+        if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
         sscanf(farg[1], "%lf", &max);
     } else if (fargct == 2) {
-        if (fargt[1] + fargt[2] != 4) {cerr = 2; goto fexit;}
+        if (fargt[1] + fargt[2] != 4) {CBX(cerr) = 2; goto fexit;}
         sscanf(farg[1], "%lf", &min);
         sscanf(farg[2], "%lf", &max);
     } else {
-        cerr = 3;
+        CBX(cerr) = 3;
         goto fexit;
     }
     sprintf(outbuf, "%lf", randNum(min, max));
     goto fexit;
 }
 if (chkCmd(1, "TIMERUS")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;} 
+    if (fargct) {CBX(cerr) = 3; goto fexit;} 
     sprintf(outbuf, "%llu", (long long unsigned)timer());
     goto fexit;
 }
 if (chkCmd(1, "TIMERMS")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;} 
+    if (fargct) {CBX(cerr) = 3; goto fexit;} 
     sprintf(outbuf, "%llu", (long long unsigned)timer() / 1000);
     goto fexit;
 }
 if (chkCmd(1, "TIMER")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;} 
+    if (fargct) {CBX(cerr) = 3; goto fexit;} 
     sprintf(outbuf, "%llu", (long long unsigned)timer() / 1000000);
     goto fexit;
 }
 if (chkCmd(1, "TIMEUS")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;} 
+    if (fargct) {CBX(cerr) = 3; goto fexit;} 
     sprintf(outbuf, "%llu", (long long unsigned)usTime());
     goto fexit;
 }
 if (chkCmd(1, "TIMEMS")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;} 
+    if (fargct) {CBX(cerr) = 3; goto fexit;} 
     sprintf(outbuf, "%llu", (long long unsigned)usTime() / 1000);
     goto fexit;
 }
 if (chkCmd(1, "TIME")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;} 
+    if (fargct) {CBX(cerr) = 3; goto fexit;} 
     sprintf(outbuf, "%llu", (long long unsigned)usTime() / 1000000);
     goto fexit;
 }
 if (chkCmd(1, "SH")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;} 
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;} 
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     #ifndef _WIN_NO_VT
     if (esc && sh_clearAttrib) fputs("\e[0m", stdout);
     #else
     if (sh_clearAttrib) SetConsoleTextAttribute(hConsole, ocAttrib);
     #endif
+    #ifndef _WIN32
+    fflush(stdout);
+    int shret = shpoolRun(farg[1], NULL, sh_silent);
+    if (shret != -1) {
+        sprintf(outbuf, "%d", (CBX(retval) = shret));
+        if (sh_restoreAttrib) updateTxtAttrib();
+        goto fexit;
+    }
+    #endif
     farg[1] = realloc(farg[1], strlen(farg[1]) + 6); copyStrApnd(" 2>&1", farg[1]);
     #ifndef _WIN32
     if (sh_silent) {farg[1] = realloc(farg[1], strlen(farg[1]) + 13); copyStrApnd(" &>/dev/null", farg[1]);}
@@ -136,34 +145,34 @@ if (chkCmd(1, "SH")) {
     int duperr;
     duperr = dup(2);
     close(2);
-    sprintf(outbuf, "%d", (retval = system(farg[1])));
+    sprintf(outbuf, "%d", (CBX(retval) = system(farg[1])));
     dup2(duperr, 2);
     close(duperr);
     if (sh_restoreAttrib) updateTxtAttrib();
     goto fexit;
 }
 if (chkCmd(2, "EXEC", "EXECA")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct < 1) {cerr = 3; goto fexit;} 
+    if (fargct < 1) {CBX(cerr) = 3; goto fexit;} 
     bool execa = false;
     char** tmpfarg = NULL;
     int tmpfargct = 0;
     if (!strcmp(farg[0], "EXECA")) {
-        if (fargct != 1) {cerr = 3; goto fexit;}
+        if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
         execa = true;
         int v = -1;
-        for (register int i = 0; i < varmaxct; ++i) {
-            if (vardata[i].inuse && !strcmp(arg[1], vardata[i].name)) {v = i; break;}
+        for (register int i = 0; i < CBX(varmaxct); ++i) {
+            if (CBX(vardata)[i].inuse && !strcmp(CBX(arg)[1], CBX(vardata)[i].name)) {v = i; break;}
         }
-        if (v == -1 || vardata[v].size == -1) {cerr = 23; seterrstr(farg[1]); goto fexit;}
-        if (vardata[v].type != 1) {cerr = 2; goto fexit;}
+        if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(farg[1]); goto fexit;}
+        if (CBX(vardata)[v].type != 1) {CBX(cerr) = 2; goto fexit;}
         tmpfarg = farg;
         tmpfargct = fargct;
-        farg = vardata[v].data - 1;
-        fargct = vardata[v].size + 1;
+        farg = CBX(vardata)[v].data - 1;
+        fargct = CBX(vardata)[v].size + 1;
     } else {
-        if (fargt[1] != 1) {cerr = 2; goto fexit;}
+        if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     }
     #ifndef _WIN_NO_VT
     if (esc && sh_clearAttrib) fputs("\e[0m", stdout);
@@ -188,14 +197,14 @@ if (chkCmd(2, "EXEC", "EXECA")) {
         dup2(fd, 2);
     }
     pid_t pid = fork();
-    if (pid < 0) cerr = -1;
+    if (pid < 0) CBX(cerr) = -1;
     if (pid == 0) {
         execvp(runargs[0], runargs);
         exit(127);
     }
     else if (pid > 0) {
         while (wait(&status) != pid) {}
-        sprintf(outbuf, "%d", (retval = WEXITSTATUS(status)));
+        sprintf(outbuf, "%d", (CBX(retval) = WEXITSTATUS(status)));
     }
     else if (sh_silent) {
         dup2(stdout_dup, 1);
@@ -225,7 +234,7 @@ if (chkCmd(2, "EXEC", "EXECA")) {
         dup2(fd, 1);
         dup2(fd, 2);
     }
-    retval = WEXITSTATUS(system(tmpcmd));
+    CBX(retval) = WEXITSTATUS(system(tmpcmd));
     if (sh_silent) {
         dup2(stdout_dup, 1);
         dup2(stderr_dup, 2);
@@ -240,10 +249,17 @@ if (chkCmd(2, "EXEC", "EXECA")) {
     goto fexit;
 }
 if (chkCmd(1, "SH$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;} 
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;} 
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
+    #ifndef _WIN32
+    int shret = shpoolRun(farg[1], outbuf, false);
+    if (shret != -1) {
+        CBX(retval) = WEXITSTATUS(shret);
+        goto fexit;
+    }
+    #endif
     farg[1] = realloc(farg[1], strlen(farg[1]) + 6); copyStrApnd(" 2>&1", farg[1]);
     int duperr;
     duperr = dup(2);
@@ -252,34 +268,34 @@ if (chkCmd(1, "SH$")) {
     FILE* p = popen(farg[1], "r");
     if (p) {
         outbuf[fread(outbuf, 1, CB_BUF_SIZE - 1, p)] = 0;
-        retval = WEXITSTATUS(pclose(p));
+        CBX(retval) = WEXITSTATUS(pclose(p));
     }
     dup2(duperr, 2);
     close(duperr);
     goto fexit;
 }
 if (chkCmd(2, "EXEC$", "EXECA$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct < 1) {cerr = 3; goto fexit;} 
+    if (fargct < 1) {CBX(cerr) = 3; goto fexit;} 
     bool execa = false;
     char** tmpfarg = NULL;
     int tmpfargct = 0;
     if (!strcmp(farg[0], "EXECA$")) {
-        if (fargct != 1) {cerr = 3; goto fexit;}
+        if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
         execa = true;
         int v = -1;
-        for (register int i = 0; i < varmaxct; ++i) {
-            if (vardata[i].inuse && !strcmp(farg[1], vardata[i].name)) {v = i; break;}
+        for (register int i = 0; i < CBX(varmaxct); ++i) {
+            if (CBX(vardata)[i].inuse && !strcmp(farg[1], CBX(vardata)[i].name)) {v = i; break;}
         }
-        if (v == -1 || vardata[v].size == -1) {cerr = 23; seterrstr(farg[1]); goto fexit;}
-        if (vardata[v].type != 1) {cerr = 2; goto fexit;}
+        if (v == -1 || CBX(vardata)[v].size == -1) {CBX(cerr) = 23; seterrstr(farg[1]); goto fexit;}
+        if (CBX(vardata)[v].type != 1) {CBX(cerr) = 2; goto fexit;}
         tmpfarg = farg;
         tmpfargct = fargct;
-        farg = vardata[v].data - 1;
-        fargct = vardata[v].size + 1;
+        farg = CBX(vardata)[v].data - 1;
+        fargct = CBX(vardata)[v].size + 1;
     } else {
-        if (fargt[1] != 1) {cerr = 2; goto fexit;}
+        if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     }
     #ifndef _WIN32
     char** runargs = (char**)malloc((fargct + 1) * sizeof(char*));
@@ -290,21 +306,21 @@ if (chkCmd(2, "EXEC$", "EXECA$")) {
     }
     runargs[argno] = NULL;
     int stdout_dup = 0, stderr_dup = 0, fd[2];
-    if (pipe(fd) == -1) {cerr = -1; goto fexit;}
+    if (pipe(fd) == -1) {CBX(cerr) = -1; goto fexit;}
     stdout_dup = dup(1);
     stderr_dup = dup(2);
     dup2(fd[1], 1);
     dup2(fd[1], 2);
     pid_t pid = fork();
-    if (pid < 0) cerr = -1;
+    if (pid < 0) CBX(cerr) = -1;
     else if (pid == 0) {
         execvp(runargs[0], runargs);
         putchar(0);
         exit(127);
     }
     else if (pid > 0) {
-        while (wait(&retval) != pid) {}
-        retval = WEXITSTATUS(retval);
+        while (wait(&CBX(retval)) != pid) {}
+        CBX(retval) = WEXITSTATUS(CBX(retval));
         outbuf[read(fd[0], outbuf, CB_BUF_SIZE - 1)] = 0;
     }
     dup2(stdout_dup, 1);
@@ -333,7 +349,7 @@ if (chkCmd(2, "EXEC$", "EXECA$")) {
     FILE* p = popen(tmpcmd, "r");
     if (p) {
         outbuf[fread(outbuf, 1, CB_BUF_SIZE, p)] = 0;
-        retval = WEXITSTATUS(pclose(p));
+        CBX(retval) = WEXITSTATUS(pclose(p));
     }
     dup2(duperr, 2);
     close(duperr);
@@ -347,18 +363,18 @@ if (chkCmd(2, "EXEC$", "EXECA$")) {
     goto fexit;
 }
 if (chkCmd(1, "CINT")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     sprintf(outbuf, "%d", (int)round(atof(farg[1])));
     goto fexit;
 }
 if (chkCmd(1, "INT")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     sprintf(outbuf, "%d", (int)dbl);
@@ -368,11 +384,11 @@ if (chkCmd(1, "INT")) {
     goto fexit;
 }
 if (chkCmd(1, "VAL")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct < 1 || fargct > 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
-    if (fargct == 2 && fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargct < 1 || fargct > 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
+    if (fargct == 2 && fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     if (fargct == 1) {
         sscanf(farg[1], "%lf", &dbl);
@@ -420,24 +436,24 @@ if (chkCmd(1, "VAL")) {
             sprintf(outbuf, "%llu", (long long unsigned int)num);
             break;            
         default:;
-            cerr = 16;
+            CBX(cerr) = 16;
             break;
     }
     goto fexit;
 }
 if (chkCmd(1, "STR$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     copyStr(farg[1], outbuf);
     goto fexit;
 }
 if (chkCmd(1, "MOD")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2 || fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl1, dbl2;
     sscanf(farg[1], "%lf", &dbl1);
     sscanf(farg[2], "%lf", &dbl2);
@@ -445,113 +461,113 @@ if (chkCmd(1, "MOD")) {
     goto fexit;
 }
 if (chkCmd(1, "PI")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     strcpy(outbuf, "3.141593");
     goto fexit;
 }
 if (chkCmd(1, "ABS")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     sprintf(outbuf, "%lf", fabs(atof(farg[1])));
     goto fexit;
 }
 if (chkCmd(1, "SIN")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     sprintf(outbuf, "%lf", sin(dbl));
     goto fexit;
 }
 if (chkCmd(1, "COS")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     sprintf(outbuf, "%lf", cos(dbl));
     goto fexit;
 }
 if (chkCmd(1, "TAN")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     sprintf(outbuf, "%lf", tan(dbl));
     goto fexit;
 }
 if (chkCmd(1, "SINH")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     dbl = sinh(dbl);
-    if (!isfinite(dbl)) {cerr = 5; goto fexit;}
+    if (!isfinite(dbl)) {CBX(cerr) = 5; goto fexit;}
     sprintf(outbuf, "%lf", dbl);
     goto fexit;
 }
 if (chkCmd(1, "COSH")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     dbl = cosh(dbl);
-    if (!isfinite(dbl)) {cerr = 5; goto fexit;}
+    if (!isfinite(dbl)) {CBX(cerr) = 5; goto fexit;}
     sprintf(outbuf, "%lf", dbl);
     goto fexit;
 }
 if (chkCmd(1, "TANH")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     sprintf(outbuf, "%lf", tanh(dbl));
     goto fexit;
 }
 if (chkCmd(1, "LOG")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     dbl = log(dbl);
-    if (!isfinite(dbl)) {cerr = 5; goto fexit;}
+    if (!isfinite(dbl)) {CBX(cerr) = 5; goto fexit;}
     sprintf(outbuf, "%lf", dbl);
     goto fexit;
 }
 if (chkCmd(1, "LOG10")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     dbl = log10(dbl);
-    if (!isfinite(dbl)) {cerr = 5; goto fexit;}
+    if (!isfinite(dbl)) {CBX(cerr) = 5; goto fexit;}
     sprintf(outbuf, "%lf", dbl);
     goto fexit;
 }
 if (chkCmd(1, "SHIFT")) {
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargt[1] != 2 || fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     uint64_t num;
     sscanf(farg[1], "%llu", (long long unsigned int*)&num);
     int l = atoi(farg[2]);
@@ -565,20 +581,20 @@ if (chkCmd(1, "SHIFT")) {
     goto fexit;
 }
 if (chkCmd(1, "NOT")) {
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     uint64_t num;
     sscanf(farg[1], "%llu", (long long unsigned int*)&num);
     sprintf(outbuf, "%llu", (long long unsigned int)~num);
     goto fexit;
 }
 if (chkCmd(1, "AND")) {
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargt[1] != 2 || fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     uint64_t num1, num2;
     sscanf(farg[1], "%llu", (long long unsigned int*)&num1);
     sscanf(farg[2], "%llu", (long long unsigned int*)&num2);
@@ -586,10 +602,10 @@ if (chkCmd(1, "AND")) {
     goto fexit;
 }
 if (chkCmd(1, "OR")) {
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargt[1] != 2 || fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     uint64_t num1, num2;
     sscanf(farg[1], "%llu", (long long unsigned int*)&num1);
     sscanf(farg[2], "%llu", (long long unsigned int*)&num2);
@@ -597,10 +613,10 @@ if (chkCmd(1, "OR")) {
     goto fexit;
 }
 if (chkCmd(1, "XOR")) {
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargt[1] != 2 || fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     uint64_t num1, num2;
     sscanf(farg[1], "%llu", (long long unsigned int*)&num1);
     sscanf(farg[2], "%llu", (long long unsigned int*)&num2);
@@ -608,20 +624,20 @@ if (chkCmd(1, "XOR")) {
     goto fexit;
 }
 if (chkCmd(1, "EXP")) {
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     dbl = exp(dbl);
-    if (!isfinite(dbl)) {cerr = 5; goto fexit;}
+    if (!isfinite(dbl)) {CBX(cerr) = 5; goto fexit;}
     sprintf(outbuf, "%lf", dbl);
     goto fexit;
 }
 if (chkCmd(1, "INKEY$")) {
-    if (fargct) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 1;
     #ifndef _WIN32
     int32_t tmp = 0;
@@ -645,58 +661,58 @@ if (chkCmd(1, "INKEY$")) {
     goto fexit;
 }
 if (chkCmd(1, "UCASE$")) {
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     upCase(farg[1]);
     copyStr(farg[1], outbuf);
     goto fexit;
 }
 if (chkCmd(1, "LCASE$")) {
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     lowCase(farg[1]);
     copyStr(farg[1], outbuf);
     goto fexit;
 }
 if (chkCmd(1, "LEN")) {
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     sprintf(outbuf, "%lu", (long unsigned)strlen(farg[1]));
     goto fexit;
 }
 if (chkCmd(1, "TYPEOF")) {
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
     sprintf(outbuf, "%u", fargt[1]);
     goto fexit;
 }
 if (chkCmd(1, "SNIP$")) {
-    if (fargct < 2 || fargct > 3) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct < 2 || fargct > 3) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     int32_t start, end;
     if (fargct == 2) {
-        if (fargt[2] == 1) {cerr = 2; goto fexit;}
-        if (fargt[2] == 0) {cerr = 3; goto fexit;}
+        if (fargt[2] == 1) {CBX(cerr) = 2; goto fexit;}
+        if (fargt[2] == 0) {CBX(cerr) = 3; goto fexit;}
         start = 0;
         end = atoi(farg[2]);
     } else {
-        if (fargt[2] == 1 || fargt[3] == 1) {cerr = 2; goto fexit;}
+        if (fargt[2] == 1 || fargt[3] == 1) {CBX(cerr) = 2; goto fexit;}
         if (fargt[2] + fargt[3]) {
             if (!fargt[2]) {start = 0;}
             else {start = atoi(farg[2]);}
             if (!fargt[3]) {end = 32;}
             else {end = atoi(farg[3]);}
         } else {
-            cerr = 3;
+            CBX(cerr) = 3;
             goto fexit;
         }
     }
@@ -707,26 +723,26 @@ if (chkCmd(1, "SNIP$")) {
     copyStrSnip(farg[1], start, end, outbuf);
 }
 if (chkCmd(1, "CURX")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     getCurPos();
     sprintf(outbuf, "%d", curx);
     goto fexit;
 }
 if (chkCmd(1, "CURY")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     getCurPos();
     sprintf(outbuf, "%d", cury);
     goto fexit;
 }
 if (chkCmd(1, "HEX$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     sprintf(outbuf, "%llx", (long long unsigned int)dbl);
@@ -734,10 +750,10 @@ if (chkCmd(1, "HEX$")) {
     goto fexit;
 }
 if (chkCmd(1, "OCT$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     double dbl;
     sscanf(farg[1], "%lf", &dbl);
     sprintf(outbuf, "%llo", (long long unsigned int)dbl);
@@ -745,28 +761,28 @@ if (chkCmd(1, "OCT$")) {
     goto fexit;
 }
 if (chkCmd(1, "RGB")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 3) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2 || fargt[2] != 2 || fargt[3] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 3) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2 || fargt[3] != 2) {CBX(cerr) = 2; goto fexit;}
     uint8_t r, g, b;
     int tmpv;
-    if ((tmpv = atoi(farg[1])) < 0 || tmpv > 255) {cerr = 16; goto fexit;}
+    if ((tmpv = atoi(farg[1])) < 0 || tmpv > 255) {CBX(cerr) = 16; goto fexit;}
     r = tmpv;
-    if ((tmpv = atoi(farg[2])) < 0 || tmpv > 255) {cerr = 16; goto fexit;}
+    if ((tmpv = atoi(farg[2])) < 0 || tmpv > 255) {CBX(cerr) = 16; goto fexit;}
     g = tmpv;
-    if ((tmpv = atoi(farg[3])) < 0 || tmpv > 255) {cerr = 16; goto fexit;}
+    if ((tmpv = atoi(farg[3])) < 0 || tmpv > 255) {CBX(cerr) = 16; goto fexit;}
     b = tmpv;
     sprintf(outbuf, "%u", (r << 16) | (g << 8) | b);
     goto fexit;
 }
 if (chkCmd(1, "LIMIT")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
     double num = 0;
-    if (fargct < 2 || fargct > 3) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2 || fargt[2] != 2) {cerr = 2; goto fexit;}
-    if (fargct == 3 && fargt[3] == 1) {cerr = 2; goto fexit;}
+    if (fargct < 2 || fargct > 3) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
+    if (fargct == 3 && fargt[3] == 1) {CBX(cerr) = 2; goto fexit;}
     num = atof(farg[1]);
     if (fargct == 2) {
         double max = atof(farg[2]);
@@ -780,22 +796,22 @@ if (chkCmd(1, "LIMIT")) {
         if (num > max) {num = max;}
         else if (num < min) {num = min;}
     } else {
-        cerr = 3;
+        CBX(cerr) = 3;
         goto fexit;
     }
     sprintf(outbuf, "%lf", num);
     goto fexit;
 }
 if (chkCmd(1, "PAD$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct < 2 || fargct > 3) {cerr = 3; goto fexit;}
-    if (fargt[1] == 0) {cerr = 3; goto fexit;}
-    if (fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargct < 2 || fargct > 3) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] == 0) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     char tmpc;
     if (fargct == 3) {
-        if (fargt[3] != 1) {cerr = 2; goto fexit;}
-        if (flen[3] != 1) {cerr = 16; goto fexit;}
+        if (fargt[3] != 1) {CBX(cerr) = 2; goto fexit;}
+        if (flen[3] != 1) {CBX(cerr) = 16; goto fexit;}
         tmpc = farg[3][0];
     } else {
         if (fargt[1] == 1) tmpc = ' ';
@@ -811,25 +827,25 @@ if (chkCmd(1, "PAD$")) {
     goto fexit;
 }
 if (chkCmd(1, "BASENAME$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     copyStr(basefilename(farg[1]), outbuf);
     goto fexit;
 }
 if (chkCmd(1, "DIRNAME$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     copyStr(pathfilename(farg[1]), outbuf);
     goto fexit;
 }
 if (chkCmd(1, "WIDTH")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     #ifdef __unix__
     struct winsize max;
     ioctl(0, TIOCGWINSZ, &max);
@@ -844,9 +860,9 @@ if (chkCmd(1, "WIDTH")) {
     goto fexit;
 }
 if (chkCmd(1, "HEIGHT")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     #ifdef __unix__
     struct winsize max;
     ioctl(0, TIOCGWINSZ, &max);
@@ -861,39 +877,39 @@ if (chkCmd(1, "HEIGHT")) {
     goto fexit;
 }
 if (chkCmd(1, "FGC")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     if (txtattrib.truecolor) sprintf(outbuf, "%u", txtattrib.truefgc);
     else sprintf(outbuf, "%u", txtattrib.fgc);
     goto fexit;
 }
 if (chkCmd(1, "BGC")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     if (txtattrib.truecolor) sprintf(outbuf, "%u", txtattrib.truebgc);
     else sprintf(outbuf, "%u", txtattrib.bgc);
     goto fexit;
 }
 if (chkCmd(1, "TRUECOLOR")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     sprintf(outbuf, "%d", (int)txtattrib.truecolor);
     goto fexit;
 }
 if (chkCmd(1, "INPUT$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct > 1) {cerr = 3; goto fexit;}
-    if (fargct == 1 && fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct > 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargct == 1 && fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     if (fargct != 1) {
         farg[1] = malloc(4);
         strcpy(farg[1], "?: ");
     }
     char* tmp = NULL;
-    #ifndef _WIN32
+    #if !defined(_WIN32) && !defined(CB_LIB)
     getCurPos();
     curx--;
     farg[1] = realloc(farg[1], strlen(farg[1]) + curx);
@@ -901,6 +917,7 @@ if (chkCmd(1, "INPUT$")) {
     while (curx) {farg[1][ptr] = 22; ptr++; curx--;}
     farg[1][ptr] = 0;
     #endif
+    #ifndef CB_LIB
     #ifndef _WIN32
     __typeof__(rl_getc_function) old_rl_getc_function = rl_getc_function;
     rl_getc_function = getc;
@@ -909,6 +926,16 @@ if (chkCmd(1, "INPUT$")) {
     #ifndef _WIN32
     rl_getc_function = old_rl_getc_function;
     #endif
+    #else
+    fputs(farg[1], stdout);
+    fflush(stdout);
+    tmp = malloc(CB_BUF_SIZE);
+    if (fgets(tmp, CB_BUF_SIZE, stdin)) {
+        tmp[strcspn(tmp, "\r\n")] = 0;
+    } else {
+        nfree(tmp);
+    }
+    #endif
     if (tmp != NULL) {
         copyStr(tmp, outbuf);
         free(tmp);
@@ -921,10 +948,10 @@ if (chkCmd(1, "INPUT$")) {
     goto fexit;
 }
 if (chkCmd(1, "LINES")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     int cl = 1;
     if (!farg[1][0]) {strcpy(outbuf, "0"); goto fexit;}
     for (int32_t i = 0; farg[1][i]; i++) {
@@ -936,12 +963,12 @@ if (chkCmd(1, "LINES")) {
     goto fexit;
 }
 if (chkCmd(1, "LINE$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2 || fargt[2] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
     int cl = 0, tl = atoi(farg[1]);
-    if (tl < 0) {cerr = 16; goto fexit;}
+    if (tl < 0) {CBX(cerr) = 16; goto fexit;}
     for (int32_t i = 0; farg[2][i]; i++) {
         if (farg[2][i] == '\n') {
             cl++;
@@ -953,15 +980,15 @@ if (chkCmd(1, "LINE$")) {
     goto fexit;
 }
 if (chkCmd(1, "DATE")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1 || fargt[1] == 0) {cerr = 3; goto fexit;}
+    if (fargct != 1 || fargt[1] == 0) {CBX(cerr) = 3; goto fexit;}
     int element = -1;
     if (fargt[1] == 2) {
         element = atoi(farg[1]);
     } else {
         upCase(farg[1]);
-        chkCmdPtr = farg[1];
+        CBX(chkCmdPtr) = farg[1];
         if (chkCmd(2, "SEC", "SECOND")) {element = 0;}
         else if (chkCmd(2, "MIN", "MINUTE")) {element = 1;}
         else if (chkCmd(2, "HR", "HOUR")) {element = 2;}
@@ -972,7 +999,7 @@ if (chkCmd(1, "DATE")) {
         else if (chkCmd(2, "YDAY", "YEARDAY")) {element = 7;}
         else if (chkCmd(3, "DST", "DAYLIGHT", "DAYLIGHTSAVING")) {element = 8;}
     }
-    if (element > 8 || element < 0) {cerr = 16; goto fexit;}
+    if (element > 8 || element < 0) {CBX(cerr) = 16; goto fexit;}
     time_t rawtime;
     time(&rawtime);
     struct tm* timeinfo;
@@ -1011,28 +1038,28 @@ if (chkCmd(1, "DATE")) {
     goto fexit;
 }
 if (chkCmd(1, "CWD$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     char* ret;
     ret = getcwd(outbuf, CB_BUF_SIZE);
     (void)ret;
     goto fexit;
 }
 if (chkCmd(1, "FILES$")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 1;
-    if (fargct > 1) {cerr = 3; goto fexit;}
+    if (fargct > 1) {CBX(cerr) = 3; goto fexit;}
     char* olddn = NULL;
     char* bret;
     int ret;
     if (fargct) {
-        if (fargt[1] != 1) {cerr = 2; goto fexit;}
+        if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
         olddn = malloc(CB_BUF_SIZE);
         bret = getcwd(olddn, CB_BUF_SIZE);
         if (chdir(farg[1])) {
-            fileerror = errno;
+            CBX(fileerror) = errno;
             free(olddn);
             outbuf[0] = 0;
             goto fexit;
@@ -1076,210 +1103,368 @@ if (chkCmd(1, "FILES$")) {
     goto fexit;
 }
 if (chkCmd(2, "CD", "CHDIR")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     outbuf[0] = '0' + !chdir(farg[1]);
     outbuf[1] = 0;
     goto fexit;
 }
 if (chkCmd(1, "FOPEN")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1 || fargt[2] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
     if (!isFile(farg[1])) {
         outbuf[0] = '-';
         outbuf[1] = '1';
         outbuf[2] = 0;
-        fileerror = EINVAL;
+        CBX(fileerror) = EINVAL;
         goto fexit;
     }
     sprintf(outbuf, "%d", openFile(farg[1], farg[2]));
     goto fexit;
 }
+if (chkCmd(1, "LISTEN")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
+    sprintf(outbuf, "%d", sockListen(farg[1]));
+    goto fexit;
+}
+if (chkCmd(1, "ACCEPT")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    sprintf(outbuf, "%d", sockAccept(atoi(farg[1])));
+    goto fexit;
+}
+if (chkCmd(1, "FOPENREC")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct < 2 || fargct > 3) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1 || fargt[2] != 2 || (fargct == 3 && fargt[3] != 2)) {CBX(cerr) = 2; goto fexit;}
+    int32_t reclen = atoi(farg[2]);
+    int32_t pages = (fargct == 3) ? atoi(farg[3]) : 0;
+    if (!isFile(farg[1]) || reclen < 1 || reclen > CB_BUF_SIZE - 1 || pages < 0) {
+        outbuf[0] = '-';
+        outbuf[1] = '1';
+        outbuf[2] = 0;
+        CBX(fileerror) = EINVAL;
+        goto fexit;
+    }
+    sprintf(outbuf, "%d", openRecFile(farg[1], reclen, pages));
+    goto fexit;
+}
 if (chkCmd(1, "FCLOSE")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     outbuf[0] = '0' + closeFile(atoi(farg[1]));
     outbuf[1] = 0;
     goto fexit;
 }
 if (chkCmd(1, "FSIZE")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
-    if (fnum < 0 || fnum >= filemaxct) {
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
         outbuf[0] = '-';
         outbuf[1] = '1';
         outbuf[2] = 0;
-        fileerror = EINVAL;
+        CBX(fileerror) = EINVAL;
         goto fexit;
     }
-    sprintf(outbuf, "%d", filedata[fnum].size);
+    errno = 0;
+    sprintf(outbuf, "%" PRId64, fileSize(fnum));
+    CBX(fileerror) = errno;
     goto fexit;
 }
 if (chkCmd(1, "EOF")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
-    if (fnum < 0 || fnum >= filemaxct) {
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
         outbuf[0] = '-';
         outbuf[1] = '1';
         outbuf[2] = 0;
-        fileerror = EINVAL;
+        CBX(fileerror) = EINVAL;
         goto fexit;
     }
-    int32_t prev = ftell(filedata[fnum].fptr);
-    fgetc(filedata[fnum].fptr);
     errno = 0;
-    outbuf[0] = '0' + (feof(filedata[fnum].fptr) != 0);
-    fileerror = errno;
-    fseek(filedata[fnum].fptr, prev, SEEK_SET);
+    outbuf[0] = '0' + fileEOF(fnum);
+    CBX(fileerror) = errno;
     outbuf[1] = 0;
     goto fexit;
 }
 if (chkCmd(1, "EOFD")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
-    if (fnum < 0 || fnum >= filemaxct) {
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
         outbuf[0] = '-';
         outbuf[1] = '1';
         outbuf[2] = 0;
-        fileerror = EINVAL;
+        CBX(fileerror) = EINVAL;
         goto fexit;
     }
     errno = 0;
-    outbuf[0] = '0' + (ftell(filedata[fnum].fptr) >= filedata[fnum].size);
+    outbuf[0] = '0' + (fileTell(fnum) >= fileSize(fnum));
     outbuf[1] = 0;
-    fileerror = errno;
+    CBX(fileerror) = errno;
     goto fexit;
 }
 if (chkCmd(1, "FREAD$")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct < 1 || fargct > 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || (fargct == 2 && fargt[2] != 2)) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
+    outbuf[0] = 0;
     outbuf[1] = 0;
-    if (fnum < 0 || fnum >= filemaxct) {
-        outbuf[0] = 0;
-        fileerror = EINVAL;
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(fileerror) = EINVAL;
         goto fexit;
     }
-    if (feof(filedata[fnum].fptr)) {
-        outbuf[0] = 0;
-    } else {
+    if (fargct == 2) {
+        int32_t len = atoi(farg[2]);
+        if (len < 0) {CBX(fileerror) = EINVAL; goto fexit;}
+        if (len > CB_BUF_SIZE - 1) len = CB_BUF_SIZE - 1;
         errno = 0;
-        int c = fgetc(filedata[fnum].fptr);
+        fileRead(fnum, outbuf, len);
+        CBX(fileerror) = errno;
+    } else if (!feof(CBX(filedata)[fnum].fptr)) {
+        errno = 0;
+        int c = fileGetc(fnum);
         outbuf[0] = (c < 0) ? 0 : c;
-        fileerror = errno;
+        CBX(fileerror) = errno;
     }
     goto fexit;
 }
+if (chkCmd(1, "FREADLINE$")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 1;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    int fnum = atoi(farg[1]);
+    outbuf[0] = 0;
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(fileerror) = EINVAL;
+        goto fexit;
+    }
+    errno = 0;
+    fileReadLine(fnum, outbuf, CB_BUF_SIZE);
+    CBX(fileerror) = errno;
+    goto fexit;
+}
 if (chkCmd(1, "FREAD")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
     int fc = -1;
-    if (fnum < 0 || fnum >= filemaxct) {
-        fileerror = EINVAL;
-    } else if (!feof(filedata[fnum].fptr)) {
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(fileerror) = EINVAL;
+    } else if (!feof(CBX(filedata)[fnum].fptr)) {
         errno = 0;
-        fc = fgetc(filedata[fnum].fptr);
+        fc = fileGetc(fnum);
         if (fc < 0) fc = -1;
-        fileerror = errno;
+        CBX(fileerror) = errno;
     }
     sprintf(outbuf, "%d", fc);
     goto fexit;
 }
-if (chkCmd(1, "FWRITE")) {
-    cerr = 0;
-    fileerror = 0;
+if (chkCmd(2, "FWRITE", "FWRITELN")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
+    int fnum = atoi(farg[1]);
+    int32_t ret = -1;
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(fileerror) = EINVAL;
+    } else {
+        errno = 0;
+        ret = fileWrite(fnum, farg[2], !strcmp(farg[0], "FWRITELN"));
+        CBX(fileerror) = errno;
+    }
+    sprintf(outbuf, "%d", ret);
+    goto fexit;
+}
+if (chkCmd(1, "FBUFFER")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
+    int fnum = atoi(farg[1]);
+    int32_t ret = -1;
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(fileerror) = EINVAL;
+    } else {
+        errno = 0;
+        ret = fileSetBuf(fnum, atoi(farg[2]));
+        CBX(fileerror) = errno;
+    }
+    sprintf(outbuf, "%d", ret);
+    goto fexit;
+}
+if (chkCmd(1, "GETREC$")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 1;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
+    int fnum = atoi(farg[1]);
+    int64_t rec = strtoll(farg[2], NULL, 10);
+    outbuf[0] = 0;
+    if (fnum < 0 || fnum >= CBX(filemaxct) || !CBX(filedata)[fnum].reclen || rec < 0) {
+        CBX(fileerror) = EINVAL;
+        goto fexit;
+    }
+    errno = 0;
+    fileGetRec(fnum, rec, outbuf);
+    CBX(fileerror) = errno;
+    goto fexit;
+}
+if (chkCmd(1, "PUTREC")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2 || fargt[2] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 3) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2 || fargt[3] != 1) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
+    int64_t rec = strtoll(farg[2], NULL, 10);
     int32_t ret = -1;
-    if (fnum < 0 || fnum >= filemaxct) {
-        fileerror = EINVAL;
+    if (fnum < 0 || fnum >= CBX(filemaxct) || !CBX(filedata)[fnum].reclen || rec < 0) {
+        CBX(fileerror) = EINVAL;
     } else {
         errno = 0;
-        ret = (fputs(farg[2], filedata[fnum].fptr) != EOF);
-        fileerror = errno;
+        ret = filePutRec(fnum, rec, farg[3]);
+        CBX(fileerror) = errno;
     }
     sprintf(outbuf, "%d", ret);
     goto fexit;
 }
+if (chkCmd(1, "KVOPEN")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
+    sprintf(outbuf, "%d", kvOpen(farg[1]));
+    goto fexit;
+}
+if (chkCmd(1, "KVCLOSE")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    outbuf[0] = '0' + kvClose(atoi(farg[1]));
+    outbuf[1] = 0;
+    goto fexit;
+}
+if (chkCmd(1, "KVGET$")) {
+    CBX(cerr) = 0;
+    ftype = 1;
+    if (fargct < 2 || fargct > 3) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 1 || (fargct == 3 && fargt[3] != 1)) {CBX(cerr) = 2; goto fexit;}
+    if (!kvGet(atoi(farg[1]), farg[2], outbuf) && fargct == 3) copyStr(farg[3], outbuf);
+    goto fexit;
+}
+if (chkCmd(1, "KVHAS")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
+    char* tmpbuf = malloc(CB_BUF_SIZE);
+    outbuf[0] = '0' + kvGet(atoi(farg[1]), farg[2], tmpbuf);
+    outbuf[1] = 0;
+    free(tmpbuf);
+    goto fexit;
+}
+if (chkCmd(1, "KVDEL")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
+    outbuf[0] = '0' + kvDel(atoi(farg[1]), farg[2]);
+    outbuf[1] = 0;
+    goto fexit;
+}
 if (chkCmd(1, "FSEEK")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2 || fargt[2] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || fargt[2] != 2) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
     int32_t ret = 2;
-    if (fnum < 0 || fnum >= filemaxct) {
-        fileerror = EINVAL;
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
+        CBX(fileerror) = EINVAL;
     } else {
         errno = 0;
-        int32_t pos = atoi(farg[2]);
+        int64_t pos = strtoll(farg[2], NULL, 10);
         if (pos < 0) {
-            fileerror = EINVAL;
+            CBX(fileerror) = EINVAL;
         } else {
-            ret = !fseek(filedata[fnum].fptr, (pos > filedata[fnum].size) ? filedata[fnum].size : pos, SEEK_SET);
-            fileerror = errno;
+            ret = fileSeek(fnum, pos);
+            CBX(fileerror) = errno;
         }
     }
     sprintf(outbuf, "%d", ret);
     goto fexit;
 }
 if (chkCmd(1, "FLUSH")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     int fnum = atoi(farg[1]);
-    if (fnum < 0 || fnum >= filemaxct) {
+    if (fnum < 0 || fnum >= CBX(filemaxct)) {
         outbuf[0] = '-';
         outbuf[1] = '1';
         outbuf[2] = 0;
-        fileerror = EINVAL;
+        CBX(fileerror) = EINVAL;
         goto fexit;
     }
     errno = 0;
-    outbuf[0] = (fflush(filedata[fnum].fptr) != EOF);
+    outbuf[0] = '0' + fileFlush(fnum);
     outbuf[1] = 0;
-    fileerror = errno;
+    CBX(fileerror) = errno;
     goto fexit;
 }
 if (chkCmd(2, "MD", "MKDIR")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     errno = 0;
     #ifndef _WIN32
     outbuf[0] = '0' + !mkdir(farg[1], S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
@@ -1287,43 +1472,255 @@ if (chkCmd(2, "MD", "MKDIR")) {
     outbuf[0] = '0' + !mkdir(farg[1]);
     #endif
     outbuf[1] = 0;
-    fileerror = errno;
+    CBX(fileerror) = errno;
     goto fexit;
 }
 if (chkCmd(2, "RM", "REMOVE")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     outbuf[0] = '0' + cbrm(farg[1]);
     outbuf[1] = 0;
     goto fexit;
 }
+if (chkCmd(2, "COPY", "CP")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
+    outbuf[0] = '0' + copyFile(farg[1], farg[2]);
+    outbuf[1] = 0;
+    goto fexit;
+}
+if (chkCmd(2, "HASH$", "FHASH$")) {
+    CBX(cerr) = 0;
+    ftype = 1;
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
+    int algo = hashAlgo(farg[1]);
+    if (!algo) {CBX(cerr) = 16; seterrstr(farg[1]); goto fexit;}
+    if (farg[0][0] == 'F') {
+        if (!hashFile(algo, farg[2], outbuf)) outbuf[0] = 0;
+    } else {
+        cb_hash h;
+        hashInit(&h, algo);
+        hashUpdate(&h, (uint8_t*)farg[2], strlen(farg[2]));
+        hashFinal(&h, outbuf);
+    }
+    goto fexit;
+}
+if (chkCmd(1, "FGREP")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 3) {CBX(cerr) = 3; goto fexit;}
+    char* tmpbuf[2] = {malloc(CB_BUF_SIZE), malloc(CB_BUF_SIZE)};
+    for (int i = 0; i < 2; ++i) {
+        uint8_t t = getVal(farg[i + 1], tmpbuf[i]);
+        if (t != 1) {
+            if (t) CBX(cerr) = 2;
+            free(tmpbuf[0]);
+            free(tmpbuf[1]);
+            goto fexit;
+        }
+    }
+    if (!farg[3][0] || getType(farg[3]) != 255) {CBX(cerr) = 4; seterrstr(farg[3]); free(tmpbuf[0]); free(tmpbuf[1]); goto fexit;}
+    upCase(farg[3]);
+    if (farg[3][strlen(farg[3]) - 1] != '$') {CBX(cerr) = 2; free(tmpbuf[0]); free(tmpbuf[1]); goto fexit;}
+    int32_t ct = grepFiles(tmpbuf[0], tmpbuf[1], farg[3]);
+    free(tmpbuf[0]);
+    free(tmpbuf[1]);
+    if (ct < 0) goto fexit;
+    sprintf(outbuf, "%d", ct);
+    goto fexit;
+}
+if (chkCmd(1, "SPAWN")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct < 1) {CBX(cerr) = 3; goto fexit;}
+    char** sargs = (char**)malloc(fargct * sizeof(char*));
+    int sargct = 0;
+    bool ok = true;
+    for (int i = 2; ok && i <= fargct; ++i) {
+        sargs[sargct] = malloc(CB_BUF_SIZE);
+        ok = getVal(farg[i], sargs[sargct++]);
+    }
+    int id = -1;
+    if (ok) {
+        upCase(farg[1]);
+        id = taskSpawn(farg[1], sargct, sargs, false);
+    }
+    for (int i = 0; i < sargct; ++i) {free(sargs[i]);}
+    free(sargs);
+    if (id == -1) goto fexit;
+    sprintf(outbuf, "%d", id);
+    goto fexit;
+}
+if (chkCmd(1, "JOIN")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    int ret = taskJoin(atoi(farg[1]));
+    if (ret == -1) {CBX(cerr) = 16; goto fexit;}
+    sprintf(outbuf, "%d", ret);
+    goto fexit;
+}
+if (chkCmd(1, "COSTART")) {
+    if (!CBX(inProg)) {CBX(cerr) = 125; goto fexit;}
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    upCase(farg[1]);
+    int id = coStart(farg[1]);
+    if (id == -1) goto fexit;
+    sprintf(outbuf, "%d", id);
+    goto fexit;
+}
+if (chkCmd(1, "COCOUNT")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    sprintf(outbuf, "%d", coCount());
+    goto fexit;
+}
+if (chkCmd(1, "EVWATCH")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    sprintf(outbuf, "%d", evWatch(atoi(farg[1])));
+    goto fexit;
+}
+if (chkCmd(1, "EVTIMER")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct < 1 || fargct > 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2 || (fargct == 2 && fargt[2] != 2)) {CBX(cerr) = 2; goto fexit;}
+    sprintf(outbuf, "%d", evTimer(atof(farg[1]), (fargct == 2 && atof(farg[2]))));
+    goto fexit;
+}
+if (chkCmd(1, "EVWAIT")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct > 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargct && fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    sprintf(outbuf, "%d", evWait((fargct) ? atof(farg[1]) : -1));
+    goto fexit;
+}
+if (chkCmd(1, "EVID")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    sprintf(outbuf, "%d", CBX(evlast));
+    goto fexit;
+}
+if (chkCmd(1, "CHANOPEN")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct > 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargct == 1 && fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    int32_t cap = (fargct) ? atoi(farg[1]) : 1024;
+    if (cap < 1 || cap > 16777216) {CBX(cerr) = 16; goto fexit;}
+    sprintf(outbuf, "%d", chanOpen(cap));
+    goto fexit;
+}
+if (chkCmd(1, "CHANRECV$")) {
+    CBX(cerr) = 0;
+    ftype = 1;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
+    chanRecv(atoi(farg[1]), outbuf);
+    goto fexit;
+}
+if (chkCmd(1, "DIRLIST")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct < 2 || fargct > 3) {CBX(cerr) = 3; goto fexit;}
+    char* tmpbuf = malloc(CB_BUF_SIZE);
+    uint8_t t = getVal(farg[1], tmpbuf);
+    if (t != 1) {if (t) {CBX(cerr) = 2;} free(tmpbuf); goto fexit;}
+    bool rec = false;
+    if (fargct == 3) {
+        char tmpnum[CB_BUF_SIZE];
+        t = getVal(farg[3], tmpnum);
+        if (t != 2) {if (t) {CBX(cerr) = 2;} free(tmpbuf); goto fexit;}
+        rec = (atof(tmpnum) != 0.0);
+    }
+    if (!farg[2][0] || getType(farg[2]) != 255) {CBX(cerr) = 4; seterrstr(farg[2]); free(tmpbuf); goto fexit;}
+    upCase(farg[2]);
+    if (farg[2][strlen(farg[2]) - 1] != '$') {CBX(cerr) = 2; free(tmpbuf); goto fexit;}
+    int32_t ct = dirList(tmpbuf, farg[2], rec);
+    free(tmpbuf);
+    if (ct < 0) goto fexit;
+    sprintf(outbuf, "%d", ct);
+    goto fexit;
+}
+if (chkCmd(1, "CSVLOAD")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct != 3) {CBX(cerr) = 3; goto fexit;}
+    char* tmpbuf[2] = {malloc(CB_BUF_SIZE), malloc(CB_BUF_SIZE)};
+    for (int i = 0; i < 2; ++i) {
+        uint8_t t = getVal(farg[i + 1], tmpbuf[i]);
+        if (t != i + 1) {
+            if (t) CBX(cerr) = 2;
+            free(tmpbuf[0]);
+            free(tmpbuf[1]);
+            goto fexit;
+        }
+    }
+    int32_t cols = atoi(tmpbuf[1]);
+    if (cols < 1) {CBX(cerr) = 16; seterrstr(tmpbuf[1]); free(tmpbuf[0]); free(tmpbuf[1]); goto fexit;}
+    if (!farg[3][0] || getType(farg[3]) != 255) {CBX(cerr) = 4; seterrstr(farg[3]); free(tmpbuf[0]); free(tmpbuf[1]); goto fexit;}
+    upCase(farg[3]);
+    int32_t ct = csvLoad(tmpbuf[0], cols, farg[3]);
+    free(tmpbuf[0]);
+    free(tmpbuf[1]);
+    if (ct < 0) goto fexit;
+    sprintf(outbuf, "%d", ct);
+    goto fexit;
+}
+if (chkCmd(1, "SORTFILE")) {
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
+    ftype = 2;
+    if (fargct < 2 || fargct > 3) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1 || fargt[2] != 1 || (fargct == 3 && fargt[3] != 1)) {CBX(cerr) = 2; goto fexit;}
+    cb_sortopts so;
+    if (!sortParseOpts((fargct == 3) ? farg[3] : "", &so)) {CBX(cerr) = 16; seterrstr(farg[3]); goto fexit;}
+    outbuf[0] = '0' + sortFile(farg[1], farg[2], &so);
+    outbuf[1] = 0;
+    goto fexit;
+}
 if (chkCmd(4, "MV", "MOVE", "REN", "RENAME")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 2) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1 || fargt[2] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 2) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1 || fargt[2] != 1) {CBX(cerr) = 2; goto fexit;}
     errno = 0;
     outbuf[0] = '0' + !rename(farg[1], farg[2]);
     outbuf[1] = 0;
-    fileerror = errno;
+    CBX(fileerror) = errno;
     goto fexit;
 }
 if (chkCmd(1, "ISFILE")) {
-    cerr = 0;
-    fileerror = 0;
+    CBX(cerr) = 0;
+    CBX(fileerror) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     struct stat pathstat;
     if (stat(farg[1], &pathstat)) {
         outbuf[0] = '-';
         outbuf[1] = '1';
         outbuf[2] = 0;
-        fileerror = errno;
+        CBX(fileerror) = errno;
         goto fexit;
     }
     outbuf[0] = '0' + !(S_ISDIR(pathstat.st_mode));
@@ -1332,21 +1729,21 @@ if (chkCmd(1, "ISFILE")) {
 }
 if (chkCmd(1, "LOADEXT")) {
     ftype = 2;
-    if (fargct < 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct < 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     outbuf[0] = '1';
     for (int i = 1; i <= fargct; i++) {
-        if (fargt[i] != 1) {cerr = 2; goto fexit;}
+        if (fargt[i] != 1) {CBX(cerr) = 2; goto fexit;}
         if (loadExt(farg[i]) < 0) {outbuf[0] = '0'; break;}
     }
     outbuf[1] = 0;
-    cerr = 0;
+    CBX(cerr) = 0;
     goto fexit;
 }
 if (chkCmd(1, "UNLOADEXT")) {
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     if (fargt[1] == 1) {
         upCase(farg[1]);
         for (register int i = 0; i < extmaxct; ++i) {
@@ -1357,14 +1754,14 @@ if (chkCmd(1, "UNLOADEXT")) {
     } else {
         sprintf(outbuf, "%d", (int)unloadExt(atoi(farg[1])));
     }
-    cerr = 0;
+    CBX(cerr) = 0;
     goto fexit;
 }
 if (chkCmd(1, "READEXTNAME$")) {
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     #ifndef _WIN32
     void* lib = dlopen(farg[1], RTLD_LAZY);
     #else
@@ -1382,9 +1779,9 @@ if (chkCmd(1, "READEXTNAME$")) {
 }
 if (chkCmd(1, "EXTNAME$")) {
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     int e = atoi(farg[1]);
     if (e >= 0 && e < extmaxct && extdata[e].inuse) {
         copyStr(extdata[e].name, outbuf);
@@ -1395,8 +1792,8 @@ if (chkCmd(1, "EXTNAME$")) {
 }
 if (chkCmd(1, "EXTLOADED")) {
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     if (fargt[1] == 1) {
         upCase(farg[1]);
         outbuf[0] = '0';
@@ -1416,8 +1813,8 @@ if (chkCmd(1, "EXTLOADED")) {
 }
 if (chkCmd(1, "EXTENSIONS$")) {
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
-    cerr = 0;
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    CBX(cerr) = 0;
     for (register int i = 0; i < extmaxct; ++i) {
         if (i < 0) strApndChar(outbuf, '\n');
         if (extdata[i].inuse) {copyStrApnd(extdata[i].name, outbuf);}
@@ -1427,17 +1824,17 @@ if (chkCmd(1, "EXTENSIONS$")) {
 goto fexit;
 _func:;
 if (chkCmd(1, "_HOME$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     copyStr(gethome(), outbuf);
     goto fexit;
 }
 if (chkCmd(1, "_ENV$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     char* tmpenv = getenv(farg[1]);
     if (tmpenv) {
         copyStr(tmpenv, outbuf);
@@ -1445,50 +1842,75 @@ if (chkCmd(1, "_ENV$")) {
     goto fexit;
 }
 if (chkCmd(1, "_ENVSET")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 1) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 1) {CBX(cerr) = 2; goto fexit;}
     char* tmpenv = getenv(farg[1]);
     outbuf[0] = '0' + (tmpenv != NULL);
     outbuf[1] = 0;
     goto fexit;
 }
+if (chkCmd(1, "_SHPOOL")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    #ifndef _WIN32
+    sprintf(outbuf, "%d", shpoolct);
+    #else
+    outbuf[0] = '0'; outbuf[1] = 0;
+    #endif
+    goto fexit;
+}
+if (chkCmd(1, "_SHARD")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    sprintf(outbuf, "%d", shardid);
+    goto fexit;
+}
+if (chkCmd(1, "_SHARDS")) {
+    CBX(cerr) = 0;
+    ftype = 2;
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    sprintf(outbuf, "%d", shardct);
+    goto fexit;
+}
 if (chkCmd(1, "_RET")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
-    sprintf(outbuf, "%d", retval);
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    sprintf(outbuf, "%d", CBX(retval));
     goto fexit;
 }
 if (chkCmd(1, "_ERRNOSTR$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     copyStr(strerror(atoi(farg[1])), outbuf);
     goto fexit;
 }
 if (chkCmd(1, "_FILEERROR")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
-    sprintf(outbuf, "%d", fileerror);
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    sprintf(outbuf, "%d", CBX(fileerror));
     goto fexit;
 }
 if (chkCmd(1, "_PROMPT$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     int tmpt = getVal(prompt, outbuf);
     if (tmpt != 1) strcpy(outbuf, "CLIBASIC> ");
     goto fexit;
 }
 if (chkCmd(1, "_ISATTY")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct != 1) {cerr = 3; goto fexit;}
-    if (fargt[1] != 2) {cerr = 2; goto fexit;}
+    if (fargct != 1) {CBX(cerr) = 3; goto fexit;}
+    if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
     int n = atoi(farg[1]);
     if (n == 0) {
         n = isatty(STDIN_FILENO);
@@ -1497,44 +1919,44 @@ if (chkCmd(1, "_ISATTY")) {
     } else if (n == 2) {
         n = isatty(STDERR_FILENO);
     } else {
-        cerr = 16;
+        CBX(cerr) = 16;
         goto fexit;
     }
     sprintf(outbuf, "%d", n);
     goto fexit;
 }
 if (chkCmd(1, "_TXTLOCK")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     sprintf(outbuf, "%d", (int)textlock);
     goto fexit;
 }
 if (chkCmd(1, "_VER$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     copyStr(VER, outbuf);
     goto fexit;
 }
 if (chkCmd(1, "_BITS$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     copyStr(BVER, outbuf);
     goto fexit;
 }
 if (chkCmd(1, "_OS$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     copyStr(OSVER, outbuf);
     goto fexit;
 }
 if (chkCmd(1, "_VT")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     #ifdef _WIN_NO_VT
     outbuf[0] = '0';
     #else
@@ -1544,37 +1966,37 @@ if (chkCmd(1, "_VT")) {
     goto fexit;
 }
 if (chkCmd(1, "_STARTCMD$")) {
-    cerr = 0;
+    CBX(cerr) = 0;
     ftype = 1;
-    if (fargct) {cerr = 3; goto fexit;}
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
     copyStr(startcmd, outbuf);
     goto fexit;
 }
 if (chkCmd(1, "_ARG$")) {
-    if (!inProg) {cerr = 125; goto fexit;}
-    cerr = 0;
+    if (!CBX(inProg)) {CBX(cerr) = 125; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 1;
     if (fargct == 0) {
-        for (int i = 1; i < progargc; i++) {
-            copyStrApnd(progargs[i], outbuf);
-            if (i != progargc - 1) strApndChar(outbuf, ' ');
+        for (int i = 1; i < CBX(progargc); i++) {
+            copyStrApnd(CBX(progargs)[i], outbuf);
+            if (i != CBX(progargc) - 1) strApndChar(outbuf, ' ');
         }
     } else if (fargct == 1) {
-        if (fargt[1] != 2) {cerr = 2; goto fexit;}
+        if (fargt[1] != 2) {CBX(cerr) = 2; goto fexit;}
         int i = atoi(farg[1]);
-        if (i < 0) {cerr = 16; goto fexit;}
-        if (i > progargc - 1 && i > 0) {outbuf[0] = 0; goto fexit;}
-        if (i == 0) {copyStr(progfn[progindex], outbuf);}
-        else {copyStr(progargs[i], outbuf);}
+        if (i < 0) {CBX(cerr) = 16; goto fexit;}
+        if (i > CBX(progargc) - 1 && i > 0) {outbuf[0] = 0; goto fexit;}
+        if (i == 0) {copyStr(CBX(progfn)[CBX(progindex)], outbuf);}
+        else {copyStr(CBX(progargs)[i], outbuf);}
     } else {
-        cerr = 3; goto fexit;
+        CBX(cerr) = 3; goto fexit;
     }
 }
 if (chkCmd(1, "_ARGC")) {
-    if (!inProg) {cerr = 125; goto fexit;}
-    cerr = 0;
+    if (!CBX(inProg)) {CBX(cerr) = 125; goto fexit;}
+    CBX(cerr) = 0;
     ftype = 2;
-    if (fargct) {cerr = 3; goto fexit;}
-    sprintf(outbuf, "%d", (progargc > 0) ? progargc - 1 : progargc);
+    if (fargct) {CBX(cerr) = 3; goto fexit;}
+    sprintf(outbuf, "%d", (CBX(progargc) > 0) ? CBX(progargc) - 1 : CBX(progargc));
     goto fexit;
 }
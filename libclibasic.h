@@ -0,0 +1,62 @@
+/*  --------------------------------------------------------------------------------------------  */
+/* |                              CLIBASIC header for embedding                                 | */
+/*  --------------------------------------------------------------------------------------------  */
+//
+// Build with 'make lib' and link against libclibasic.a or libclibasic.so (plus -lm -ldl -pthread).
+// The library does not use readline or touch the terminal; escape codes and cursor queries are off.
+//
+//   cb_ctx* cbCreate()
+//     Create an interpreter with its own variables, files, and program stack, returns NULL if out
+//     of memory
+//
+//   void cbDestroy(cb_ctx*)
+//     Close the files and free everything owned by the interpreter
+//
+//   int cbEval(cb_ctx*, const char*)
+//     Run source text (one or more lines) as a program and return 0 on success or the CLIBASIC
+//     error code that stopped it; variables persist between calls
+//
+//   int cbLoad(cb_ctx*, const char*)
+//     Same as cbEval but runs the program file at the path
+//
+//   int cbExitCode(cb_ctx*)
+//     Return the code passed to EXIT by the last cbEval or cbLoad, or 0 if it did not call EXIT
+//
+//   uint8_t cbGetVar(cb_ctx*, const char*, char*)
+//     Copy the value of a variable or array element (e.g. "A$", "B[2]") into a buffer of at
+//     least CB_LIB_BUF_SIZE bytes and return its type (1 = string, 2 = number) or 0 on error
+//
+//   int cbSetVar(cb_ctx*, const char*, const char*, uint8_t)
+//     Set a variable to a raw string (type 1) or a numeric expression (type 2) and return 0 on
+//     success or an error code
+//
+// Notes:
+//   - Errors are still printed to stdout the same way the shell prints them.
+//   - An interpreter can be used from any thread, but only from one thread at a time, and calls
+//     must not be nested inside a running cbEval or cbLoad on the same interpreter.
+//   - Settings outside of an interpreter (text attributes, extensions, the shell pool) are shared
+//     by every interpreter in the process.
+//   - ON TIMER and ON EVENT belong to the interpreter that set them up and use no signals, so the
+//     host's own SIGALRM handler is left alone.
+
+#ifndef LIBCLIBASIC_H
+#define LIBCLIBASIC_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#define CB_LIB_BUF_SIZE 32768 // must match CB_BUF_SIZE in clibasic.c (checked when it is built)
+
+#ifndef CB_EXT_API
+typedef struct cb_ctx cb_ctx;
+#endif
+
+cb_ctx* cbCreate();
+void cbDestroy(cb_ctx*);
+int cbEval(cb_ctx*, const char*);
+int cbLoad(cb_ctx*, const char*);
+int cbExitCode(cb_ctx*);
+uint8_t cbGetVar(cb_ctx*, const char*, char*);
+int cbSetVar(cb_ctx*, const char*, const char*, uint8_t);
+
+#endif
@@ -1,41 +1,41 @@
 int extcerr = 255;
 for (int i = extmaxct - 1; i > -1; --i) {
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) break;
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) break;
     }
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) break;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) break;
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp] || !fninfor[fnstackp]) break;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)] || !CBX(fninfor)[CBX(fnstackp)]) break;
     }
     if (extdata[i].inuse && extdata[i].runlogic) {
-        extcerr = extdata[i].runlogic(cmd, (char**)ltmp, i, j);
+        extcerr = extdata[i].runlogic(CBX(cmd), (char**)CBX(ltmp), i, j);
         if (extcerr != 255) {
-            cerr = extcerr;
+            CBX(cerr) = extcerr;
             return true;
         }
     }
 }
 if (chkCmd(1, "REM")) return true;
-if (chkCmd(2, "?", "PRINT") || cmd[i] == '?') {
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) return true;
+if (chkCmd(2, "?", "PRINT") || CBX(cmd)[i] == '?') {
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) return true;
     }
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) return true;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) return true;
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp] || !fninfor[fnstackp]) return true;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)] || !CBX(fninfor)[CBX(fnstackp)]) return true;
     }
-    if (cmd[i] == '?') {j = i + 1;}
+    if (CBX(cmd)[i] == '?') {j = i + 1;}
     {
         int32_t tmpj = j;
-        while (cmd[tmpj] == ' ') ++tmpj;
-        if (cmd[tmpj] == '=') return false;
+        while (CBX(cmd)[tmpj] == ' ') ++tmpj;
+        if (CBX(cmd)[tmpj] == '=') return false;
     }
-    while (cmd[j] == ' ') ++j;
-    if (cmd[j] == 0) {putchar('\n'); return true;}
+    while (CBX(cmd)[j] == ' ') ++j;
+    if (CBX(cmd)[j] == 0) {putchar('\n'); return true;}
     else {j--;}
     bool newline = false;
     bool inStr = false;
@@ -44,326 +44,459 @@ if (chkCmd(2, "?", "PRINT") || cmd[i] == '?') {
     int pct = 0, bct = 0;
     int32_t ptr = 0;
     int32_t i = j;
-    while (cmd[i]) {
+    while (CBX(cmd)[i]) {
         ++i;
-        if (cmd[i] == '"') {inStr = !inStr;}
+        if (CBX(cmd)[i] == '"') {inStr = !inStr;}
         if (!inStr) {
-            switch (cmd[i]) {
+            switch (CBX(cmd)[i]) {
                 case '(': ++pct; break;
                 case ')': --pct; break;
                 case '[': ++bct; break;
                 case ']': --bct; break;
             }
         }
-        if ((cmd[i] == ',' || cmd[i] == ';' || cmd[i] == 0) && !inStr && pct == 0 && bct == 0) {
-            ltmp[1][ptr] = 0;
+        if ((CBX(cmd)[i] == ',' || CBX(cmd)[i] == ';' || CBX(cmd)[i] == 0) && !inStr && pct == 0 && bct == 0) {
+            CBX(ltmp)[1][ptr] = 0;
             ptr = 0;
-            int32_t len = strlen(ltmp[1]);
+            int32_t len = strlen(CBX(ltmp)[1]);
             int tmpt;
-            if (!(tmpt = getVal(ltmp[1], ltmp[1]))) return true;
+            if (!(tmpt = getVal(CBX(ltmp)[1], CBX(ltmp)[1]))) return true;
             newline = false;
-            if (cmd[j] == ',') {
-                if (tmpt == 255 && !cmd[j + 1]) {newline = true;}
+            if (CBX(cmd)[j] == ',') {
+                if (tmpt == 255 && !CBX(cmd)[j + 1]) {newline = true;}
                 putchar('\t');
             }
-            fputs(ltmp[1], stdout);
-            if (cmd[i] == 0 && len > 0) putchar('\n');
+            fputs(CBX(ltmp)[1], stdout);
+            if (CBX(cmd)[i] == 0 && len > 0) putchar('\n');
             j = i;
             lookingForSpChar = false;
             sawSpChar = false;
         } else {
             if (!inStr) {
-                if (cmd[i] == ' ' && !sawSpChar && ptr > 0) {lookingForSpChar = true;}
-                if (isExSpChar(cmd[i])) {lookingForSpChar = false; sawSpChar = true;}
+                if (CBX(cmd)[i] == ' ' && !sawSpChar && ptr > 0) {lookingForSpChar = true;}
+                if (isExSpChar(CBX(cmd)[i])) {lookingForSpChar = false; sawSpChar = true;}
             }
-            if (inStr || cmd[i] != ' ') {
-                if (!isExSpChar(cmd[i])) sawSpChar = false;
-                if (lookingForSpChar) {cerr = 1; return true;}
-                ltmp[1][ptr] = cmd[i];
+            if (inStr || CBX(cmd)[i] != ' ') {
+                if (!isExSpChar(CBX(cmd)[i])) sawSpChar = false;
+                if (lookingForSpChar) {CBX(cerr) = 1; return true;}
+                CBX(ltmp)[1][ptr] = CBX(cmd)[i];
                 ptr++;
             }
         }
     }
     if (newline) putchar('\n');
-    if (pct || bct || inStr) {cerr = 1; return true;}
+    if (pct || bct || inStr) {CBX(cerr) = 1; return true;}
     fflush(stdout);
     return true;
 }
 if (chkCmd(1, "DO")) {
-    if (dlstackp >= CB_PROG_LOGIC_MAX - 1) {cerr = 12; return true;}
-    dlstackp++;
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) {dldcmd[dlstackp] = true; return true;}
-    }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] + 1 : 0)) {
-        if (dldcmd[dlstackp - 1]) {dldcmd[dlstackp] = true; return true;}
-    }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
-    }
-    while (cmd[j]) {if (cmd[j] != ' ') {cerr = 3; return true;} ++j;}
-    dldcmd[dlstackp] = false;
-    dlstack[dlstackp].cp = cmdpos;
-    dlstack[dlstackp].pl = progLine;
-    dlstack[dlstackp].brkinfo = brkinfo;
-    brkinfo.block = 1;
+    if (CBX(dlstackp) >= CB_PROG_LOGIC_MAX - 1) {CBX(cerr) = 12; return true;}
+    CBX(dlstackp)++;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) {CBX(dldcmd)[CBX(dlstackp)] = true; return true;}
+    }
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] + 1 : 0)) {
+        if (CBX(dldcmd)[CBX(dlstackp) - 1]) {CBX(dldcmd)[CBX(dlstackp)] = true; return true;}
+    }
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
+    }
+    while (CBX(cmd)[j]) {if (CBX(cmd)[j] != ' ') {CBX(cerr) = 3; return true;} ++j;}
+    CBX(dldcmd)[CBX(dlstackp)] = false;
+    CBX(dlstack)[CBX(dlstackp)].cp = CBX(cmdpos);
+    CBX(dlstack)[CBX(dlstackp)].pl = CBX(progLine);
+    CBX(dlstack)[CBX(dlstackp)].brkinfo = CBX(brkinfo);
+    CBX(brkinfo).block = 1;
     #ifdef _WIN32
     updatechars();
     #endif
     return true;
 }
 if (chkCmd(2, "WHILE", "DOWHILE")) {
-    if (dlstackp >= CB_PROG_LOGIC_MAX - 1) {cerr = 12; return true;}
-    dlstackp++;
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) {dldcmd[dlstackp] = true; return true;}
+    if (CBX(dlstackp) >= CB_PROG_LOGIC_MAX - 1) {CBX(cerr) = 12; return true;}
+    CBX(dlstackp)++;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) {CBX(dldcmd)[CBX(dlstackp)] = true; return true;}
     }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] + 1 : 0)) {
-        if (dldcmd[dlstackp - 1]) {dldcmd[dlstackp] = true; return true;}
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] + 1 : 0)) {
+        if (CBX(dldcmd)[CBX(dlstackp) - 1]) {CBX(dldcmd)[CBX(dlstackp)] = true; return true;}
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
     }
-    copyStrSnip(cmd, j + 1, strlen(cmd), ltmp[1]);
-    if (getArgCt(ltmp[1]) != 1) {cerr = 3; return true;}
-    uint8_t testval = logictest(ltmp[1]);
+    copyStrSnip(CBX(cmd), j + 1, strlen(CBX(cmd)), CBX(ltmp)[1]);
+    if (getArgCt(CBX(ltmp)[1]) != 1) {CBX(cerr) = 3; return true;}
+    uint8_t testval = logictest(CBX(ltmp)[1]);
     if (testval == 255) return true;
     if (testval == 1) {
-        dlstack[dlstackp].pl = progLine;
-        dlstack[dlstackp].cp = cmdpos;
-        dlstack[dlstackp].brkinfo = brkinfo;
-        brkinfo.block = 1;
+        CBX(dlstack)[CBX(dlstackp)].pl = CBX(progLine);
+        CBX(dlstack)[CBX(dlstackp)].cp = CBX(cmdpos);
+        CBX(dlstack)[CBX(dlstackp)].brkinfo = CBX(brkinfo);
+        CBX(brkinfo).block = 1;
         #ifdef _WIN32
         updatechars();
         #endif
     }
-    dldcmd[dlstackp] = !testval;
+    CBX(dldcmd)[CBX(dlstackp)] = !testval;
     return true;
 }
 if (chkCmd(1, "LOOP")) {
-    if (dlstackp <= -1) {cerr = 6; return true;}
+    if (CBX(dlstackp) <= -1) {CBX(cerr) = 6; return true;}
     bool brk = false;
-    if (brkinfo.block == 1) {
-        if (brkinfo.type >= 1) {dldcmd[dlstackp] = false;}
-        if (brkinfo.type == 2) {brk = true;}
-        brkinfo.type = 0;
+    if (CBX(brkinfo).block == 1) {
+        if (CBX(brkinfo).type >= 1) {CBX(dldcmd)[CBX(dlstackp)] = false;}
+        if (CBX(brkinfo).type == 2) {brk = true;}
+        CBX(brkinfo).type = 0;
     }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) {dlstackp--; return true;}
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) {CBX(dlstackp)--; return true;}
     }
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) return true;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) return true;
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
     }
-    while (cmd[j]) {if (cmd[j] != ' ') {cerr = 3; return true;} ++j;}
+    while (CBX(cmd)[j]) {if (CBX(cmd)[j] != ' ') {CBX(cerr) = 3; return true;} ++j;}
     if (!brk) {
-        if (inProg) {
-            cp = dlstack[dlstackp].cp;
+        if (CBX(inProg)) {
+            CBX(cp) = CBX(dlstack)[CBX(dlstackp)].cp;
         } else {
-            concp = dlstack[dlstackp].cp;
+            concp = CBX(dlstack)[CBX(dlstackp)].cp;
         }
-        progLine = dlstack[dlstackp].pl;
-        brkinfo = dlstack[dlstackp].brkinfo;
-        lockpl = true;
+        CBX(progLine) = CBX(dlstack)[CBX(dlstackp)].pl;
+        CBX(brkinfo) = CBX(dlstack)[CBX(dlstackp)].brkinfo;
+        CBX(lockpl) = true;
     }
-    dldcmd[dlstackp] = false;
-    didloop = true;
-    dlstackp--;
+    CBX(dldcmd)[CBX(dlstackp)] = false;
+    CBX(didloop) = true;
+    CBX(dlstackp)--;
     return true;
 }
 if (chkCmd(1, "LOOPWHILE")) {
-    if (dlstackp <= -1) {cerr = 6; return true;}
+    if (CBX(dlstackp) <= -1) {CBX(cerr) = 6; return true;}
     bool brk = false;
-    if (brkinfo.block == 1) {
-        if (brkinfo.type >= 1) {dldcmd[dlstackp] = false;}
-        if (brkinfo.type == 2) {brk = true;}
-        brkinfo.type = 0;
+    if (CBX(brkinfo).block == 1) {
+        if (CBX(brkinfo).type >= 1) {CBX(dldcmd)[CBX(dlstackp)] = false;}
+        if (CBX(brkinfo).type == 2) {brk = true;}
+        CBX(brkinfo).type = 0;
     }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) {dlstackp--; return true;}
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) {CBX(dlstackp)--; return true;}
     }
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) return true;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) return true;
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
     }
     if (!brk) {
-        copyStrSnip(cmd, j + 1, strlen(cmd), ltmp[1]);
-        if (getArgCt(ltmp[1]) != 1) {cerr = 3; return true;}
-        uint8_t testval = logictest(ltmp[1]);
+        copyStrSnip(CBX(cmd), j + 1, strlen(CBX(cmd)), CBX(ltmp)[1]);
+        if (getArgCt(CBX(ltmp)[1]) != 1) {CBX(cerr) = 3; return true;}
+        uint8_t testval = logictest(CBX(ltmp)[1]);
         if (testval == 255) return true;
         if (testval == 1) {
-            if (inProg) {
-                cp = dlstack[dlstackp].cp;
+            if (CBX(inProg)) {
+                CBX(cp) = CBX(dlstack)[CBX(dlstackp)].cp;
             } else {
-                concp = dlstack[dlstackp].cp;
+                concp = CBX(dlstack)[CBX(dlstackp)].cp;
             }
-            progLine = dlstack[dlstackp].pl;
-            brkinfo = dlstack[dlstackp].brkinfo;
-            lockpl = true;
+            CBX(progLine) = CBX(dlstack)[CBX(dlstackp)].pl;
+            CBX(brkinfo) = CBX(dlstack)[CBX(dlstackp)].brkinfo;
+            CBX(lockpl) = true;
         }
     }
-    dldcmd[dlstackp] = false;
-    dlstackp--;
-    didloop = true;
+    CBX(dldcmd)[CBX(dlstackp)] = false;
+    CBX(dlstackp)--;
+    CBX(didloop) = true;
     return true;
 }
 if (chkCmd(1, "IF")) {
-    if (itstackp >= CB_PROG_LOGIC_MAX - 1) {cerr = 13; return true;}
-    itstackp++;
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] + 1 : 0)) {
-        if (itdcmd[itstackp - 1]) {itdcmd[itstackp] = true; return true;}
+    if (CBX(itstackp) >= CB_PROG_LOGIC_MAX - 1) {CBX(cerr) = 13; return true;}
+    CBX(itstackp)++;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] + 1 : 0)) {
+        if (CBX(itdcmd)[CBX(itstackp) - 1]) {CBX(itdcmd)[CBX(itstackp)] = true; return true;}
     }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) {itdcmd[itstackp] = true; return true;}
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) {CBX(itdcmd)[CBX(itstackp)] = true; return true;}
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
     }
-    copyStrSnip(cmd, j + 1, strlen(cmd), ltmp[1]);
-    if (getArgCt(ltmp[1]) != 1) {cerr = 3; return true;}
-    uint8_t testval = logictest(ltmp[1]);
+    copyStrSnip(CBX(cmd), j + 1, strlen(CBX(cmd)), CBX(ltmp)[1]);
+    if (getArgCt(CBX(ltmp)[1]) != 1) {CBX(cerr) = 3; return true;}
+    uint8_t testval = logictest(CBX(ltmp)[1]);
     if (testval == 255) return true;
-    didelseif[itstackp] = testval;
-    itdcmd[itstackp] = !testval;
+    CBX(didelseif)[CBX(itstackp)] = testval;
+    CBX(itdcmd)[CBX(itstackp)] = !testval;
     return true;
 }
 if (chkCmd(1, "ELSE")) {
-    if (itstackp <= -1) {cerr = 8; return true;}
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] + 1 : 0)) {
-        if (itdcmd[itstackp - 1]) return true;
+    if (CBX(itstackp) <= -1) {CBX(cerr) = 8; return true;}
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] + 1 : 0)) {
+        if (CBX(itdcmd)[CBX(itstackp) - 1]) return true;
     }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) return true;
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) return true;
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
     }
-    while (cmd[j]) {if (cmd[j] != ' ') {cerr = 3; return true;} ++j;}
-    if (didelse[itstackp]) {cerr = 11; return true;}
-    if (didelseif[itstackp]) {itdcmd[itstackp] = true; return true;}
-    didelse[itstackp] = true;
-    itdcmd[itstackp] = !itdcmd[itstackp];
+    while (CBX(cmd)[j]) {if (CBX(cmd)[j] != ' ') {CBX(cerr) = 3; return true;} ++j;}
+    if (CBX(didelse)[CBX(itstackp)]) {CBX(cerr) = 11; return true;}
+    if (CBX(didelseif)[CBX(itstackp)]) {CBX(itdcmd)[CBX(itstackp)] = true; return true;}
+    CBX(didelse)[CBX(itstackp)] = true;
+    CBX(itdcmd)[CBX(itstackp)] = !CBX(itdcmd)[CBX(itstackp)];
     return true;
 }
 if (chkCmd(1, "ELSEIF")) {
-    if (itstackp <= -1) {cerr = 8; return true;}
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] + 1 : 0)) {
-        if (itdcmd[itstackp - 1]) return true;
+    if (CBX(itstackp) <= -1) {CBX(cerr) = 8; return true;}
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] + 1 : 0)) {
+        if (CBX(itdcmd)[CBX(itstackp) - 1]) return true;
     }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) return true;
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) return true;
     }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
     }
-    copyStrSnip(cmd, j + 1, strlen(cmd), ltmp[1]);
-    if (getArgCt(ltmp[1]) != 1) {cerr = 3; return true;}
-    if (didelseif[itstackp]) {itdcmd[itstackp] = true; return true;}
-    uint8_t testval = logictest(ltmp[1]);
+    copyStrSnip(CBX(cmd), j + 1, strlen(CBX(cmd)), CBX(ltmp)[1]);
+    if (getArgCt(CBX(ltmp)[1]) != 1) {CBX(cerr) = 3; return true;}
+    if (CBX(didelseif)[CBX(itstackp)]) {CBX(itdcmd)[CBX(itstackp)] = true; return true;}
+    uint8_t testval = logictest(CBX(ltmp)[1]);
     if (testval == 255) return true;
-    didelseif[itstackp] = testval;
-    itdcmd[itstackp] = !testval;
+    CBX(didelseif)[CBX(itstackp)] = testval;
+    CBX(itdcmd)[CBX(itstackp)] = !testval;
     return true;
 }
 if (chkCmd(1, "ENDIF")) {
-    if (itstackp <= -1) {cerr = 7; return true;}
-    itstackp--;
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) return true;
-    }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] : -1)) {
-        if (fndcmd[fnstackp]) return true;
-    }
-    while (cmd[j]) {if (cmd[j] != ' ') {cerr = 3; return true;} ++j;}
-    itdcmd[itstackp + 1] = false;
-    didelse[itstackp + 1] = false;
-    didelseif[itstackp + 1] = false;
+    if (CBX(itstackp) <= -1) {CBX(cerr) = 7; return true;}
+    CBX(itstackp)--;
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) return true;
+    }
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
+    }
+    while (CBX(cmd)[j]) {if (CBX(cmd)[j] != ' ') {CBX(cerr) = 3; return true;} ++j;}
+    CBX(itdcmd)[CBX(itstackp) + 1] = false;
+    CBX(didelse)[CBX(itstackp) + 1] = false;
+    CBX(didelseif)[CBX(itstackp) + 1] = false;
+    return true;
+}
+if (chkCmd(1, "PARFOR")) {
+    if (CBX(itstackp) >= CB_PROG_LOGIC_MAX - 1) {CBX(cerr) = 13; return true;}
+    bool skip = false;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) skip = true;
+    }
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) skip = true;
+    }
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) skip = true;
+    }
+    if (skip) {
+        if (CBX(fnstackp) >= CB_PROG_LOGIC_MAX - 1) {CBX(cerr) = 14; return true;}
+        CBX(fnstack)[CBX(fnstackp)].brkinfo = CBX(brkinfo);
+        CBX(brkinfo).type = 0;
+        CBX(fnstackp)++;
+        CBX(fndcmd)[CBX(fnstackp)] = true;
+        return true;
+    }
+    // PARFOR var = a, b or PARFOR var, a, b, then REDUCE op var clauses with or without commas
+    copyStrSnip(CBX(cmd), j + 1, strlen(CBX(cmd)), CBX(ltmp)[1]);
+    char* rp = NULL;
+    {
+        bool inStr = false;
+        int pd = 0;
+        for (char* c = CBX(ltmp)[1]; *c; ++c) {
+            if (*c == '"') inStr = !inStr;
+            if (inStr) continue;
+            if (*c == '(' || *c == '[') {++pd;}
+            else if (*c == ')' || *c == ']') {--pd;}
+            else if (!pd && c > CBX(ltmp)[1] && (c[-1] == ' ' || c[-1] == ',') && !strncmp(c, "REDUCE ", 7)) {rp = c; break;}
+        }
+    }
+    if (rp) {
+        char* e = rp;
+        while (e > CBX(ltmp)[1] && e[-1] == ' ') {--e;}
+        if (e > CBX(ltmp)[1] && e[-1] == ',') --e;
+        *e = 0;
+    }
+    int pargct = getArgCt(CBX(ltmp)[1]);
+    CBX(cerr) = 2;
+    int32_t tmpptr = 0;
+    if ((tmpptr = getArgO(0, CBX(ltmp)[1], CBX(fnvar), 0)) == -1) return true;
+    char* eq = strchr(CBX(fnvar), '=');
+    if (pargct != ((eq) ? 2 : 3)) {CBX(cerr) = 3; return true;}
+    if (eq) {
+        *eq = 0;
+        copyStr(eq + 1, CBX(forbuf)[1]);
+    } else if ((tmpptr = getArgO(1, CBX(ltmp)[1], CBX(forbuf)[1], tmpptr)) == -1) {
+        return true;
+    }
+    if (getVar(CBX(fnvar), CBX(forbuf)[0]) != 2) return true;
+    if (getVal(CBX(forbuf)[1], CBX(forbuf)[1]) != 2) return true;
+    if ((tmpptr = getArgO(pargct - 1, CBX(ltmp)[1], CBX(forbuf)[2], tmpptr)) == -1) return true;
+    if (getVal(CBX(forbuf)[2], CBX(forbuf)[2]) != 2) return true;
+    cb_parred reds[16];
+    char rbuf[16][128];
+    int redct = 0;
+    while (rp && *rp) {
+        char op[8];
+        int n = 0;
+        CBX(cerr) = 1;
+        if (redct >= 16 || sscanf(rp, " REDUCE %7[^ ,] %127[^ ,] %n", op, rbuf[redct], &n) != 2 || !n) return true;
+        rp += n;
+        if (*rp == ',') ++rp;
+        reds[redct].var = rbuf[redct];
+        if (!strcmp(op, "+")) reds[redct].op = 0;
+        else if (!strcmp(op, "*")) reds[redct].op = 1;
+        else if (!strcmp(op, "MIN")) reds[redct].op = 2;
+        else if (!strcmp(op, "MAX")) reds[redct].op = 3;
+        else return true;
+        ++redct;
+    }
+    int ret = parFor(CBX(fnvar), atof(CBX(forbuf)[1]), atof(CBX(forbuf)[2]), reds, redct);
+    if (ret < 0) {
+        CBX(lasterr) = -ret;
+        if (runc || runfile) CBX(err) = 1;
+        CBX(cp) = -1;
+        if (cbctx == &cbmainctx) concp = -1;
+        CBX(chkinProg) = CBX(inProg) = false;
+        ret = 0;
+    }
+    CBX(cerr) = ret;
     return true;
 }
 if (chkCmd(1, "FOR")) {
-    if (itstackp >= CB_PROG_LOGIC_MAX - 1) {cerr = 13; return true;}
-    fnstack[fnstackp].brkinfo = brkinfo;
-    brkinfo.type = 0;
-    fnstackp++;
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) {return true;}
-    }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) {return true;}
-    }
-    if (fnstackp > ((progindex > -1) ? minfnstackp[progindex] + 1 : 0)) {
-        if (fndcmd[fnstackp - 1]) {return true;}
-    }
-    copyStrSnip(cmd, j + 1, strlen(cmd), ltmp[1]);
-    if (getArgCt(ltmp[1]) != 4) {cerr = 3; return true;}
-    cerr = 2;
+    if (CBX(itstackp) >= CB_PROG_LOGIC_MAX - 1) {CBX(cerr) = 13; return true;}
+    CBX(fnstack)[CBX(fnstackp)].brkinfo = CBX(brkinfo);
+    CBX(brkinfo).type = 0;
+    CBX(fnstackp)++;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) {return true;}
+    }
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) {return true;}
+    }
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] + 1 : 0)) {
+        if (CBX(fndcmd)[CBX(fnstackp) - 1]) {return true;}
+    }
+    copyStrSnip(CBX(cmd), j + 1, strlen(CBX(cmd)), CBX(ltmp)[1]);
+    if (getArgCt(CBX(ltmp)[1]) != 4) {CBX(cerr) = 3; return true;}
+    CBX(cerr) = 2;
     int32_t tmpptr = 0;
-    if ((tmpptr = getArgO(0, ltmp[1], fnvar, 0)) == -1) return true;
-    if (getVar(fnvar, forbuf[0]) != 2) return true;
-    if ((tmpptr = getArgO(1, ltmp[1], forbuf[1], tmpptr)) == -1) return true;
-    if (getVal(forbuf[1], forbuf[1]) != 2) return true;
-    if ((tmpptr = getArgO(2, ltmp[1], forbuf[2], tmpptr)) == -1) return true;
-    if ((tmpptr = getArgO(3, ltmp[1], forbuf[3], tmpptr)) == -1) return true;
-    if (getVal(forbuf[3], forbuf[3]) != 2) return true;
-    setVar(fnvar, forbuf[1], 2, -1);
-    if (fnstack[fnstackp].cp == -1) {
-        copyStr(forbuf[1], forbuf[0]);
-    }
-    if (fninfor[fnstackp]) {
-        sprintf(forbuf[0], "%lf", atof(forbuf[0]) + atof(forbuf[3]));
-        setVar(fnvar, forbuf[0], 2, -1);
-    }
-    int testval = logictest(forbuf[2]);
+    if ((tmpptr = getArgO(0, CBX(ltmp)[1], CBX(fnvar), 0)) == -1) return true;
+    if (getVar(CBX(fnvar), CBX(forbuf)[0]) != 2) return true;
+    if ((tmpptr = getArgO(1, CBX(ltmp)[1], CBX(forbuf)[1], tmpptr)) == -1) return true;
+    if (getVal(CBX(forbuf)[1], CBX(forbuf)[1]) != 2) return true;
+    if ((tmpptr = getArgO(2, CBX(ltmp)[1], CBX(forbuf)[2], tmpptr)) == -1) return true;
+    if ((tmpptr = getArgO(3, CBX(ltmp)[1], CBX(forbuf)[3], tmpptr)) == -1) return true;
+    if (getVal(CBX(forbuf)[3], CBX(forbuf)[3]) != 2) return true;
+    setVar(CBX(fnvar), CBX(forbuf)[1], 2, -1);
+    if (CBX(fnstack)[CBX(fnstackp)].cp == -1) {
+        copyStr(CBX(forbuf)[1], CBX(forbuf)[0]);
+    }
+    if (CBX(fninfor)[CBX(fnstackp)]) {
+        sprintf(CBX(forbuf)[0], "%lf", atof(CBX(forbuf)[0]) + atof(CBX(forbuf)[3]));
+        setVar(CBX(fnvar), CBX(forbuf)[0], 2, -1);
+    }
+    int testval = logictest(CBX(forbuf)[2]);
     if (testval == 255) return true;
-    fndcmd[fnstackp] = !testval;
-    if (!(fninfor[fnstackp] = testval)) {cerr = 0; return true;}
-    if (!fninfor[fnstackp] && fnstack[fnstackp].cp == -1) {
-        sprintf(forbuf[0], "%lf", atof(forbuf[0]) - atof(forbuf[3]));
-        setVar(fnvar, forbuf[0], 2, -1);
-    }
-    cerr = 0;
-    fnstack[fnstackp].cp = cmdpos;
-    fnstack[fnstackp].pl = progLine;
-    brkinfo.block = 2;
+    CBX(fndcmd)[CBX(fnstackp)] = !testval;
+    if (!(CBX(fninfor)[CBX(fnstackp)] = testval)) {CBX(cerr) = 0; return true;}
+    if (!CBX(fninfor)[CBX(fnstackp)] && CBX(fnstack)[CBX(fnstackp)].cp == -1) {
+        sprintf(CBX(forbuf)[0], "%lf", atof(CBX(forbuf)[0]) - atof(CBX(forbuf)[3]));
+        setVar(CBX(fnvar), CBX(forbuf)[0], 2, -1);
+    }
+    CBX(cerr) = 0;
+    CBX(fnstack)[CBX(fnstackp)].cp = CBX(cmdpos);
+    CBX(fnstack)[CBX(fnstackp)].pl = CBX(progLine);
+    CBX(brkinfo).block = 2;
     #ifdef _WIN32
     updatechars();
     #endif
     return true;
 }
 if (chkCmd(1, "NEXT")) {
-    if (fnstackp <= -1) {cerr = 9; return true;}
-    if (brkinfo.block == 2) {
-        if (brkinfo.type > 0) {fndcmd[dlstackp] = false;}
-        if (brkinfo.type == 2) {fninfor[fnstackp] = false;}
-    }
-    fnstackp--;
-    if (itstackp > ((progindex > -1) ? minitstackp[progindex] : -1)) {
-        if (itdcmd[itstackp]) {return true;}
-    }
-    if (dlstackp > ((progindex > -1) ? mindlstackp[progindex] : -1)) {
-        if (dldcmd[dlstackp]) {return true;}
-    }
-    fnstackp++;
-    while (cmd[j]) {if (cmd[j] != ' ') {cerr = 3; return true;} ++j;}
-    if (fninfor[fnstackp]) {
-        if (inProg) {
-            cp = fnstack[fnstackp].cp;
+    if (CBX(fnstackp) <= -1) {CBX(cerr) = 9; return true;}
+    if (CBX(brkinfo).block == 2) {
+        if (CBX(brkinfo).type > 0) {CBX(fndcmd)[CBX(dlstackp)] = false;}
+        if (CBX(brkinfo).type == 2) {CBX(fninfor)[CBX(fnstackp)] = false;}
+    }
+    CBX(fnstackp)--;
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) {return true;}
+    }
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) {return true;}
+    }
+    CBX(fnstackp)++;
+    while (CBX(cmd)[j]) {if (CBX(cmd)[j] != ' ') {CBX(cerr) = 3; return true;} ++j;}
+    if (CBX(fninfor)[CBX(fnstackp)]) {
+        if (CBX(inProg)) {
+            CBX(cp) = CBX(fnstack)[CBX(fnstackp)].cp;
         } else {
-            concp = fnstack[fnstackp].cp;
+            concp = CBX(fnstack)[CBX(fnstackp)].cp;
         }
-        progLine = fnstack[fnstackp].pl;
-        lockpl = true;
-        didloop = true;
+        CBX(progLine) = CBX(fnstack)[CBX(fnstackp)].pl;
+        CBX(lockpl) = true;
+        CBX(didloop) = true;
+    } else {
+        CBX(fnstack)[CBX(fnstackp)].cp = -1;
+        CBX(brkinfo).type = 0;
+        CBX(fndcmd)[CBX(dlstackp)] = false;
+    }
+    CBX(fnstackp)--;
+    CBX(brkinfo) = CBX(fnstack)[CBX(fnstackp)].brkinfo;
+    return true;
+}
+if (chkCmd(1, "ON")) {
+    if (CBX(dlstackp) > ((CBX(progindex) > -1) ? CBX(mindlstackp)[CBX(progindex)] : -1)) {
+        if (CBX(dldcmd)[CBX(dlstackp)]) return true;
+    }
+    if (CBX(itstackp) > ((CBX(progindex) > -1) ? CBX(minitstackp)[CBX(progindex)] : -1)) {
+        if (CBX(itdcmd)[CBX(itstackp)]) return true;
+    }
+    if (CBX(fnstackp) > ((CBX(progindex) > -1) ? CBX(minfnstackp)[CBX(progindex)] : -1)) {
+        if (CBX(fndcmd)[CBX(fnstackp)]) return true;
+    }
+    if (!CBX(inProg)) {CBX(cerr) = 253; return true;}
+    copyStrSnip(CBX(cmd), j + 1, strlen(CBX(cmd)), CBX(ltmp)[1]);
+    upCase(CBX(ltmp)[1]);
+    char lbl[256];
+    int n = 0;
+    CBX(cerr) = 1;
+    if (sscanf(CBX(ltmp)[1], " EVENT OFF %n", &n) == 0 && n && !CBX(ltmp)[1][n]) {
+        nfree(CBX(evlbl));
+        CBX(evgs) = 0;
+        CBX(evpend) = 0;
+    } else if (sscanf(CBX(ltmp)[1], " EVENT GOSUB %255[^ ] %n", lbl, &n) == 1 && !CBX(ltmp)[1][n]) {
+        if (!isLabel(lbl)) {CBX(cerr) = 29; return true;}
+        CBX(evlbl) = realloc(CBX(evlbl), strlen(lbl) + 1);
+        strcpy(CBX(evlbl), lbl);
+        CBX(evprog) = CBX(progindex);
+        CBX(evchk) = 0;
+    } else if (sscanf(CBX(ltmp)[1], " TIMER OFF %n", &n) == 0 && n && !CBX(ltmp)[1][n]) {
+        tmrStop();
+    } else if (sscanf(CBX(ltmp)[1], " TIMER %n", &n) == 0 && n) {
+        char* e = &CBX(ltmp)[1][n];
+        char* g = NULL;
+        for (char* p = e; (p = strstr(p, " GOSUB ")); ++p) {g = p;}
+        n = 0;
+        if (!g || sscanf(g, " GOSUB %255[^ ] %n", lbl, &n) != 1 || g[n]) return true;
+        if (!isLabel(lbl)) {CBX(cerr) = 29; return true;}
+        *g = 0;
+        CBX(cerr) = 2;
+        if (getArgO(0, e, CBX(forbuf)[0], 0) == -1 || getVal(CBX(forbuf)[0], CBX(forbuf)[0]) != 2) return true;
+        CBX(cerr) = 0;
+        tmrStart(atof(CBX(forbuf)[0]), lbl);
+        return true;
     } else {
-        fnstack[fnstackp].cp = -1;
-        brkinfo.type = 0;
-        fndcmd[dlstackp] = false;
+        return true;
     }
-    fnstackp--;
-    brkinfo = fnstack[fnstackp].brkinfo;
+    CBX(cerr) = 0;
     return true;
 }
@@ -0,0 +1,47 @@
+# COPY of a regular file and recursive RM of a directory tree
+D$ = "copy_rm.tmp"
+MD D$
+P$ = D$ + "/src.txt"
+F = FOPEN(P$, "w")
+FOR I, 0, I < 20000, 1
+FWRITELN F, "line " + STR$(I)
+NEXT
+FCLOSE F
+C = COPY(P$, D$ + "/dst.txt")
+S = COPY(P$, P$)
+COPY P$, D$ + "/dst2.txt"
+F = FOPEN(D$ + "/dst.txt", "r")
+A = FSIZE(F)
+N = 0
+DO
+L$ = FREADLINE$(F)
+IF L$ <> "line " + STR$(N)
+    PRINT "FAIL: copied line "; N; " is '"; L$; "'"
+    EXIT 1
+ENDIF
+N = N + 1
+LOOPWHILE EOF(F) = 0
+FCLOSE F
+F = FOPEN(P$, "r")
+B = FSIZE(F)
+FCLOSE F
+F = FOPEN(D$ + "/dst2.txt", "r")
+B2 = FSIZE(F)
+FCLOSE F
+IF C <> 1 | S <> 0 | N <> 20000 | A <> B | B2 <> B
+    PRINT "FAIL: COPY returned "; C; " and "; S; ", "; N; " lines, sizes "; A; " "; B; " "; B2
+    EXIT 1
+ENDIF
+FOR I, 0, I < 5, 1
+MD D$ + "/d" + STR$(I)
+FOR J, 0, J < 5, 1
+F = FOPEN(D$ + "/d" + STR$(I) + "/f" + STR$(J), "w")
+FCLOSE F
+NEXT
+NEXT
+RM D$
+IF ISFILE(D$) <> -1
+    PRINT "FAIL: RM left "; D$
+    EXIT 1
+ENDIF
+PRINT "ok"
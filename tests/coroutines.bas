@@ -0,0 +1,44 @@
+# COSTART/YIELD round-robin order and COWAIT letting the others run
+IF 0
+    @CA
+    FOR IA, 0, IA < 3, 1
+    L$ = L$ + "a"
+    YIELD
+    NEXT
+    RETURN
+    @CB
+    FOR IB, 0, IB < 3, 1
+    L$ = L$ + "b"
+    YIELD
+    NEXT
+    RETURN
+    @CW
+    COWAIT 0.1
+    D = 1
+    RETURN
+ENDIF
+L$ = ""
+COSTART CA
+COSTART CB
+N = COCOUNT()
+DO
+YIELD
+LOOPWHILE COCOUNT() > 0
+IF L$ <> "ababab" | N <> 2
+    PRINT "FAIL: ran '"; L$; "' with "; N; " coroutines"
+    EXIT 1
+ENDIF
+D = 0
+M = 0
+T = TIMERUS()
+COSTART CW
+DO
+M = M + 1
+YIELD
+LOOPWHILE COCOUNT() > 0
+T = TIMERUS() - T
+IF D <> 1 | M < 2 | T < 100000
+    PRINT "FAIL: COWAIT finished "; D; " after "; T; " us, main ran "; M; " times"
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,38 @@
+# CSVLOAD of quoted, short and long rows into string and number arrays
+P$ = "csvload.tmp"
+Q$ = CHR$(34)
+N$ = CHR$(13) + CHR$(10)
+F = FOPEN(P$, "w")
+FWRITE F, "name,qty,note" + N$
+FWRITE F, "plain,1,x" + N$
+FWRITE F, Q$ + "a, b" + Q$ + ",2," + Q$ + "say " + Q$ + Q$ + "hi" + Q$ + Q$ + Q$ + N$
+FWRITE F, "short,3" + N$
+FWRITE F, N$
+FWRITE F, "long,4,y,dropped" + N$
+FWRITE F, Q$ + "two" + CHR$(10) + "lines" + Q$ + ",5,z"
+FCLOSE F
+R = CSVLOAD(P$, 3, C$)
+IF R <> 6
+    PRINT "FAIL: CSVLOAD returned "; R; " rows"
+    EXIT 1
+ENDIF
+IF C$[3] <> "plain" | C$[6] <> "a, b" | C$[8] <> "say " + Q$ + "hi" + Q$ | C$[9] <> "short" | C$[11] <> ""
+    PRINT "FAIL: row fields '"; C$[3]; "' '"; C$[6]; "' '"; C$[8]; "' '"; C$[9]; "' '"; C$[11]; "'"
+    EXIT 1
+ENDIF
+IF C$[12] <> "long" | C$[14] <> "y" | C$[15] <> "two" + CHR$(10) + "lines" | C$[17] <> "z"
+    PRINT "FAIL: row fields '"; C$[12]; "' '"; C$[14]; "' '"; C$[15]; "' '"; C$[17]; "'"
+    EXIT 1
+ENDIF
+F = FOPEN(P$, "w")
+FWRITELN F, "1,2.5"
+FWRITELN F, "-3,abc"
+FWRITELN F, "1e3,0.10"
+FCLOSE F
+CSVLOAD P$, 2, V
+RM P$
+IF V[0] <> 1 | V[1] <> 2.5 | V[2] <> -3 | V[3] <> 0 | V[4] <> 1000 | V[5] <> 0.1
+    PRINT "FAIL: numbers "; V[0]; " "; V[1]; " "; V[2]; " "; V[3]; " "; V[4]; " "; V[5]
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,36 @@
+# DIRLIST, flat and recursive, as a function and as a command
+D$ = "dirlist.tmp"
+MD D$
+MD D$ + "/sub"
+F = FOPEN(D$ + "/a.txt", "w")
+FCLOSE F
+F = FOPEN(D$ + "/sub/b.txt", "w")
+FCLOSE F
+N = DIRLIST(D$, A$)
+M = 0
+FOR I, 0, I < N, 1
+IF A$[I] = "a.txt" | A$[I] = "sub/"
+M = M + 1
+ENDIF
+NEXT
+IF N <> 2 | M <> 2
+    PRINT "FAIL: DIRLIST found "; N; " entries, "; M; " expected ones"
+    EXIT 1
+ENDIF
+DIRLIST D$, B$, 1
+M = 0
+FOR I, 0, I < 3, 1
+IF B$[I] = "a.txt" | B$[I] = "sub/" | B$[I] = "sub/b.txt"
+M = M + 1
+ENDIF
+NEXT
+N = DIRLIST(D$ + "/sub/", C$)
+T$ = C$[0]
+RM D$ + "/sub/b.txt"
+N2 = DIRLIST(D$ + "/sub", E$)
+RM D$
+IF M <> 3 | N <> 1 | T$ <> "b.txt" | N2 <> 0
+    PRINT "FAIL: recursive DIRLIST matched "; M; ", sub has "; N; " then "; N2; " entries"
+    EXIT 1
+ENDIF
+PRINT "ok"
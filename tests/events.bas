@@ -0,0 +1,46 @@
+# ON EVENT GOSUB driven by a repeating EVTIMER and by EVWATCH on a FIFO
+IF 0
+    @EV
+    E = EVID()
+    IF E = T
+        TC = TC + 1
+    ENDIF
+    IF E = W
+        IF EOF(F)
+            EVUNWATCH W
+            DONE = 1
+        ELSE
+            L$ = L$ + FREADLINE$(F)
+        ENDIF
+    ENDIF
+    RETURN
+ENDIF
+P$ = "events.tmp"
+RM P$
+IF SH("mkfifo " + P$) <> 0
+    PRINT "skipped: mkfifo failed"
+    EXIT
+ENDIF
+SH "(sleep 0.05; printf 'x\ny\n'; sleep 0.05; printf 'z\n') > " + P$ + " &"
+F = FOPEN(P$, "r")
+L$ = ""
+TC = 0
+DONE = 0
+ON EVENT GOSUB EV
+T = EVTIMER(0.01)
+W = EVWATCH(F)
+S = TIMERUS()
+DO
+IF TIMERUS() - S > 5000000
+BREAK
+ENDIF
+LOOPWHILE DONE = 0 | TC < 5
+ON EVENT OFF
+EVUNWATCH T
+FCLOSE F
+RM P$
+IF L$ <> "xyz" | DONE <> 1 | TC < 5
+    PRINT "FAIL: read '"; L$; "', done "; DONE; ", "; TC; " timer events"
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,28 @@
+# EXECPAR exit codes, captured output, concurrency, and the _RET() summary
+DIM C$, 3, ""
+C$[0] = "exit 0"
+C$[1] = "exit 2"
+C$[2] = "echo out; echo err >&2"
+C$[3] = "sleep 0.1; printf slow"
+EXECPAR C$, R, 2, O$
+IF R[0] <> 0 | R[1] <> 2 | R[2] <> 0 | R[3] <> 0 | _RET() <> 2
+    PRINT "FAIL: codes "; R[0]; " "; R[1]; " "; R[2]; " "; R[3]; ", _RET() "; _RET()
+    EXIT 1
+ENDIF
+IF O$[0] <> "" | O$[2] <> "out" + CHR$(10) + "err" + CHR$(10) | O$[3] <> "slow"
+    PRINT "FAIL: output '"; O$[0]; "' '"; O$[2]; "' '"; O$[3]; "'"
+    EXIT 1
+ENDIF
+DIM S$, 3, ""
+FOR I, 0, I < 4, 1
+S$[I] = "sleep 0.2"
+NEXT
+T = TIMERUS()
+_SHATTRIB SILENT
+EXECPAR S$, Q, 4
+T = TIMERUS() - T
+IF T > 600000 | _RET() <> 0
+    PRINT "FAIL: four 0.2 s sleeps took "; T; " us"
+    EXIT 1
+ENDIF
+PRINT "ok"
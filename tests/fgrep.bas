@@ -0,0 +1,35 @@
+# FGREP over a directory tree and over a single file
+D$ = "fgrep.tmp"
+MD D$
+MD D$ + "/sub"
+F = FOPEN(D$ + "/a.txt", "w")
+FWRITELN F, "nothing here"
+FWRITELN F, "a needle here"
+FWRITELN F, "needle again"
+FCLOSE F
+F = FOPEN(D$ + "/sub/b.txt", "w")
+FOR I, 0, I < 5000, 1
+FWRITELN F, "hay " + STR$(I)
+NEXT
+FWRITE F, "last needle"
+FCLOSE F
+N = FGREP("needle", D$, R$)
+M = 0
+FOR I, 0, I < N, 1
+IF R$[I] = D$ + "/a.txt:2:a needle here" | R$[I] = D$ + "/a.txt:3:needle again" | R$[I] = D$ + "/sub/b.txt:5001:last needle"
+M = M + 1
+ENDIF
+NEXT
+IF N <> 3 | M <> 3
+    PRINT "FAIL: FGREP found "; N; " lines, "; M; " expected ones"
+    EXIT 1
+ENDIF
+N = FGREP("hay 4999", D$ + "/sub/b.txt", S$)
+T$ = S$[0]
+N2 = FGREP("missing", D$, U$)
+RM D$
+IF N <> 1 | T$ <> D$ + "/sub/b.txt:5000:hay 4999" | N2 <> 0
+    PRINT "FAIL: FGREP found "; N; " then "; N2; " lines, first '"; T$; "'"
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,26 @@
+# 64-bit offsets and live sizes on a sparse file past 4 GiB
+P$ = "file_offsets.tmp"
+G = 5368709120
+F = FOPEN(P$, "w")
+FCLOSE F
+R = SH("truncate -s " + STR$(G) + " " + P$)
+IF R <> 0
+    PRINT "skipped: truncate failed"
+    RM P$
+    EXIT
+ENDIF
+F = FOPEN(P$, "r+")
+S = FSIZE(F)
+FSEEK F, G - 2
+W = FWRITE(F, "xyz")
+T = FSIZE(F)
+FSEEK F, G - 1
+A$ = FREAD$(F, 2)
+E = EOFD(F)
+FCLOSE F
+RM P$
+IF S <> G | W = 0 | T <> G + 1 | A$ <> "yz" | E = 0
+    PRINT "FAIL: size "; S; " then "; T; ", read '"; A$; "', eof "; E
+    EXIT 1
+ENDIF
+PRINT "ok"
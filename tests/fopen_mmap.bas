@@ -0,0 +1,33 @@
+# Memory-mapped read-only FOPEN mode "m"
+P$ = "fopen_mmap.tmp"
+F = FOPEN(P$, "w")
+FOR I, 0, I < 1000, 1
+FWRITELN F, "line " + STR$(I)
+NEXT
+FCLOSE F
+F = FOPEN(P$, "m")
+IF F < 0
+    PRINT "FAIL: FOPEN "; P$; " m: "; _ERRNOSTR$(_FILEERROR())
+    EXIT 1
+ENDIF
+S = FSIZE(F)
+N = 0
+L$ = ""
+DO
+L$ = FREADLINE$(F)
+N = N + 1
+LOOPWHILE EOF(F) = 0
+FSEEK F, 5
+A$ = FREAD$(F, 3)
+W = FWRITE(F, "x")
+FCLOSE F
+RM P$
+IF N <> 1000 | L$ <> "line 999" | A$ <> "0" + CHR$(10) + "l"
+    PRINT "FAIL: read "; N; " lines, last '"; L$; "', size "; S
+    EXIT 1
+ENDIF
+IF W <> 0
+    PRINT "FAIL: FWRITE on a mapped file returned "; W
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,31 @@
+# Read-ahead FOPEN mode "p" over a file spanning several buffer blocks
+P$ = "fopen_readahead.tmp"
+A$ = "0123456789012345678901234567890123456789"
+F = FOPEN(P$, "w")
+FOR I, 0, I < 30000, 1
+FWRITELN F, A$ + STR$(I)
+NEXT
+FCLOSE F
+F = FOPEN(P$, "rp")
+IF F < 0
+    PRINT "FAIL: FOPEN "; P$; " rp: "; _ERRNOSTR$(_FILEERROR())
+    EXIT 1
+ENDIF
+N = 0
+DO
+L$ = FREADLINE$(F)
+IF L$ <> A$ + STR$(N)
+    PRINT "FAIL: line "; N; " is '"; L$; "'"
+    EXIT 1
+ENDIF
+N = N + 1
+LOOPWHILE EOF(F) = 0
+FSEEK F, 42
+B$ = FREADLINE$(F)
+FCLOSE F
+RM P$
+IF N <> 30000 | B$ <> A$ + "1"
+    PRINT "FAIL: read "; N; " lines, '"; B$; "' after FSEEK"
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,27 @@
+# Fixed-length record files with FOPENREC, GETREC$ and PUTREC, with and without a page cache
+P$ = "fopenrec.tmp"
+F = FOPENREC(P$, 8, 2)
+IF F < 0
+    PRINT "FAIL: FOPENREC "; P$; ": "; _ERRNOSTR$(_FILEERROR())
+    EXIT 1
+ENDIF
+FOR I, 0, I < 1000, 1
+PUTREC F, I, "rec" + STR$(I)
+NEXT
+PUTREC F, 5, "truncated to eight"
+A$ = GETREC$(F, 999)
+B$ = GETREC$(F, 1000)
+S = FSIZE(F)
+FCLOSE F
+F = FOPENREC(P$, 8)
+C$ = GETREC$(F, 5)
+D$ = GETREC$(F, 500)
+PUTREC F, 500, "x"
+E$ = GETREC$(F, 500)
+FCLOSE F
+RM P$
+IF A$ <> "rec999" | B$ <> "" | S <> 8000 | C$ <> "truncate" | D$ <> "rec500" | E$ <> "x"
+    PRINT "FAIL: read '"; A$; "' '"; B$; "' '"; C$; "' '"; D$; "' '"; E$; "', size "; S
+    EXIT 1
+ENDIF
+PRINT "ok"
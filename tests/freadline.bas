@@ -0,0 +1,25 @@
+# FREADLINE$ and FREAD$ with a length
+P$ = "freadline.tmp"
+F = FOPEN(P$, "w")
+FWRITE F, "first" + CHR$(10) + "second" + CHR$(13) + CHR$(10) + "third"
+FCLOSE F
+F = FOPEN(P$, "r")
+A$ = FREADLINE$(F)
+B$ = FREADLINE$(F)
+C$ = FREADLINE$(F)
+E = EOF(F)
+FCLOSE F
+IF A$ <> "first" | B$ <> "second" | C$ <> "third" | E = 0
+    PRINT "FAIL: FREADLINE$ read '"; A$; "' '"; B$; "' '"; C$; "' eof "; E
+    EXIT 1
+ENDIF
+F = FOPEN(P$, "r")
+A$ = FREAD$(F, 3)
+B$ = FREAD$(F, 2)
+FCLOSE F
+RM P$
+IF A$ <> "fir" | B$ <> "st"
+    PRINT "FAIL: FREAD$ read '"; A$; "' '"; B$; "'"
+    EXIT 1
+ENDIF
+PRINT "ok"
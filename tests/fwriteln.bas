@@ -0,0 +1,37 @@
+# FWRITELN, FBUFFER and the writev append mode "av"
+P$ = "fwriteln.tmp"
+F = FOPEN(P$, "w")
+FWRITELN F, "head"
+FCLOSE F
+F = FOPEN(P$, "av")
+IF FBUFFER(F, 16) = 0
+    PRINT "FAIL: FBUFFER"
+    EXIT 1
+ENDIF
+FOR I, 0, I < 100, 1
+FWRITELN F, STR$(I)
+NEXT
+FWRITELN F, "a line that does not fit in the buffer"
+FWRITE F, "tail"
+FCLOSE F
+F = FOPEN(P$, "r")
+S = FSIZE(F)
+H$ = FREADLINE$(F)
+N = 0
+DO
+L$ = FREADLINE$(F)
+IF L$ <> STR$(N)
+    PRINT "FAIL: line "; N; " is '"; L$; "'"
+    EXIT 1
+ENDIF
+N = N + 1
+LOOPWHILE N < 100
+L$ = FREADLINE$(F)
+T$ = FREADLINE$(F)
+FCLOSE F
+RM P$
+IF H$ <> "head" | L$ <> "a line that does not fit in the buffer" | T$ <> "tail" | S <> 5 + 290 + 39 + 4
+    PRINT "FAIL: read '"; H$; "' '"; L$; "' '"; T$; "', size "; S
+    EXIT 1
+ENDIF
+PRINT "ok"
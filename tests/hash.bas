@@ -0,0 +1,36 @@
+# HASH$ against known digests and FHASH$ against HASH$ and sha256sum
+IF HASH$("sha256", "abc") <> "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"
+    PRINT "FAIL: sha256 of abc is "; HASH$("sha256", "abc")
+    EXIT 1
+ENDIF
+IF HASH$("crc32c", "123456789") <> "e3069283" | HASH$("CRC-32C", "") <> "00000000"
+    PRINT "FAIL: crc32c gave "; HASH$("crc32c", "123456789"); " and "; HASH$("CRC-32C", "")
+    EXIT 1
+ENDIF
+IF HASH$("xxh64", "abc") <> "44bc2cf5ad770999" | HASH$("xxhash64", "") <> "ef46db3751d8e999"
+    PRINT "FAIL: xxh64 gave "; HASH$("xxh64", "abc"); " and "; HASH$("xxhash64", "")
+    EXIT 1
+ENDIF
+P$ = "hash.tmp"
+F = FOPEN(P$, "w")
+FWRITE F, "abc"
+FCLOSE F
+A$ = FHASH$("sha256", P$)
+B$ = FHASH$("xxh64", P$)
+F = FOPEN(P$, "w")
+FOR I, 0, I < 50000, 1
+FWRITELN F, "line " + STR$(I)
+NEXT
+FCLOSE F
+C$ = FHASH$("sha256", P$)
+D$ = SH$("sha256sum " + P$ + " | cut -c1-64 | tr -d '\n'")
+RM P$
+IF A$ <> HASH$("sha256", "abc") | B$ <> HASH$("xxh64", "abc")
+    PRINT "FAIL: FHASH$ gave "; A$; " and "; B$
+    EXIT 1
+ENDIF
+IF D$ <> "" & C$ <> D$
+    PRINT "FAIL: FHASH$ gave "; C$; ", sha256sum gave "; D$
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,18 @@
+# --jobs prints the shards' output in shard order and exits with the worst code
+C$ = _STARTCMD$() + " -s -r -e -j "
+A$ = SH$(C$ + "4 -c 'WAIT 0.02 * (4 - _SHARD()): PRINT _SHARD(); _SHARDS()'")
+IF A$ <> "04" + CHR$(10) + "14" + CHR$(10) + "24" + CHR$(10) + "34" + CHR$(10)
+    PRINT "FAIL: shards printed '"; A$; "'"
+    EXIT 1
+ENDIF
+A$ = SH$(C$ + "4 -c 'IF _SHARD() = 0: WAIT 0.2: ENDIF: FOR I, 0, I < 20000, 1: PRINT _SHARD(): NEXT' | uniq | tr -d '\n'")
+IF A$ <> "0123"
+    PRINT "FAIL: interleaved shard output '"; A$; "'"
+    EXIT 1
+ENDIF
+A$ = SH$(C$ + "3 -c 'EXIT _SHARD() * 2'; echo $?")
+IF A$ <> "4" + CHR$(10)
+    PRINT "FAIL: --jobs exited with "; A$
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,38 @@
+# Persistent key-value store: puts, overwrites, deletes, and reopening
+P$ = "kv.tmp"
+RM P$
+K = KVOPEN(P$)
+IF K < 0
+    PRINT "FAIL: KVOPEN "; P$; ": "; _ERRNOSTR$(_FILEERROR())
+    EXIT 1
+ENDIF
+FOR R, 0, R < 4, 1
+FOR I, 0, I < 2000, 1
+KVPUT K, "key" + STR$(I), "value" + STR$(I * R)
+NEXT
+NEXT
+FOR I, 0, I < 2000, 2
+KVDEL K, "key" + STR$(I)
+NEXT
+KVCLOSE K
+K = KVOPEN(P$)
+FOR I, 0, I < 2000, 1
+V$ = KVGET$(K, "key" + STR$(I), "none")
+W$ = "value" + STR$(I * 3)
+IF MOD(I, 2) = 0
+    W$ = "none"
+ENDIF
+IF V$ <> W$
+    PRINT "FAIL: key"; I; " is '"; V$; "', expected '"; W$; "'"
+    EXIT 1
+ENDIF
+NEXT
+H = KVHAS(K, "key1")
+G = KVHAS(K, "key0")
+KVCLOSE K
+RM P$
+IF H = 0 | G <> 0
+    PRINT "FAIL: KVHAS returned "; H; " and "; G
+    EXIT 1
+ENDIF
+PRINT "ok"
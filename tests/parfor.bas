@@ -0,0 +1,48 @@
+# PARFOR over numeric ranges with REDUCE clauses, shared arrays and GOSUB from the body
+IF 0
+    @SQ
+    T = I * I
+    RETURN
+ENDIF
+S = 0
+MX = -1
+MN = 1000000
+DIM A, 1000
+PARFOR I, 1, 1000, REDUCE + S, REDUCE MAX MX, REDUCE MIN MN
+    GOSUB SQ
+    A[I] = T
+    S = S + I
+    IF I > MX
+        MX = I
+    ENDIF
+    IF I < MN
+        MN = I
+    ENDIF
+NEXT
+C = 0
+FOR K, 1, K <= 1000, 1
+C = C + A[K]
+NEXT
+IF S <> 500500 | MX <> 1000 | MN <> 1 | C <> 333833500 | I <> 1001
+    PRINT "FAIL: sum "; S; ", max "; MX; ", min "; MN; ", squares "; C; ", I "; I
+    EXIT 1
+ENDIF
+P = 1
+PARFOR I = 1, 10 REDUCE * P
+    P = P * I
+NEXT
+Q = 0
+PARFOR I, 1, 4, REDUCE + Q
+    PARFOR J, 1, 10, REDUCE + Q
+        Q = Q + I * J
+    NEXT
+NEXT
+Z = 5
+PARFOR I, 3, 2, REDUCE + Z
+    Z = 100
+NEXT
+IF P <> 3628800 | Q <> 550 | Z <> 5 | I <> 3
+    PRINT "FAIL: product "; P; ", nested "; Q; ", empty range "; Z; " "; I
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,23 @@
+# Shared-memory arrays updated by --jobs shards and PARFOR chunks
+K$ = "/cbtest." + STR$(TIMEUS())
+SHMDIM R, 1, K$
+SHMDIM N$, 3, 8, K$ + "s"
+C$ = _STARTCMD$() + " -s -r -e -j 4 -c '"
+SH C$ + "SHMATTACH R, " + CHR$(34) + K$ + CHR$(34) + ": SHMATTACH N$, " + CHR$(34) + K$ + "s" + CHR$(34) + ": FOR I, 0, I < 1000, 1: SHMADD R[0], 1: NEXT: SHMADD R[1], _SHARD(): N$[_SHARD()] = " + CHR$(34) + "shard" + CHR$(34) + " + STR$(_SHARD())'"
+IF R[0] <> 4000 | R[1] <> 6 | N$[0] <> "shard0" | N$[3] <> "shard3"
+    PRINT "FAIL: shards left "; R[0]; " "; R[1]; " '"; N$[0]; "' '"; N$[3]; "'"
+    EXIT 1
+ENDIF
+PARFOR I, 1, 100
+    SHMADD R[0], I
+NEXT
+IF R[0] <> 9050
+    PRINT "FAIL: PARFOR left "; R[0]
+    EXIT 1
+ENDIF
+A$ = SH$(C$ + "SHMDIM C, 0, " + CHR$(34) + K$ + "c" + CHR$(34) + ": SHMADD C[0], 1: WAIT 0.3: PRINT C[0]' | tail -n 1")
+IF A$ <> "4" + CHR$(10)
+    PRINT "FAIL: shards sharing one SHMDIM counted '"; A$; "'"
+    EXIT 1
+ENDIF
+PRINT "ok"
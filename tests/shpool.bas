@@ -0,0 +1,28 @@
+# SH and SH$ through the shell pool give the same results as without it
+A = SH("exit 3")
+A$ = SH$("printf 'no newline'")
+_SHPOOL 2
+IF _SHPOOL() <> 2
+    PRINT "FAIL: _SHPOOL() is "; _SHPOOL()
+    EXIT 1
+ENDIF
+B = SH("exit 3")
+B$ = SH$("printf 'no newline'")
+M$ = SH$("printf '\036CB0000:1\n'")
+C$ = SH$("head -c 20000 /dev/zero | tr '\0' a")
+D = SH("true")
+MD "shpool.tmp"
+CD "shpool.tmp"
+W$ = SH$("basename " + CHR$(34) + "$PWD" + CHR$(34))
+CD ".."
+RM "shpool.tmp"
+_SHPOOL 0
+IF A <> B | A = 0 | D <> 0 | A$ <> B$ | B$ <> "no newline"
+    PRINT "FAIL: codes "; A; " "; B; " "; D; ", output '"; A$; "' '"; B$; "'"
+    EXIT 1
+ENDIF
+IF M$ <> CHR$(30) + "CB0000:1" + CHR$(10) | LEN(C$) <> 20000 | W$ <> "shpool.tmp" + CHR$(10) | _SHPOOL() <> 0
+    PRINT "FAIL: output '"; M$; "', "; LEN(C$); " bytes, cwd '"; W$; "'"
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,49 @@
+# LISTEN, ACCEPT and FOPEN "s" over a unix socket, plus a loopback TCP round trip
+P$ = "unix:sockets.tmp"
+L = LISTEN(P$)
+IF L < 0
+    PRINT "FAIL: LISTEN "; P$; ": "; _ERRNOSTR$(_FILEERROR())
+    EXIT 1
+ENDIF
+F = FOPEN(P$, "s")
+C = ACCEPT(L)
+IF F < 0 | C < 0
+    PRINT "FAIL: connect "; F; ", accept "; C
+    EXIT 1
+ENDIF
+FOR I, 1, I <= 100, 1
+FWRITELN F, "MSG" + STR$(I)
+S$ = FREADLINE$(C)
+FWRITELN C, "ECHO " + S$
+R$ = FREADLINE$(F)
+NEXT
+FWRITE C, "abc"
+A$ = FREAD$(F, 100)
+FCLOSE C
+E$ = FREADLINE$(F)
+E = EOF(F)
+FCLOSE F
+FCLOSE L
+IF R$ <> "ECHO MSG100" | A$ <> "abc" | E$ <> "" | E = 0 | ISFILE("sockets.tmp") <> -1
+    PRINT "FAIL: got '"; R$; "' '"; A$; "' '"; E$; "', eof "; E
+    EXIT 1
+ENDIF
+L = LISTEN("tcp:127.0.0.1:39517")
+IF L > -1
+    F = FOPEN("tcp:127.0.0.1:39517", "s")
+    C = ACCEPT(L)
+    FWRITELN F, "ping"
+    S$ = FREADLINE$(C)
+    FCLOSE C
+    FCLOSE F
+    FCLOSE L
+    IF S$ <> "ping"
+        PRINT "FAIL: TCP read '"; S$; "'"
+        EXIT 1
+    ENDIF
+ENDIF
+IF FOPEN("tcp:127.0.0.1:1", "s") <> -1
+    PRINT "FAIL: connected to a closed port"
+    EXIT 1
+ENDIF
+PRINT "ok"
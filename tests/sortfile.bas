@@ -0,0 +1,38 @@
+# SORTFILE on a file that spills into several runs, numeric key, reverse and unique
+P$ = "sortfile.tmp"
+Q$ = "sortfile.out"
+A$ = "padding to make the input span several runs of the in-memory sort so that they have to be merged"
+F = FOPEN(P$, "w")
+FOR I, 0, I < 30000, 1
+FWRITELN F, A$ + "," + STR$(MOD(I * 7919, 30000))
+NEXT
+FCLOSE F
+SORTFILE P$, Q$, "k2 t, n m1 j2"
+F = FOPEN(Q$, "r")
+FOR I, 0, I < 30000, 1
+L$ = FREADLINE$(F)
+IF L$ <> A$ + "," + STR$(I)
+    PRINT "FAIL: line "; I; " is '"; L$; "'"
+    EXIT 1
+ENDIF
+NEXT
+E = EOF(F)
+FCLOSE F
+F = FOPEN(P$, "w")
+FWRITELN F, "b"
+FWRITELN F, "a"
+FWRITELN F, "c"
+FWRITELN F, "b"
+FCLOSE F
+SORTFILE P$, Q$, "ru"
+F = FOPEN(Q$, "r")
+R$ = FREADLINE$(F) + FREADLINE$(F) + FREADLINE$(F)
+G = EOF(F)
+FCLOSE F
+RM P$
+RM Q$
+IF E = 0 | R$ <> "cba" | G = 0
+    PRINT "FAIL: eof "; E; ", reverse unique sort gave '"; R$; "'"
+    EXIT 1
+ENDIF
+PRINT "ok"
@@ -0,0 +1,33 @@
+# SPAWN/JOIN tasks sending partial sums over a channel, each with its own variables
+IF 0
+    @WORK
+    C = VAL(_ARG$(1))
+    K = VAL(_ARG$(2))
+    S = 0
+    FOR I, K * 1000, I < (K + 1) * 1000, 1
+    S = S + I
+    NEXT
+    X = 99
+    CHANSEND C, STR$(S)
+    RETURN
+ENDIF
+X = 1
+C = CHANOPEN(2)
+DIM T, 3
+FOR K, 0, K < 4, 1
+T[K] = SPAWN(WORK, C, K)
+NEXT
+S = 0
+FOR K, 0, K < 4, 1
+S = S + VAL(CHANRECV$(C))
+NEXT
+E = 0
+FOR K, 0, K < 4, 1
+E = E + JOIN(T[K])
+NEXT
+CHANCLOSE C
+IF S <> 7998000 | E <> 0 | X <> 1
+    PRINT "FAIL: sum "; S; ", join codes "; E; ", X "; X
+    EXIT 1
+ENDIF
+PRINT "ok"
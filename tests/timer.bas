@@ -0,0 +1,33 @@
+# ON TIMER ticks while busy, during WAIT, inside skipped blocks, and after ON TIMER OFF
+IF 0
+    @TICK
+    N = N + 1
+    RETURN
+ENDIF
+N = 0
+S = TIMERUS()
+ON TIMER 10 GOSUB TICK
+DO
+IF TIMERUS() - S > 5000000
+BREAK
+ENDIF
+LOOPWHILE N < 5
+T = TIMERUS() - S
+IF N < 5 | T < 40000
+    PRINT "FAIL: "; N; " ticks after "; T; " us"
+    EXIT 1
+ENDIF
+N = 0
+WAIT 0.2
+IF N < 5
+    PRINT "FAIL: "; N; " ticks during WAIT 0.2"
+    EXIT 1
+ENDIF
+ON TIMER OFF
+M = N
+WAIT 0.05
+IF N <> M
+    PRINT "FAIL: "; N - M; " ticks after ON TIMER OFF"
+    EXIT 1
+ENDIF
+PRINT "ok"